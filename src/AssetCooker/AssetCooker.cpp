@@ -0,0 +1,766 @@
+// Converts source assets into the flat formats described in CookedAssets.hpp, so the game can map them straight into
+// memory instead of parsing them on every start.
+//
+// Usage: AssetCooker mesh <input.glb> <output.gmesh>
+//        AssetCooker texture <input.png> <output.gtex>
+//        AssetCooker course <input.glb> <output.gcourse> [tile size in meters]
+
+// clang-format off
+#include <Framework/Types.hpp>
+
+#define CGLTF_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#define GLM_ENABLE_EXPERIMENTAL
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cgltf.h>
+#include <stb_image.h>
+
+#include <spdlog/spdlog.h>
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "CookedAssets.hpp"
+// clang-format on
+
+struct CookedMesh
+{
+    std::vector<CookedVertex> vertices;
+    std::vector<u32> indices;
+    std::vector<CookedCollisionTriangle> collisionTriangles;
+
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+};
+
+static bool readAttribute(const cgltf_accessor *accessor, size_t index, f32 *out, size_t componentCount)
+{
+    if (accessor == NULL)
+    {
+        return false;
+    }
+
+    return cgltf_accessor_read_float(accessor, index, out, componentCount) != 0;
+}
+
+static bool appendPrimitive(CookedMesh *mesh, const cgltf_primitive *primitive, const glm::mat4 &transform)
+{
+    if (primitive->type != cgltf_primitive_type_triangles)
+    {
+        spdlog::warn("Skipping non-triangle primitive");
+        return true;
+    }
+
+    const cgltf_accessor *positions = NULL;
+    const cgltf_accessor *normals = NULL;
+    const cgltf_accessor *colors = NULL;
+    const cgltf_accessor *uvs = NULL;
+
+    for (size_t attributeIndex = 0; attributeIndex < primitive->attributes_count; attributeIndex++)
+    {
+        const cgltf_attribute *attribute = &primitive->attributes[attributeIndex];
+
+        switch (attribute->type)
+        {
+            case cgltf_attribute_type_position:
+            {
+                positions = attribute->data;
+                break;
+            }
+            case cgltf_attribute_type_normal:
+            {
+                normals = attribute->data;
+                break;
+            }
+            case cgltf_attribute_type_color:
+            {
+                colors = attribute->index == 0 ? attribute->data : colors;
+                break;
+            }
+            case cgltf_attribute_type_texcoord:
+            {
+                uvs = attribute->index == 0 ? attribute->data : uvs;
+                break;
+            }
+            default:
+            {
+                break;
+            }
+        }
+    }
+
+    if (positions == NULL)
+    {
+        spdlog::error("Primitive has no positions");
+        return false;
+    }
+
+    glm::mat3 normalTransform = glm::transpose(glm::inverse(glm::mat3(transform)));
+
+    size_t baseVertex = mesh->vertices.size();
+    if (baseVertex + positions->count > UINT32_MAX)
+    {
+        spdlog::error("Mesh has too many vertices for 32 bit indices");
+        return false;
+    }
+
+    for (size_t vertexIndex = 0; vertexIndex < positions->count; vertexIndex++)
+    {
+        f32 position[3] = {0.0F, 0.0F, 0.0F};
+        f32 normal[3] = {0.0F, 1.0F, 0.0F};
+        f32 color[4] = {1.0F, 1.0F, 1.0F, 1.0F};
+        f32 uv[2] = {0.0F, 0.0F};
+
+        readAttribute(positions, vertexIndex, position, 3);
+        readAttribute(normals, vertexIndex, normal, 3);
+        readAttribute(colors, vertexIndex, color, colors && colors->type == cgltf_type_vec3 ? 3 : 4);
+        readAttribute(uvs, vertexIndex, uv, 2);
+
+        glm::vec4 worldPosition = transform * glm::vec4(position[0], position[1], position[2], 1.0F);
+        glm::vec3 worldNormal = normalTransform * glm::vec3(normal[0], normal[1], normal[2]);
+        if (glm::dot(worldNormal, worldNormal) > 0.0F)
+        {
+            worldNormal = glm::normalize(worldNormal);
+        }
+
+        CookedVertex vertex;
+        vertex.position[0] = worldPosition.x;
+        vertex.position[1] = worldPosition.y;
+        vertex.position[2] = worldPosition.z;
+        vertex.normal[0] = worldNormal.x;
+        vertex.normal[1] = worldNormal.y;
+        vertex.normal[2] = worldNormal.z;
+        memcpy(vertex.color, color, sizeof(vertex.color));
+        memcpy(vertex.uv, uv, sizeof(vertex.uv));
+
+        mesh->vertices.push_back(vertex);
+
+        glm::vec3 p(worldPosition.x, worldPosition.y, worldPosition.z);
+        mesh->boundsMin = glm::min(mesh->boundsMin, p);
+        mesh->boundsMax = glm::max(mesh->boundsMax, p);
+    }
+
+    size_t indexCount = primitive->indices ? primitive->indices->count : positions->count;
+    for (size_t index = 0; index < indexCount; index++)
+    {
+        size_t vertexIndex = primitive->indices ? cgltf_accessor_read_index(primitive->indices, index) : index;
+        mesh->indices.push_back((u32)(baseVertex + vertexIndex));
+    }
+
+    return true;
+}
+
+static void computeCollisionTriangles(CookedMesh *mesh)
+{
+    size_t triangleCount = mesh->indices.size() / 3;
+    mesh->collisionTriangles.clear();
+    mesh->collisionTriangles.reserve(triangleCount);
+
+    size_t degenerateCount = 0;
+
+    for (size_t triangleIndex = 0; triangleIndex < triangleCount; triangleIndex++)
+    {
+        CookedCollisionTriangle triangle;
+        triangle.a = mesh->indices[triangleIndex * 3 + 0];
+        triangle.b = mesh->indices[triangleIndex * 3 + 1];
+        triangle.c = mesh->indices[triangleIndex * 3 + 2];
+
+        glm::vec3 p0 = glm::make_vec3(mesh->vertices[triangle.a].position);
+        glm::vec3 p1 = glm::make_vec3(mesh->vertices[triangle.b].position);
+        glm::vec3 p2 = glm::make_vec3(mesh->vertices[triangle.c].position);
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+
+        // A triangle without area has no plane, and a zero normal would collide with everything
+        if (glm::dot(normal, normal) <= FLT_MIN)
+        {
+            degenerateCount++;
+            continue;
+        }
+
+        // Keep the face on the side the authored vertex normals point to, whatever the winding
+        glm::vec3 n0 = glm::make_vec3(mesh->vertices[triangle.a].normal);
+        glm::vec3 n1 = glm::make_vec3(mesh->vertices[triangle.b].normal);
+        glm::vec3 n2 = glm::make_vec3(mesh->vertices[triangle.c].normal);
+        normal = glm::normalize(normal);
+        if (glm::dot(normal, n0 + n1 + n2) < 0.0F)
+        {
+            normal = -normal;
+        }
+
+        triangle.normal[0] = normal.x;
+        triangle.normal[1] = normal.y;
+        triangle.normal[2] = normal.z;
+        triangle.d = glm::dot(normal, p0);
+
+        mesh->collisionTriangles.push_back(triangle);
+    }
+
+    if (degenerateCount > 0)
+    {
+        spdlog::info("Dropped {} degenerate triangles from the collision geometry", degenerateCount);
+    }
+}
+
+static bool buildMesh(const char *inputPath, CookedMesh *mesh)
+{
+    cgltf_options options = {};
+    cgltf_data *gltfData = NULL;
+    if (cgltf_parse_file(&options, inputPath, &gltfData) != cgltf_result_success)
+    {
+        spdlog::error("Could not parse \"{}\"", inputPath);
+        return false;
+    }
+
+    if (cgltf_load_buffers(&options, gltfData, inputPath) != cgltf_result_success)
+    {
+        spdlog::error("Could not load buffers for \"{}\"", inputPath);
+        cgltf_free(gltfData);
+        return false;
+    }
+
+    mesh->boundsMin = glm::vec3(FLT_MAX);
+    mesh->boundsMax = glm::vec3(-FLT_MAX);
+
+    bool success = true;
+    bool anyNodeMeshes = false;
+
+    // Bake node transforms into the vertices so multi-node scenes come out the way they were authored
+    for (size_t nodeIndex = 0; nodeIndex < gltfData->nodes_count && success; nodeIndex++)
+    {
+        const cgltf_node *node = &gltfData->nodes[nodeIndex];
+        if (node->mesh == NULL)
+        {
+            continue;
+        }
+
+        anyNodeMeshes = true;
+
+        glm::mat4 transform;
+        cgltf_node_transform_world(node, glm::value_ptr(transform));
+
+        for (size_t primitiveIndex = 0; primitiveIndex < node->mesh->primitives_count && success; primitiveIndex++)
+        {
+            success = appendPrimitive(mesh, &node->mesh->primitives[primitiveIndex], transform);
+        }
+    }
+
+    if (!anyNodeMeshes)
+    {
+        for (size_t meshIndex = 0; meshIndex < gltfData->meshes_count && success; meshIndex++)
+        {
+            const cgltf_mesh *gltfMesh = &gltfData->meshes[meshIndex];
+            for (size_t primitiveIndex = 0; primitiveIndex < gltfMesh->primitives_count && success; primitiveIndex++)
+            {
+                success = appendPrimitive(mesh, &gltfMesh->primitives[primitiveIndex], glm::mat4(1.0F));
+            }
+        }
+    }
+
+    cgltf_free(gltfData);
+
+    if (mesh->vertices.empty())
+    {
+        spdlog::warn("\"{}\" contains no triangle meshes", inputPath);
+        mesh->boundsMin = glm::vec3(0.0F);
+        mesh->boundsMax = glm::vec3(0.0F);
+    }
+
+    computeCollisionTriangles(mesh);
+
+    return success;
+}
+
+static bool writeSection(FILE *file, u64 offset, const void *data, size_t size)
+{
+    if (fseek(file, (long)offset, SEEK_SET) != 0)
+    {
+        return false;
+    }
+
+    return size == 0 || fwrite(data, 1, size, file) == size;
+}
+
+static bool writeMesh(const char *outputPath, const CookedMesh *mesh)
+{
+    CookedMeshHeader header = {};
+    header.magic = COOKED_MESH_MAGIC;
+    header.version = COOKED_MESH_VERSION;
+    header.vertexCount = (u32)mesh->vertices.size();
+    header.indexCount = (u32)mesh->indices.size();
+    header.collisionTriangleCount = (u32)mesh->collisionTriangles.size();
+
+    size_t vertexDataSize = mesh->vertices.size() * sizeof(CookedVertex);
+    size_t indexDataSize = mesh->indices.size() * sizeof(u32);
+    size_t collisionDataSize = mesh->collisionTriangles.size() * sizeof(CookedCollisionTriangle);
+
+    header.vertexDataOffset = alignCookedOffset(sizeof(CookedMeshHeader));
+    header.indexDataOffset = alignCookedOffset(header.vertexDataOffset + vertexDataSize);
+    header.collisionDataOffset = alignCookedOffset(header.indexDataOffset + indexDataSize);
+
+    memcpy(header.boundsMin, glm::value_ptr(mesh->boundsMin), sizeof(header.boundsMin));
+    memcpy(header.boundsMax, glm::value_ptr(mesh->boundsMax), sizeof(header.boundsMax));
+
+    FILE *file = fopen(outputPath, "wb");
+    if (file == NULL)
+    {
+        spdlog::error("Could not open \"{}\" for writing", outputPath);
+        return false;
+    }
+
+    bool success = writeSection(file, 0, &header, sizeof(header)) &&
+                   writeSection(file, header.vertexDataOffset, mesh->vertices.data(), vertexDataSize) &&
+                   writeSection(file, header.indexDataOffset, mesh->indices.data(), indexDataSize) &&
+                   writeSection(file, header.collisionDataOffset, mesh->collisionTriangles.data(), collisionDataSize);
+
+    success = fclose(file) == 0 && success;
+    if (!success)
+    {
+        spdlog::error("Failed writing \"{}\"", outputPath);
+        remove(outputPath);
+    }
+
+    return success;
+}
+
+static bool cookMesh(const char *inputPath, const char *outputPath)
+{
+    CookedMesh mesh;
+    if (!buildMesh(inputPath, &mesh))
+    {
+        return false;
+    }
+
+    if (!writeMesh(outputPath, &mesh))
+    {
+        return false;
+    }
+
+    spdlog::info("Cooked \"{}\": {} vertices, {} indices, {} collision triangles", inputPath, mesh.vertices.size(),
+                 mesh.indices.size(), mesh.collisionTriangles.size());
+
+    return true;
+}
+
+struct CookedCourse
+{
+    f32 tileSize;
+    s32 gridMinX, gridMinZ;
+    u32 gridWidth, gridDepth;
+
+    std::vector<CookedCourseTile> tiles;
+    std::vector<std::vector<f32> > tilePositions;
+    std::vector<std::vector<CookedCollisionTriangle> > tileTriangles;
+};
+
+static s32 tileCoordinate(f32 position, f32 tileSize)
+{
+    return (s32)floorf(position / tileSize);
+}
+
+// Buckets every collision triangle into each tile its XZ bounds overlap, then gives every tile its own compact
+// vertex list so tiles can be loaded and dropped independently
+static bool buildCourse(const CookedMesh *mesh, f32 tileSize, CookedCourse *course)
+{
+    if (mesh->collisionTriangles.empty())
+    {
+        spdlog::error("Course has no triangles");
+        return false;
+    }
+
+    course->tileSize = tileSize;
+    course->gridMinX = tileCoordinate(mesh->boundsMin.x, tileSize);
+    course->gridMinZ = tileCoordinate(mesh->boundsMin.z, tileSize);
+    course->gridWidth = (u32)(tileCoordinate(mesh->boundsMax.x, tileSize) - course->gridMinX + 1);
+    course->gridDepth = (u32)(tileCoordinate(mesh->boundsMax.z, tileSize) - course->gridMinZ + 1);
+
+    std::vector<std::vector<u32> > buckets((size_t)course->gridWidth * course->gridDepth);
+
+    for (size_t triangleIndex = 0; triangleIndex < mesh->collisionTriangles.size(); triangleIndex++)
+    {
+        const CookedCollisionTriangle *triangle = &mesh->collisionTriangles[triangleIndex];
+        const f32 *p0 = mesh->vertices[triangle->a].position;
+        const f32 *p1 = mesh->vertices[triangle->b].position;
+        const f32 *p2 = mesh->vertices[triangle->c].position;
+
+        s32 minX = tileCoordinate(glm::min(p0[0], glm::min(p1[0], p2[0])), tileSize) - course->gridMinX;
+        s32 maxX = tileCoordinate(glm::max(p0[0], glm::max(p1[0], p2[0])), tileSize) - course->gridMinX;
+        s32 minZ = tileCoordinate(glm::min(p0[2], glm::min(p1[2], p2[2])), tileSize) - course->gridMinZ;
+        s32 maxZ = tileCoordinate(glm::max(p0[2], glm::max(p1[2], p2[2])), tileSize) - course->gridMinZ;
+
+        for (s32 z = minZ; z <= maxZ; z++)
+        {
+            for (s32 x = minX; x <= maxX; x++)
+            {
+                buckets[(size_t)z * course->gridWidth + (size_t)x].push_back((u32)triangleIndex);
+            }
+        }
+    }
+
+    // Global vertex index -> index within the tile being built, reset through the tile's own vertex list
+    std::vector<u32> localIndices(mesh->vertices.size(), UINT32_MAX);
+    std::vector<u32> tileVertices;
+
+    for (u32 z = 0; z < course->gridDepth; z++)
+    {
+        for (u32 x = 0; x < course->gridWidth; x++)
+        {
+            const std::vector<u32> *bucket = &buckets[(size_t)z * course->gridWidth + x];
+            if (bucket->empty())
+            {
+                continue;
+            }
+
+            CookedCourseTile tile = {};
+            tile.x = course->gridMinX + (s32)x;
+            tile.z = course->gridMinZ + (s32)z;
+
+            glm::vec3 boundsMin(FLT_MAX);
+            glm::vec3 boundsMax(-FLT_MAX);
+
+            std::vector<f32> positions;
+            std::vector<CookedCollisionTriangle> triangles(bucket->size());
+            tileVertices.clear();
+
+            for (size_t bucketIndex = 0; bucketIndex < bucket->size(); bucketIndex++)
+            {
+                CookedCollisionTriangle triangle = mesh->collisionTriangles[(*bucket)[bucketIndex]];
+                u32 *corners[3] = {&triangle.a, &triangle.b, &triangle.c};
+
+                for (u32 corner = 0; corner < 3; corner++)
+                {
+                    u32 globalIndex = *corners[corner];
+                    if (localIndices[globalIndex] == UINT32_MAX)
+                    {
+                        localIndices[globalIndex] = (u32)tileVertices.size();
+                        tileVertices.push_back(globalIndex);
+
+                        glm::vec3 position = glm::make_vec3(mesh->vertices[globalIndex].position);
+                        positions.push_back(position.x);
+                        positions.push_back(position.y);
+                        positions.push_back(position.z);
+
+                        boundsMin = glm::min(boundsMin, position);
+                        boundsMax = glm::max(boundsMax, position);
+                    }
+
+                    *corners[corner] = localIndices[globalIndex];
+                }
+
+                triangles[bucketIndex] = triangle;
+            }
+
+            for (size_t vertexIndex = 0; vertexIndex < tileVertices.size(); vertexIndex++)
+            {
+                localIndices[tileVertices[vertexIndex]] = UINT32_MAX;
+            }
+
+            tile.vertexCount = (u32)tileVertices.size();
+            tile.triangleCount = (u32)triangles.size();
+            memcpy(tile.boundsMin, glm::value_ptr(boundsMin), sizeof(tile.boundsMin));
+            memcpy(tile.boundsMax, glm::value_ptr(boundsMax), sizeof(tile.boundsMax));
+
+            course->tiles.push_back(tile);
+            course->tilePositions.push_back(positions);
+            course->tileTriangles.push_back(triangles);
+        }
+    }
+
+    return true;
+}
+
+// Sections are written in order instead of seeking, course files can be bigger than fseek's long offsets reach
+static bool writePadded(FILE *file, u64 *offset, const void *data, size_t size)
+{
+    static const u8 padding[COOKED_ASSET_ALIGNMENT] = {};
+
+    u64 alignedOffset = alignCookedOffset(*offset);
+    size_t paddingSize = (size_t)(alignedOffset - *offset);
+    if (paddingSize > 0 && fwrite(padding, 1, paddingSize, file) != paddingSize)
+    {
+        return false;
+    }
+
+    if (size > 0 && fwrite(data, 1, size, file) != size)
+    {
+        return false;
+    }
+
+    *offset = alignedOffset + size;
+    return true;
+}
+
+static bool writeCourse(const char *outputPath, CookedCourse *course, const CookedMesh *mesh)
+{
+    CookedCourseHeader header = {};
+    header.magic = COOKED_COURSE_MAGIC;
+    header.version = COOKED_COURSE_VERSION;
+    header.tileSize = course->tileSize;
+    header.tileCount = (u32)course->tiles.size();
+    header.gridMinX = course->gridMinX;
+    header.gridMinZ = course->gridMinZ;
+    header.gridWidth = course->gridWidth;
+    header.gridDepth = course->gridDepth;
+    header.tileTableOffset = alignCookedOffset(sizeof(CookedCourseHeader));
+    memcpy(header.boundsMin, glm::value_ptr(mesh->boundsMin), sizeof(header.boundsMin));
+    memcpy(header.boundsMax, glm::value_ptr(mesh->boundsMax), sizeof(header.boundsMax));
+
+    u64 offset = header.tileTableOffset + course->tiles.size() * sizeof(CookedCourseTile);
+    for (size_t tileIndex = 0; tileIndex < course->tiles.size(); tileIndex++)
+    {
+        CookedCourseTile *tile = &course->tiles[tileIndex];
+        tile->vertexDataOffset = alignCookedOffset(offset);
+        offset = tile->vertexDataOffset + course->tilePositions[tileIndex].size() * sizeof(f32);
+        tile->triangleDataOffset = alignCookedOffset(offset);
+        offset = tile->triangleDataOffset + course->tileTriangles[tileIndex].size() * sizeof(CookedCollisionTriangle);
+    }
+
+    FILE *file = fopen(outputPath, "wb");
+    if (file == NULL)
+    {
+        spdlog::error("Could not open \"{}\" for writing", outputPath);
+        return false;
+    }
+
+    u64 written = 0;
+    bool success = writePadded(file, &written, &header, sizeof(header)) &&
+                   writePadded(file, &written, course->tiles.data(), course->tiles.size() * sizeof(CookedCourseTile));
+    for (size_t tileIndex = 0; tileIndex < course->tiles.size() && success; tileIndex++)
+    {
+        const std::vector<f32> *positions = &course->tilePositions[tileIndex];
+        const std::vector<CookedCollisionTriangle> *triangles = &course->tileTriangles[tileIndex];
+        success = writePadded(file, &written, positions->data(), positions->size() * sizeof(f32)) &&
+                  writePadded(file, &written, triangles->data(), triangles->size() * sizeof(CookedCollisionTriangle));
+    }
+
+    success = fclose(file) == 0 && success;
+    if (!success)
+    {
+        spdlog::error("Failed writing \"{}\"", outputPath);
+        remove(outputPath);
+    }
+
+    return success;
+}
+
+static bool cookCourse(const char *inputPath, const char *outputPath, f32 tileSize)
+{
+    CookedMesh mesh;
+    if (!buildMesh(inputPath, &mesh))
+    {
+        return false;
+    }
+
+    CookedCourse course;
+    if (!buildCourse(&mesh, tileSize, &course) || !writeCourse(outputPath, &course, &mesh))
+    {
+        return false;
+    }
+
+    size_t tileTriangles = 0;
+    for (size_t tileIndex = 0; tileIndex < course.tileTriangles.size(); tileIndex++)
+    {
+        tileTriangles += course.tileTriangles[tileIndex].size();
+    }
+
+    spdlog::info("Cooked \"{}\": {} triangles in {} of {}x{} {:.0f} m tiles, {:.2f}x duplication at tile edges",
+                 inputPath, mesh.collisionTriangles.size(), course.tiles.size(), course.gridWidth, course.gridDepth,
+                 tileSize, (f64)tileTriangles / (f64)mesh.collisionTriangles.size());
+
+    return true;
+}
+
+struct CookedTexture
+{
+    u32 mipCount;
+    u32 widths[COOKED_TEXTURE_MAX_MIPS];
+    u32 heights[COOKED_TEXTURE_MAX_MIPS];
+    std::vector<u8> mips[COOKED_TEXTURE_MAX_MIPS];
+};
+
+// 2x2 box filter, clamping at the edge so odd sized levels still cover every source texel. This matches what
+// glGenerateMipmap does on the drivers we have tried, so cooked textures look like the ones generated at runtime.
+static void downsample(const u8 *source, u32 sourceWidth, u32 sourceHeight, u8 *destination, u32 width, u32 height)
+{
+    for (u32 y = 0; y < height; y++)
+    {
+        u32 y0 = glm::min(y * 2, sourceHeight - 1);
+        u32 y1 = glm::min(y * 2 + 1, sourceHeight - 1);
+
+        for (u32 x = 0; x < width; x++)
+        {
+            u32 x0 = glm::min(x * 2, sourceWidth - 1);
+            u32 x1 = glm::min(x * 2 + 1, sourceWidth - 1);
+
+            const u8 *p00 = &source[(y0 * sourceWidth + x0) * 4];
+            const u8 *p01 = &source[(y0 * sourceWidth + x1) * 4];
+            const u8 *p10 = &source[(y1 * sourceWidth + x0) * 4];
+            const u8 *p11 = &source[(y1 * sourceWidth + x1) * 4];
+
+            u8 *out = &destination[(y * width + x) * 4];
+            for (u32 channel = 0; channel < 4; channel++)
+            {
+                out[channel] = (u8)((p00[channel] + p01[channel] + p10[channel] + p11[channel] + 2) / 4);
+            }
+        }
+    }
+}
+
+static bool buildTexture(const char *inputPath, CookedTexture *texture)
+{
+    s32 width, height, comp;
+    u8 *pixels = stbi_load(inputPath, &width, &height, &comp, STBI_rgb_alpha);
+    if (pixels == NULL)
+    {
+        spdlog::error("Could not load \"{}\": {}", inputPath, stbi_failure_reason());
+        return false;
+    }
+
+    texture->mipCount = 1;
+    texture->widths[0] = (u32)width;
+    texture->heights[0] = (u32)height;
+    texture->mips[0].assign(pixels, pixels + (size_t)width * (size_t)height * 4);
+
+    stbi_image_free((void *)pixels);
+
+    while (texture->mipCount < COOKED_TEXTURE_MAX_MIPS)
+    {
+        u32 level = texture->mipCount;
+        u32 sourceWidth = texture->widths[level - 1];
+        u32 sourceHeight = texture->heights[level - 1];
+        if (sourceWidth == 1 && sourceHeight == 1)
+        {
+            break;
+        }
+
+        texture->widths[level] = glm::max(sourceWidth / 2, 1U);
+        texture->heights[level] = glm::max(sourceHeight / 2, 1U);
+        texture->mips[level].resize((size_t)texture->widths[level] * texture->heights[level] * 4);
+
+        downsample(texture->mips[level - 1].data(), sourceWidth, sourceHeight, texture->mips[level].data(),
+                   texture->widths[level], texture->heights[level]);
+
+        texture->mipCount++;
+    }
+
+    return true;
+}
+
+static bool writeTexture(const char *outputPath, const CookedTexture *texture)
+{
+    CookedTextureHeader header = {};
+    header.magic = COOKED_TEXTURE_MAGIC;
+    header.version = COOKED_TEXTURE_VERSION;
+    header.format = COOKED_TEXTURE_FORMAT_RGBA8;
+    header.mipCount = texture->mipCount;
+
+    u64 offset = sizeof(CookedTextureHeader);
+    for (u32 level = 0; level < texture->mipCount; level++)
+    {
+        CookedTextureMip *mip = &header.mips[level];
+        mip->width = texture->widths[level];
+        mip->height = texture->heights[level];
+        mip->offset = alignCookedOffset(offset);
+        mip->size = texture->mips[level].size();
+
+        offset = mip->offset + mip->size;
+    }
+
+    FILE *file = fopen(outputPath, "wb");
+    if (file == NULL)
+    {
+        spdlog::error("Could not open \"{}\" for writing", outputPath);
+        return false;
+    }
+
+    bool success = writeSection(file, 0, &header, sizeof(header));
+    for (u32 level = 0; level < texture->mipCount && success; level++)
+    {
+        const std::vector<u8> *mip = &texture->mips[level];
+        success = writeSection(file, header.mips[level].offset, mip->data(), mip->size());
+    }
+
+    success = fclose(file) == 0 && success;
+    if (!success)
+    {
+        spdlog::error("Failed writing \"{}\"", outputPath);
+        remove(outputPath);
+    }
+
+    return success;
+}
+
+static bool cookTexture(const char *inputPath, const char *outputPath)
+{
+    CookedTexture texture;
+    if (!buildTexture(inputPath, &texture))
+    {
+        return false;
+    }
+
+    if (!writeTexture(outputPath, &texture))
+    {
+        return false;
+    }
+
+    spdlog::info("Cooked \"{}\": {}x{}, {} mip levels", inputPath, texture.widths[0], texture.heights[0],
+                 texture.mipCount);
+
+    return true;
+}
+
+static void printUsage()
+{
+    fprintf(stderr, "Usage: AssetCooker mesh <input.glb> <output%s>\n", COOKED_MESH_EXTENSION);
+    fprintf(stderr, "       AssetCooker texture <input.png> <output%s>\n", COOKED_TEXTURE_EXTENSION);
+    fprintf(stderr, "       AssetCooker course <input.glb> <output%s> [tile size in meters]\n",
+            COOKED_COURSE_EXTENSION);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 4 && argc != 5)
+    {
+        printUsage();
+        return 1;
+    }
+
+    const char *assetType = argv[1];
+    const char *inputPath = argv[2];
+    const char *outputPath = argv[3];
+
+    bool success;
+    if (strcmp(assetType, "mesh") == 0 && argc == 4)
+    {
+        success = cookMesh(inputPath, outputPath);
+    }
+    else if (strcmp(assetType, "texture") == 0 && argc == 4)
+    {
+        success = cookTexture(inputPath, outputPath);
+    }
+    else if (strcmp(assetType, "course") == 0)
+    {
+        f32 tileSize = argc == 5 ? (f32)atof(argv[4]) : COOKED_COURSE_DEFAULT_TILE_SIZE;
+        if (tileSize <= 0.0F)
+        {
+            printUsage();
+            return 1;
+        }
+
+        success = cookCourse(inputPath, outputPath, tileSize);
+    }
+    else
+    {
+        printUsage();
+        return 1;
+    }
+
+    return success ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,1044 @@
+// Runs a fixed corpus of shots through a double precision copy of the Ball flight, bounce and roll model and through
+// every optimized variant of it, then reports how far each variant strays from the reference and how much faster it
+// is. Exits with a nonzero status when any variant goes over a tolerance, so faster integrators, fast-math builds or
+// SIMD paths can't silently change where the ball ends up. Also checks that balls landing across a course tile seam
+// find the ground on the far side, and that every trajectory decoder reads the recorded flights back the same.
+//
+// Usage: golfsim_accuracy [--variant <substring>] [--tolerance <carry|apex|lateral|total>=<meters>]...
+
+// clang-format off
+#include <Framework/Application.hpp>
+
+#define GLM_ENABLE_EXPERIMENTAL
+
+#include <tracy/Tracy.hpp>
+
+#include <glm/glm.hpp>
+#include <glm/gtx/norm.hpp>
+#include <glm/gtx/rotate_vector.hpp>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#include "GolfFlightSim3D.hpp"
+#include "CollisionKernels.hpp"
+#include "Determinism.hpp"
+#include "MemoryArena.hpp"
+#include "DrivingRange.hpp"
+#include "FlightPlanner.hpp"
+#include "TrajectoryHistory.hpp"
+#include "Scenarios.hpp"
+
+#include "GolfFlightSim3D.cpp"
+#include "CollisionKernels.cpp"
+#include "Determinism.cpp"
+#include "MemoryArena.cpp"
+#include "DrivingRange.cpp"
+#include "FlightPlanner.cpp"
+#include "TrajectoryHistory.cpp"
+// clang-format on
+
+#define MAX_SHOT_SECONDS 120.0
+
+// Timings take the fastest of this many runs of the whole corpus
+#define TIMING_RUN_COUNT 5
+
+// The range cut into course tiles this size, metres, from -SEAM_COURSE_SIZE / 2 to SEAM_COURSE_SIZE / 2
+#define SEAM_TILE_SIZE 8.0F
+#define SEAM_COURSE_SIZE 1000.0F
+
+static const f32 deltaTime = 1.0F / 60.0F;
+
+enum ShotMetric
+{
+    SHOT_METRIC_CARRY,    // Horizontal distance from the tee to the first landing
+    SHOT_METRIC_APEX,     // Highest point of the flight above the tee
+    SHOT_METRIC_LATERAL,  // Signed offset from the target line at rest
+    SHOT_METRIC_TOTAL,    // Horizontal distance from the tee at rest
+
+    SHOT_METRIC_COUNT,
+};
+
+static const char *shotMetricNames[SHOT_METRIC_COUNT] = {"carry", "apex", "lateral", "total"};
+
+// Defaults in meters, about the width of the tracer line at the far end of the range
+static f64 tolerances[SHOT_METRIC_COUNT] = {0.5, 0.25, 0.5, 1.0};
+
+struct ShotOutcome
+{
+    f64 metrics[SHOT_METRIC_COUNT];
+    u32 steps;
+};
+
+// Wind conditions every shot in the corpus is played in
+static const Wind corpusWinds[] = {
+    {0.0F, 0.0F, false},
+    {mphToMs(10.0F), glm::radians(180.0F), true},  // Into the wind
+    {mphToMs(20.0F), glm::radians(90.0F), false},  // Strong crosswind
+};
+
+#define CORPUS_SHOT_COUNT (SHOT_SET_SIZE * arrayCount(corpusWinds))
+
+// Simulates every shot of the set in the given wind until all of them are at rest
+typedef void SimulateShotsFunction(const Wind *wind, CollisionGeometry *geometry, ShotOutcome *outcomes);
+
+struct AccuracyVariant
+{
+    const char *name;
+    SimulateShotsFunction *simulate;
+    CollisionKernelType collisionKernel;
+};
+
+// The model in Ball::simulate step for step, with every quantity in double precision. Constants and the coefficient
+// table are shared with the game so the only difference is rounding.
+struct ReferenceBall
+{
+    glm::dvec3 startPosition;
+    glm::dvec3 position;
+    glm::dvec3 velocity;
+    glm::dvec3 rotationAxis;
+    glm::dvec3 netForce;
+
+    BallState state;
+    f64 spinRate;
+    f64 launchSpinRate;
+    f64 currFlightTime;
+    f64 maxHeight;
+
+    void launch(const LaunchConditions *launch);
+    void simulate(const Wind *wind, const CollisionGeometry *collisionGeometry, f64 dt);
+
+private:
+    void simulateFlying(const Wind *wind, f64 dt);
+    bool checkCollision(const CollisionGeometry *collisionGeometry,
+                        f64 dt,
+                        glm::dvec3 &outIntersectionPoint,
+                        glm::dvec3 &outNormal);
+    void computeRebound(const glm::dvec3 &surfaceNormal);
+    void simulateRolling(f64 dt);
+    void integrate(f64 dt);
+};
+
+static void computeReferenceCoefficients(f64 groundSpeedSquared,
+                                         f64 spinRate,
+                                         f64 *liftCoefficient,
+                                         f64 *dragCoefficient)
+{
+    static const f64 speedThresholds[] = {338.0, 705.0, 1226.0, 1874.0, 2654.0, 3588.0, 4698.0, 5939.0, 7249.0};
+    static const f64 spinThresholds[] = {500.0, 1433.0, 2340.0, 3283.0, 4223.0, 5478.0};
+
+    s32 row = 0;
+    while (row < (s32)arrayCount(speedThresholds) && groundSpeedSquared > speedThresholds[row])
+    {
+        row++;
+    }
+
+    s32 col = 0;
+    while (col < (s32)arrayCount(spinThresholds) && spinRate > spinThresholds[col])
+    {
+        col++;
+    }
+
+    *liftCoefficient = COEFF_LUT[row][col].lift;
+    *dragCoefficient = COEFF_LUT[row][col].drag;
+}
+
+void ReferenceBall::launch(const LaunchConditions *launch)
+{
+    bzero(this, sizeof(ReferenceBall));
+
+    const f64 teeHeight = 0.0381;
+
+    startPosition = glm::dvec3(0.0, teeHeight + BALL_RADIUS, 0.0);
+    position = startPosition;
+    state = BALL_STATE_FLYING;
+
+    velocity = glm::rotateX(glm::dvec3(0.0, 0.0, launch->speed), -(f64)launch->launchAngle);
+    velocity = glm::rotateY(velocity, (f64)launch->heading);
+
+    rotationAxis = glm::rotateY(glm::dvec3(1.0, 0.0, 0.0), (f64)launch->heading);
+    rotationAxis = glm::rotateZ(rotationAxis, (f64)launch->spinAngle);
+
+    launchSpinRate = launch->spinRate;
+}
+
+void ReferenceBall::integrate(f64 dt)
+{
+    glm::dvec3 acceleration = netForce * (1.0 / BALL_MASS);
+
+    velocity += acceleration * dt;
+
+    position += velocity * dt;
+}
+
+void ReferenceBall::simulateFlying(const Wind *wind, f64 dt)
+{
+    spinRate = launchSpinRate * exp(-currFlightTime / 24.5);
+
+    glm::dvec3 windVector(wind->speed * sin((f64)wind->direction), 0.0, wind->speed * cos((f64)wind->direction));
+    if (wind->logWind)
+    {
+        const f64 referenceHeight = 10.0;
+        const f64 roughnessLengthScale = 0.4;
+
+        f64 ballHeight = std::max(position.y, roughnessLengthScale);
+        windVector *= log(ballHeight / roughnessLengthScale) / log(referenceHeight / roughnessLengthScale);
+    }
+
+    glm::dvec3 groundSpeed = velocity - windVector;
+    f64 speedSq = glm::length2(groundSpeed);
+
+    f64 liftCoefficient, dragCoefficient;
+    computeReferenceCoefficients(speedSq, spinRate, &liftCoefficient, &dragCoefficient);
+
+    glm::dvec3 liftForce(0.0);
+    glm::dvec3 dragForce(0.0);
+    if (speedSq > 0.0)
+    {
+        liftForce = glm::normalize(glm::cross(groundSpeed, rotationAxis)) * ((f64)k * liftCoefficient * speedSq);
+        dragForce = glm::normalize(groundSpeed) * -((f64)k * dragCoefficient * speedSq);
+    }
+
+    netForce = glm::dvec3(0.0, (f64)BALL_MASS * GRAVITY, 0.0) + liftForce + dragForce;
+
+    integrate(dt);
+
+    currFlightTime += dt;
+}
+
+bool ReferenceBall::checkCollision(const CollisionGeometry *collisionGeometry,
+                                   f64 dt,
+                                   glm::dvec3 &outIntersectionPoint,
+                                   glm::dvec3 &outNormal)
+{
+    for (size_t triangleIndex = 0; triangleIndex < collisionGeometry->triangleCount; triangleIndex++)
+    {
+        const Triangle *triangle = &collisionGeometry->triangles[triangleIndex];
+
+        glm::dvec3 p(collisionGeometry->vertices[triangle->a].position);
+        glm::dvec3 normal(triangle->normal);
+
+        f64 distance = glm::dot(normal, position - p);
+        maxHeight = std::max(maxHeight, distance);
+
+        f64 collisionTime;
+        glm::dvec3 intersectionPoint;
+        if (fabs(distance) <= BALL_RADIUS)
+        {
+            collisionTime = 0.0;
+            intersectionPoint = position;
+        }
+        else
+        {
+            f64 denom = glm::dot(normal, velocity);
+            if (denom * distance >= 0.0)
+            {
+                continue;
+            }
+
+            f64 r = distance > 0.0 ? BALL_RADIUS : -BALL_RADIUS;
+            collisionTime = (r - distance) / denom;
+            intersectionPoint = position + collisionTime * velocity - r * normal;
+        }
+
+        if (collisionTime <= dt && collisionTime >= 0.0)
+        {
+            outIntersectionPoint = intersectionPoint;
+            outNormal = normal;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ReferenceBall::computeRebound(const glm::dvec3 &surfaceNormal)
+{
+    const f64 e = 0.5;
+    const f64 mu = 0.4;
+    const f64 r = BALL_RADIUS;
+
+    glm::dvec3 angularVelocity = rpmToRadS(spinRate) * rotationAxis;
+
+    glm::dvec3 xBasis = glm::normalize(glm::dvec3(velocity.x, 0.0, velocity.z));
+    glm::dvec3 yBasis = surfaceNormal;
+    glm::dvec3 zBasis = glm::normalize(glm::cross(xBasis, yBasis));
+
+    // clang-format off
+    glm::dmat3 T(xBasis.x, yBasis.x, zBasis.x,
+                 xBasis.y, yBasis.y, zBasis.y,
+                 xBasis.z, yBasis.z, zBasis.z);
+    // clang-format on
+
+    glm::dvec3 v = T * velocity;
+    glm::dvec3 w = T * angularVelocity;
+
+    f64 vrx, vry, wrz;
+    f64 muCz = (2.0 * (v.x + r * w.z)) / (7.0 * (v.y * (1.0 + e)));
+    if (mu < muCz)
+    {
+        vrx = v.x - (mu * fabs(v.y) * (1.0 + e));
+        vry = -(e * v.y);
+        wrz = ((5.0 * mu * fabs(v.y)) / (2.0 * r)) * (1.0 + e) - w.z;
+    }
+    else
+    {
+        vrx = ((5.0 * v.x) - (2.0 * r * w.z)) / 7.0;
+        vry = -(e * v.y);
+        wrz = vrx / r;
+    }
+
+    // The game computes the ZY plane response but only keeps the XY one, the reference does the same
+    glm::dmat3 invT = glm::inverse(T);
+    glm::dvec3 finalVelocity = invT * glm::dvec3(vrx, vry, v.z);
+    glm::dvec3 finalAngularVelocity = invT * glm::dvec3(w.x, w.y, wrz);
+
+    velocity = finalVelocity;
+    rotationAxis = glm::normalize(finalAngularVelocity);
+    spinRate = radSToRPM(glm::length(finalAngularVelocity));
+}
+
+void ReferenceBall::simulateRolling(f64 dt)
+{
+    const f64 frictionMagnitude = 0.04;
+
+    velocity.y = 0.0;
+
+    if (glm::length2(velocity) > SPEED_EPSILON)
+    {
+        netForce = glm::normalize(velocity) * -frictionMagnitude;
+        integrate(dt);
+    }
+    else
+    {
+        velocity = glm::dvec3(0.0);
+        spinRate = 0.0;
+        state = BALL_STATE_IDLE;
+    }
+}
+
+void ReferenceBall::simulate(const Wind *wind, const CollisionGeometry *collisionGeometry, f64 dt)
+{
+    switch (state)
+    {
+        case BALL_STATE_IDLE:
+        {
+            break;
+        }
+        case BALL_STATE_FLYING:
+        {
+            simulateFlying(wind, dt);
+
+            glm::dvec3 intersectionPoint;
+            glm::dvec3 normal;
+            if (checkCollision(collisionGeometry, dt, intersectionPoint, normal))
+            {
+                position = intersectionPoint;
+                position.y += BALL_RADIUS;
+
+                currFlightTime = 0.0;
+
+                if (maxHeight <= MIN_BOUNCE_HEIGHT)
+                {
+                    state = BALL_STATE_ROLLING;
+                    break;
+                }
+
+                computeRebound(normal);
+
+                maxHeight = 0.0;
+            }
+
+            break;
+        }
+        case BALL_STATE_ROLLING:
+        {
+            simulateRolling(dt);
+            break;
+        }
+        default:
+        {
+            invalidDefaultCase;
+        }
+    }
+}
+
+// Apex and carry are tracked from outside the model so every variant is measured the same way
+struct FlightTracker
+{
+    f64 apex;
+    bool landed;
+};
+
+static void trackFlight(FlightTracker *tracker,
+                        ShotOutcome *outcome,
+                        const glm::dvec3 &offset,
+                        bool flying,
+                        bool bounced)
+{
+    tracker->apex = std::max(tracker->apex, offset.y);
+
+    if (!tracker->landed && (!flying || bounced))
+    {
+        outcome->metrics[SHOT_METRIC_CARRY] = sqrt(offset.x * offset.x + offset.z * offset.z);
+        tracker->landed = true;
+    }
+}
+
+static void finishShot(const FlightTracker *tracker, ShotOutcome *outcome, const glm::dvec3 &offset, u32 steps)
+{
+    outcome->metrics[SHOT_METRIC_APEX] = tracker->apex;
+    outcome->metrics[SHOT_METRIC_LATERAL] = offset.x;
+    outcome->metrics[SHOT_METRIC_TOTAL] = sqrt(offset.x * offset.x + offset.z * offset.z);
+    outcome->steps = steps;
+}
+
+static void simulateReference(const Wind *wind, CollisionGeometry *geometry, ShotOutcome *outcomes)
+{
+    const u32 maxSteps = (u32)(MAX_SHOT_SECONDS / deltaTime);
+
+    for (size_t shotIndex = 0; shotIndex < SHOT_SET_SIZE; shotIndex++)
+    {
+        LaunchConditions launch = getShotLaunchConditions(shotIndex);
+
+        ReferenceBall ball;
+        ball.launch(&launch);
+
+        FlightTracker tracker = {};
+        u32 step = 0;
+        while (ball.state != BALL_STATE_IDLE && step < maxSteps)
+        {
+            bool wasFlying = ball.state == BALL_STATE_FLYING;
+            ball.simulate(wind, geometry, deltaTime);
+            step++;
+
+            bool bounced = wasFlying && ball.currFlightTime == 0.0;
+            trackFlight(&tracker, &outcomes[shotIndex], ball.position - ball.startPosition,
+                        ball.state == BALL_STATE_FLYING, bounced);
+        }
+
+        finishShot(&tracker, &outcomes[shotIndex], ball.position - ball.startPosition, step);
+    }
+}
+
+// Solves the flights simulateWorld's balls follow, when set
+static FlightPlanner *worldPlanner;
+
+// The game's own Ball, all shots in flight at once through World::update like they are on the range
+static void simulateWorld(const Wind *wind, CollisionGeometry *geometry, ShotOutcome *outcomes)
+{
+    static World *world;
+    if (world == NULL)
+    {
+        world = (World *)calloc(1, sizeof(World));
+    }
+
+    bzero(world->ballManager.getBall(0), SHOT_SET_SIZE * sizeof(Ball));
+    world->ballManager.activeBalls = 0;
+    world->wind = *wind;
+    world->planner = worldPlanner;
+
+    for (size_t shotIndex = 0; shotIndex < SHOT_SET_SIZE; shotIndex++)
+    {
+        spawnShot(&world->ballManager, shotIndex);
+    }
+
+    const u32 maxSteps = (u32)(MAX_SHOT_SECONDS / deltaTime);
+    FlightTracker trackers[SHOT_SET_SIZE] = {};
+    bool wasFlying[SHOT_SET_SIZE];
+
+    u32 step = 0;
+    bool moving = true;
+    while (moving && step < maxSteps)
+    {
+        for (size_t shotIndex = 0; shotIndex < SHOT_SET_SIZE; shotIndex++)
+        {
+            wasFlying[shotIndex] = world->ballManager.getBall(shotIndex)->state == BALL_STATE_FLYING;
+        }
+
+        world->update(geometry, deltaTime);
+        step++;
+
+        moving = false;
+        for (size_t shotIndex = 0; shotIndex < SHOT_SET_SIZE; shotIndex++)
+        {
+            Ball *ball = world->ballManager.getBall(shotIndex);
+            if (ball->state == BALL_STATE_IDLE)
+            {
+                if (outcomes[shotIndex].steps == 0)
+                {
+                    finishShot(&trackers[shotIndex], &outcomes[shotIndex],
+                               glm::dvec3(ball->position - ball->startPosition), step);
+                }
+                continue;
+            }
+
+            moving = true;
+
+            bool bounced = wasFlying[shotIndex] && ball->currFlightTime == 0.0F;
+            trackFlight(&trackers[shotIndex], &outcomes[shotIndex], glm::dvec3(ball->position - ball->startPosition),
+                        ball->state == BALL_STATE_FLYING, bounced);
+        }
+    }
+
+    // Shots that hit the step limit are reported where they stopped being simulated
+    for (size_t shotIndex = 0; shotIndex < SHOT_SET_SIZE; shotIndex++)
+    {
+        if (outcomes[shotIndex].steps == 0)
+        {
+            Ball *ball = world->ballManager.getBall(shotIndex);
+            finishShot(&trackers[shotIndex], &outcomes[shotIndex], glm::dvec3(ball->position - ball->startPosition),
+                       step);
+        }
+    }
+}
+
+// The flat range as a streamed course would hold it, each tile only the two triangles of its own square. Shots then
+// land and bounce across tile seams all the time, and have to find the ground on the far side of them.
+static CollisionGeometry *getSeamCourse()
+{
+    static CollisionGeometry *geometry;
+    if (geometry != NULL)
+    {
+        return geometry;
+    }
+
+    const s32 tilesPerSide = (s32)(SEAM_COURSE_SIZE / SEAM_TILE_SIZE);
+    const size_t tileCount = (size_t)tilesPerSide * (size_t)tilesPerSide;
+
+    geometry = (CollisionGeometry *)calloc(1, sizeof(CollisionGeometry));
+    CollisionTileGrid *grid = (CollisionTileGrid *)calloc(1, sizeof(CollisionTileGrid));
+    CollisionTile *tiles = (CollisionTile *)calloc(tileCount, sizeof(CollisionTile));
+    CollisionTile **tilePointers = (CollisionTile **)calloc(tileCount, sizeof(CollisionTile *));
+    glm::vec3 *positions = (glm::vec3 *)calloc(tileCount * 4, sizeof(glm::vec3));
+    Triangle *triangles = (Triangle *)calloc(tileCount * 2, sizeof(Triangle));
+    CollisionBlock *blocks = (CollisionBlock *)calloc(tileCount, sizeof(CollisionBlock));
+    if (geometry == NULL || grid == NULL || tiles == NULL || tilePointers == NULL || positions == NULL ||
+        triangles == NULL || blocks == NULL)
+    {
+        spdlog::error("Failed to allocate the seam course");
+        exit(1);
+    }
+
+    grid->tiles = tilePointers;
+    grid->minX = -tilesPerSide / 2;
+    grid->minZ = -tilesPerSide / 2;
+    grid->width = (u32)tilesPerSide;
+    grid->depth = (u32)tilesPerSide;
+    grid->tileSize = SEAM_TILE_SIZE;
+
+    for (size_t tileIndex = 0; tileIndex < tileCount; tileIndex++)
+    {
+        f32 x0 = (f32)(grid->minX + (s32)(tileIndex % (size_t)tilesPerSide)) * SEAM_TILE_SIZE;
+        f32 z0 = (f32)(grid->minZ + (s32)(tileIndex / (size_t)tilesPerSide)) * SEAM_TILE_SIZE;
+
+        glm::vec3 *corners = &positions[tileIndex * 4];
+        corners[0] = glm::vec3(x0, 0.0F, z0);
+        corners[1] = glm::vec3(x0 + SEAM_TILE_SIZE, 0.0F, z0);
+        corners[2] = glm::vec3(x0, 0.0F, z0 + SEAM_TILE_SIZE);
+        corners[3] = glm::vec3(x0 + SEAM_TILE_SIZE, 0.0F, z0 + SEAM_TILE_SIZE);
+
+        const u32 cornerIndices[2][3] = {{0, 2, 1}, {1, 2, 3}};
+        for (u32 half = 0; half < 2; half++)
+        {
+            Triangle *triangle = &triangles[tileIndex * 2 + half];
+            triangle->a = cornerIndices[half][0];
+            triangle->b = cornerIndices[half][1];
+            triangle->c = cornerIndices[half][2];
+            triangle->normal = glm::vec3(0.0F, 1.0F, 0.0F);
+            triangle->d = 0.0F;
+        }
+
+        packCollisionBlocks((const u8 *)corners, sizeof(glm::vec3), &triangles[tileIndex * 2], 2, &blocks[tileIndex]);
+
+        CollisionTile *tile = &tiles[tileIndex];
+        tile->positions = corners;
+        tile->triangles = &triangles[tileIndex * 2];
+        tile->blocks = &blocks[tileIndex];
+        tile->vertexCount = 4;
+        tile->triangleCount = 2;
+        tilePointers[tileIndex] = tile;
+    }
+
+    // Nothing but the course to collide with
+    geometry->course = grid;
+    return geometry;
+}
+
+// The game's Ball through World::update like simulateWorld, on the range cut into course tiles
+static void simulateWorldOnSeams(const Wind *wind, CollisionGeometry *geometry, ShotOutcome *outcomes)
+{
+    (void)geometry;
+    simulateWorld(wind, getSeamCourse(), outcomes);
+}
+
+// The game's Ball through World::update like simulateWorld, with deterministic mode's portable transcendentals
+static void simulateWorldDeterministic(const Wind *wind, CollisionGeometry *geometry, ShotOutcome *outcomes)
+{
+    DeterminismConfig *determinismConfig = getDeterminismConfig();
+    bool wasEnabled = determinismConfig->enabled;
+
+    determinismConfig->enabled = true;
+    simulateWorld(wind, geometry, outcomes);
+    determinismConfig->enabled = wasEnabled;
+}
+
+// The game's Ball through World::update like simulateWorld, following flights solved on worker threads as it is
+// launched. In deterministic mode, so every ball picks its plan up a few steps after launch however busy the machine
+// is, instead of being integrated to rest before a worker gets to it.
+static void simulateWorldPlanned(const Wind *wind, CollisionGeometry *geometry, ShotOutcome *outcomes)
+{
+    FlightPlannerConfig plannerConfig = {true, std::max(std::thread::hardware_concurrency(), 1U)};
+    FlightPlanner *planner = new FlightPlanner();
+    planner->initialize(&plannerConfig);
+
+    DeterminismConfig *determinismConfig = getDeterminismConfig();
+    bool wasEnabled = determinismConfig->enabled;
+
+    determinismConfig->enabled = true;
+    worldPlanner = planner;
+    simulateWorld(wind, geometry, outcomes);
+    worldPlanner = NULL;
+    determinismConfig->enabled = wasEnabled;
+
+    planner->shutdown();
+    delete planner;
+}
+
+struct BallInternals
+{
+    static bool checkCollision(Ball *ball,
+                               CollisionGeometry *collisionGeometry,
+                               f32 dt,
+                               f32 *outCollisionTime,
+                               glm::vec3 &outIntersectionPoint,
+                               glm::vec3 &outNormal)
+    {
+        return ball->checkCollision(collisionGeometry, dt, outCollisionTime, outIntersectionPoint, outNormal);
+    }
+};
+
+// Steps that cross a tile seam high enough to clear the near tile's edge and touch down past it, on ground only the
+// tile on the far side holds. Across each of the four sides of a tile and through each of its corners, with every
+// collision kernel. Returns how many of them missed the ground.
+static u32 checkSeamLandings()
+{
+    const f32 seam = SEAM_TILE_SIZE;
+    const f32 halfTile = 0.5F * SEAM_TILE_SIZE;
+    const glm::vec3 crossings[8][2] = {
+        {glm::vec3(seam, 0.0F, halfTile), glm::vec3(1.0F, 0.0F, 0.0F)},
+        {glm::vec3(seam, 0.0F, halfTile), glm::vec3(-1.0F, 0.0F, 0.0F)},
+        {glm::vec3(halfTile, 0.0F, seam), glm::vec3(0.0F, 0.0F, 1.0F)},
+        {glm::vec3(halfTile, 0.0F, seam), glm::vec3(0.0F, 0.0F, -1.0F)},
+        {glm::vec3(seam, 0.0F, seam), glm::normalize(glm::vec3(1.0F, 0.0F, 1.0F))},
+        {glm::vec3(seam, 0.0F, seam), glm::normalize(glm::vec3(-1.0F, 0.0F, 1.0F))},
+        {glm::vec3(seam, 0.0F, seam), glm::normalize(glm::vec3(1.0F, 0.0F, -1.0F))},
+        {glm::vec3(seam, 0.0F, seam), glm::normalize(glm::vec3(-1.0F, 0.0F, -1.0F))},
+    };
+
+    // 30 cm down and 10 cm along in the step, so the ball is still 15 cm up where it crosses the seam and touches down
+    // about 4 cm past it
+    const f32 startHeight = 0.3F;
+    const f32 startBehind = 0.05F;
+    const f32 groundSpeed = 6.0F;
+    const f32 fallSpeed = 18.0F;
+
+    CollisionGeometry *geometry = getSeamCourse();
+    u32 landings = 0;
+    u32 missed = 0;
+
+    for (u32 kernelIndex = 0; kernelIndex < COLLISION_KERNEL_COUNT; kernelIndex++)
+    {
+        CollisionKernelType kernel = (CollisionKernelType)kernelIndex;
+        if (!setCollisionKernel(kernel))
+        {
+            continue;
+        }
+
+        for (u32 crossingIndex = 0; crossingIndex < arrayCount(crossings); crossingIndex++)
+        {
+            const glm::vec3 &point = crossings[crossingIndex][0];
+            const glm::vec3 &direction = crossings[crossingIndex][1];
+
+            Ball ball;
+            bzero(&ball, sizeof(Ball));
+            ball.position = point - direction * startBehind + glm::vec3(0.0F, startHeight, 0.0F);
+            ball.velocity = direction * groundSpeed - glm::vec3(0.0F, fallSpeed, 0.0F);
+            ball.state = BALL_STATE_FLYING;
+            ball.alive = true;
+
+            f32 collisionTime;
+            glm::vec3 intersectionPoint;
+            glm::vec3 normal;
+            bool found = BallInternals::checkCollision(&ball, geometry, deltaTime, &collisionTime, intersectionPoint,
+                                                       normal);
+
+            landings++;
+            if (!found || fabsf(intersectionPoint.y) > 1e-3F || normal.y < 0.999F)
+            {
+                missed++;
+                spdlog::error("Seam landing {} with the {} kernel {}", crossingIndex, getCollisionKernelName(kernel),
+                              found ? "hit the wrong ground" : "fell through the course");
+            }
+        }
+    }
+
+    printf("%-24s %u of %u landings across tile seams found the ground %8s\n\n", "Course seams", landings - missed,
+           landings, missed > 0 ? "FAIL" : "ok");
+
+    return missed;
+}
+
+// Records the corpus into a trajectory history and decodes every track with each decoder. They have to agree to the
+// bit, stay within half a quantum of the recorded positions, give or take f32 rounding, and samplePosition has to
+// land between the decoded neighbours. Returns how many tracks failed.
+static u32 checkTrajectoryDecoders(CollisionGeometry *geometry)
+{
+    const u32 maxSteps = (u32)(MAX_SHOT_SECONDS / deltaTime);
+    const u32 trackCount = (u32)CORPUS_SHOT_COUNT;
+
+    World *world = (World *)calloc(1, sizeof(World));
+    TrajectoryHistory *history = (TrajectoryHistory *)calloc(1, sizeof(TrajectoryHistory));
+    glm::vec3 *recorded = (glm::vec3 *)malloc((size_t)trackCount * maxSteps * sizeof(glm::vec3));
+    glm::vec3 *decoded = (glm::vec3 *)malloc((size_t)TRAJECTORY_DECODER_COUNT * maxSteps * sizeof(glm::vec3));
+    TrajectoryHistoryConfig historyConfig = {TRAJECTORY_DEFAULT_BUDGET};
+    if (world == NULL || history == NULL || recorded == NULL || decoded == NULL || !history->initialize(&historyConfig))
+    {
+        spdlog::error("Failed to allocate the trajectory history check");
+        free(decoded);
+        free(recorded);
+        free(history);
+        free(world);
+        return 1;
+    }
+
+    u32 failedTracks = 0;
+    for (size_t windIndex = 0; windIndex < arrayCount(corpusWinds); windIndex++)
+    {
+        bzero(world->ballManager.getBall(0), SHOT_SET_SIZE * sizeof(Ball));
+        world->ballManager.activeBalls = 0;
+        world->wind = corpusWinds[windIndex];
+        for (size_t shotIndex = 0; shotIndex < SHOT_SET_SIZE; shotIndex++)
+        {
+            spawnShot(&world->ballManager, shotIndex);
+        }
+
+        bool moving = true;
+        for (u32 step = 0; moving && step < maxSteps; step++)
+        {
+            world->update(geometry, deltaTime);
+            history->record(&world->ballManager, deltaTime);
+
+            moving = false;
+            for (size_t ballIndex = 0; ballIndex < SHOT_SET_SIZE; ballIndex++)
+            {
+                // A track's newest sample is this step's until the ball comes to rest
+                const Ball *ball = world->ballManager.getBall(ballIndex);
+                u32 trackIndex = history->getBallTrack(ballIndex);
+                const TrajectoryTrack *track = history->getTrack(trackIndex);
+                if (trackIndex != TRAJECTORY_NO_TRACK && track->firstStep + track->sampleCount == history->steps + 1)
+                {
+                    recorded[(size_t)trackIndex * maxSteps + track->sampleCount - 1] = ball->position;
+                }
+                moving |= ball->state != BALL_STATE_IDLE;
+            }
+        }
+        history->closeTracks();
+    }
+
+    for (u32 trackIndex = 0; trackIndex < trackCount; trackIndex++)
+    {
+        const TrajectoryTrack *track = history->getTrack(trackIndex);
+        const glm::vec3 *trackPositions = &recorded[(size_t)trackIndex * maxSteps];
+        const glm::vec3 *firstDecoded = NULL;
+        bool failed = false;
+
+        for (u32 type = 0; type < TRAJECTORY_DECODER_COUNT; type++)
+        {
+            if (!setTrajectoryDecoder((TrajectoryDecoderType)type))
+            {
+                continue;
+            }
+
+            glm::vec3 *positions = &decoded[(size_t)type * maxSteps];
+            history->decodeTrack(trackIndex, positions);
+            if (firstDecoded == NULL)
+            {
+                firstDecoded = positions;
+            }
+            else if (memcmp(positions, firstDecoded, track->sampleCount * sizeof(glm::vec3)) != 0)
+            {
+                spdlog::error("Track {} decodes differently with the {} decoder", trackIndex,
+                              getTrajectoryDecoderName((TrajectoryDecoderType)type));
+                failed = true;
+            }
+
+            for (u32 sampleIndex = 0; sampleIndex < track->sampleCount; sampleIndex++)
+            {
+                for (u32 axis = 0; axis < 3; axis++)
+                {
+                    f32 position = trackPositions[sampleIndex][axis];
+                    f32 bound = 0.5F * TRAJECTORY_QUANTUM + 4.0F * FLT_EPSILON * fabsf(position);
+                    if (fabsf(positions[sampleIndex][axis] - position) > bound)
+                    {
+                        spdlog::error("Track {} sample {} is {:.6f} m off with the {} decoder", trackIndex,
+                                      sampleIndex, fabsf(positions[sampleIndex][axis] - position),
+                                      getTrajectoryDecoderName((TrajectoryDecoderType)type));
+                        failed = true;
+                    }
+                }
+            }
+
+            // Halfway between each pair of samples, both neighbours from a single decode or not
+            for (u32 sampleIndex = 0; sampleIndex + 1 < track->sampleCount; sampleIndex++)
+            {
+                f64 time = (track->firstStep + sampleIndex + 0.5) * (f64)history->stepTime;
+                glm::vec3 sampled = history->samplePosition(trackIndex, time);
+                glm::vec3 expected = glm::mix(positions[sampleIndex], positions[sampleIndex + 1], 0.5F);
+                if (glm::length(sampled - expected) > 0.5F * TRAJECTORY_QUANTUM)
+                {
+                    spdlog::error("Track {} samples {:.6f} m off between samples {} and {} with the {} decoder",
+                                  trackIndex, glm::length(sampled - expected), sampleIndex, sampleIndex + 1,
+                                  getTrajectoryDecoderName((TrajectoryDecoderType)type));
+                    failed = true;
+                }
+            }
+        }
+
+        if (failed)
+        {
+            failedTracks++;
+        }
+    }
+
+    printf("%-24s %u of %u tracks decoded the same by every decoder within half a quantum %8s\n\n",
+           "Trajectory history", trackCount - failedTracks, trackCount, failedTracks > 0 ? "FAIL" : "ok");
+
+    history->shutdown();
+    free(decoded);
+    free(recorded);
+    free(history);
+    free(world);
+    return failedTracks;
+}
+
+// Optimized variants of the simulation register here to be held to the reference
+static const AccuracyVariant variants[] = {
+    {"World::update (scalar)", simulateWorld, COLLISION_KERNEL_SCALAR},
+    {"World::update (sse2)", simulateWorld, COLLISION_KERNEL_SSE2},
+    {"World::update (avx2)", simulateWorld, COLLISION_KERNEL_AVX2},
+    {"World::update (seams)", simulateWorldOnSeams, COLLISION_KERNEL_SSE2},
+    {"World::update (portable)", simulateWorldDeterministic, COLLISION_KERNEL_SSE2},
+    {"World::update (planned)", simulateWorldPlanned, COLLISION_KERNEL_SSE2},
+};
+
+static f64 getSeconds()
+{
+    return std::chrono::duration<f64>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Runs the whole corpus, returning the fastest time of a few runs so the speedup isn't skewed by a cold cache
+static f64 simulateCorpus(SimulateShotsFunction *simulate, CollisionGeometry *geometry, ShotOutcome *outcomes)
+{
+    f64 bestTime = 0.0;
+
+    for (u32 runIndex = 0; runIndex < TIMING_RUN_COUNT; runIndex++)
+    {
+        bzero(outcomes, CORPUS_SHOT_COUNT * sizeof(ShotOutcome));
+
+        f64 start = getSeconds();
+        for (size_t windIndex = 0; windIndex < arrayCount(corpusWinds); windIndex++)
+        {
+            simulate(&corpusWinds[windIndex], geometry, &outcomes[windIndex * SHOT_SET_SIZE]);
+        }
+        f64 elapsed = getSeconds() - start;
+
+        if (runIndex == 0 || elapsed < bestTime)
+        {
+            bestTime = elapsed;
+        }
+    }
+
+    return bestTime;
+}
+
+static bool parseTolerance(const char *tolerance)
+{
+    const char *equals = strchr(tolerance, '=');
+    if (equals == NULL)
+    {
+        return false;
+    }
+
+    for (u32 metric = 0; metric < SHOT_METRIC_COUNT; metric++)
+    {
+        size_t nameLength = strlen(shotMetricNames[metric]);
+        if ((size_t)(equals - tolerance) == nameLength && strncmp(tolerance, shotMetricNames[metric], nameLength) == 0)
+        {
+            char *end;
+            f64 value = strtod(equals + 1, &end);
+            if (end == equals + 1 || *end != '\0' || value < 0.0)
+            {
+                return false;
+            }
+
+            tolerances[metric] = value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void printUsage()
+{
+    fprintf(stderr, "Usage: golfsim_accuracy [--variant <substring>]\n");
+    fprintf(stderr, "                        [--tolerance <carry|apex|lateral|total>=<meters>]...\n");
+}
+
+int main(int argc, char *argv[])
+{
+    const char *variantFilter = NULL;
+
+    for (s32 argIndex = 1; argIndex < argc; argIndex++)
+    {
+        const char *arg = argv[argIndex];
+        const char *value = argIndex + 1 < argc ? argv[argIndex + 1] : NULL;
+
+        if (strcmp(arg, "--variant") == 0 && value != NULL)
+        {
+            variantFilter = value;
+            argIndex++;
+        }
+        else if (strcmp(arg, "--tolerance") == 0 && value != NULL && parseTolerance(value))
+        {
+            argIndex++;
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // stdout is reserved for the report
+    spdlog::set_default_logger(spdlog::stderr_color_mt("accuracy"));
+
+    // The flat range the game is played on
+    CollisionGeometry *geometry = (CollisionGeometry *)calloc(1, sizeof(CollisionGeometry));
+    ShotOutcome *referenceOutcomes = (ShotOutcome *)calloc(CORPUS_SHOT_COUNT, sizeof(ShotOutcome));
+    ShotOutcome *variantOutcomes = (ShotOutcome *)calloc(CORPUS_SHOT_COUNT, sizeof(ShotOutcome));
+    if (geometry == NULL || referenceOutcomes == NULL || variantOutcomes == NULL)
+    {
+        spdlog::error("Failed to allocate the accuracy corpus");
+        return 1;
+    }
+
+    buildTerrain(geometry, 1, 1000.0F);
+
+    f64 referenceTime = simulateCorpus(simulateReference, geometry, referenceOutcomes);
+
+    printf("%zu shots, reference (f64) %.3f ms\n\n", (size_t)CORPUS_SHOT_COUNT, referenceTime * 1e3);
+    printf("%-24s %-8s %12s %12s %12s %8s\n", "variant", "metric", "max dev (m)", "mean dev (m)", "tolerance", "result");
+
+    u32 failedVariants = 0;
+    u32 testedVariants = 0;
+    for (u32 variantIndex = 0; variantIndex < arrayCount(variants); variantIndex++)
+    {
+        const AccuracyVariant *variant = &variants[variantIndex];
+        if (variantFilter != NULL && strstr(variant->name, variantFilter) == NULL)
+        {
+            continue;
+        }
+
+        if (!setCollisionKernel(variant->collisionKernel))
+        {
+            printf("%-24s skipped, the %s collision kernel is not supported on this CPU\n\n", variant->name,
+                   getCollisionKernelName(variant->collisionKernel));
+            continue;
+        }
+
+        f64 variantTime = simulateCorpus(variant->simulate, geometry, variantOutcomes);
+        testedVariants++;
+
+        bool failed = false;
+        for (u32 metric = 0; metric < SHOT_METRIC_COUNT; metric++)
+        {
+            f64 maxDeviation = 0.0;
+            f64 totalDeviation = 0.0;
+            size_t worstShot = 0;
+
+            for (size_t shotIndex = 0; shotIndex < CORPUS_SHOT_COUNT; shotIndex++)
+            {
+                f64 deviation =
+                    fabs(variantOutcomes[shotIndex].metrics[metric] - referenceOutcomes[shotIndex].metrics[metric]);
+                totalDeviation += deviation;
+
+                if (deviation > maxDeviation)
+                {
+                    maxDeviation = deviation;
+                    worstShot = shotIndex;
+                }
+            }
+
+            bool exceeded = maxDeviation > tolerances[metric];
+            failed |= exceeded;
+
+            printf("%-24s %-8s %12.4f %12.4f %12g %8s\n", variant->name, shotMetricNames[metric], maxDeviation,
+                   totalDeviation / (f64)CORPUS_SHOT_COUNT, tolerances[metric], exceeded ? "FAIL" : "ok");
+
+            if (exceeded)
+            {
+                spdlog::error("{} {} is off by {:.4f} m on shot {} (club {}, shape {}, wind {})", variant->name,
+                              shotMetricNames[metric], maxDeviation, worstShot,
+                              (worstShot % SHOT_SET_SIZE) / arrayCount(shotShapes),
+                              worstShot % arrayCount(shotShapes), worstShot / SHOT_SET_SIZE);
+            }
+        }
+
+        printf("%-24s %-8s %.3f ms, %.2fx the reference\n\n", variant->name, "time", variantTime * 1e3,
+               referenceTime / variantTime);
+
+        if (failed)
+        {
+            failedVariants++;
+        }
+    }
+
+    if (testedVariants == 0)
+    {
+        spdlog::error("No variant matches {}", variantFilter);
+        return 1;
+    }
+
+    u32 missedLandings = checkSeamLandings();
+    u32 failedTracks = checkTrajectoryDecoders(geometry);
+
+    if (failedVariants > 0)
+    {
+        spdlog::error("{} of {} variants exceeded the tolerances", failedVariants, testedVariants);
+    }
+
+    free(variantOutcomes);
+    free(referenceOutcomes);
+    free(geometry);
+
+    return failedVariants > 0 || missedLandings > 0 || failedTracks > 0 ? 1 : 0;
+}
@@ -0,0 +1,909 @@
+// Microbenchmarks for the hot paths of the ball simulation, plus a macro benchmark that plays a fixed set of shots
+// until every ball comes to rest. Results are written as JSON so runs can be diffed or tracked over time.
+//
+// Usage: golfsim_bench [--filter <substring>] [--min-time <seconds>] [--out <results.json>]
+
+// clang-format off
+#include <Framework/Application.hpp>
+
+#define GLM_ENABLE_EXPERIMENTAL
+
+#include <tracy/Tracy.hpp>
+
+#include <glm/glm.hpp>
+#include <glm/gtx/norm.hpp>
+#include <glm/gtx/rotate_vector.hpp>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#include "GolfFlightSim3D.hpp"
+#include "CollisionKernels.hpp"
+#include "Determinism.hpp"
+#include "MemoryArena.hpp"
+#include "DrivingRange.hpp"
+#include "FlightPlanner.hpp"
+#include "ShotIngest.hpp"
+#include "TrajectoryHistory.hpp"
+#include "Scenarios.hpp"
+
+#include "GolfFlightSim3D.cpp"
+#include "CollisionKernels.cpp"
+#include "Determinism.cpp"
+#include "MemoryArena.cpp"
+#include "DrivingRange.cpp"
+#include "FlightPlanner.cpp"
+#include "ShotIngest.cpp"
+#include "TrajectoryHistory.cpp"
+// clang-format on
+
+#define BENCHMARK_SAMPLE_COUNT 5
+#define BENCHMARK_MAX_RESULTS 64
+#define BENCHMARK_MAX_COUNTERS 2
+
+// Inputs are cycled through so the compiler can't fold them and the branch predictor can't learn a single path
+#define BENCHMARK_INPUT_COUNT 1024
+
+// Steps between resetting the balls in the World::update benchmarks, long enough to cover flight, bounces and roll
+#define WORLD_RESTORE_PERIOD 1024
+
+#define MAX_SHOT_SECONDS 120.0F
+
+static const f32 deltaTime = 1.0F / 60.0F;
+
+typedef void BenchmarkFunction(void *state, u64 iterations);
+
+struct BenchmarkResult
+{
+    char name[64];
+    u64 iterations;
+    f64 minNs;
+    f64 medianNs;
+    f64 meanNs;
+
+    // Extra values reported by a single benchmark, like how many steps a shot set took to come to rest
+    const char *counterNames[BENCHMARK_MAX_COUNTERS];
+    f64 counterValues[BENCHMARK_MAX_COUNTERS];
+    u32 counterCount;
+};
+
+struct BenchmarkRunner
+{
+    const char *filter;
+    f64 minSampleTime;
+
+    BenchmarkResult results[BENCHMARK_MAX_RESULTS];
+    u32 resultCount;
+};
+
+// Private parts of Ball that are timed on their own
+struct BallInternals
+{
+    static void computeRebound(Ball *ball, const glm::vec3 &surfaceNormal)
+    {
+        ball->computeRebound(surfaceNormal);
+    }
+
+    static bool checkCollision(Ball *ball,
+                               CollisionGeometry *collisionGeometry,
+                               f32 dt,
+                               f32 *outCollisionTime,
+                               glm::vec3 &outIntersectionPoint,
+                               glm::vec3 &outNormal)
+    {
+        return ball->checkCollision(collisionGeometry, dt, outCollisionTime, outIntersectionPoint, outNormal);
+    }
+};
+
+// Keeps a result alive without the cost of storing it anywhere
+template <typename T>
+static inline void doNotOptimize(const T &value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+}
+
+static f64 getSeconds()
+{
+    return std::chrono::duration<f64>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static f64 timeIterations(BenchmarkFunction *function, void *state, u64 iterations)
+{
+    f64 start = getSeconds();
+    function(state, iterations);
+    return getSeconds() - start;
+}
+
+// xorshift32, the inputs only need to be varied and the same on every run
+static f32 randomRange(u32 *seed, f32 min, f32 max)
+{
+    u32 x = *seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *seed = x;
+
+    return min + (max - min) * ((f32)(x >> 8) / (f32)(1 << 24));
+}
+
+static BenchmarkResult *runBenchmark(BenchmarkRunner *runner,
+                                     const char *name,
+                                     BenchmarkFunction *function,
+                                     void *state)
+{
+    if (runner->filter != NULL && strstr(name, runner->filter) == NULL)
+    {
+        return NULL;
+    }
+
+    if (runner->resultCount >= BENCHMARK_MAX_RESULTS)
+    {
+        spdlog::error("Too many benchmarks, skipping {}", name);
+        return NULL;
+    }
+
+    // Grow the iteration count until one sample runs for at least the minimum time, which also warms the caches
+    u64 iterations = 1;
+    for (;;)
+    {
+        f64 elapsed = timeIterations(function, state, iterations);
+        if (elapsed >= runner->minSampleTime)
+        {
+            break;
+        }
+
+        f64 scale = elapsed > 0.0 ? runner->minSampleTime / elapsed * 1.2 : 100.0;
+        scale = std::min(std::max(scale, 2.0), 100.0);
+        iterations = (u64)((f64)iterations * scale) + 1;
+    }
+
+    f64 samples[BENCHMARK_SAMPLE_COUNT];
+    f64 totalNs = 0.0;
+    for (u32 sampleIndex = 0; sampleIndex < BENCHMARK_SAMPLE_COUNT; sampleIndex++)
+    {
+        samples[sampleIndex] = timeIterations(function, state, iterations) * 1e9 / (f64)iterations;
+        totalNs += samples[sampleIndex];
+    }
+
+    std::sort(samples, samples + BENCHMARK_SAMPLE_COUNT);
+
+    BenchmarkResult *result = &runner->results[runner->resultCount++];
+    bzero(result, sizeof(BenchmarkResult));
+    snprintf(result->name, sizeof(result->name), "%s", name);
+    result->iterations = iterations;
+    result->minNs = samples[0];
+    result->medianNs = samples[BENCHMARK_SAMPLE_COUNT / 2];
+    result->meanNs = totalNs / BENCHMARK_SAMPLE_COUNT;
+
+    spdlog::info("{:<40} {:>12.1f} ns/op  ({} iterations)", name, result->medianNs, iterations);
+
+    return result;
+}
+
+static void addCounter(BenchmarkResult *result, const char *name, f64 value)
+{
+    if (result == NULL || result->counterCount >= BENCHMARK_MAX_COUNTERS)
+    {
+        return;
+    }
+
+    result->counterNames[result->counterCount] = name;
+    result->counterValues[result->counterCount] = value;
+    result->counterCount++;
+}
+
+// Balls are zeroed before spawning because pushBall only sets the launch state
+static void resetBalls(World *world, size_t ballCount)
+{
+    bzero(world->ballManager.getBall(0), ballCount * sizeof(Ball));
+    world->ballManager.activeBalls = 0;
+
+    for (size_t ballIndex = 0; ballIndex < ballCount; ballIndex++)
+    {
+        spawnShot(&world->ballManager, ballIndex);
+    }
+}
+
+struct CoefficientState
+{
+    f32 groundSpeedsSquared[BENCHMARK_INPUT_COUNT];
+    f32 spinRates[BENCHMARK_INPUT_COUNT];
+};
+
+static void benchmarkCoefficients(void *state, u64 iterations)
+{
+    CoefficientState *inputs = (CoefficientState *)state;
+
+    for (u64 iteration = 0; iteration < iterations; iteration++)
+    {
+        u64 inputIndex = iteration & (BENCHMARK_INPUT_COUNT - 1);
+
+        f32 liftCoefficient, dragCoefficient;
+        computeLiftAndDragCoefficients(inputs->groundSpeedsSquared[inputIndex], inputs->spinRates[inputIndex],
+                                       &liftCoefficient, &dragCoefficient);
+        doNotOptimize(liftCoefficient);
+        doNotOptimize(dragCoefficient);
+    }
+}
+
+struct ReboundState
+{
+    Ball ball;
+    glm::vec3 velocities[BENCHMARK_INPUT_COUNT];
+    glm::vec3 rotationAxes[BENCHMARK_INPUT_COUNT];
+    f32 spinRates[BENCHMARK_INPUT_COUNT];
+};
+
+static void benchmarkRebound(void *state, u64 iterations)
+{
+    ReboundState *inputs = (ReboundState *)state;
+    const glm::vec3 up(0.0F, 1.0F, 0.0F);
+
+    for (u64 iteration = 0; iteration < iterations; iteration++)
+    {
+        u64 inputIndex = iteration & (BENCHMARK_INPUT_COUNT - 1);
+
+        inputs->ball.velocity = inputs->velocities[inputIndex];
+        inputs->ball.rotationAxis = inputs->rotationAxes[inputIndex];
+        inputs->ball.spinRate = inputs->spinRates[inputIndex];
+
+        BallInternals::computeRebound(&inputs->ball, up);
+        doNotOptimize(inputs->ball.velocity);
+    }
+}
+
+struct KernelState
+{
+    CollisionKernel *kernel;
+    const CollisionBlock *blocks;
+    size_t blockCount;
+    CollisionSweep sweeps[BENCHMARK_INPUT_COUNT];
+};
+
+// One block of eight triangles per iteration
+static void benchmarkKernel(void *state, u64 iterations)
+{
+    KernelState *inputs = (KernelState *)state;
+
+    for (u64 iteration = 0; iteration < iterations; iteration++)
+    {
+        u64 inputIndex = iteration & (BENCHMARK_INPUT_COUNT - 1);
+
+        CollisionLanes lanes;
+        inputs->kernel(&inputs->blocks[inputIndex % inputs->blockCount], &inputs->sweeps[inputIndex], &lanes);
+        doNotOptimize(lanes.faceMask | lanes.edgeMask);
+        doNotOptimize(lanes.times[0]);
+    }
+}
+
+struct CollisionState
+{
+    CollisionGeometry *geometry;
+    Ball balls[BENCHMARK_INPUT_COUNT];
+};
+
+static void benchmarkCollision(void *state, u64 iterations)
+{
+    CollisionState *inputs = (CollisionState *)state;
+
+    for (u64 iteration = 0; iteration < iterations; iteration++)
+    {
+        u64 inputIndex = iteration & (BENCHMARK_INPUT_COUNT - 1);
+
+        f32 collisionTime;
+        glm::vec3 intersectionPoint;
+        glm::vec3 normal;
+        bool colliding = BallInternals::checkCollision(&inputs->balls[inputIndex], inputs->geometry, deltaTime,
+                                                       &collisionTime, intersectionPoint, normal);
+        doNotOptimize(colliding);
+    }
+}
+
+struct WorldUpdateState
+{
+    World *world;
+    CollisionGeometry *geometry;
+    Ball *snapshot;
+    size_t ballCount;
+    u32 stepsSinceRestore;
+};
+
+static void benchmarkWorldUpdate(void *state, u64 iterations)
+{
+    WorldUpdateState *inputs = (WorldUpdateState *)state;
+
+    for (u64 iteration = 0; iteration < iterations; iteration++)
+    {
+        if (inputs->stepsSinceRestore == WORLD_RESTORE_PERIOD)
+        {
+            memcpy(inputs->world->ballManager.getBall(0), inputs->snapshot, inputs->ballCount * sizeof(Ball));
+            inputs->stepsSinceRestore = 0;
+        }
+
+        inputs->world->update(inputs->geometry, deltaTime);
+        inputs->stepsSinceRestore++;
+    }
+}
+
+#define INGEST_BENCHMARK_LINE_LENGTH 128
+
+struct IngestParseState
+{
+    bool json;
+    CsvColumns columns;
+    char lines[BENCHMARK_INPUT_COUNT][INGEST_BENCHMARK_LINE_LENGTH];
+};
+
+// One launch record per iteration, as the ingest reader parses them
+static void benchmarkIngestParse(void *state, u64 iterations)
+{
+    IngestParseState *inputs = (IngestParseState *)state;
+
+    for (u64 iteration = 0; iteration < iterations; iteration++)
+    {
+        u64 inputIndex = iteration & (BENCHMARK_INPUT_COUNT - 1);
+
+        LaunchRecord record;
+        bool parsed = inputs->json ? parseJsonRecord(inputs->lines[inputIndex], &record)
+                                   : parseCsvRecord(inputs->lines[inputIndex], &inputs->columns, &record);
+        doNotOptimize(parsed);
+        doNotOptimize(record.launch.speed);
+    }
+}
+
+struct ShotSetState
+{
+    World *world;
+    CollisionGeometry *geometry;
+
+    u64 steps;
+    f64 meanRestDistance;
+};
+
+static void benchmarkShotSet(void *state, u64 iterations)
+{
+    ShotSetState *inputs = (ShotSetState *)state;
+    World *world = inputs->world;
+    const u32 maxSteps = (u32)(MAX_SHOT_SECONDS / deltaTime);
+
+    for (u64 iteration = 0; iteration < iterations; iteration++)
+    {
+        resetBalls(world, SHOT_SET_SIZE);
+
+        u32 step = 0;
+        bool moving = true;
+        while (moving && step < maxSteps)
+        {
+            world->update(inputs->geometry, deltaTime);
+            step++;
+
+            moving = false;
+            for (size_t ballIndex = 0; ballIndex < world->ballManager.activeBalls; ballIndex++)
+            {
+                moving |= world->ballManager.getBall(ballIndex)->state != BALL_STATE_IDLE;
+            }
+        }
+
+        inputs->steps = step;
+    }
+
+    f64 totalDistance = 0.0;
+    for (size_t ballIndex = 0; ballIndex < world->ballManager.activeBalls; ballIndex++)
+    {
+        Ball *ball = world->ballManager.getBall(ballIndex);
+        glm::vec3 offset = ball->position - ball->startPosition;
+        totalDistance += sqrt((f64)offset.x * offset.x + (f64)offset.z * offset.z);
+    }
+    inputs->meanRestDistance = totalDistance / (f64)world->ballManager.activeBalls;
+}
+
+struct TrajectoryState
+{
+    TrajectoryHistory *history;
+    glm::vec3 *positions;
+    u32 sampleTracks[BENCHMARK_INPUT_COUNT];
+    f64 sampleTimes[BENCHMARK_INPUT_COUNT];
+};
+
+static void benchmarkTrajectoryDecode(void *state, u64 iterations)
+{
+    TrajectoryState *inputs = (TrajectoryState *)state;
+
+    for (u64 iteration = 0; iteration < iterations; iteration++)
+    {
+        inputs->history->decodeTrack((u32)(iteration % inputs->history->trackCount), inputs->positions);
+    }
+}
+
+static void benchmarkTrajectorySample(void *state, u64 iterations)
+{
+    TrajectoryState *inputs = (TrajectoryState *)state;
+
+    for (u64 iteration = 0; iteration < iterations; iteration++)
+    {
+        u64 inputIndex = iteration & (BENCHMARK_INPUT_COUNT - 1);
+        inputs->positions[0] =
+            inputs->history->samplePosition(inputs->sampleTracks[inputIndex], inputs->sampleTimes[inputIndex]);
+    }
+}
+
+static void runBenchmarks(BenchmarkRunner *runner, World *world, CollisionGeometry *geometry)
+{
+    u32 seed = 0x9E3779B9;
+
+    CoefficientState *coefficientState = (CoefficientState *)calloc(1, sizeof(CoefficientState));
+    for (u32 inputIndex = 0; inputIndex < BENCHMARK_INPUT_COUNT; inputIndex++)
+    {
+        f32 speed = randomRange(&seed, 0.0F, 90.0F);
+        coefficientState->groundSpeedsSquared[inputIndex] = speed * speed;
+        coefficientState->spinRates[inputIndex] = randomRange(&seed, 0.0F, 7000.0F);
+    }
+    runBenchmark(runner, "computeLiftAndDragCoefficients", benchmarkCoefficients, coefficientState);
+    free(coefficientState);
+
+    // Landing conditions of full shots, descending steeply with backspin tilted a little either way
+    ReboundState *reboundState = (ReboundState *)calloc(1, sizeof(ReboundState));
+    for (u32 inputIndex = 0; inputIndex < BENCHMARK_INPUT_COUNT; inputIndex++)
+    {
+        f32 heading = randomRange(&seed, -0.2F, 0.2F);
+        glm::vec3 velocity(0.0F, randomRange(&seed, -30.0F, -8.0F), randomRange(&seed, 8.0F, 40.0F));
+        reboundState->velocities[inputIndex] = glm::rotateY(velocity, heading);
+        reboundState->rotationAxes[inputIndex] =
+            glm::rotateZ(glm::rotateY(glm::vec3(1.0F, 0.0F, 0.0F), heading), randomRange(&seed, -0.3F, 0.3F));
+        reboundState->spinRates[inputIndex] = randomRange(&seed, 1500.0F, 9000.0F);
+    }
+    runBenchmark(runner, "computeRebound", benchmarkRebound, reboundState);
+    free(reboundState);
+
+    // A mix of balls that are overlapping, approaching and moving away from a small patch of rolling terrain, inside
+    // and outside its triangles
+    buildTerrain(geometry, 8, 16.0F);
+    KernelState *kernelState = (KernelState *)calloc(1, sizeof(KernelState));
+    kernelState->blocks = geometry->blocks;
+    kernelState->blockCount = geometry->blockCount;
+    for (u32 inputIndex = 0; inputIndex < BENCHMARK_INPUT_COUNT; inputIndex++)
+    {
+        glm::vec3 position(randomRange(&seed, -8.0F, 8.0F), randomRange(&seed, -0.5F, 1.0F),
+                           randomRange(&seed, -8.0F, 8.0F));
+        glm::vec3 velocity(randomRange(&seed, -5.0F, 5.0F), randomRange(&seed, -30.0F, 30.0F),
+                           randomRange(&seed, 0.0F, 60.0F));
+        setupCollisionSweep(&kernelState->sweeps[inputIndex], position, velocity, deltaTime);
+    }
+    CollisionKernelType widestKernel = getCollisionKernelType();
+    for (u32 type = 0; type < COLLISION_KERNEL_COUNT; type++)
+    {
+        if (!setCollisionKernel((CollisionKernelType)type))
+        {
+            continue;
+        }
+        kernelState->kernel = getCollisionKernel();
+
+        char name[64];
+        snprintf(name, sizeof(name), "collisionKernel/%s", getCollisionKernelName((CollisionKernelType)type));
+        runBenchmark(runner, name, benchmarkKernel, kernelState);
+    }
+    free(kernelState);
+    setCollisionKernel(widestKernel);
+
+    // Balls climb away from the terrain, so every triangle is tested, which is the worst case of the linear scan
+    const u32 terrainSizes[] = {1, 8, 32, 128};
+    CollisionState *collisionState = (CollisionState *)calloc(1, sizeof(CollisionState));
+    collisionState->geometry = geometry;
+    for (u32 inputIndex = 0; inputIndex < BENCHMARK_INPUT_COUNT; inputIndex++)
+    {
+        Ball *ball = &collisionState->balls[inputIndex];
+        ball->position = glm::vec3(randomRange(&seed, -100.0F, 100.0F), randomRange(&seed, 5.0F, 40.0F),
+                                   randomRange(&seed, 0.0F, 200.0F));
+        ball->velocity = glm::vec3(randomRange(&seed, -5.0F, 5.0F), randomRange(&seed, 5.0F, 30.0F),
+                                   randomRange(&seed, 20.0F, 60.0F));
+    }
+    for (u32 sizeIndex = 0; sizeIndex < arrayCount(terrainSizes); sizeIndex++)
+    {
+        buildTerrain(geometry, terrainSizes[sizeIndex], 500.0F);
+
+        char name[64];
+        snprintf(name, sizeof(name), "checkCollision/triangles:%zu", geometry->triangleCount);
+        runBenchmark(runner, name, benchmarkCollision, collisionState);
+    }
+    free(collisionState);
+
+    // The whole world runs against a flat range like the one in the game
+    buildTerrain(geometry, 1, 1000.0F);
+
+    const size_t ballCounts[] = {1, 100, MAX_BALLS};
+    WorldUpdateState worldState = {};
+    worldState.world = world;
+    worldState.geometry = geometry;
+    worldState.snapshot = (Ball *)calloc(MAX_BALLS, sizeof(Ball));
+    bzero(&world->wind, sizeof(Wind));
+    for (u32 countIndex = 0; countIndex < arrayCount(ballCounts); countIndex++)
+    {
+        worldState.ballCount = ballCounts[countIndex];
+        worldState.stepsSinceRestore = 0;
+        resetBalls(world, worldState.ballCount);
+        memcpy(worldState.snapshot, world->ballManager.getBall(0), worldState.ballCount * sizeof(Ball));
+
+        char name[64];
+        snprintf(name, sizeof(name), "World::update/balls:%zu", worldState.ballCount);
+        runBenchmark(runner, name, benchmarkWorldUpdate, &worldState);
+    }
+
+    // Balls crowded onto the ground a ball apart, so every step has contacts to resolve and the cost of the hash
+    // shows against the ball count
+    const size_t contactBallCounts[] = {100, 1000, MAX_BALLS};
+    BallContacts *contacts = (BallContacts *)calloc(1, sizeof(BallContacts));
+    contacts->enabled = true;
+    world->contacts = contacts;
+    for (u32 countIndex = 0; countIndex < arrayCount(contactBallCounts); countIndex++)
+    {
+        worldState.ballCount = contactBallCounts[countIndex];
+        worldState.stepsSinceRestore = 0;
+        resetBalls(world, worldState.ballCount);
+
+        u32 side = (u32)ceilf(sqrtf((f32)worldState.ballCount));
+        for (size_t ballIndex = 0; ballIndex < worldState.ballCount; ballIndex++)
+        {
+            Ball *ball = world->ballManager.getBall(ballIndex);
+            ball->position = glm::vec3((f32)(ballIndex % side) * 0.06F, BALL_RADIUS, (f32)(ballIndex / side) * 0.06F);
+            ball->velocity = glm::vec3((f32)(ballIndex % 3) - 1.0F, 0.0F, (f32)(ballIndex % 5) * 0.5F - 1.0F);
+            ball->state = BALL_STATE_ROLLING;
+        }
+        memcpy(worldState.snapshot, world->ballManager.getBall(0), worldState.ballCount * sizeof(Ball));
+
+        char name[64];
+        snprintf(name, sizeof(name), "World::update/contacts/balls:%zu", worldState.ballCount);
+        BenchmarkResult *result = runBenchmark(runner, name, benchmarkWorldUpdate, &worldState);
+        addCounter(result, "contacts", (f64)contacts->contacts);
+        addCounter(result, "pairs_tested", (f64)contacts->pairsTested);
+    }
+    world->contacts = NULL;
+    free(contacts);
+
+    // A full venue, every ball in flight from one of 100 bays, on one thread and then on every hardware thread
+    const u32 threadCounts[] = {1, std::max(std::thread::hardware_concurrency(), 1U)};
+    for (u32 threadIndex = 0; threadIndex < arrayCount(threadCounts); threadIndex++)
+    {
+        if (threadIndex > 0 && threadCounts[threadIndex] == threadCounts[0])
+        {
+            continue;
+        }
+
+        DrivingRangeConfig rangeConfig = {100, BAY_DEFAULT_SPACING, threadCounts[threadIndex]};
+        DrivingRange *range = new DrivingRange();
+        range->initialize(&rangeConfig);
+        world->range = range;
+
+        worldState.ballCount = MAX_BALLS;
+        worldState.stepsSinceRestore = 0;
+        bzero(world->ballManager.getBall(0), MAX_BALLS * sizeof(Ball));
+        world->ballManager.activeBalls = 0;
+        for (size_t ballIndex = 0; ballIndex < MAX_BALLS; ballIndex++)
+        {
+            u32 bayIndex = (u32)(ballIndex % range->bayCount);
+            LaunchConditions launch = getShotLaunchConditions(ballIndex / range->bayCount);
+            world->ballManager.pushBall(launch.speed, launch.launchAngle, launch.heading, launch.spinRate,
+                                        launch.spinAngle, bayIndex, &range->bays[bayIndex].tee);
+        }
+        memcpy(worldState.snapshot, world->ballManager.getBall(0), MAX_BALLS * sizeof(Ball));
+
+        char name[64];
+        snprintf(name, sizeof(name), "World::update/bays:%u/threads:%u", range->bayCount, range->workerCount);
+        runBenchmark(runner, name, benchmarkWorldUpdate, &worldState);
+
+        world->range = NULL;
+        range->shutdown();
+        delete range;
+    }
+    free(worldState.snapshot);
+
+    // Launch monitor logs with every field filled in, as CSV under a header and as NDJSON with a timestamp to skip
+    IngestParseState *ingestState = (IngestParseState *)calloc(1, sizeof(IngestParseState));
+    parseCsvHeader("speedMph,launchAngle,heading,spinRate,spinAngle,bay", &ingestState->columns);
+    for (u32 json = 0; json < 2; json++)
+    {
+        ingestState->json = json != 0;
+        for (u32 inputIndex = 0; inputIndex < BENCHMARK_INPUT_COUNT; inputIndex++)
+        {
+            f32 speedMph = randomRange(&seed, 80.0F, 180.0F);
+            f32 launchAngle = randomRange(&seed, 8.0F, 30.0F);
+            f32 heading = randomRange(&seed, -5.0F, 5.0F);
+            f32 spinRate = randomRange(&seed, 2000.0F, 10000.0F);
+            f32 spinAngle = randomRange(&seed, -20.0F, 20.0F);
+            u32 bay = 1 + inputIndex % 100;
+
+            char *line = ingestState->lines[inputIndex];
+            if (ingestState->json)
+            {
+                snprintf(line, INGEST_BENCHMARK_LINE_LENGTH,
+                         "{\"time\": \"10:%02u:%02u\", \"speedMph\": %.1f, \"launchAngle\": %.2f, \"heading\": %.2f, "
+                         "\"spinRate\": %.0f, \"spinAngle\": %.2f, \"bay\": %u}",
+                         inputIndex / 60 % 60, inputIndex % 60, speedMph, launchAngle, heading, spinRate, spinAngle,
+                         bay);
+            }
+            else
+            {
+                snprintf(line, INGEST_BENCHMARK_LINE_LENGTH, "%.1f,%.2f,%.2f,%.0f,%.2f,%u", speedMph, launchAngle,
+                         heading, spinRate, spinAngle, bay);
+            }
+        }
+
+        runBenchmark(runner, ingestState->json ? "ShotIngest/parse:ndjson" : "ShotIngest/parse:csv",
+                     benchmarkIngestParse, ingestState);
+    }
+    free(ingestState);
+
+    // Every club and shape in a light crosswind, from the tee until the last ball stops rolling
+    ShotSetState shotSetState = {};
+    shotSetState.world = world;
+    shotSetState.geometry = geometry;
+    world->wind.speed = mphToMs(10.0F);
+    world->wind.direction = glm::radians(60.0F);
+    world->wind.logWind = true;
+
+    BenchmarkResult *result = runBenchmark(runner, "ShotSet/to_rest", benchmarkShotSet, &shotSetState);
+    addCounter(result, "steps", (f64)shotSetState.steps);
+    addCounter(result, "mean_rest_distance_m", shotSetState.meanRestDistance);
+
+    // The same with the portable transcendentals deterministic mode swaps in for the C library's
+    getDeterminismConfig()->enabled = true;
+    result = runBenchmark(runner, "ShotSet/to_rest:deterministic", benchmarkShotSet, &shotSetState);
+    addCounter(result, "steps", (f64)shotSetState.steps);
+    addCounter(result, "mean_rest_distance_m", shotSetState.meanRestDistance);
+    getDeterminismConfig()->enabled = false;
+
+    // The same with the balls following flights solved on worker threads as they are launched. They come to rest at
+    // the same distances, and the steps only get cheaper once the workers have caught up.
+    FlightPlannerConfig plannerConfig = {true, std::max(std::thread::hardware_concurrency(), 1U)};
+    FlightPlanner *planner = new FlightPlanner();
+    planner->initialize(&plannerConfig);
+    world->planner = planner;
+    result = runBenchmark(runner, "ShotSet/to_rest:planned", benchmarkShotSet, &shotSetState);
+    addCounter(result, "steps", (f64)shotSetState.steps);
+    addCounter(result, "mean_rest_distance_m", shotSetState.meanRestDistance);
+    world->planner = NULL;
+    planner->shutdown();
+    delete planner;
+
+    // The shot set's trajectories from the tee to rest, decoded a track at a time and sampled at random times
+    TrajectoryState *trajectoryState = (TrajectoryState *)calloc(1, sizeof(TrajectoryState));
+    TrajectoryHistory *history = (TrajectoryHistory *)calloc(1, sizeof(TrajectoryHistory));
+    TrajectoryHistoryConfig historyConfig = {TRAJECTORY_DEFAULT_BUDGET};
+    history->initialize(&historyConfig);
+    trajectoryState->history = history;
+
+    resetBalls(world, SHOT_SET_SIZE);
+    const u32 maxSteps = (u32)(MAX_SHOT_SECONDS / deltaTime);
+    bool moving = true;
+    for (u32 step = 0; moving && step < maxSteps; step++)
+    {
+        world->update(geometry, deltaTime);
+        history->record(&world->ballManager, deltaTime);
+
+        moving = false;
+        for (size_t ballIndex = 0; ballIndex < world->ballManager.activeBalls; ballIndex++)
+        {
+            moving |= world->ballManager.getBall(ballIndex)->state != BALL_STATE_IDLE;
+        }
+    }
+    history->closeTracks();
+
+    u32 maxSamples = 0;
+    for (u32 trackIndex = 0; trackIndex < history->trackCount; trackIndex++)
+    {
+        maxSamples = std::max(maxSamples, history->getTrack(trackIndex)->sampleCount);
+    }
+    trajectoryState->positions = (glm::vec3 *)malloc(std::max(maxSamples, 1U) * sizeof(glm::vec3));
+    for (u32 inputIndex = 0; inputIndex < BENCHMARK_INPUT_COUNT; inputIndex++)
+    {
+        const TrajectoryTrack *track = history->getTrack(inputIndex % history->trackCount);
+        trajectoryState->sampleTracks[inputIndex] = inputIndex % history->trackCount;
+        trajectoryState->sampleTimes[inputIndex] =
+            (track->firstStep + randomRange(&seed, 0.0F, (f32)track->sampleCount)) * (f64)deltaTime;
+    }
+
+    f64 meanSamples = (f64)history->stats.encodedSamples / (f64)history->trackCount;
+    f64 compressionRatio = (f64)history->stats.encodedSamples * sizeof(glm::vec3) / (f64)history->stats.encodedBytes;
+    for (u32 type = 0; type < TRAJECTORY_DECODER_COUNT; type++)
+    {
+        if (!setTrajectoryDecoder((TrajectoryDecoderType)type))
+        {
+            continue;
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "TrajectoryHistory/decodeTrack:%s",
+                 getTrajectoryDecoderName((TrajectoryDecoderType)type));
+        result = runBenchmark(runner, name, benchmarkTrajectoryDecode, trajectoryState);
+        addCounter(result, "compression_ratio", compressionRatio);
+        if (result != NULL)
+        {
+            addCounter(result, "million_positions_per_s", meanSamples / result->medianNs * 1e3);
+        }
+    }
+
+    runBenchmark(runner, "TrajectoryHistory/samplePosition", benchmarkTrajectorySample, trajectoryState);
+
+    history->shutdown();
+    free(history);
+    free(trajectoryState->positions);
+    free(trajectoryState);
+}
+
+static void writeResults(FILE *file, const BenchmarkRunner *runner)
+{
+    char date[32];
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+#if defined(__clang__)
+    const char *compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    const char *compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    const char *compiler = "msvc";
+#else
+    const char *compiler = "unknown";
+#endif
+
+#ifdef NDEBUG
+    const char *buildType = "release";
+#else
+    const char *buildType = "debug";
+#endif
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"context\": {\n");
+    fprintf(file, "    \"date\": \"%s\",\n", date);
+    fprintf(file, "    \"compiler\": \"%s\",\n", compiler);
+    fprintf(file, "    \"build_type\": \"%s\",\n", buildType);
+    fprintf(file, "    \"samples\": %d,\n", BENCHMARK_SAMPLE_COUNT);
+    fprintf(file, "    \"min_sample_time_s\": %g\n", runner->minSampleTime);
+    fprintf(file, "  },\n");
+    fprintf(file, "  \"benchmarks\": [");
+
+    for (u32 resultIndex = 0; resultIndex < runner->resultCount; resultIndex++)
+    {
+        const BenchmarkResult *result = &runner->results[resultIndex];
+
+        fprintf(file, "%s\n    {\n", resultIndex > 0 ? "," : "");
+        fprintf(file, "      \"name\": \"%s\",\n", result->name);
+        fprintf(file, "      \"iterations\": %llu,\n", (unsigned long long)result->iterations);
+        fprintf(file, "      \"min_ns\": %.2f,\n", result->minNs);
+        fprintf(file, "      \"median_ns\": %.2f,\n", result->medianNs);
+        fprintf(file, "      \"mean_ns\": %.2f", result->meanNs);
+
+        if (result->counterCount > 0)
+        {
+            fprintf(file, ",\n      \"counters\": {");
+            for (u32 counterIndex = 0; counterIndex < result->counterCount; counterIndex++)
+            {
+                fprintf(file, "%s\"%s\": %.6g", counterIndex > 0 ? ", " : "", result->counterNames[counterIndex],
+                        result->counterValues[counterIndex]);
+            }
+            fprintf(file, "}");
+        }
+
+        fprintf(file, "\n    }");
+    }
+
+    fprintf(file, "\n  ]\n}\n");
+}
+
+static void printUsage()
+{
+    fprintf(stderr, "Usage: golfsim_bench [--filter <substring>] [--min-time <seconds>] [--out <results.json>]\n");
+}
+
+int main(int argc, char *argv[])
+{
+    BenchmarkRunner *runner = (BenchmarkRunner *)calloc(1, sizeof(BenchmarkRunner));
+    runner->minSampleTime = 0.05;
+
+    const char *outputPath = NULL;
+
+    for (s32 argIndex = 1; argIndex < argc; argIndex++)
+    {
+        const char *arg = argv[argIndex];
+        const char *value = argIndex + 1 < argc ? argv[argIndex + 1] : NULL;
+
+        if (strcmp(arg, "--filter") == 0 && value != NULL)
+        {
+            runner->filter = value;
+            argIndex++;
+        }
+        else if (strcmp(arg, "--min-time") == 0 && value != NULL && atof(value) > 0.0)
+        {
+            runner->minSampleTime = atof(value);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--out") == 0 && value != NULL)
+        {
+            outputPath = value;
+            argIndex++;
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // stdout is reserved for the results
+    spdlog::set_default_logger(spdlog::stderr_color_mt("bench"));
+
+#ifndef NDEBUG
+    spdlog::warn("Benchmarking a debug build, numbers will not be representative");
+#endif
+
+    // Only the pages the terrain touches are ever committed
+    World *world = (World *)calloc(1, sizeof(World));
+    CollisionGeometry *geometry = (CollisionGeometry *)calloc(1, sizeof(CollisionGeometry));
+    if (world == NULL || geometry == NULL)
+    {
+        spdlog::error("Failed to allocate the benchmark world");
+        return 1;
+    }
+
+    runBenchmarks(runner, world, geometry);
+
+    FILE *file = stdout;
+    if (outputPath != NULL)
+    {
+        file = fopen(outputPath, "w");
+        if (file == NULL)
+        {
+            spdlog::error("Failed to open {} for writing", outputPath);
+            return 1;
+        }
+    }
+
+    writeResults(file, runner);
+
+    if (file != stdout)
+    {
+        fclose(file);
+        spdlog::info("Results written to {}", outputPath);
+    }
+
+    free(geometry);
+    free(world);
+    free(runner);
+
+    return 0;
+}
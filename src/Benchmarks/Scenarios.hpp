@@ -0,0 +1,118 @@
+// Fixed shots and terrain shared by the benchmarks and the accuracy harness, so both measure the same scenes
+
+#define mphToMs(n) ((n) * 0.44704F)
+
+struct Shot
+{
+    f32 speedMph;
+    f32 launchAngleDegrees;
+    f32 spinRate;
+};
+
+// Roughly tour average launch conditions from driver down to wedge
+static const Shot clubShots[] = {
+    {167.0F, 10.9F, 2686.0F},  // Driver
+    {158.0F, 9.2F, 3655.0F},   // 3 wood
+    {146.0F, 10.2F, 4350.0F},  // Hybrid
+    {132.0F, 12.1F, 5361.0F},  // 5 iron
+    {120.0F, 16.3F, 7097.0F},  // 7 iron
+    {102.0F, 24.2F, 9304.0F},  // Pitching wedge
+};
+
+// Heading and spin axis in degrees: straight, draw, fade and a pushed slice for every club
+static const f32 shotShapes[][2] = {
+    {0.0F, 0.0F},
+    {-2.0F, -8.0F},
+    {2.0F, 8.0F},
+    {4.0F, 20.0F},
+};
+
+#define SHOT_SET_SIZE (arrayCount(clubShots) * arrayCount(shotShapes))
+
+// Same units spawnBall takes: m/s, radians and rpm
+struct LaunchConditions
+{
+    f32 speed;
+    f32 launchAngle;
+    f32 heading;
+    f32 spinRate;
+    f32 spinAngle;
+};
+
+static LaunchConditions getShotLaunchConditions(size_t shotIndex)
+{
+    const Shot *shot = &clubShots[(shotIndex / arrayCount(shotShapes)) % arrayCount(clubShots)];
+    const f32 *shape = shotShapes[shotIndex % arrayCount(shotShapes)];
+
+    LaunchConditions launch;
+    launch.speed = mphToMs(shot->speedMph);
+    launch.launchAngle = glm::radians(shot->launchAngleDegrees);
+    launch.heading = glm::radians(shape[0]);
+    launch.spinRate = shot->spinRate;
+    launch.spinAngle = glm::radians(shape[1]);
+
+    return launch;
+}
+
+static void spawnShot(BallManager *ballManager, size_t shotIndex)
+{
+    LaunchConditions launch = getShotLaunchConditions(shotIndex);
+    ballManager->spawnBall(launch.speed, launch.launchAngle, launch.heading, launch.spinRate, launch.spinAngle);
+}
+
+// Rolling terrain of quadsPerSide^2 quads split into two triangles each, centered on the tee. Vertices are shared
+// between quads.
+static void buildTerrain(CollisionGeometry *geometry, u32 quadsPerSide, f32 size)
+{
+    u32 verticesPerSide = quadsPerSide + 1;
+    f32 spacing = size / (f32)quadsPerSide;
+    f32 origin = -0.5F * size;
+
+    geometry->vertexCount = 0;
+    for (u32 z = 0; z < verticesPerSide; z++)
+    {
+        for (u32 x = 0; x < verticesPerSide; x++)
+        {
+            f32 px = origin + spacing * (f32)x;
+            f32 pz = origin + spacing * (f32)z;
+            f32 py = quadsPerSide > 1 ? 0.5F * sinf(px * 0.05F) * cosf(pz * 0.07F) : 0.0F;
+
+            Vtx *vertex = &geometry->vertices[geometry->vertexCount++];
+            vertex->position = glm::vec3(px, py, pz);
+            vertex->normal = glm::vec3(0.0F, 1.0F, 0.0F);
+        }
+    }
+
+    geometry->triangleCount = 0;
+    for (u32 z = 0; z < quadsPerSide; z++)
+    {
+        for (u32 x = 0; x < quadsPerSide; x++)
+        {
+            u32 v00 = z * verticesPerSide + x;
+            u32 v10 = v00 + 1;
+            u32 v01 = v00 + verticesPerSide;
+            u32 v11 = v01 + 1;
+
+            u32 corners[2][3] = {{v00, v01, v10}, {v10, v01, v11}};
+            for (u32 half = 0; half < 2; half++)
+            {
+                Triangle *triangle = &geometry->triangles[geometry->triangleCount++];
+                triangle->a = corners[half][0];
+                triangle->b = corners[half][1];
+                triangle->c = corners[half][2];
+
+                glm::vec3 &a = geometry->vertices[triangle->a].position;
+                glm::vec3 &b = geometry->vertices[triangle->b].position;
+                glm::vec3 &c = geometry->vertices[triangle->c].position;
+                triangle->normal = glm::normalize(glm::cross(b - a, c - a));
+                triangle->d = glm::dot(triangle->normal, a);
+            }
+        }
+    }
+
+    // Grown to the largest terrain built so far, the benchmarks build several sizes into the same geometry
+    geometry->blockCount = getCollisionBlockCount(geometry->triangleCount);
+    geometry->blocks = (CollisionBlock *)realloc(geometry->blocks, geometry->blockCount * sizeof(CollisionBlock));
+    packCollisionBlocks((const u8 *)&geometry->vertices[0].position, sizeof(Vtx), geometry->triangles,
+                        geometry->triangleCount, geometry->blocks);
+}
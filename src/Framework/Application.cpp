@@ -1,4 +1,5 @@
 #include <Framework/Application.hpp>
+#include <Framework/FrameCapture.hpp>
 
 // clang-format off
 #include <spdlog/spdlog.h>
@@ -7,14 +8,55 @@
 #include <imgui.h>
 #include <imgui_impl_opengl3.h>
 #include <imgui_impl_glfw.h>
+
+#ifdef FRAMEWORK_HEADLESS_EGL
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
 // clang-format on
 
+#include <float.h>
+
+#include <algorithm>
+#include <chrono>
+
 #include <tracy/Tracy.hpp>
 #include <tracy/TracyOpenGL.hpp>
 
-void Application::run()
+#define HEADLESS_FRAME_TIME (1.0F / 60.0F)
+
+struct HeadlessContext
+{
+#ifdef FRAMEWORK_HEADLESS_EGL
+    EGLDisplay display;
+    EGLContext context;
+#endif
+
+    GLuint framebuffer;
+    GLuint colorRenderbuffer;
+    GLuint depthRenderbuffer;
+
+    // Stands in for the swap chain, keeping at most one frame in flight so frame times include the GPU work
+    GLsync frameFence;
+
+    // The first frame pays for shader compilation and first uploads, so it is left out of the stats
+    f64 measureStartTime;
+    f64 measureEndTime;
+    u32 measuredFrames;
+    f64 minFrameTime;
+    f64 maxFrameTime;
+};
+
+void Application::run(const ApplicationOptions &options)
 {
     FrameMarkStart("App Run");
+
+    _headless = options.headless;
+    _frameCount = options.frameCount;
+    _windowWidth = options.width;
+    _windowHeight = options.height;
+
     if (!initialize())
     {
         return;
@@ -29,20 +71,69 @@ void Application::run()
 
     spdlog::info("Application: Loaded");
 
-    f64 previousTime = glfwGetTime();
-    while (!glfwWindowShouldClose(_windowHandle))
+    if (options.capturePath != NULL)
+    {
+        u32 captureWidth = _windowWidth;
+        u32 captureHeight = _windowHeight;
+        if (!_headless)
+        {
+            s32 framebufferWidth, framebufferHeight;
+            glfwGetFramebufferSize(_windowHandle, &framebufferWidth, &framebufferHeight);
+            captureWidth = (u32)framebufferWidth;
+            captureHeight = (u32)framebufferHeight;
+        }
+
+        // A window has to keep up with the display, so it drops frames the encoder can't take. Headless runs wait for
+        // it instead, they are there to produce every frame.
+        _frameCapture = new FrameCapture();
+        if (!_frameCapture->begin(options.capturePath, captureWidth, captureHeight, !_headless))
+        {
+            delete _frameCapture;
+            _frameCapture = NULL;
+            unload();
+            return;
+        }
+    }
+
+    f64 previousTime = getTime();
+    while (!shouldClose())
     {
-        f64 currentTime = glfwGetTime();
+        f64 currentTime = getTime();
         f32 frameTime = (f32)(currentTime - previousTime);
+        if (_headless)
+        {
+            recordHeadlessFrameTime(currentTime, currentTime - previousTime);
+            frameTime = HEADLESS_FRAME_TIME;
+        }
+        else
+        {
+            glfwPollEvents();
+        }
+        previousTime = currentTime;
+
         if (frameTime > 0.1F)
         {
             frameTime = 0.1F;
         }
-        previousTime = currentTime;
 
-        glfwPollEvents();
         update(frameTime);
         render(frameTime);
+
+        _frameIndex++;
+    }
+
+    if (_headless)
+    {
+        f64 endTime = getTime();
+        recordHeadlessFrameTime(endTime, endTime - previousTime);
+        reportHeadlessFrameTimes();
+    }
+
+    if (_frameCapture != NULL)
+    {
+        _frameCapture->end();
+        delete _frameCapture;
+        _frameCapture = NULL;
     }
 
     spdlog::info("Application: Unloading");
@@ -55,16 +146,263 @@ void Application::run()
 
 void Application::close()
 {
-    glfwSetWindowShouldClose(_windowHandle, 1);
+    _closeRequested = true;
+
+    if (!_headless)
+    {
+        glfwSetWindowShouldClose(_windowHandle, 1);
+    }
+}
+
+bool Application::shouldClose()
+{
+    if (_frameCount > 0 && _frameIndex >= _frameCount)
+    {
+        return true;
+    }
+
+    if (_headless)
+    {
+        return _closeRequested;
+    }
+
+    return glfwWindowShouldClose(_windowHandle);
+}
+
+void Application::recordHeadlessFrameTime(f64 currentTime, f64 frameTime)
+{
+    HeadlessContext *headless = _headlessContext;
+    if (_frameIndex == 1)
+    {
+        headless->measureStartTime = currentTime;
+        headless->minFrameTime = DBL_MAX;
+        headless->maxFrameTime = 0.0;
+    }
+    else if (_frameIndex > 1)
+    {
+        headless->measureEndTime = currentTime;
+        headless->measuredFrames++;
+        headless->minFrameTime = std::min(headless->minFrameTime, frameTime);
+        headless->maxFrameTime = std::max(headless->maxFrameTime, frameTime);
+    }
+}
+
+void Application::reportHeadlessFrameTimes()
+{
+    HeadlessContext *headless = _headlessContext;
+    if (headless->measuredFrames == 0)
+    {
+        spdlog::info("Application: Rendered {} frames headless", _frameIndex);
+        return;
+    }
+
+    f64 totalTime = headless->measureEndTime - headless->measureStartTime;
+    spdlog::info("Application: Rendered {} frames headless, {:.3f} ms/frame over the last {} (min {:.3f}, max {:.3f})",
+                 _frameIndex, totalTime * 1000.0 / headless->measuredFrames, headless->measuredFrames,
+                 headless->minFrameTime * 1000.0, headless->maxFrameTime * 1000.0);
 }
 
 bool Application::keyIsPressed(s32 key)
 {
+    if (_headless)
+    {
+        return false;
+    }
+
     return glfwGetKey(_windowHandle, key) == GLFW_PRESS;
 }
 
+f64 Application::getTime()
+{
+    if (!_headless)
+    {
+        return glfwGetTime();
+    }
+
+    static std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    return std::chrono::duration<f64>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+#ifdef FRAMEWORK_HEADLESS_EGL
+
+static EGLDisplay getHeadlessDisplay()
+{
+    // Prefer a display that doesn't need a window system at all, then fall back to whatever the default one is
+    PFNEGLGETPLATFORMDISPLAYEXTPROC eglGetPlatformDisplayEXT =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (eglGetPlatformDisplayEXT != NULL)
+    {
+        EGLDisplay display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        if (display != EGL_NO_DISPLAY)
+        {
+            return display;
+        }
+    }
+
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+bool Application::initializeHeadless()
+{
+    EGLDisplay display = getHeadlessDisplay();
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL))
+    {
+        spdlog::error("EGL: Unable to initialize a display");
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        spdlog::error("EGL: Desktop OpenGL is not supported");
+        eglTerminate(display);
+        return false;
+    }
+
+    // Nothing is ever drawn to an EGL surface, and the default surface type filter would ask for a window
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, 0,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE,
+    };
+
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+    {
+        spdlog::error("EGL: No OpenGL config available");
+        eglTerminate(display);
+        return false;
+    }
+
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE,
+    };
+
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT)
+    {
+        spdlog::error("EGL: Unable to create an OpenGL 3.3 core context");
+        eglTerminate(display);
+        return false;
+    }
+
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        spdlog::error("EGL: Surfaceless contexts are not supported");
+        eglDestroyContext(display, context);
+        eglTerminate(display);
+        return false;
+    }
+
+    _headlessContext = new HeadlessContext();
+    _headlessContext->display = display;
+    _headlessContext->context = context;
+
+    gladLoadGLLoader((GLADloadproc)eglGetProcAddress);
+
+    HeadlessContext *headless = _headlessContext;
+
+    glGenRenderbuffers(1, &headless->colorRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, headless->colorRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, (GLsizei)_windowWidth, (GLsizei)_windowHeight);
+
+    glGenRenderbuffers(1, &headless->depthRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, headless->depthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, (GLsizei)_windowWidth, (GLsizei)_windowHeight);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &headless->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, headless->framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, headless->colorRenderbuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER,
+                              headless->depthRenderbuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        spdlog::error("OpenGL: Offscreen framebuffer is incomplete");
+        unloadHeadless();
+        return false;
+    }
+
+    // The framebuffer stays bound for the lifetime of the app, it is what everything renders into
+    glViewport(0, 0, (GLsizei)_windowWidth, (GLsizei)_windowHeight);
+
+    spdlog::info("EGL: Rendering headless at {}x{} on {}", _windowWidth, _windowHeight,
+                 (const char *)glGetString(GL_RENDERER));
+
+    return true;
+}
+
+void Application::unloadHeadless()
+{
+    HeadlessContext *headless = _headlessContext;
+    if (headless == NULL)
+    {
+        return;
+    }
+
+    if (headless->frameFence != NULL)
+    {
+        glDeleteSync(headless->frameFence);
+    }
+
+    glDeleteFramebuffers(1, &headless->framebuffer);
+    glDeleteRenderbuffers(1, &headless->colorRenderbuffer);
+    glDeleteRenderbuffers(1, &headless->depthRenderbuffer);
+
+    eglMakeCurrent(headless->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(headless->display, headless->context);
+    eglTerminate(headless->display);
+
+    delete headless;
+    _headlessContext = NULL;
+}
+
+#else
+
+bool Application::initializeHeadless()
+{
+    spdlog::error("Application: This build has no headless support, EGL was not found");
+    return false;
+}
+
+void Application::unloadHeadless() {}
+
+#endif
+
 bool Application::initialize()
 {
+#ifndef NDEBUG
+    spdlog::set_level(spdlog::level::debug);
+#endif
+
+    if (_headless)
+    {
+        if (!initializeHeadless())
+        {
+            return false;
+        }
+
+        TracyGpuContext;
+        TracyGpuContextName("Headless", 8);
+
+        ImGui::CreateContext();
+        afterCreatedUIContext();
+        ImGui_ImplOpenGL3_Init();
+        ImGui::StyleColorsDark();
+
+        // Without a platform backend nobody else fills these in
+        ImGuiIO &io = ImGui::GetIO();
+        io.DisplaySize = ImVec2((f32)_windowWidth, (f32)_windowHeight);
+        io.DisplayFramebufferScale = ImVec2(1.0F, 1.0F);
+        io.IniFilename = NULL;
+
+        return true;
+    }
+
     if (!glfwInit())
     {
         spdlog::error("Glfw: Unable to initialize");
@@ -97,16 +435,14 @@ bool Application::initialize()
     glfwMakeContextCurrent(_windowHandle);
     gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
 
+    TracyGpuContext;
+
     ImGui::CreateContext();
     afterCreatedUIContext();
     ImGui_ImplGlfw_InitForOpenGL(_windowHandle, true);
     ImGui_ImplOpenGL3_Init();
     ImGui::StyleColorsDark();
 
-#ifndef NDEBUG
-    spdlog::set_level(spdlog::level::debug);
-#endif
-
     return true;
 }
 
@@ -203,7 +539,10 @@ bool Application::load()
     glEnable(GL_DEPTH_TEST);
     glDepthFunc(GL_LEQUAL);
 
-    glfwSwapInterval(1);
+    if (!_headless)
+    {
+        glfwSwapInterval(1);
+    }
 
     return true;
 }
@@ -211,11 +550,21 @@ bool Application::load()
 void Application::unload()
 {
     ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
+    if (!_headless)
+    {
+        ImGui_ImplGlfw_Shutdown();
+    }
     beforeDestroyUIContext();
     ImGui::DestroyContext();
 
-    glfwTerminate();
+    if (_headless)
+    {
+        unloadHeadless();
+    }
+    else
+    {
+        glfwTerminate();
+    }
 }
 
 void Application::render(f32 frameTime)
@@ -223,17 +572,55 @@ void Application::render(f32 frameTime)
     ZoneScopedC(tracy::Color::Red2);
 
     renderScene(frameTime);
+
+    // Replays are captured without the debug UI on top
+    if (_frameCapture != NULL)
+    {
+        TracyGpuZone("Capture Readback");
+        _frameCapture->captureFrame();
+    }
+
     ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
+    if (_headless)
+    {
+        ImGui::GetIO().DeltaTime = frameTime;
+    }
+    else
+    {
+        ImGui_ImplGlfw_NewFrame();
+    }
     ImGui::NewFrame();
     {
         renderUI(frameTime);
         ImGui::Render();
+
+        TracyGpuZone("ImGui");
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
         ImGui::EndFrame();
     }
 
-    glfwSwapBuffers(_windowHandle);
+    // Everything of the frame has been submitted, only presenting it is left
+    afterRender(frameTime);
+
+    if (!_headless)
+    {
+        glfwSwapBuffers(_windowHandle);
+
+        FrameMark;
+        TracyGpuCollect;
+        return;
+    }
+
+    HeadlessContext *headless = _headlessContext;
+    if (headless->frameFence != NULL)
+    {
+        glClientWaitSync(headless->frameFence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(headless->frameFence);
+    }
+    headless->frameFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    FrameMark;
+    TracyGpuCollect;
 }
 
 void Application::renderScene(f32 frameTime)
@@ -246,6 +633,11 @@ void Application::renderUI(f32 frameTime)
     (void)frameTime;
 }
 
+void Application::afterRender(f32 frameTime)
+{
+    (void)frameTime;
+}
+
 void Application::update(f32 frameTime)
 {
     (void)frameTime;
@@ -0,0 +1,404 @@
+#include <Framework/FrameCapture.hpp>
+
+// clang-format off
+#include <spdlog/spdlog.h>
+#include <glad/glad.h>
+// clang-format on
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+// The pattern is handed to snprintf with the frame number, so it may contain exactly one integer conversion
+static bool isFramePattern(const char *path)
+{
+    u32 conversions = 0;
+    for (const char *c = path; *c != '\0'; c++)
+    {
+        if (*c != '%')
+        {
+            continue;
+        }
+
+        c++;
+        if (*c == '%')
+        {
+            continue;
+        }
+
+        while (*c >= '0' && *c <= '9')
+        {
+            c++;
+        }
+
+        if (*c != 'u' && *c != 'd')
+        {
+            return false;
+        }
+
+        conversions++;
+    }
+
+    return conversions == 1;
+}
+
+static f64 captureTime()
+{
+    return std::chrono::duration<f64>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+FrameCapture::FrameCapture()
+{
+    width_ = 0;
+    height_ = 0;
+    frameSize_ = 0;
+    format_ = CAPTURE_FORMAT_PPM_SEQUENCE;
+    path_[0] = '\0';
+    dropWhenBehind_ = false;
+
+    for (u32 bufferIndex = 0; bufferIndex < CAPTURE_PIXEL_BUFFER_COUNT; bufferIndex++)
+    {
+        pixelBuffers_[bufferIndex] = 0;
+        fences_[bufferIndex] = NULL;
+        frameIndices_[bufferIndex] = 0;
+    }
+    pendingCount_ = 0;
+    nextBuffer_ = 0;
+
+    for (u32 frameIndex = 0; frameIndex < CAPTURE_FRAME_POOL_SIZE; frameIndex++)
+    {
+        framePool_[frameIndex] = NULL;
+        freeFrames_[frameIndex] = NULL;
+    }
+    freeFrameCount_ = 0;
+
+    queueHead_ = 0;
+    queueCount_ = 0;
+    finishing_ = false;
+
+    videoFile_ = NULL;
+    encodeBuffer_ = NULL;
+
+    framesRead_ = 0;
+    framesWritten_ = 0;
+    framesDropped_ = 0;
+    writeFailed_ = false;
+    startTime_ = 0.0;
+}
+
+bool FrameCapture::begin(const char *path, u32 width, u32 height, bool dropWhenBehind)
+{
+    size_t pathLength = strlen(path);
+    if (pathLength >= sizeof(path_))
+    {
+        spdlog::error("Capture: Path \"{}\" is too long", path);
+        return false;
+    }
+
+    memcpy(path_, path, pathLength + 1);
+
+    if (pathLength >= 4 && strcmp(path + pathLength - 4, ".y4m") == 0)
+    {
+        format_ = CAPTURE_FORMAT_Y4M;
+    }
+    else if (isFramePattern(path))
+    {
+        format_ = CAPTURE_FORMAT_PPM_SEQUENCE;
+    }
+    else
+    {
+        spdlog::error("Capture: \"{}\" must end in .y4m or contain a frame number pattern like %05u", path);
+        return false;
+    }
+
+    width_ = width;
+    height_ = height;
+    frameSize_ = (size_t)width * height * 4;
+    dropWhenBehind_ = dropWhenBehind;
+
+    bool allocated = true;
+    for (u32 frameIndex = 0; frameIndex < CAPTURE_FRAME_POOL_SIZE; frameIndex++)
+    {
+        framePool_[frameIndex] = (u8 *)malloc(frameSize_);
+        freeFrames_[frameIndex] = framePool_[frameIndex];
+        allocated = allocated && framePool_[frameIndex] != NULL;
+    }
+    freeFrameCount_ = CAPTURE_FRAME_POOL_SIZE;
+
+    // Big enough for one frame of packed RGB or three full resolution planes
+    encodeBuffer_ = (u8 *)malloc((size_t)width * height * 3);
+    if (!allocated || encodeBuffer_ == NULL)
+    {
+        spdlog::error("Capture: Unable to allocate the frame pool for {}x{} frames", width_, height_);
+        freeFrames();
+        return false;
+    }
+
+    if (format_ == CAPTURE_FORMAT_Y4M)
+    {
+        videoFile_ = fopen(path_, "wb");
+        if (videoFile_ == NULL)
+        {
+            spdlog::error("Capture: Could not open \"{}\" for writing", path_);
+            freeFrames();
+            return false;
+        }
+
+        fprintf(videoFile_, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C444\n", width_, height_, CAPTURE_FRAME_RATE);
+    }
+
+    glGenBuffers(CAPTURE_PIXEL_BUFFER_COUNT, pixelBuffers_);
+    for (u32 bufferIndex = 0; bufferIndex < CAPTURE_PIXEL_BUFFER_COUNT; bufferIndex++)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers_[bufferIndex]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)frameSize_, NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    startTime_ = captureTime();
+    worker_ = std::thread(&FrameCapture::work, this);
+
+    spdlog::info("Capture: Writing {}x{} frames to \"{}\"", width_, height_, path_);
+
+    return true;
+}
+
+void FrameCapture::captureFrame()
+{
+    // Only blocks if the GPU is more than a whole ring behind, the map itself is always of a finished transfer
+    if (pendingCount_ == CAPTURE_PIXEL_BUFFER_COUNT)
+    {
+        readOldestPending(true);
+    }
+
+    u32 bufferIndex = nextBuffer_;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers_[bufferIndex]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, (GLsizei)width_, (GLsizei)height_, GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid *)0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    fences_[bufferIndex] = (void *)glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frameIndices_[bufferIndex] = framesRead_ + pendingCount_;
+
+    nextBuffer_ = (nextBuffer_ + 1) % CAPTURE_PIXEL_BUFFER_COUNT;
+    pendingCount_++;
+
+    // Drain anything that has already landed so frames reach the encoder as early as possible
+    while (pendingCount_ > 1 && readOldestPending(false))
+    {
+    }
+}
+
+bool FrameCapture::readOldestPending(bool wait)
+{
+    u32 bufferIndex = (nextBuffer_ + CAPTURE_PIXEL_BUFFER_COUNT - pendingCount_) % CAPTURE_PIXEL_BUFFER_COUNT;
+    GLsync fence = (GLsync)fences_[bufferIndex];
+
+    GLenum waitResult = glClientWaitSync(fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? GL_TIMEOUT_IGNORED : 0);
+    if (waitResult == GL_TIMEOUT_EXPIRED)
+    {
+        return false;
+    }
+
+    glDeleteSync(fence);
+    fences_[bufferIndex] = NULL;
+    pendingCount_--;
+    framesRead_++;
+
+    u8 *pixels = NULL;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (freeFrameCount_ == 0 && dropWhenBehind_)
+        {
+            framesDropped_++;
+            return true;
+        }
+
+        frameFreed_.wait(lock, [this] { return freeFrameCount_ > 0; });
+        pixels = freeFrames_[--freeFrameCount_];
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers_[bufferIndex]);
+    const void *mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)frameSize_, GL_MAP_READ_BIT);
+    if (mapped != NULL)
+    {
+        memcpy(pixels, mapped, frameSize_);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (mapped == NULL)
+        {
+            freeFrames_[freeFrameCount_++] = pixels;
+            framesDropped_++;
+            return true;
+        }
+
+        CaptureFrame *frame = &queue_[(queueHead_ + queueCount_) % CAPTURE_FRAME_POOL_SIZE];
+        frame->pixels = pixels;
+        frame->index = frameIndices_[bufferIndex];
+        queueCount_++;
+    }
+    frameQueued_.notify_one();
+
+    return true;
+}
+
+void FrameCapture::work()
+{
+    for (;;)
+    {
+        CaptureFrame frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            frameQueued_.wait(lock, [this] { return queueCount_ > 0 || finishing_; });
+            if (queueCount_ == 0)
+            {
+                return;
+            }
+
+            frame = queue_[queueHead_];
+            queueHead_ = (queueHead_ + 1) % CAPTURE_FRAME_POOL_SIZE;
+            queueCount_--;
+        }
+
+        bool written = !writeFailed_ && encode(&frame);
+        if (!written && !writeFailed_)
+        {
+            spdlog::error("Capture: Failed writing frame {}, stopping capture", frame.index);
+            writeFailed_ = true;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            freeFrames_[freeFrameCount_++] = frame.pixels;
+            framesWritten_ += written ? 1 : 0;
+        }
+        frameFreed_.notify_one();
+    }
+}
+
+void FrameCapture::end()
+{
+    if (encodeBuffer_ == NULL)
+    {
+        return;
+    }
+
+    while (pendingCount_ > 0)
+    {
+        readOldestPending(true);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finishing_ = true;
+    }
+    frameQueued_.notify_one();
+    worker_.join();
+
+    f64 elapsed = captureTime() - startTime_;
+
+    if (videoFile_ != NULL)
+    {
+        fclose(videoFile_);
+        videoFile_ = NULL;
+    }
+
+    glDeleteBuffers(CAPTURE_PIXEL_BUFFER_COUNT, pixelBuffers_);
+
+    freeFrames();
+
+    spdlog::info("Capture: {} frames written to \"{}\" in {:.2f} s, {:.1f} fps ({} dropped)", framesWritten_, path_,
+                 elapsed, elapsed > 0.0 ? framesWritten_ / elapsed : 0.0, framesDropped_);
+}
+
+void FrameCapture::freeFrames()
+{
+    for (u32 frameIndex = 0; frameIndex < CAPTURE_FRAME_POOL_SIZE; frameIndex++)
+    {
+        free(framePool_[frameIndex]);
+        framePool_[frameIndex] = NULL;
+        freeFrames_[frameIndex] = NULL;
+    }
+    freeFrameCount_ = 0;
+
+    free(encodeBuffer_);
+    encodeBuffer_ = NULL;
+}
+
+bool FrameCapture::encode(const CaptureFrame *frame)
+{
+    switch (format_)
+    {
+        case CAPTURE_FORMAT_PPM_SEQUENCE:
+            return writePPM(frame);
+        case CAPTURE_FORMAT_Y4M:
+            return writeY4M(frame);
+        default:
+            return false;
+    }
+}
+
+bool FrameCapture::writePPM(const CaptureFrame *frame)
+{
+    char filepath[CAPTURE_MAX_PATH + 16];
+    snprintf(filepath, sizeof(filepath), path_, frame->index);
+
+    FILE *file = fopen(filepath, "wb");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    // PPM is stored top row first
+    u8 *out = encodeBuffer_;
+    for (u32 y = 0; y < height_; y++)
+    {
+        const u8 *row = frame->pixels + (size_t)(height_ - 1 - y) * width_ * 4;
+        for (u32 x = 0; x < width_; x++)
+        {
+            *out++ = row[x * 4 + 0];
+            *out++ = row[x * 4 + 1];
+            *out++ = row[x * 4 + 2];
+        }
+    }
+
+    size_t size = (size_t)width_ * height_ * 3;
+    bool success = fprintf(file, "P6\n%u %u\n255\n", width_, height_) > 0;
+    success = success && fwrite(encodeBuffer_, 1, size, file) == size;
+
+    return fclose(file) == 0 && success;
+}
+
+bool FrameCapture::writeY4M(const CaptureFrame *frame)
+{
+    size_t planeSize = (size_t)width_ * height_;
+    u8 *yPlane = encodeBuffer_;
+    u8 *uPlane = yPlane + planeSize;
+    u8 *vPlane = uPlane + planeSize;
+
+    // BT.601 limited range, which is what players assume when the header doesn't say otherwise
+    size_t outIndex = 0;
+    for (u32 y = 0; y < height_; y++)
+    {
+        const u8 *row = frame->pixels + (size_t)(height_ - 1 - y) * width_ * 4;
+        for (u32 x = 0; x < width_; x++, outIndex++)
+        {
+            s32 r = row[x * 4 + 0];
+            s32 g = row[x * 4 + 1];
+            s32 b = row[x * 4 + 2];
+
+            yPlane[outIndex] = (u8)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+            uPlane[outIndex] = (u8)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            vPlane[outIndex] = (u8)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+
+    // Frames arrive in order, there is a single worker and readback is FIFO
+    return fputs("FRAME\n", videoFile_) >= 0 && fwrite(encodeBuffer_, 1, planeSize * 3, videoFile_) == planeSize * 3;
+}
@@ -14,16 +14,36 @@
 
 struct GLFWwindow;
 
+struct ApplicationOptions
+{
+    // Render into an offscreen framebuffer through an EGL surfaceless context instead of opening a window
+    bool headless = false;
+
+    // Frames to render before exiting, 0 runs until closed. Headless runs step the simulation by a fixed 1/60 s per
+    // frame so their output does not depend on how fast the machine renders.
+    u32 frameCount = 0;
+
+    u32 width = 1920;
+    u32 height = 1080;
+
+    // Rendered frames are written here when set, see FrameCapture for the accepted formats
+    const char *capturePath = NULL;
+};
+
+struct HeadlessContext;
+class FrameCapture;
+
 class Application
 {
 public:
-    void run();
+    void run(const ApplicationOptions &options = ApplicationOptions());
 
 protected:
     void close();
     bool keyIsPressed(s32 key);
 
     f64 getDeltaTime();
+    f64 getTime();
 
     virtual void afterCreatedUIContext();
     virtual void beforeDestroyUIContext();
@@ -32,12 +52,26 @@ protected:
     virtual void unload();
     virtual void renderScene(f32 frameTime);
     virtual void renderUI(f32 frameTime);
+    virtual void afterRender(f32 frameTime);
     virtual void update(f32 frameTime);
 
     GLFWwindow *_windowHandle;
     u32 _windowWidth = 1920;
     u32 _windowHeight = 1080;
 
+    bool _headless = false;
+    u32 _frameCount = 0;
+    u32 _frameIndex = 0;
+
 private:
+    HeadlessContext *_headlessContext = NULL;
+    FrameCapture *_frameCapture = NULL;
+    bool _closeRequested = false;
+
+    bool initializeHeadless();
+    void unloadHeadless();
+    bool shouldClose();
+    void recordHeadlessFrameTime(f64 currentTime, f64 frameTime);
+    void reportHeadlessFrameTimes();
     void render(f32 frameTime);
 };
\ No newline at end of file
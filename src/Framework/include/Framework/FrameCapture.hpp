@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Types.hpp"
+
+#include <stdio.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Frames in flight between glReadPixels and the CPU mapping them. Three keeps the GPU a full frame ahead of the map.
+#define CAPTURE_PIXEL_BUFFER_COUNT 3
+
+// Frames that can sit in the encoder queue at once
+#define CAPTURE_FRAME_POOL_SIZE 8
+
+#define CAPTURE_MAX_PATH 512
+
+// Written into video headers. Headless runs step the simulation at exactly this rate, windowed runs are vsynced to it
+// on most displays.
+#define CAPTURE_FRAME_RATE 60
+
+enum CaptureFormat
+{
+    CAPTURE_FORMAT_PPM_SEQUENCE,  // One binary PPM per frame, path is a printf pattern like "shot_%05u.ppm"
+    CAPTURE_FORMAT_Y4M,           // Single uncompressed YUV4MPEG2 (4:4:4) file that ffmpeg and most players open
+
+    CAPTURE_FORMAT_COUNT,
+};
+
+struct CaptureFrame
+{
+    u8 *pixels;  // RGBA, bottom row first, the way GL hands it back
+    u32 index;
+};
+
+// Reads frames back through a ring of pixel buffer objects and encodes them on a worker thread, so neither the GPU
+// nor the encoder ever holds up the frame that is being rendered
+class FrameCapture
+{
+public:
+    FrameCapture();
+
+    bool begin(const char *path, u32 width, u32 height, bool dropWhenBehind);
+    void captureFrame();
+    void end();
+
+private:
+    u32 width_;
+    u32 height_;
+    size_t frameSize_;
+    CaptureFormat format_;
+    char path_[CAPTURE_MAX_PATH];
+    bool dropWhenBehind_;
+
+    u32 pixelBuffers_[CAPTURE_PIXEL_BUFFER_COUNT];
+    void *fences_[CAPTURE_PIXEL_BUFFER_COUNT];
+    u32 frameIndices_[CAPTURE_PIXEL_BUFFER_COUNT];
+    u32 pendingCount_;
+    u32 nextBuffer_;
+
+    u8 *framePool_[CAPTURE_FRAME_POOL_SIZE];
+    u8 *freeFrames_[CAPTURE_FRAME_POOL_SIZE];
+    u32 freeFrameCount_;
+
+    CaptureFrame queue_[CAPTURE_FRAME_POOL_SIZE];
+    u32 queueHead_;
+    u32 queueCount_;
+    bool finishing_;
+
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable frameQueued_;
+    std::condition_variable frameFreed_;
+
+    FILE *videoFile_;
+    u8 *encodeBuffer_;
+
+    u32 framesRead_;
+    u32 framesWritten_;
+    u32 framesDropped_;
+    bool writeFailed_;
+    f64 startTime_;
+
+    bool readOldestPending(bool wait);
+    void work();
+    bool encode(const CaptureFrame *frame);
+    bool writePPM(const CaptureFrame *frame);
+    bool writeY4M(const CaptureFrame *frame);
+    void freeFrames();
+};
@@ -0,0 +1,427 @@
+static CheckpointConfig checkpointConfig = {NULL, CHECKPOINT_DEFAULT_INTERVAL};
+
+CheckpointConfig *getCheckpointConfig()
+{
+    return &checkpointConfig;
+}
+
+static f64 getCheckpointTime()
+{
+    return std::chrono::duration<f64>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static u64 hashBytes(u64 hash, const void *data, size_t size)
+{
+    // FNV-1a
+    const u8 *bytes = (const u8 *)data;
+    for (size_t byteIndex = 0; byteIndex < size; byteIndex++)
+    {
+        hash = (hash ^ bytes[byteIndex]) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+// Size and modification time, both 0 when there is no such file
+static void getFileStamp(const char *filepath, u64 outStamp[2])
+{
+    outStamp[0] = 0;
+    outStamp[1] = 0;
+
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (GetFileAttributesExA(filepath, GetFileExInfoStandard, &attributes))
+    {
+        outStamp[0] = ((u64)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+        outStamp[1] = ((u64)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+    }
+#else
+    struct stat status;
+    if (stat(filepath, &status) == 0)
+    {
+        outStamp[0] = (u64)status.st_size;
+        outStamp[1] = (u64)status.st_mtime;
+    }
+#endif
+}
+
+u64 hashCheckpointSource(u64 key, const char *filepath, const glm::mat4 *transform)
+{
+    u64 hash = key != 0 ? key : 0xCBF29CE484222325ULL;
+    hash = hashBytes(hash, filepath, strlen(filepath));
+
+    u64 stamp[2];
+    getFileStamp(filepath, stamp);
+    hash = hashBytes(hash, stamp, sizeof(stamp));
+
+    char cookedFilepath[512];
+    if (cookedAssetPath(cookedFilepath, sizeof(cookedFilepath), filepath, COOKED_MESH_EXTENSION))
+    {
+        getFileStamp(cookedFilepath, stamp);
+        hash = hashBytes(hash, stamp, sizeof(stamp));
+    }
+
+    return hashBytes(hash, transform, sizeof(glm::mat4));
+}
+
+static u64 alignCheckpointOffset(u64 offset)
+{
+    return (offset + (CHECKPOINT_ALIGNMENT - 1)) & ~(u64)(CHECKPOINT_ALIGNMENT - 1);
+}
+
+// Sections are written in order instead of seeking, geometry can be bigger than fseek's long offsets reach
+static bool writeCheckpointSection(FILE *file, u64 *offset, u64 sectionOffset, const void *data, size_t size)
+{
+    static const u8 padding[CHECKPOINT_ALIGNMENT] = {};
+
+    size_t paddingSize = (size_t)(sectionOffset - *offset);
+    if (paddingSize > 0 && fwrite(padding, 1, paddingSize, file) != paddingSize)
+    {
+        return false;
+    }
+
+    if (size > 0 && fwrite(data, 1, size, file) != size)
+    {
+        return false;
+    }
+
+    *offset = sectionOffset + size;
+    return true;
+}
+
+static bool sectionFits(const MappedFile *file, u64 offset, u64 count, size_t size)
+{
+    return offset % CHECKPOINT_ALIGNMENT == 0 && offset <= file->size && count <= (file->size - offset) / size;
+}
+
+// The restored geometry is used as is, so every triangle has to name vertices of the checkpoint and every block lane
+// a triangle of it
+static bool geometryIndicesValid(const CheckpointHeader *header, const u8 *data)
+{
+    const Triangle *triangles = (const Triangle *)(data + header->triangleDataOffset);
+    for (u64 triangleIndex = 0; triangleIndex < header->triangleCount; triangleIndex++)
+    {
+        const Triangle *triangle = &triangles[triangleIndex];
+        if (triangle->a >= header->vertexCount || triangle->b >= header->vertexCount ||
+            triangle->c >= header->vertexCount)
+        {
+            return false;
+        }
+    }
+
+    const CollisionBlock *blocks = (const CollisionBlock *)(data + header->blockDataOffset);
+    for (u64 blockIndex = 0; blockIndex < header->blockCount; blockIndex++)
+    {
+        for (u32 lane = 0; lane < COLLISION_BLOCK_WIDTH; lane++)
+        {
+            if (blocks[blockIndex].triangleIndices[lane] >= header->triangleCount)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// A launch queue out of range would have the range launch whatever lies past it
+static bool launchQueuesValid(const CheckpointHeader *header, const u8 *data)
+{
+    const Bay *bays = (const Bay *)(data + header->bayDataOffset);
+    for (u64 bayIndex = 0; bayIndex < header->bayCount; bayIndex++)
+    {
+        if (bays[bayIndex].queueHead >= BAY_LAUNCH_QUEUE_SIZE || bays[bayIndex].queueCount > BAY_LAUNCH_QUEUE_SIZE)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Checkpoint::initialize(const CheckpointConfig *checkpointConfig)
+{
+    config = *checkpointConfig;
+    geometryKey = 0;
+    simulatedTime = 0.0;
+    sinceLastWrite = 0.0F;
+    writePending = false;
+    quitting = false;
+
+    if (snprintf(tempPath, sizeof(tempPath), "%s.tmp", config.path) >= (s32)sizeof(tempPath))
+    {
+        spdlog::warn("Checkpoint: \"{}\" is too long a path, checkpoints won't be written", config.path);
+        tempPath[0] = '\0';
+        return;
+    }
+
+    writer = std::thread(&Checkpoint::work, this);
+}
+
+bool Checkpoint::restore(World *world, CollisionGeometry *geometry, u64 sourceGeometryKey)
+{
+    ZoneScoped;
+
+    geometryKey = sourceGeometryKey;
+
+    MappedFile file;
+    if (!file.open(config.path))
+    {
+        spdlog::info("Checkpoint: No checkpoint at \"{}\", starting a new session", config.path);
+        return false;
+    }
+
+    const CheckpointHeader *header = (const CheckpointHeader *)file.data;
+
+    bool valid = file.size >= sizeof(CheckpointHeader) && header->magic == CHECKPOINT_MAGIC &&
+                 header->version == CHECKPOINT_VERSION && header->fileSize == file.size &&
+                 header->ballSize == sizeof(Ball) && header->baySize == sizeof(Bay) &&
+                 header->vertexSize == sizeof(Vtx) && header->triangleSize == sizeof(Triangle) &&
+                 header->blockSize == sizeof(CollisionBlock) && header->ballCount <= MAX_BALLS &&
+                 header->bayCount >= 1 && header->bayCount <= MAX_BAYS && header->vertexCount <= MAX_VERTICES &&
+                 header->triangleCount <= MAX_COLLIDABLE_TRIANGLES &&
+                 header->blockCount == getCollisionBlockCount(header->triangleCount) &&
+                 sectionFits(&file, header->ballDataOffset, header->ballCount, sizeof(Ball)) &&
+                 sectionFits(&file, header->bayDataOffset, header->bayCount, sizeof(Bay)) &&
+                 sectionFits(&file, header->vertexDataOffset, header->vertexCount, sizeof(Vtx)) &&
+                 sectionFits(&file, header->triangleDataOffset, header->triangleCount, sizeof(Triangle)) &&
+                 sectionFits(&file, header->blockDataOffset, header->blockCount, sizeof(CollisionBlock)) &&
+                 geometryIndicesValid(header, file.data) && launchQueuesValid(header, file.data);
+    if (!valid)
+    {
+        spdlog::warn("Checkpoint: Ignoring stale or corrupt checkpoint \"{}\"", config.path);
+        file.close();
+        return false;
+    }
+
+    if (header->geometryKey != geometryKey)
+    {
+        spdlog::warn("Checkpoint: \"{}\" was taken with other collision meshes, starting a new session", config.path);
+        file.close();
+        return false;
+    }
+
+    size_t blockDataSize = std::max(header->blockCount, (u64)1) * sizeof(CollisionBlock);
+    CollisionBlock *blocks = (CollisionBlock *)malloc(blockDataSize);
+    if (blocks == NULL)
+    {
+        spdlog::error("Checkpoint: Failed to allocate {} collision blocks", header->blockCount);
+        file.close();
+        return false;
+    }
+    trackAllocation(MEMORY_TAG_COLLISION, blocks, blockDataSize);
+
+    memcpy(geometry->vertices, file.data + header->vertexDataOffset, header->vertexCount * sizeof(Vtx));
+    memcpy(geometry->triangles, file.data + header->triangleDataOffset, header->triangleCount * sizeof(Triangle));
+    memcpy(blocks, file.data + header->blockDataOffset, header->blockCount * sizeof(CollisionBlock));
+    geometry->vertexCount = header->vertexCount;
+    geometry->triangleCount = header->triangleCount;
+    geometry->blocks = blocks;
+    geometry->blockCount = header->blockCount;
+
+    BallManager *ballManager = &world->ballManager;
+    ballManager->activeBalls = header->ballCount;
+    if (header->ballCount > 0)
+    {
+        memcpy(ballManager->getBall(0), file.data + header->ballDataOffset, header->ballCount * sizeof(Ball));
+    }
+
+    // Flight plans aren't saved, the restored balls are given new ones
+    for (size_t ballIndex = 0; ballIndex < ballManager->activeBalls; ballIndex++)
+    {
+        ballManager->getBall(ballIndex)->plan = 0;
+    }
+
+    DrivingRange *range = world->range;
+    if (header->bayCount != range->bayCount)
+    {
+        spdlog::warn("Checkpoint: Restoring {} bays in place of the {} asked for", header->bayCount, range->bayCount);
+    }
+    range->bayCount = header->bayCount;
+    memcpy(range->bays, file.data + header->bayDataOffset, header->bayCount * sizeof(Bay));
+    range->partition(ballManager);
+
+    world->wind.speed = header->windSpeed;
+    world->wind.direction = header->windDirection;
+    world->wind.logWind = header->logWind != 0;
+    simulatedTime = header->simulatedTime;
+
+    spdlog::info("Checkpoint: Restored {} balls and {} triangles from {:.1f} s into the session", header->ballCount,
+                 header->triangleCount, simulatedTime);
+
+    file.close();
+    return true;
+}
+
+void Checkpoint::update(World *world, const CollisionGeometry *geometry, f32 dt)
+{
+    simulatedTime += dt;
+    sinceLastWrite += dt;
+    if (sinceLastWrite < config.interval || tempPath[0] == '\0')
+    {
+        return;
+    }
+    sinceLastWrite = 0.0F;
+
+    // A disk slower than the interval loses checkpoints rather than stalling the sim
+    std::unique_lock<std::mutex> lock(mutex);
+    if (writePending)
+    {
+        stats.skippedWrites++;
+        return;
+    }
+
+    f64 startTime = getCheckpointTime();
+    takeSnapshot(world, geometry);
+    stats.lastSnapshotTime = getCheckpointTime() - startTime;
+
+    writePending = true;
+    lock.unlock();
+    writeRequested.notify_one();
+}
+
+void Checkpoint::close(World *world, const CollisionGeometry *geometry)
+{
+    if (tempPath[0] == '\0')
+    {
+        return;
+    }
+
+    // The writer finishes the checkpoint it has before it stops
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quitting = true;
+    }
+    writeRequested.notify_one();
+    writer.join();
+
+    takeSnapshot(world, geometry);
+    writeSnapshot();
+}
+
+void Checkpoint::takeSnapshot(World *world, const CollisionGeometry *geometry)
+{
+    ZoneScoped;
+
+    const DrivingRange *range = world->range;
+    BallManager *ballManager = &world->ballManager;
+
+    CheckpointHeader *header = &snapshotHeader;
+    bzero(header, sizeof(CheckpointHeader));
+    header->magic = CHECKPOINT_MAGIC;
+    header->version = CHECKPOINT_VERSION;
+    header->ballSize = sizeof(Ball);
+    header->baySize = sizeof(Bay);
+    header->vertexSize = sizeof(Vtx);
+    header->triangleSize = sizeof(Triangle);
+    header->blockSize = sizeof(CollisionBlock);
+    header->geometryKey = geometryKey;
+    header->simulatedTime = simulatedTime;
+    header->windSpeed = world->wind.speed;
+    header->windDirection = world->wind.direction;
+    header->logWind = world->wind.logWind ? 1 : 0;
+    header->ballCount = (u32)ballManager->activeBalls;
+    header->bayCount = range->bayCount;
+    header->vertexCount = geometry->vertexCount;
+    header->triangleCount = geometry->triangleCount;
+    header->blockCount = geometry->blockCount;
+
+    header->ballDataOffset = alignCheckpointOffset(sizeof(CheckpointHeader));
+    header->bayDataOffset = alignCheckpointOffset(header->ballDataOffset + header->ballCount * sizeof(Ball));
+    header->vertexDataOffset = alignCheckpointOffset(header->bayDataOffset + header->bayCount * sizeof(Bay));
+    header->triangleDataOffset = alignCheckpointOffset(header->vertexDataOffset + header->vertexCount * sizeof(Vtx));
+    header->blockDataOffset =
+        alignCheckpointOffset(header->triangleDataOffset + header->triangleCount * sizeof(Triangle));
+    header->fileSize = header->blockDataOffset + header->blockCount * sizeof(CollisionBlock);
+
+    if (header->ballCount > 0)
+    {
+        memcpy(snapshotBalls, ballManager->getBall(0), header->ballCount * sizeof(Ball));
+    }
+    memcpy(snapshotBays, range->bays, header->bayCount * sizeof(Bay));
+    snapshotGeometry = geometry;
+}
+
+bool Checkpoint::writeSnapshot()
+{
+    ZoneScoped;
+
+    f64 startTime = getCheckpointTime();
+
+    const CheckpointHeader *header = &snapshotHeader;
+    const CollisionGeometry *geometry = snapshotGeometry;
+
+    FILE *file = fopen(tempPath, "wb");
+    if (file == NULL)
+    {
+        spdlog::error("Checkpoint: Could not open \"{}\" for writing", tempPath);
+        stats.failedWrites++;
+        return false;
+    }
+
+    u64 offset = 0;
+    bool success =
+        writeCheckpointSection(file, &offset, 0, header, sizeof(CheckpointHeader)) &&
+        writeCheckpointSection(file, &offset, header->ballDataOffset, snapshotBalls,
+                               header->ballCount * sizeof(Ball)) &&
+        writeCheckpointSection(file, &offset, header->bayDataOffset, snapshotBays, header->bayCount * sizeof(Bay)) &&
+        writeCheckpointSection(file, &offset, header->vertexDataOffset, geometry->vertices,
+                               header->vertexCount * sizeof(Vtx)) &&
+        writeCheckpointSection(file, &offset, header->triangleDataOffset, geometry->triangles,
+                               header->triangleCount * sizeof(Triangle)) &&
+        writeCheckpointSection(file, &offset, header->blockDataOffset, geometry->blocks,
+                               header->blockCount * sizeof(CollisionBlock));
+
+    // The rename below must not reach the disk before the data does
+    success = success && fflush(file) == 0;
+#ifndef _WIN32
+    success = success && fsync(fileno(file)) == 0;
+#endif
+    success = fclose(file) == 0 && success;
+
+#ifdef _WIN32
+    success = success && MoveFileExA(tempPath, config.path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    success = success && rename(tempPath, config.path) == 0;
+#endif
+
+    if (!success)
+    {
+        spdlog::error("Checkpoint: Failed writing \"{}\"", config.path);
+        remove(tempPath);
+        stats.failedWrites++;
+        return false;
+    }
+
+    stats.lastWriteTime = getCheckpointTime() - startTime;
+    stats.lastWriteSize = header->fileSize;
+    stats.writes++;
+
+    return true;
+}
+
+void Checkpoint::work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        writeRequested.wait(lock, [this] { return writePending || quitting; });
+        if (!writePending)
+        {
+            return;
+        }
+
+        // The snapshot is left alone while a write is pending, so it is written without holding the lock
+        lock.unlock();
+        writeSnapshot();
+        lock.lock();
+
+        writePending = false;
+    }
+}
+
+void Checkpoint::logReport() const
+{
+    spdlog::info("Checkpoint: {} written to \"{}\", {} failed, {} skipped, the last {:.1f} MiB in {:.2f} ms",
+                 stats.writes.load(), config.path, stats.failedWrites.load(), stats.skippedWrites,
+                 (f64)stats.lastWriteSize.load() / (1024.0 * 1024.0), stats.lastWriteTime.load() * 1000.0);
+}
@@ -0,0 +1,115 @@
+#define CHECKPOINT_MAGIC 0x4B434347  // "GCCK"
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_ALIGNMENT 64
+
+#define CHECKPOINT_DEFAULT_INTERVAL 10.0F  // Seconds of simulated time
+
+// Everything is written as it is in memory, so a checkpoint is only restored by a build with the same layouts. Only
+// the balls and triangles in use are written, not the whole of the fixed size arrays they live in.
+struct CheckpointHeader
+{
+    u32 magic;
+    u32 version;
+
+    u32 ballSize;
+    u32 baySize;
+    u32 vertexSize;
+    u32 triangleSize;
+    u32 blockSize;
+    u32 reserved;
+
+    u64 geometryKey;  // Which meshes the collision geometry was loaded from, see hashCheckpointSource
+    f64 simulatedTime;
+
+    f32 windSpeed;
+    f32 windDirection;
+    u32 logWind;
+    u32 ballCount;
+    u32 bayCount;
+    u32 padding;
+
+    u64 vertexCount;
+    u64 triangleCount;
+    u64 blockCount;
+
+    u64 ballDataOffset;      // Ball[ballCount]
+    u64 bayDataOffset;       // Bay[bayCount]
+    u64 vertexDataOffset;    // Vtx[vertexCount]
+    u64 triangleDataOffset;  // Triangle[triangleCount]
+    u64 blockDataOffset;     // CollisionBlock[blockCount]
+    u64 fileSize;            // Written last, a checkpoint cut short by a crash is shorter than this
+};
+
+struct CheckpointConfig
+{
+    const char *path;  // NULL when the session isn't checkpointed
+    f32 interval;      // Seconds of simulated time between checkpoints
+};
+
+struct CheckpointStats
+{
+    // Written by the writer thread
+    std::atomic<u32> writes;
+    std::atomic<u32> failedWrites;
+    std::atomic<f64> lastWriteTime;  // Seconds spent writing the last one
+    std::atomic<u64> lastWriteSize;
+
+    // Sim thread
+    u32 skippedWrites;  // Checkpoints that came due while the last one was still being written
+    f64 lastSnapshotTime;  // Seconds the last checkpoint stalled the step it was taken after
+};
+
+// Saves the session to a file every so often and when the app exits, and brings it back on the next start. The
+// collision geometry goes in already packed into blocks, so a restart maps the file and copies it back instead of
+// parsing and packing the meshes again.
+//
+// The sim thread only copies the balls and bays aside, a background thread writes them out along with the geometry,
+// which doesn't change after loading. Checkpoints are written next to the last one and renamed over it, so a crash
+// while writing leaves the previous one in place.
+struct Checkpoint
+{
+    CheckpointStats stats;
+
+    void initialize(const CheckpointConfig *checkpointConfig);
+
+    // Restores the world and the collision geometry, false when there is no checkpoint of the same geometry. The
+    // geometry's blocks are allocated like a cold load allocates them.
+    bool restore(World *world, CollisionGeometry *geometry, u64 geometryKey);
+
+    // Hands a checkpoint to the writer once the interval has passed since the last one
+    void update(World *world, const CollisionGeometry *geometry, f32 dt);
+
+    // Stops the writer and writes a last checkpoint on the calling thread
+    void close(World *world, const CollisionGeometry *geometry);
+
+    void logReport() const;
+
+private:
+    CheckpointConfig config;
+    char tempPath[512];
+    u64 geometryKey;
+    f64 simulatedTime;  // Carried over from the checkpoint restored
+    f32 sinceLastWrite;
+
+    // Taken by the sim thread, written by the writer
+    CheckpointHeader snapshotHeader;
+    const CollisionGeometry *snapshotGeometry;
+    Bay snapshotBays[MAX_BAYS];
+    Ball snapshotBalls[MAX_BALLS];
+
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable writeRequested;
+    bool writePending;
+    bool quitting;
+
+    void takeSnapshot(World *world, const CollisionGeometry *geometry);
+    bool writeSnapshot();
+    void work();
+};
+
+// Folds a collidable mesh into a geometry key: its path, the size and modification time of the file and its cooked
+// version, and where it is placed. Rebuilding or moving either file makes old checkpoints stale.
+u64 hashCheckpointSource(u64 key, const char *filepath, const glm::mat4 *transform);
+
+CheckpointConfig *getCheckpointConfig();
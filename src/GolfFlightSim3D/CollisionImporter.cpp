@@ -0,0 +1,401 @@
+// Start of an accessor's elements when they can be read in place, NULL when only cgltf can convert them
+static const u8 *getAccessorData(const cgltf_accessor *accessor)
+{
+    if (accessor->is_sparse || accessor->buffer_view == NULL)
+    {
+        return NULL;
+    }
+
+    const u8 *data = (const u8 *)cgltf_buffer_view_data(accessor->buffer_view);
+    return data != NULL ? data + accessor->offset : NULL;
+}
+
+static const u8 *getFloat3Data(const cgltf_accessor *accessor)
+{
+    if (accessor->component_type != cgltf_component_type_r_32f || accessor->type != cgltf_type_vec3 ||
+        accessor->normalized)
+    {
+        return NULL;
+    }
+
+    return getAccessorData(accessor);
+}
+
+static glm::vec3 readFloat3(const cgltf_accessor *accessor, const u8 *data, size_t index)
+{
+    if (data != NULL)
+    {
+        const f32 *source = (const f32 *)(data + index * accessor->stride);
+        return glm::vec3(source[0], source[1], source[2]);
+    }
+
+    glm::vec3 result(0.0F);
+    cgltf_accessor_read_float(accessor, index, glm::value_ptr(result), 3);
+    return result;
+}
+
+static u32 readIndex(const cgltf_accessor *accessor, const u8 *data, size_t index)
+{
+    if (data != NULL)
+    {
+        const u8 *source = data + index * accessor->stride;
+        switch (accessor->component_type)
+        {
+            case cgltf_component_type_r_8u:
+                return *source;
+            case cgltf_component_type_r_16u:
+                return *(const u16 *)source;
+            case cgltf_component_type_r_32u:
+                return *(const u32 *)source;
+            default:
+                break;
+        }
+    }
+
+    return (u32)cgltf_accessor_read_index(accessor, index);
+}
+
+void CollisionImporter::addPrimitive(const cgltf_primitive *primitive, const glm::mat4 &transform)
+{
+    if (primitive->type != cgltf_primitive_type_triangles)
+    {
+        spdlog::debug("Skipping non-triangle primitive for collision");
+        return;
+    }
+
+    const cgltf_accessor *positions = NULL;
+    const cgltf_accessor *normals = NULL;
+
+    for (size_t attributeIndex = 0; attributeIndex < primitive->attributes_count; attributeIndex++)
+    {
+        const cgltf_attribute *attribute = &primitive->attributes[attributeIndex];
+        if (attribute->type == cgltf_attribute_type_position)
+        {
+            positions = attribute->data;
+        }
+        else if (attribute->type == cgltf_attribute_type_normal)
+        {
+            normals = attribute->data;
+        }
+    }
+
+    if (positions == NULL)
+    {
+        spdlog::warn("Skipping primitive without positions for collision");
+        return;
+    }
+
+    CollisionImportPrimitive *result = &primitives[primitiveCount++];
+    result->positions = positions;
+    result->normals = normals;
+    result->indices = primitive->indices;
+    result->transform = transform;
+    result->normalTransform = glm::transpose(glm::inverse(glm::mat3(transform)));
+    result->vertexCount = positions->count;
+    result->triangleCount = (primitive->indices != NULL ? primitive->indices->count : positions->count) / 3;
+}
+
+void CollisionImporter::importVertices(CollisionImportJob *job)
+{
+    const CollisionImportPrimitive *primitive = &primitives[job->primitiveIndex];
+
+    const u8 *positionData = getFloat3Data(primitive->positions);
+    const u8 *normalData = primitive->normals != NULL ? getFloat3Data(primitive->normals) : NULL;
+
+    for (size_t vertexIndex = job->first; vertexIndex < job->first + job->count; vertexIndex++)
+    {
+        glm::vec3 position = readFloat3(primitive->positions, positionData, vertexIndex);
+        glm::vec3 normal = primitive->normals != NULL ? readFloat3(primitive->normals, normalData, vertexIndex)
+                                                      : glm::vec3(0.0F, 1.0F, 0.0F);
+
+        normal = primitive->normalTransform * normal;
+        if (glm::dot(normal, normal) > 0.0F)
+        {
+            normal = glm::normalize(normal);
+        }
+
+        glm::vec4 worldPosition = primitive->transform * glm::vec4(position, 1.0F);
+
+        Vtx *vertex = &geometry->vertices[primitive->baseVertex + vertexIndex];
+        vertex->position = glm::vec3(worldPosition.x, worldPosition.y, worldPosition.z);
+        vertex->normal = normal;
+    }
+}
+
+void CollisionImporter::importTriangles(CollisionImportJob *job)
+{
+    const CollisionImportPrimitive *primitive = &primitives[job->primitiveIndex];
+
+    const u8 *indexData = primitive->indices != NULL ? getAccessorData(primitive->indices) : NULL;
+    const Vtx *vertices = &geometry->vertices[primitive->baseVertex];
+    Triangle *output = &geometry->triangles[primitive->baseTriangle + job->first];
+
+    size_t kept = 0;
+    for (size_t triangleIndex = job->first; triangleIndex < job->first + job->count; triangleIndex++)
+    {
+        u32 corners[3];
+        bool valid = true;
+        for (u32 corner = 0; corner < 3; corner++)
+        {
+            size_t index = triangleIndex * 3 + corner;
+            corners[corner] = primitive->indices != NULL ? readIndex(primitive->indices, indexData, index) : (u32)index;
+            valid = valid && corners[corner] < primitive->vertexCount;
+        }
+
+        if (!valid)
+        {
+            continue;
+        }
+
+        const Vtx *v0 = &vertices[corners[0]];
+        const Vtx *v1 = &vertices[corners[1]];
+        const Vtx *v2 = &vertices[corners[2]];
+
+        // A triangle without area has no plane, and a zero normal would collide with everything
+        glm::vec3 normal = glm::cross(v1->position - v0->position, v2->position - v0->position);
+        if (glm::dot(normal, normal) <= FLT_MIN)
+        {
+            continue;
+        }
+
+        // Keep the face on the side the authored vertex normals point to, whatever the winding
+        normal = glm::normalize(normal);
+        if (glm::dot(normal, v0->normal + v1->normal + v2->normal) < 0.0F)
+        {
+            normal = -normal;
+        }
+
+        Triangle *triangle = &output[kept++];
+        triangle->normal = normal;
+        triangle->d = glm::dot(normal, v0->position);
+        triangle->a = (u32)(primitive->baseVertex + corners[0]);
+        triangle->b = (u32)(primitive->baseVertex + corners[1]);
+        triangle->c = (u32)(primitive->baseVertex + corners[2]);
+    }
+
+    job->keptTriangles = kept;
+}
+
+void CollisionImporter::work()
+{
+    for (;;)
+    {
+        size_t jobIndex = nextJob.fetch_add(1);
+        if (jobIndex >= phaseEnd)
+        {
+            return;
+        }
+
+        if (importingTriangles)
+        {
+            importTriangles(&jobs[jobIndex]);
+        }
+        else
+        {
+            importVertices(&jobs[jobIndex]);
+        }
+    }
+}
+
+void CollisionImporter::runPhase(size_t firstJob, size_t lastJob, bool triangles)
+{
+    if (firstJob == lastJob)
+    {
+        return;
+    }
+
+    nextJob = firstJob;
+    phaseEnd = lastJob;
+    importingTriangles = triangles;
+
+    size_t threadCount = glm::clamp((size_t)std::thread::hardware_concurrency(), (size_t)1,
+                                    std::min(lastJob - firstJob, (size_t)COLLISION_IMPORT_MAX_WORKERS));
+
+    // The calling thread takes jobs too
+    std::thread workers[COLLISION_IMPORT_MAX_WORKERS];
+    for (size_t workerIndex = 1; workerIndex < threadCount; workerIndex++)
+    {
+        workers[workerIndex] = std::thread(&CollisionImporter::work, this);
+    }
+
+    work();
+
+    for (size_t workerIndex = 1; workerIndex < threadCount; workerIndex++)
+    {
+        workers[workerIndex].join();
+    }
+
+    workerCount = std::max(workerCount, (u32)threadCount);
+}
+
+bool CollisionImporter::import(const cgltf_data *gltfData,
+                               const char *filepath,
+                               const glm::mat4 &rootTransform,
+                               CollisionGeometry *collisionGeometry)
+{
+    ZoneScoped;
+
+    geometry = collisionGeometry;
+    workerCount = 0;
+    primitiveCount = 0;
+    droppedTriangles = 0;
+
+    // Scenes are walked the same way the AssetCooker walks them, so cooked and uncooked files collide alike: every
+    // mesh node in its world transform, or every mesh as is when no node places one. The root transform then places
+    // the whole scene.
+    bool anyNodeMeshes = false;
+    size_t maxPrimitives = 0;
+    for (size_t nodeIndex = 0; nodeIndex < gltfData->nodes_count; nodeIndex++)
+    {
+        if (gltfData->nodes[nodeIndex].mesh != NULL)
+        {
+            anyNodeMeshes = true;
+            maxPrimitives += gltfData->nodes[nodeIndex].mesh->primitives_count;
+        }
+    }
+    if (!anyNodeMeshes)
+    {
+        for (size_t meshIndex = 0; meshIndex < gltfData->meshes_count; meshIndex++)
+        {
+            maxPrimitives += gltfData->meshes[meshIndex].primitives_count;
+        }
+    }
+
+    if (maxPrimitives == 0)
+    {
+        spdlog::warn("\"{}\" has no meshes to collide with", filepath);
+        return false;
+    }
+
+    primitives = (CollisionImportPrimitive *)assetMalloc(maxPrimitives * sizeof(CollisionImportPrimitive));
+    if (primitives == NULL)
+    {
+        spdlog::error("Unable to allocate the collision import of \"{}\"", filepath);
+        return false;
+    }
+
+    if (anyNodeMeshes)
+    {
+        for (size_t nodeIndex = 0; nodeIndex < gltfData->nodes_count; nodeIndex++)
+        {
+            const cgltf_node *node = &gltfData->nodes[nodeIndex];
+            if (node->mesh == NULL)
+            {
+                continue;
+            }
+
+            glm::mat4 transform;
+            cgltf_node_transform_world(node, glm::value_ptr(transform));
+
+            for (size_t primitiveIndex = 0; primitiveIndex < node->mesh->primitives_count; primitiveIndex++)
+            {
+                addPrimitive(&node->mesh->primitives[primitiveIndex], rootTransform * transform);
+            }
+        }
+    }
+    else
+    {
+        for (size_t meshIndex = 0; meshIndex < gltfData->meshes_count; meshIndex++)
+        {
+            const cgltf_mesh *mesh = &gltfData->meshes[meshIndex];
+            for (size_t primitiveIndex = 0; primitiveIndex < mesh->primitives_count; primitiveIndex++)
+            {
+                addPrimitive(&mesh->primitives[primitiveIndex], rootTransform);
+            }
+        }
+    }
+
+    // Lay the primitives out back to back in the collision buffers, so every job knows where to write up front
+    size_t vertexCount = 0;
+    size_t triangleCount = 0;
+    size_t vertexJobCount = 0;
+    jobCount = 0;
+    for (size_t primitiveIndex = 0; primitiveIndex < primitiveCount; primitiveIndex++)
+    {
+        CollisionImportPrimitive *primitive = &primitives[primitiveIndex];
+        primitive->baseVertex = geometry->vertexCount + vertexCount;
+        primitive->baseTriangle = geometry->triangleCount + triangleCount;
+
+        vertexCount += primitive->vertexCount;
+        triangleCount += primitive->triangleCount;
+
+        size_t vertexJobs = (primitive->vertexCount + COLLISION_IMPORT_JOB_SIZE - 1) / COLLISION_IMPORT_JOB_SIZE;
+        size_t triangleJobs = (primitive->triangleCount + COLLISION_IMPORT_JOB_SIZE - 1) / COLLISION_IMPORT_JOB_SIZE;
+        vertexJobCount += vertexJobs;
+        jobCount += vertexJobs + triangleJobs;
+    }
+
+    if (geometry->vertexCount + vertexCount > MAX_VERTICES ||
+        geometry->triangleCount + triangleCount > MAX_COLLIDABLE_TRIANGLES)
+    {
+        spdlog::error("Collision geometry of \"{}\" does not fit in the collision buffers", filepath);
+        assetFree(primitives);
+        return false;
+    }
+
+    jobs = (CollisionImportJob *)assetMalloc(std::max(jobCount, (size_t)1) * sizeof(CollisionImportJob));
+    if (jobs == NULL)
+    {
+        spdlog::error("Unable to allocate the collision import of \"{}\"", filepath);
+        assetFree(primitives);
+        return false;
+    }
+
+    // Every vertex job comes before every triangle job, triangles need their vertices in world space
+    size_t vertexJobIndex = 0;
+    size_t triangleJobIndex = vertexJobCount;
+    for (size_t primitiveIndex = 0; primitiveIndex < primitiveCount; primitiveIndex++)
+    {
+        CollisionImportPrimitive *primitive = &primitives[primitiveIndex];
+
+        for (size_t first = 0; first < primitive->vertexCount; first += COLLISION_IMPORT_JOB_SIZE)
+        {
+            CollisionImportJob *job = &jobs[vertexJobIndex++];
+            job->primitiveIndex = primitiveIndex;
+            job->first = first;
+            job->count = std::min((size_t)COLLISION_IMPORT_JOB_SIZE, primitive->vertexCount - first);
+            job->keptTriangles = 0;
+        }
+
+        for (size_t first = 0; first < primitive->triangleCount; first += COLLISION_IMPORT_JOB_SIZE)
+        {
+            CollisionImportJob *job = &jobs[triangleJobIndex++];
+            job->primitiveIndex = primitiveIndex;
+            job->first = first;
+            job->count = std::min((size_t)COLLISION_IMPORT_JOB_SIZE, primitive->triangleCount - first);
+            job->keptTriangles = 0;
+        }
+    }
+
+    runPhase(0, vertexJobCount, false);
+    runPhase(vertexJobCount, jobCount, true);
+
+    // Close the gaps the dropped triangles left, jobs only ever move down so this is safe in order
+    size_t keptTriangles = geometry->triangleCount;
+    for (size_t jobIndex = vertexJobCount; jobIndex < jobCount; jobIndex++)
+    {
+        const CollisionImportJob *job = &jobs[jobIndex];
+        size_t source = primitives[job->primitiveIndex].baseTriangle + job->first;
+        if (source != keptTriangles)
+        {
+            memmove(&geometry->triangles[keptTriangles], &geometry->triangles[source],
+                    job->keptTriangles * sizeof(Triangle));
+        }
+        keptTriangles += job->keptTriangles;
+    }
+
+    droppedTriangles = geometry->triangleCount + triangleCount - keptTriangles;
+    if (droppedTriangles > 0)
+    {
+        spdlog::info("Collision: Dropped {} triangles of \"{}\" without area or with invalid indices", droppedTriangles,
+                     filepath);
+    }
+
+    geometry->vertexCount += vertexCount;
+    geometry->triangleCount = keptTriangles;
+
+    assetFree(jobs);
+    assetFree(primitives);
+
+    return true;
+}
@@ -0,0 +1,63 @@
+// Vertices or triangles per job, enough work to make taking a job free and few enough that workers finish together
+#define COLLISION_IMPORT_JOB_SIZE 16384
+#define COLLISION_IMPORT_MAX_WORKERS 32
+
+// One triangle primitive of the scene, placed in the world by its node
+struct CollisionImportPrimitive
+{
+    const cgltf_accessor *positions;
+    const cgltf_accessor *normals;  // NULL when the primitive has none
+    const cgltf_accessor *indices;  // NULL for non-indexed primitives
+
+    glm::mat4 transform;
+    glm::mat3 normalTransform;
+
+    size_t vertexCount;
+    size_t triangleCount;
+
+    // First slots of the primitive in the collision buffers
+    size_t baseVertex;
+    size_t baseTriangle;
+};
+
+// A range of the vertices or of the triangles of one primitive
+struct CollisionImportJob
+{
+    size_t primitiveIndex;
+    size_t first;
+    size_t count;
+
+    // Triangles without area are dropped, so each job's output is compacted once every job is done
+    size_t keptTriangles;
+};
+
+// Builds collision geometry from every triangle primitive of a glTF scene. Vertices are transformed into world space
+// first, then each triangle gets its face normal and plane constant. Both passes are split across threads.
+struct CollisionImporter
+{
+    u32 workerCount;
+    size_t primitiveCount;
+    size_t droppedTriangles;
+
+    bool import(const cgltf_data *gltfData,
+                const char *filepath,
+                const glm::mat4 &rootTransform,
+                CollisionGeometry *collisionGeometry);
+
+private:
+    CollisionGeometry *geometry;
+
+    CollisionImportPrimitive *primitives;
+    CollisionImportJob *jobs;
+    size_t jobCount;
+
+    std::atomic<size_t> nextJob;
+    size_t phaseEnd;
+    bool importingTriangles;
+
+    void addPrimitive(const cgltf_primitive *primitive, const glm::mat4 &transform);
+    void runPhase(size_t firstJob, size_t lastJob, bool triangles);
+    void work();
+    void importVertices(CollisionImportJob *job);
+    void importTriangles(CollisionImportJob *job);
+};
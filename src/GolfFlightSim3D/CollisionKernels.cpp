@@ -0,0 +1,556 @@
+// The kernels only use adds, multiplies, divides and compares in the same order, and the build never contracts them
+// into fused multiply-adds, so which one runs can't change where a ball lands.
+#if defined(_MSC_VER)
+#define COLLISION_TARGET_SSE2
+#define COLLISION_TARGET_AVX2
+#else
+#define COLLISION_TARGET_SSE2 __attribute__((target("sse2")))
+#define COLLISION_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+static const char *collisionKernelNames[COLLISION_KERNEL_COUNT] = {"scalar", "sse2", "avx2"};
+
+void packCollisionBlocks(const u8 *positions,
+                         size_t positionStride,
+                         const Triangle *triangles,
+                         size_t triangleCount,
+                         CollisionBlock *outBlocks)
+{
+    ZoneScoped;
+
+    size_t blockCount = getCollisionBlockCount(triangleCount);
+    for (size_t blockIndex = 0; blockIndex < blockCount; blockIndex++)
+    {
+        CollisionBlock *block = &outBlocks[blockIndex];
+
+        for (u32 lane = 0; lane < COLLISION_BLOCK_WIDTH; lane++)
+        {
+            size_t triangleIndex = blockIndex * COLLISION_BLOCK_WIDTH + lane;
+            if (triangleIndex >= triangleCount)
+            {
+                // Bounds that contain nothing keep the padding out of every test
+                block->normalX[lane] = 0.0F;
+                block->normalY[lane] = 0.0F;
+                block->normalZ[lane] = 0.0F;
+                block->d[lane] = 0.0F;
+                for (u32 edge = 0; edge < 3; edge++)
+                {
+                    block->edgeNormalX[edge][lane] = 0.0F;
+                    block->edgeNormalY[edge][lane] = 0.0F;
+                    block->edgeNormalZ[edge][lane] = 0.0F;
+                    block->edgeD[edge][lane] = 0.0F;
+                }
+                block->boundsMinX[lane] = FLT_MAX;
+                block->boundsMinY[lane] = FLT_MAX;
+                block->boundsMinZ[lane] = FLT_MAX;
+                block->boundsMaxX[lane] = -FLT_MAX;
+                block->boundsMaxY[lane] = -FLT_MAX;
+                block->boundsMaxZ[lane] = -FLT_MAX;
+                block->triangleIndices[lane] = 0;
+                continue;
+            }
+
+            const Triangle *triangle = &triangles[triangleIndex];
+            glm::vec3 corners[3] = {
+                *(const glm::vec3 *)(positions + triangle->a * positionStride),
+                *(const glm::vec3 *)(positions + triangle->b * positionStride),
+                *(const glm::vec3 *)(positions + triangle->c * positionStride),
+            };
+
+            block->normalX[lane] = triangle->normal.x;
+            block->normalY[lane] = triangle->normal.y;
+            block->normalZ[lane] = triangle->normal.z;
+            block->d[lane] = triangle->d;
+
+            for (u32 edge = 0; edge < 3; edge++)
+            {
+                const glm::vec3 &start = corners[edge];
+                const glm::vec3 &end = corners[(edge + 1) % 3];
+                const glm::vec3 &opposite = corners[(edge + 2) % 3];
+
+                glm::vec3 edgeNormal = glm::cross(triangle->normal, end - start);
+                f32 length = glm::length(edgeNormal);
+                if (length > 0.0F)
+                {
+                    edgeNormal /= length;
+                }
+
+                // Triangle normals follow the surface rather than the winding, so face the plane by the third corner
+                if (glm::dot(edgeNormal, opposite - start) < 0.0F)
+                {
+                    edgeNormal = -edgeNormal;
+                }
+
+                block->edgeNormalX[edge][lane] = edgeNormal.x;
+                block->edgeNormalY[edge][lane] = edgeNormal.y;
+                block->edgeNormalZ[edge][lane] = edgeNormal.z;
+                block->edgeD[edge][lane] = glm::dot(edgeNormal, start);
+            }
+
+            glm::vec3 boundsMin = glm::min(glm::min(corners[0], corners[1]), corners[2]);
+            glm::vec3 boundsMax = glm::max(glm::max(corners[0], corners[1]), corners[2]);
+            block->boundsMinX[lane] = boundsMin.x;
+            block->boundsMinY[lane] = boundsMin.y;
+            block->boundsMinZ[lane] = boundsMin.z;
+            block->boundsMaxX[lane] = boundsMax.x;
+            block->boundsMaxY[lane] = boundsMax.y;
+            block->boundsMaxZ[lane] = boundsMax.z;
+            block->triangleIndices[lane] = (u32)triangleIndex;
+        }
+    }
+}
+
+void setupCollisionSweep(CollisionSweep *sweep, const glm::vec3 &position, const glm::vec3 &velocity, f32 dt)
+{
+    glm::vec3 end = position + velocity * dt;
+    glm::vec3 boundsMin = glm::min(position, end) - glm::vec3(BALL_RADIUS);
+    glm::vec3 boundsMax = glm::max(position, end) + glm::vec3(BALL_RADIUS);
+
+    for (u32 axis = 0; axis < 3; axis++)
+    {
+        sweep->position[axis] = position[axis];
+        sweep->velocity[axis] = velocity[axis];
+        sweep->boundsMin[axis] = boundsMin[axis];
+        sweep->boundsMax[axis] = boundsMax[axis];
+    }
+    sweep->dt = dt;
+}
+
+bool sweepTriangleEdges(const CollisionSweep *sweep, const glm::vec3 corners[3], f32 *outTime, glm::vec3 &outContact)
+{
+    glm::vec3 position(sweep->position[0], sweep->position[1], sweep->position[2]);
+    glm::vec3 velocity(sweep->velocity[0], sweep->velocity[1], sweep->velocity[2]);
+    const f32 radiusSquared = BALL_RADIUS * BALL_RADIUS;
+
+    // Already touching an edge or a corner
+    for (u32 edgeIndex = 0; edgeIndex < 3; edgeIndex++)
+    {
+        const glm::vec3 &start = corners[edgeIndex];
+        glm::vec3 edge = corners[(edgeIndex + 1) % 3] - start;
+
+        f32 along = glm::clamp(glm::dot(position - start, edge) / glm::dot(edge, edge), 0.0F, 1.0F);
+        glm::vec3 closest = start + along * edge;
+        if (glm::length2(position - closest) <= radiusSquared)
+        {
+            *outTime = 0.0F;
+            outContact = closest;
+            return true;
+        }
+    }
+
+    bool found = false;
+    f32 velocityLengthSquared = glm::dot(velocity, velocity);
+
+    for (u32 edgeIndex = 0; edgeIndex < 3; edgeIndex++)
+    {
+        const glm::vec3 &start = corners[edgeIndex];
+        glm::vec3 edge = corners[(edgeIndex + 1) % 3] - start;
+        glm::vec3 offset = position - start;
+
+        // The corner at the start of the edge, as a sphere of the ball's radius
+        f32 b = glm::dot(offset, velocity);
+        f32 c = glm::dot(offset, offset) - radiusSquared;
+        f32 discriminant = b * b - velocityLengthSquared * c;
+        if (velocityLengthSquared > 0.0F && discriminant >= 0.0F)
+        {
+            f32 time = (-b - sqrtf(discriminant)) / velocityLengthSquared;
+            if (time >= 0.0F && time <= sweep->dt && (!found || time < *outTime))
+            {
+                *outTime = time;
+                outContact = start;
+                found = true;
+            }
+        }
+
+        // The edge itself, as a cylinder of the ball's radius cut off at the corners
+        f32 edgeLengthSquared = glm::dot(edge, edge);
+        f32 offsetAlong = glm::dot(offset, edge);
+        f32 velocityAlong = glm::dot(velocity, edge);
+
+        f32 a = edgeLengthSquared * velocityLengthSquared - velocityAlong * velocityAlong;
+        b = edgeLengthSquared * glm::dot(offset, velocity) - velocityAlong * offsetAlong;
+        c = edgeLengthSquared * (glm::dot(offset, offset) - radiusSquared) - offsetAlong * offsetAlong;
+        discriminant = b * b - a * c;
+        if (a <= 0.0F || discriminant < 0.0F)
+        {
+            // Moving along the edge or passing it by, only its corners are left
+            continue;
+        }
+
+        f32 time = (-b - sqrtf(discriminant)) / a;
+        f32 along = (offsetAlong + time * velocityAlong) / edgeLengthSquared;
+        if (time >= 0.0F && time <= sweep->dt && along >= 0.0F && along <= 1.0F && (!found || time < *outTime))
+        {
+            *outTime = time;
+            outContact = start + along * edge;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+static void collisionKernelScalar(const CollisionBlock *block, const CollisionSweep *sweep, CollisionLanes *lanes)
+{
+    const f32 *p = sweep->position;
+    const f32 *v = sweep->velocity;
+
+    lanes->height = -FLT_MAX;
+    lanes->faceMask = 0;
+    lanes->edgeMask = 0;
+
+    for (u32 lane = 0; lane < COLLISION_BLOCK_WIDTH; lane++)
+    {
+        bool overlapsBounds = sweep->boundsMin[0] <= block->boundsMaxX[lane] &&
+                              sweep->boundsMax[0] >= block->boundsMinX[lane] &&
+                              sweep->boundsMin[1] <= block->boundsMaxY[lane] &&
+                              sweep->boundsMax[1] >= block->boundsMinY[lane] &&
+                              sweep->boundsMin[2] <= block->boundsMaxZ[lane] &&
+                              sweep->boundsMax[2] >= block->boundsMinZ[lane];
+        bool underBall = p[0] >= block->boundsMinX[lane] && p[0] <= block->boundsMaxX[lane] &&
+                         p[2] >= block->boundsMinZ[lane] && p[2] <= block->boundsMaxZ[lane];
+        if (!overlapsBounds && !underBall)
+        {
+            continue;
+        }
+
+        f32 nx = block->normalX[lane];
+        f32 ny = block->normalY[lane];
+        f32 nz = block->normalZ[lane];
+
+        f32 distance = nx * p[0] + ny * p[1] + nz * p[2] - block->d[lane];
+        if (underBall)
+        {
+            lanes->height = std::max(lanes->height, distance);
+        }
+
+        f32 denom = nx * v[0] + ny * v[1] + nz * v[2];
+
+        bool overlapping = fabsf(distance) <= BALL_RADIUS;
+        f32 r = distance > 0.0F ? BALL_RADIUS : -BALL_RADIUS;
+        f32 time = overlapping ? 0.0F : (r - distance) / denom;
+        bool reaches = overlapping || (denom * distance < 0.0F && time <= sweep->dt);
+        if (!overlapsBounds || !reaches)
+        {
+            continue;
+        }
+
+        // Where the sphere meets the plane, or the point of the plane under its center when it already overlaps
+        f32 offset = overlapping ? distance : r;
+        f32 cx = p[0] + time * v[0] - offset * nx;
+        f32 cy = p[1] + time * v[1] - offset * ny;
+        f32 cz = p[2] + time * v[2] - offset * nz;
+
+        bool inside = true;
+        for (u32 edge = 0; edge < 3; edge++)
+        {
+            f32 edgeDistance = block->edgeNormalX[edge][lane] * cx + block->edgeNormalY[edge][lane] * cy +
+                               block->edgeNormalZ[edge][lane] * cz - block->edgeD[edge][lane];
+            inside = inside && edgeDistance >= -COLLISION_INSIDE_EPSILON;
+        }
+
+        lanes->times[lane] = time;
+        if (inside)
+        {
+            lanes->faceMask |= 1U << lane;
+        }
+        else
+        {
+            lanes->edgeMask |= 1U << lane;
+        }
+    }
+}
+
+#if defined(COLLISION_KERNELS_X86)
+// Four lanes at a time, SSE2 is there on every x86-64 CPU
+COLLISION_TARGET_SSE2
+static void collisionKernelSSE2(const CollisionBlock *block, const CollisionSweep *sweep, CollisionLanes *lanes)
+{
+    const __m128 px = _mm_set1_ps(sweep->position[0]);
+    const __m128 py = _mm_set1_ps(sweep->position[1]);
+    const __m128 pz = _mm_set1_ps(sweep->position[2]);
+    const __m128 signBit = _mm_set1_ps(-0.0F);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 noHeight = _mm_set1_ps(-FLT_MAX);
+
+    __m128 height = noHeight;
+    lanes->faceMask = 0;
+    lanes->edgeMask = 0;
+
+    for (u32 first = 0; first < COLLISION_BLOCK_WIDTH; first += 4)
+    {
+        // Most triangles are nowhere near the ball, which the bounds alone tell
+        __m128 minX = _mm_loadu_ps(&block->boundsMinX[first]);
+        __m128 minZ = _mm_loadu_ps(&block->boundsMinZ[first]);
+        __m128 maxX = _mm_loadu_ps(&block->boundsMaxX[first]);
+        __m128 maxZ = _mm_loadu_ps(&block->boundsMaxZ[first]);
+
+        __m128 overlapsBounds = _mm_and_ps(
+            _mm_and_ps(_mm_cmple_ps(_mm_set1_ps(sweep->boundsMin[0]), maxX),
+                       _mm_cmpge_ps(_mm_set1_ps(sweep->boundsMax[0]), minX)),
+            _mm_and_ps(_mm_and_ps(_mm_cmple_ps(_mm_set1_ps(sweep->boundsMin[1]),
+                                               _mm_loadu_ps(&block->boundsMaxY[first])),
+                                  _mm_cmpge_ps(_mm_set1_ps(sweep->boundsMax[1]),
+                                               _mm_loadu_ps(&block->boundsMinY[first]))),
+                       _mm_and_ps(_mm_cmple_ps(_mm_set1_ps(sweep->boundsMin[2]), maxZ),
+                                  _mm_cmpge_ps(_mm_set1_ps(sweep->boundsMax[2]), minZ))));
+        __m128 underBall = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(px, minX), _mm_cmple_ps(px, maxX)),
+                                      _mm_and_ps(_mm_cmpge_ps(pz, minZ), _mm_cmple_ps(pz, maxZ)));
+        if (_mm_movemask_ps(_mm_or_ps(overlapsBounds, underBall)) == 0)
+        {
+            continue;
+        }
+
+        __m128 nx = _mm_loadu_ps(&block->normalX[first]);
+        __m128 ny = _mm_loadu_ps(&block->normalY[first]);
+        __m128 nz = _mm_loadu_ps(&block->normalZ[first]);
+
+        __m128 distance = _mm_sub_ps(
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, px), _mm_mul_ps(ny, py)), _mm_mul_ps(nz, pz)),
+            _mm_loadu_ps(&block->d[first]));
+        height = _mm_max_ps(height, _mm_or_ps(_mm_and_ps(underBall, distance), _mm_andnot_ps(underBall, noHeight)));
+
+        const __m128 vx = _mm_set1_ps(sweep->velocity[0]);
+        const __m128 vy = _mm_set1_ps(sweep->velocity[1]);
+        const __m128 vz = _mm_set1_ps(sweep->velocity[2]);
+        const __m128 radius = _mm_set1_ps(BALL_RADIUS);
+        const __m128 negativeRadius = _mm_set1_ps(-BALL_RADIUS);
+        const __m128 insideEpsilon = _mm_set1_ps(-COLLISION_INSIDE_EPSILON);
+
+        __m128 denom = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, vx), _mm_mul_ps(ny, vy)), _mm_mul_ps(nz, vz));
+
+        __m128 overlapping = _mm_cmple_ps(_mm_andnot_ps(signBit, distance), radius);
+        __m128 above = _mm_cmpgt_ps(distance, zero);
+        __m128 r = _mm_or_ps(_mm_and_ps(above, radius), _mm_andnot_ps(above, negativeRadius));
+        __m128 time = _mm_andnot_ps(overlapping, _mm_div_ps(_mm_sub_ps(r, distance), denom));
+        __m128 approaching = _mm_cmplt_ps(_mm_mul_ps(denom, distance), zero);
+        __m128 reaches =
+            _mm_or_ps(overlapping, _mm_and_ps(approaching, _mm_cmple_ps(time, _mm_set1_ps(sweep->dt))));
+
+        __m128 offset = _mm_or_ps(_mm_and_ps(overlapping, distance), _mm_andnot_ps(overlapping, r));
+        __m128 cx = _mm_sub_ps(_mm_add_ps(px, _mm_mul_ps(time, vx)), _mm_mul_ps(offset, nx));
+        __m128 cy = _mm_sub_ps(_mm_add_ps(py, _mm_mul_ps(time, vy)), _mm_mul_ps(offset, ny));
+        __m128 cz = _mm_sub_ps(_mm_add_ps(pz, _mm_mul_ps(time, vz)), _mm_mul_ps(offset, nz));
+
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+        for (u32 edge = 0; edge < 3; edge++)
+        {
+            __m128 edgeDistance =
+                _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&block->edgeNormalX[edge][first]), cx),
+                                                 _mm_mul_ps(_mm_loadu_ps(&block->edgeNormalY[edge][first]), cy)),
+                                      _mm_mul_ps(_mm_loadu_ps(&block->edgeNormalZ[edge][first]), cz)),
+                           _mm_loadu_ps(&block->edgeD[edge][first]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(edgeDistance, insideEpsilon));
+        }
+
+        _mm_storeu_ps(&lanes->times[first], time);
+
+        __m128 touches = _mm_and_ps(overlapsBounds, reaches);
+        lanes->faceMask |= (u32)_mm_movemask_ps(_mm_and_ps(touches, inside)) << first;
+        lanes->edgeMask |= (u32)_mm_movemask_ps(_mm_andnot_ps(inside, touches)) << first;
+    }
+
+    height = _mm_max_ps(height, _mm_shuffle_ps(height, height, _MM_SHUFFLE(1, 0, 3, 2)));
+    height = _mm_max_ps(height, _mm_shuffle_ps(height, height, _MM_SHUFFLE(2, 3, 0, 1)));
+    lanes->height = _mm_cvtss_f32(height);
+}
+
+// The whole block at once
+COLLISION_TARGET_AVX2
+static void collisionKernelAVX2(const CollisionBlock *block, const CollisionSweep *sweep, CollisionLanes *lanes)
+{
+    const __m256 px = _mm256_set1_ps(sweep->position[0]);
+    const __m256 py = _mm256_set1_ps(sweep->position[1]);
+    const __m256 pz = _mm256_set1_ps(sweep->position[2]);
+
+    lanes->height = -FLT_MAX;
+    lanes->faceMask = 0;
+    lanes->edgeMask = 0;
+
+    // Most blocks are nowhere near the ball, which the bounds alone tell
+    __m256 minX = _mm256_loadu_ps(block->boundsMinX);
+    __m256 minZ = _mm256_loadu_ps(block->boundsMinZ);
+    __m256 maxX = _mm256_loadu_ps(block->boundsMaxX);
+    __m256 maxZ = _mm256_loadu_ps(block->boundsMaxZ);
+
+    __m256 overlapsBounds = _mm256_and_ps(
+        _mm256_and_ps(_mm256_cmp_ps(_mm256_set1_ps(sweep->boundsMin[0]), maxX, _CMP_LE_OQ),
+                      _mm256_cmp_ps(_mm256_set1_ps(sweep->boundsMax[0]), minX, _CMP_GE_OQ)),
+        _mm256_and_ps(
+            _mm256_and_ps(
+                _mm256_cmp_ps(_mm256_set1_ps(sweep->boundsMin[1]), _mm256_loadu_ps(block->boundsMaxY), _CMP_LE_OQ),
+                _mm256_cmp_ps(_mm256_set1_ps(sweep->boundsMax[1]), _mm256_loadu_ps(block->boundsMinY), _CMP_GE_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(_mm256_set1_ps(sweep->boundsMin[2]), maxZ, _CMP_LE_OQ),
+                          _mm256_cmp_ps(_mm256_set1_ps(sweep->boundsMax[2]), minZ, _CMP_GE_OQ))));
+    __m256 underBall =
+        _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(px, minX, _CMP_GE_OQ), _mm256_cmp_ps(px, maxX, _CMP_LE_OQ)),
+                      _mm256_and_ps(_mm256_cmp_ps(pz, minZ, _CMP_GE_OQ), _mm256_cmp_ps(pz, maxZ, _CMP_LE_OQ)));
+    if (_mm256_movemask_ps(_mm256_or_ps(overlapsBounds, underBall)) == 0)
+    {
+        return;
+    }
+
+    const __m256 vx = _mm256_set1_ps(sweep->velocity[0]);
+    const __m256 vy = _mm256_set1_ps(sweep->velocity[1]);
+    const __m256 vz = _mm256_set1_ps(sweep->velocity[2]);
+    const __m256 radius = _mm256_set1_ps(BALL_RADIUS);
+    const __m256 negativeRadius = _mm256_set1_ps(-BALL_RADIUS);
+    const __m256 insideEpsilon = _mm256_set1_ps(-COLLISION_INSIDE_EPSILON);
+    const __m256 signBit = _mm256_set1_ps(-0.0F);
+    const __m256 zero = _mm256_setzero_ps();
+
+    __m256 nx = _mm256_loadu_ps(block->normalX);
+    __m256 ny = _mm256_loadu_ps(block->normalY);
+    __m256 nz = _mm256_loadu_ps(block->normalZ);
+
+    __m256 distance = _mm256_sub_ps(
+        _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, px), _mm256_mul_ps(ny, py)), _mm256_mul_ps(nz, pz)),
+        _mm256_loadu_ps(block->d));
+    __m256 denom =
+        _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, vx), _mm256_mul_ps(ny, vy)), _mm256_mul_ps(nz, vz));
+
+    __m256 overlapping = _mm256_cmp_ps(_mm256_andnot_ps(signBit, distance), radius, _CMP_LE_OQ);
+    __m256 r = _mm256_blendv_ps(negativeRadius, radius, _mm256_cmp_ps(distance, zero, _CMP_GT_OQ));
+    __m256 time = _mm256_andnot_ps(overlapping, _mm256_div_ps(_mm256_sub_ps(r, distance), denom));
+    __m256 approaching = _mm256_cmp_ps(_mm256_mul_ps(denom, distance), zero, _CMP_LT_OQ);
+    __m256 reaches = _mm256_or_ps(
+        overlapping, _mm256_and_ps(approaching, _mm256_cmp_ps(time, _mm256_set1_ps(sweep->dt), _CMP_LE_OQ)));
+
+    __m256 offset = _mm256_blendv_ps(r, distance, overlapping);
+    __m256 cx = _mm256_sub_ps(_mm256_add_ps(px, _mm256_mul_ps(time, vx)), _mm256_mul_ps(offset, nx));
+    __m256 cy = _mm256_sub_ps(_mm256_add_ps(py, _mm256_mul_ps(time, vy)), _mm256_mul_ps(offset, ny));
+    __m256 cz = _mm256_sub_ps(_mm256_add_ps(pz, _mm256_mul_ps(time, vz)), _mm256_mul_ps(offset, nz));
+
+    __m256 inside = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+    for (u32 edge = 0; edge < 3; edge++)
+    {
+        __m256 edgeDistance = _mm256_sub_ps(
+            _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(block->edgeNormalX[edge]), cx),
+                                        _mm256_mul_ps(_mm256_loadu_ps(block->edgeNormalY[edge]), cy)),
+                          _mm256_mul_ps(_mm256_loadu_ps(block->edgeNormalZ[edge]), cz)),
+            _mm256_loadu_ps(block->edgeD[edge]));
+        inside = _mm256_and_ps(inside, _mm256_cmp_ps(edgeDistance, insideEpsilon, _CMP_GE_OQ));
+    }
+
+    _mm256_storeu_ps(lanes->times, time);
+
+    __m256 touches = _mm256_and_ps(overlapsBounds, reaches);
+    lanes->faceMask = (u32)_mm256_movemask_ps(_mm256_and_ps(touches, inside));
+    lanes->edgeMask = (u32)_mm256_movemask_ps(_mm256_andnot_ps(inside, touches));
+
+    __m256 heights = _mm256_blendv_ps(_mm256_set1_ps(-FLT_MAX), distance, underBall);
+    __m128 height = _mm_max_ps(_mm256_castps256_ps128(heights), _mm256_extractf128_ps(heights, 1));
+    height = _mm_max_ps(height, _mm_shuffle_ps(height, height, _MM_SHUFFLE(1, 0, 3, 2)));
+    height = _mm_max_ps(height, _mm_shuffle_ps(height, height, _MM_SHUFFLE(2, 3, 0, 1)));
+    lanes->height = _mm_cvtss_f32(height);
+}
+#endif
+
+static CollisionKernel *const collisionKernels[COLLISION_KERNEL_COUNT] = {
+    collisionKernelScalar,
+#if defined(COLLISION_KERNELS_X86)
+    collisionKernelSSE2,
+    collisionKernelAVX2,
+#else
+    NULL,
+    NULL,
+#endif
+};
+
+static bool cpuSupportsCollisionKernel(CollisionKernelType type)
+{
+    if (type == COLLISION_KERNEL_SCALAR)
+    {
+        return true;
+    }
+
+#if defined(COLLISION_KERNELS_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    if (type == COLLISION_KERNEL_SSE2)
+    {
+        return (info[3] & (1 << 26)) != 0;
+    }
+
+    // AVX2 needs the OS to save the upper halves of the registers too
+    bool osSavesAVX = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+    __cpuid(info, 0);
+    if (!osSavesAVX || info[0] < 7)
+    {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(COLLISION_KERNELS_X86)
+    __builtin_cpu_init();
+    return type == COLLISION_KERNEL_SSE2 ? __builtin_cpu_supports("sse2") != 0 : __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+}
+
+static CollisionKernelType selectCollisionKernel()
+{
+    for (s32 type = COLLISION_KERNEL_COUNT - 1; type > COLLISION_KERNEL_SCALAR; type--)
+    {
+        if (isCollisionKernelSupported((CollisionKernelType)type))
+        {
+            return (CollisionKernelType)type;
+        }
+    }
+
+    return COLLISION_KERNEL_SCALAR;
+}
+
+static CollisionKernelType collisionKernelType = selectCollisionKernel();
+static CollisionKernel *collisionKernel = collisionKernels[collisionKernelType];
+
+const char *getCollisionKernelName(CollisionKernelType type)
+{
+    return collisionKernelNames[type];
+}
+
+bool isCollisionKernelSupported(CollisionKernelType type)
+{
+    return collisionKernels[type] != NULL && cpuSupportsCollisionKernel(type);
+}
+
+bool setCollisionKernel(CollisionKernelType type)
+{
+    if (!isCollisionKernelSupported(type))
+    {
+        return false;
+    }
+
+    collisionKernelType = type;
+    collisionKernel = collisionKernels[type];
+    return true;
+}
+
+CollisionKernelType getCollisionKernelType()
+{
+    return collisionKernelType;
+}
+
+CollisionKernel *getCollisionKernel()
+{
+    return collisionKernel;
+}
+
+bool parseCollisionKernel(const char *name)
+{
+    for (u32 type = 0; type < COLLISION_KERNEL_COUNT; type++)
+    {
+        if (strcmp(name, collisionKernelNames[type]) == 0)
+        {
+            if (!setCollisionKernel((CollisionKernelType)type))
+            {
+                spdlog::error("The {} collision kernel is not supported on this CPU", name);
+                return false;
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,62 @@
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define COLLISION_KERNELS_X86
+#endif
+
+// Points on an edge shared by two triangles may round to just outside both, this keeps them inside one of them
+#define COLLISION_INSIDE_EPSILON 1e-6F
+
+enum CollisionKernelType
+{
+    COLLISION_KERNEL_SCALAR,
+    COLLISION_KERNEL_SSE2,
+    COLLISION_KERNEL_AVX2,
+
+    COLLISION_KERNEL_COUNT,
+};
+
+// A ball's movement over one step, set up once and tested against every block
+struct CollisionSweep
+{
+    f32 position[3];
+    f32 velocity[3];
+    f32 dt;
+
+    // Box around the whole swept sphere
+    f32 boundsMin[3];
+    f32 boundsMax[3];
+};
+
+// What a kernel found for each triangle of a block
+struct CollisionLanes
+{
+    // When the sphere touches each triangle's plane, 0 when it already does. Only set for lanes in the masks.
+    f32 times[COLLISION_BLOCK_WIDTH];
+
+    // Highest distance above the planes of the triangles right under or over the ball, -FLT_MAX when there are none
+    f32 height;
+
+    // Lanes where the sphere touches the inside of the triangle within the step
+    u32 faceMask;
+
+    // Lanes where the sphere touches the plane outside the triangle, which its edges or corners may still be hit by
+    u32 edgeMask;
+};
+
+typedef void CollisionKernel(const CollisionBlock *block, const CollisionSweep *sweep, CollisionLanes *lanes);
+
+void packCollisionBlocks(const u8 *positions,
+                         size_t positionStride,
+                         const Triangle *triangles,
+                         size_t triangleCount,
+                         CollisionBlock *outBlocks);
+
+void setupCollisionSweep(CollisionSweep *sweep, const glm::vec3 &position, const glm::vec3 &velocity, f32 dt);
+bool sweepTriangleEdges(const CollisionSweep *sweep, const glm::vec3 corners[3], f32 *outTime, glm::vec3 &outContact);
+
+// Every kernel gives bit for bit the same results, the widest one the CPU supports is picked at startup
+const char *getCollisionKernelName(CollisionKernelType type);
+bool isCollisionKernelSupported(CollisionKernelType type);
+bool setCollisionKernel(CollisionKernelType type);
+CollisionKernelType getCollisionKernelType();
+CollisionKernel *getCollisionKernel();
+bool parseCollisionKernel(const char *name);
@@ -0,0 +1,136 @@
+// Formats written by the AssetCooker and read directly out of memory-mapped files by the game. Every section starts
+// at a 16 byte aligned offset from the start of the file so it can be handed straight to GL without copying.
+
+#define COOKED_ASSET_ALIGNMENT 16
+
+#define COOKED_MESH_MAGIC 0x48534D47  // "GMSH"
+#define COOKED_MESH_VERSION 2
+#define COOKED_MESH_EXTENSION ".gmesh"
+
+// Must match the layout of Vertex
+struct CookedVertex
+{
+    f32 position[3];
+    f32 normal[3];
+    f32 color[4];
+    f32 uv[2];
+};
+
+struct CookedCollisionTriangle
+{
+    f32 normal[3];
+    f32 d;  // Plane constant, dot(normal, p) for any point p on the triangle
+
+    // Indices into the vertex section of the same file
+    u32 a, b, c;
+};
+
+struct CookedMeshHeader
+{
+    u32 magic;
+    u32 version;
+
+    u32 vertexCount;
+    u32 indexCount;
+    u32 collisionTriangleCount;
+    u32 reserved;
+
+    u64 vertexDataOffset;     // CookedVertex[vertexCount]
+    u64 indexDataOffset;      // u32[indexCount], triangle list
+    u64 collisionDataOffset;  // CookedCollisionTriangle[collisionTriangleCount]
+
+    f32 boundsMin[3];
+    f32 boundsMax[3];
+};
+
+#define COOKED_TEXTURE_MAGIC 0x58455447  // "GTEX"
+#define COOKED_TEXTURE_VERSION 1
+#define COOKED_TEXTURE_EXTENSION ".gtex"
+#define COOKED_TEXTURE_MAX_MIPS 16
+
+enum CookedTextureFormat
+{
+    COOKED_TEXTURE_FORMAT_RGBA8,
+
+    COOKED_TEXTURE_FORMAT_COUNT,
+};
+
+struct CookedTextureMip
+{
+    u32 width;
+    u32 height;
+    u64 offset;
+    u64 size;
+};
+
+// The full mip chain is stored, largest level first, so loading never has to call glGenerateMipmap
+struct CookedTextureHeader
+{
+    u32 magic;
+    u32 version;
+
+    u32 format;
+    u32 mipCount;
+
+    CookedTextureMip mips[COOKED_TEXTURE_MAX_MIPS];
+};
+
+#define COOKED_COURSE_MAGIC 0x4C495447  // "GTIL"
+#define COOKED_COURSE_VERSION 2
+#define COOKED_COURSE_EXTENSION ".gcourse"
+#define COOKED_COURSE_DEFAULT_TILE_SIZE 64.0F
+
+// One square of the course grid. Triangles are stored in every tile their XZ bounds overlap, so a ball only ever has
+// to test the tiles its swept sphere overlaps.
+struct CookedCourseTile
+{
+    s32 x, z;  // Grid coordinates, the tile covers [x, x + 1) * tileSize on the X axis and likewise on Z
+    u32 vertexCount;
+    u32 triangleCount;
+
+    u64 vertexDataOffset;    // f32[vertexCount][3], positions only
+    u64 triangleDataOffset;  // CookedCollisionTriangle[triangleCount], indices local to the tile
+
+    f32 boundsMin[3];
+    f32 boundsMax[3];
+};
+
+// Collision geometry for a whole course, split into tiles that are streamed in around the balls and the camera
+struct CookedCourseHeader
+{
+    u32 magic;
+    u32 version;
+
+    f32 tileSize;
+    u32 tileCount;  // Only tiles that contain triangles are stored
+
+    s32 gridMinX, gridMinZ;
+    u32 gridWidth, gridDepth;
+
+    u64 tileTableOffset;  // CookedCourseTile[tileCount]
+
+    f32 boundsMin[3];
+    f32 boundsMax[3];
+};
+
+static inline u64 alignCookedOffset(u64 offset)
+{
+    return (offset + (COOKED_ASSET_ALIGNMENT - 1)) & ~(u64)(COOKED_ASSET_ALIGNMENT - 1);
+}
+
+// Path of the cooked file that sits next to a source asset, e.g. "models/ball.glb" -> "models/ball.gmesh"
+static inline bool cookedAssetPath(char *result, size_t resultSize, const char *filepath, const char *extension)
+{
+    const char *dot = strrchr(filepath, '.');
+    size_t stemLength = dot ? (size_t)(dot - filepath) : strlen(filepath);
+    size_t extensionSize = strlen(extension) + 1;
+    if (stemLength + extensionSize > resultSize)
+    {
+        return false;
+    }
+
+    memcpy(result, filepath, stemLength);
+    memcpy(result + stemLength, extension, extensionSize);
+
+    return true;
+}
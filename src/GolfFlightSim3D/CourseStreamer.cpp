@@ -0,0 +1,337 @@
+// Resident tiles are copied straight out of the course file
+static_assert(sizeof(glm::vec3) == sizeof(f32) * 3, "Course tile positions must be tightly packed");
+static_assert(sizeof(Triangle) == sizeof(CookedCollisionTriangle), "Cooked triangle layout must match Triangle");
+
+static CourseStreamerConfig courseStreamerConfig = {NULL, COURSE_DEFAULT_CACHE_SIZE};
+
+// Ball positions further ahead than a frame's steps reach that are worth having resident before a ball gets there
+static const f32 coursePrefetchTimes[] = {0.25F, 0.5F, 1.0F};
+
+CourseStreamerConfig *getCourseStreamerConfig()
+{
+    return &courseStreamerConfig;
+}
+
+static bool isCourseRangeValid(const MappedFile *file, u64 offset, u64 count, size_t elementSize)
+{
+    return offset <= file->size && count <= (file->size - offset) / elementSize;
+}
+
+bool CourseStreamer::open(const CourseStreamerConfig *streamerConfig)
+{
+    bzero(this, sizeof(CourseStreamer));
+
+    config = *streamerConfig;
+
+    if (!file.open(config.path))
+    {
+        spdlog::error("Could not open course \"{}\"", config.path);
+        return false;
+    }
+
+    header = (const CookedCourseHeader *)file.data;
+    if (file.size < sizeof(CookedCourseHeader) || header->magic != COOKED_COURSE_MAGIC ||
+        header->version != COOKED_COURSE_VERSION || header->tileSize <= 0.0F || header->gridWidth == 0 ||
+        header->gridDepth == 0 ||
+        !isCourseRangeValid(&file, header->tileTableOffset, header->tileCount, sizeof(CookedCourseTile)))
+    {
+        spdlog::error("\"{}\" is not a valid course file", config.path);
+        close();
+        return false;
+    }
+
+    size_t cellCount = (size_t)header->gridWidth * header->gridDepth;
+    grid.tiles = (CollisionTile **)calloc(cellCount, sizeof(CollisionTile *));
+    slots = (CourseTileSlot *)calloc(header->tileCount, sizeof(CourseTileSlot));
+    residentSlots = (CourseTileSlot **)calloc(header->tileCount, sizeof(CourseTileSlot *));
+    if (grid.tiles == NULL || slots == NULL || residentSlots == NULL)
+    {
+        spdlog::error("Failed to allocate the tile tables for course \"{}\"", config.path);
+        close();
+        return false;
+    }
+
+    trackAllocation(MEMORY_TAG_COLLISION, grid.tiles, cellCount * sizeof(CollisionTile *));
+    trackAllocation(MEMORY_TAG_COLLISION, slots, header->tileCount * sizeof(CourseTileSlot));
+    trackAllocation(MEMORY_TAG_COLLISION, residentSlots, header->tileCount * sizeof(CourseTileSlot *));
+
+    grid.minX = header->gridMinX;
+    grid.minZ = header->gridMinZ;
+    grid.width = header->gridWidth;
+    grid.depth = header->gridDepth;
+    grid.tileSize = header->tileSize;
+
+    // Only the tile table is read up front, the geometry is left on disk until a tile is needed
+    const CookedCourseTile *cookedTiles = (const CookedCourseTile *)(file.data + header->tileTableOffset);
+    for (u32 tileIndex = 0; tileIndex < header->tileCount; tileIndex++)
+    {
+        const CookedCourseTile *cooked = &cookedTiles[tileIndex];
+
+        if (!grid.covers(cooked->x, cooked->z) || cooked->triangleCount == 0 ||
+            grid.getTile(cooked->x, cooked->z) != NULL ||
+            !isCourseRangeValid(&file, cooked->vertexDataOffset, cooked->vertexCount, sizeof(glm::vec3)) ||
+            !isCourseRangeValid(&file, cooked->triangleDataOffset, cooked->triangleCount, sizeof(Triangle)))
+        {
+            spdlog::error("Course \"{}\" has an invalid tile at ({}, {})", config.path, cooked->x, cooked->z);
+            close();
+            return false;
+        }
+
+        CourseTileSlot *slot = &slots[tileIndex];
+        slot->cooked = cooked;
+
+        grid.tiles[(size_t)(cooked->z - grid.minZ) * grid.width + (size_t)(cooked->x - grid.minX)] = &slot->tile;
+    }
+
+    spdlog::info("Course: \"{}\", {} tiles of {:.0f} m in a {}x{} grid, {:.1f} MiB tile cache", config.path,
+                 header->tileCount, grid.tileSize, grid.width, grid.depth, bytesToMiB(config.cacheSize));
+
+    return true;
+}
+
+void CourseStreamer::close()
+{
+    if (header != NULL && grid.tiles != NULL && slots != NULL && residentSlots != NULL)
+    {
+        while (stats.residentTiles > 0)
+        {
+            evictTile(residentSlots[stats.residentTiles - 1]);
+        }
+
+        trackFree(MEMORY_TAG_COLLISION, grid.tiles, (size_t)grid.width * grid.depth * sizeof(CollisionTile *));
+        trackFree(MEMORY_TAG_COLLISION, slots, header->tileCount * sizeof(CourseTileSlot));
+        trackFree(MEMORY_TAG_COLLISION, residentSlots, header->tileCount * sizeof(CourseTileSlot *));
+    }
+
+    free(grid.tiles);
+    free(slots);
+    free(residentSlots);
+    file.close();
+
+    grid.tiles = NULL;
+    slots = NULL;
+    residentSlots = NULL;
+    header = NULL;
+}
+
+CourseTileSlot *CourseStreamer::findSlot(const glm::vec3 &position) const
+{
+    s32 x = (s32)floorf(position.x / grid.tileSize);
+    s32 z = (s32)floorf(position.z / grid.tileSize);
+    return (CourseTileSlot *)grid.getTile(x, z);
+}
+
+void CourseStreamer::require(const glm::vec3 &start, const glm::vec3 &end)
+{
+    // Every tile a ball's swept sphere can overlap on the way, the same ones its collision checks look at
+    glm::vec3 boundsMin = glm::min(start, end) - glm::vec3(BALL_RADIUS);
+    glm::vec3 boundsMax = glm::max(start, end) + glm::vec3(BALL_RADIUS);
+    s32 minX = (s32)floorf(boundsMin.x / grid.tileSize);
+    s32 maxX = (s32)floorf(boundsMax.x / grid.tileSize);
+    s32 minZ = (s32)floorf(boundsMin.z / grid.tileSize);
+    s32 maxZ = (s32)floorf(boundsMax.z / grid.tileSize);
+
+    for (s32 z = minZ; z <= maxZ; z++)
+    {
+        for (s32 x = minX; x <= maxX; x++)
+        {
+            CourseTileSlot *slot = (CourseTileSlot *)grid.getTile(x, z);
+            if (slot == NULL)
+            {
+                continue;
+            }
+
+            slot->lastUsedFrame = frameIndex;
+            if (slot->tile.triangles == NULL)
+            {
+                loadTile(slot, true);
+            }
+        }
+    }
+}
+
+void CourseStreamer::prefetch(const glm::vec3 &position)
+{
+    CourseTileSlot *slot = findSlot(position);
+    if (slot == NULL)
+    {
+        return;
+    }
+
+    if (slot->tile.triangles != NULL)
+    {
+        slot->lastUsedFrame = frameIndex;
+        return;
+    }
+
+    if (framePrefetches >= COURSE_PREFETCH_LOADS_PER_FRAME)
+    {
+        stats.prefetchesDeferred++;
+        return;
+    }
+
+    if (loadTile(slot, false))
+    {
+        slot->lastUsedFrame = frameIndex;
+        framePrefetches++;
+    }
+}
+
+bool CourseStreamer::loadTile(CourseTileSlot *slot, bool required)
+{
+    ZoneScoped;
+
+    // Blocks are packed on load rather than cooked, they are several times the size of the triangles on disk
+    const CookedCourseTile *cooked = slot->cooked;
+    size_t blocksSize = getCollisionBlockCount(cooked->triangleCount) * sizeof(CollisionBlock);
+    size_t positionsSize = cooked->vertexCount * sizeof(glm::vec3);
+    size_t trianglesSize = cooked->triangleCount * sizeof(Triangle);
+    size_t size = blocksSize + positionsSize + trianglesSize;
+
+    // Evict the least recently used tiles nothing asked for this frame. Tiles this frame's steps need are loaded
+    // even past the budget, colliding correctly matters more than the cache size.
+    while (stats.residentBytes + size > config.cacheSize)
+    {
+        CourseTileSlot *leastRecentlyUsed = NULL;
+        for (u32 residentIndex = 0; residentIndex < stats.residentTiles; residentIndex++)
+        {
+            CourseTileSlot *resident = residentSlots[residentIndex];
+            if (resident->lastUsedFrame < frameIndex &&
+                (leastRecentlyUsed == NULL || resident->lastUsedFrame < leastRecentlyUsed->lastUsedFrame))
+            {
+                leastRecentlyUsed = resident;
+            }
+        }
+
+        if (leastRecentlyUsed == NULL)
+        {
+            if (!required)
+            {
+                stats.prefetchesDeferred++;
+                return false;
+            }
+            break;
+        }
+
+        evictTile(leastRecentlyUsed);
+    }
+
+    u8 *memory = (u8 *)malloc(size);
+    if (memory == NULL)
+    {
+        spdlog::error("Failed to allocate {} bytes for course tile ({}, {})", size, cooked->x, cooked->z);
+        return false;
+    }
+
+    memcpy(memory + blocksSize, file.data + cooked->vertexDataOffset, positionsSize);
+    memcpy(memory + blocksSize + positionsSize, file.data + cooked->triangleDataOffset, trianglesSize);
+
+    const glm::vec3 *positions = (const glm::vec3 *)(memory + blocksSize);
+    const Triangle *triangles = (const Triangle *)(memory + blocksSize + positionsSize);
+    for (u32 triangleIndex = 0; triangleIndex < cooked->triangleCount; triangleIndex++)
+    {
+        const Triangle *triangle = &triangles[triangleIndex];
+        if (triangle->a >= cooked->vertexCount || triangle->b >= cooked->vertexCount ||
+            triangle->c >= cooked->vertexCount)
+        {
+            // Drop the tile from the grid so a broken tile is reported once instead of reloaded every frame
+            spdlog::error("Course tile ({}, {}) has out of range vertex indices, ignoring it", cooked->x, cooked->z);
+            grid.tiles[(size_t)(cooked->z - grid.minZ) * grid.width + (size_t)(cooked->x - grid.minX)] = NULL;
+            free(memory);
+            return false;
+        }
+    }
+
+    packCollisionBlocks((const u8 *)positions, sizeof(glm::vec3), triangles, cooked->triangleCount,
+                        (CollisionBlock *)memory);
+
+    trackAllocation(MEMORY_TAG_COLLISION, memory, size);
+
+    slot->tile.positions = positions;
+    slot->tile.triangles = triangles;
+    slot->tile.blocks = (const CollisionBlock *)memory;
+    slot->tile.vertexCount = cooked->vertexCount;
+    slot->tile.triangleCount = cooked->triangleCount;
+    slot->memory = memory;
+    slot->memorySize = size;
+
+    slot->residentIndex = stats.residentTiles;
+    residentSlots[stats.residentTiles++] = slot;
+    stats.residentBytes += size;
+    stats.loads++;
+
+    return true;
+}
+
+void CourseStreamer::evictTile(CourseTileSlot *slot)
+{
+    trackFree(MEMORY_TAG_COLLISION, slot->memory, slot->memorySize);
+    free(slot->memory);
+
+    stats.residentBytes -= slot->memorySize;
+    stats.evictions++;
+
+    CourseTileSlot *last = residentSlots[--stats.residentTiles];
+    residentSlots[slot->residentIndex] = last;
+    last->residentIndex = slot->residentIndex;
+
+    bzero(&slot->tile, sizeof(CollisionTile));
+    slot->memory = NULL;
+    slot->memorySize = 0;
+}
+
+void CourseStreamer::update(BallManager *ballManager, const glm::vec3 &cameraTarget, f32 lookahead)
+{
+    ZoneScoped;
+
+    frameIndex++;
+    framePrefetches = 0;
+
+    // Everything the coming steps can touch first, so prefetching can't take the budget from it
+    for (size_t ballIndex = 0; ballIndex < ballManager->activeBalls; ballIndex++)
+    {
+        Ball *ball = ballManager->getBall(ballIndex);
+        if (!ball->alive || ball->state == BALL_STATE_IDLE)
+        {
+            continue;
+        }
+
+        require(ball->position, ball->position + ball->velocity * lookahead);
+    }
+
+    for (size_t ballIndex = 0; ballIndex < ballManager->activeBalls; ballIndex++)
+    {
+        Ball *ball = ballManager->getBall(ballIndex);
+        if (!ball->alive || ball->state == BALL_STATE_IDLE)
+        {
+            continue;
+        }
+
+        for (u32 timeIndex = 0; timeIndex < arrayCount(coursePrefetchTimes); timeIndex++)
+        {
+            prefetch(ball->position + ball->velocity * coursePrefetchTimes[timeIndex]);
+        }
+    }
+
+    for (s32 z = -1; z <= 1; z++)
+    {
+        for (s32 x = -1; x <= 1; x++)
+        {
+            prefetch(cameraTarget + glm::vec3((f32)x * grid.tileSize, 0.0F, (f32)z * grid.tileSize));
+        }
+    }
+
+    TracyPlot("Course Tiles Resident", (s64)stats.residentTiles);
+}
+
+void CourseStreamer::logReport() const
+{
+    spdlog::info("Course: {} tile loads, {} evictions, {} tiles resident ({:.1f} MiB)", stats.loads, stats.evictions,
+                 stats.residentTiles, bytesToMiB(stats.residentBytes));
+
+    u32 misses = grid.misses.load();
+    if (misses > 0)
+    {
+        spdlog::warn("Course: {} collision checks found their tile not resident", misses);
+    }
+}
@@ -0,0 +1,64 @@
+#define COURSE_DEFAULT_CACHE_SIZE (256ULL * 1024ULL * 1024ULL)
+
+// Prefetch loads are spread over frames so flying into a new area doesn't stall one frame on disk reads
+#define COURSE_PREFETCH_LOADS_PER_FRAME 4
+
+struct CourseStreamerConfig
+{
+    const char *path;  // NULL when no course is streamed
+    size_t cacheSize;  // Bytes of resident tiles before the least recently used ones are dropped
+};
+
+struct CourseStreamerStats
+{
+    u32 residentTiles;
+    size_t residentBytes;
+    u64 loads;
+    u64 evictions;
+    u64 prefetchesDeferred;  // Prefetches left for a later frame by the per frame cap or the cache budget
+};
+
+// One stored tile of the course file, resident or not. The collision tile comes first so the grid's pointers lead
+// back to their slot.
+struct CourseTileSlot
+{
+    CollisionTile tile;
+    const CookedCourseTile *cooked;
+    u8 *memory;
+    size_t memorySize;
+    u64 lastUsedFrame;
+    u32 residentIndex;
+};
+
+// Keeps the tiles around the active balls and the camera resident within a fixed budget, so a course scan far
+// bigger than memory can be used for collision
+struct CourseStreamer
+{
+    CollisionTileGrid grid;
+    CourseStreamerStats stats;
+
+    bool open(const CourseStreamerConfig *streamerConfig);
+    void close();
+    // lookahead is the most simulated time the frame's steps can cover, the balls' tiles that far ahead are loaded
+    // before it returns
+    void update(BallManager *ballManager, const glm::vec3 &cameraTarget, f32 lookahead);
+    void logReport() const;
+
+private:
+    CourseStreamerConfig config;
+    MappedFile file;
+    const CookedCourseHeader *header;
+
+    CourseTileSlot *slots;
+    CourseTileSlot **residentSlots;
+    u64 frameIndex;
+    u32 framePrefetches;
+
+    CourseTileSlot *findSlot(const glm::vec3 &position) const;
+    void require(const glm::vec3 &start, const glm::vec3 &end);
+    void prefetch(const glm::vec3 &position);
+    bool loadTile(CourseTileSlot *slot, bool required);
+    void evictTile(CourseTileSlot *slot);
+};
+
+CourseStreamerConfig *getCourseStreamerConfig();
@@ -0,0 +1,156 @@
+void Frustum::extract(const glm::mat4 &m)
+{
+    // Gribb/Hartmann: each clip plane is the last row of the matrix plus or minus one of the others
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    planes[0] = row3 + row0;  // Left
+    planes[1] = row3 - row0;  // Right
+    planes[2] = row3 + row1;  // Bottom
+    planes[3] = row3 - row1;  // Top
+    planes[4] = row3 + row2;  // Near
+    planes[5] = row3 - row2;  // Far
+
+    for (u32 planeIndex = 0; planeIndex < arrayCount(planes); planeIndex++)
+    {
+        glm::vec4 &plane = planes[planeIndex];
+        f32 length = glm::length(glm::vec3(plane.x, plane.y, plane.z));
+        plane = plane * (1.0F / length);
+    }
+}
+
+bool Frustum::intersectsSphere(const glm::vec3 &center, f32 radius) const
+{
+    for (u32 planeIndex = 0; planeIndex < arrayCount(planes); planeIndex++)
+    {
+        const glm::vec4 &plane = planes[planeIndex];
+        f32 distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+        if (distance < -radius)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void BallVisibility::initialize(OpenGLProgram *program)
+{
+    glGenVertexArrays(1, &pointVertexArray);
+    glBindVertexArray(pointVertexArray);
+
+    glGenBuffers(1, &pointVertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, pointVertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)sizeof(points), NULL, GL_STREAM_DRAW);
+
+    glEnableVertexAttribArray(program->positionAttribute);
+    glVertexAttribPointer(program->positionAttribute, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (const GLvoid *)0);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void BallVisibility::setCenter(size_t ballIndex, const glm::vec3 &center)
+{
+    centerX[ballIndex] = center.x;
+    centerY[ballIndex] = center.y;
+    centerZ[ballIndex] = center.z;
+}
+
+void BallVisibility::classify(const Frustum *frustum,
+                              const glm::mat4 &viewProjection,
+                              f32 pixelsPerUnit,
+                              size_t ballCount)
+{
+    for (size_t ballIndex = 0; ballIndex < ballCount; ballIndex++)
+    {
+        visible[ballIndex] = 1;
+    }
+
+    // Plane-major order keeps the inner loop free of branches so it vectorizes across balls
+    for (u32 planeIndex = 0; planeIndex < arrayCount(frustum->planes); planeIndex++)
+    {
+        const glm::vec4 &plane = frustum->planes[planeIndex];
+
+        for (size_t ballIndex = 0; ballIndex < ballCount; ballIndex++)
+        {
+            f32 distance =
+                plane.x * centerX[ballIndex] + plane.y * centerY[ballIndex] + plane.z * centerZ[ballIndex] + plane.w;
+            visible[ballIndex] &= (u8)(distance >= -BALL_RADIUS);
+        }
+    }
+
+    culledCount = 0;
+    for (u32 lodIndex = 0; lodIndex < BALL_LOD_COUNT; lodIndex++)
+    {
+        lodCounts[lodIndex] = 0;
+    }
+
+    // Clip space w is the distance along the view direction, which is what the projected size depends on
+    f32 projectedRadius = BALL_RADIUS * pixelsPerUnit;
+    for (size_t ballIndex = 0; ballIndex < ballCount; ballIndex++)
+    {
+        if (!visible[ballIndex])
+        {
+            culledCount++;
+            continue;
+        }
+
+        f32 w = viewProjection[0][3] * centerX[ballIndex] + viewProjection[1][3] * centerY[ballIndex] +
+                viewProjection[2][3] * centerZ[ballIndex] + viewProjection[3][3];
+
+        BallLOD ballLOD = BALL_LOD_FULL;
+        if (w > 0.0F)
+        {
+            f32 radiusPixels = projectedRadius / w;
+            if (radiusPixels < BALL_LOD_POINT_PIXELS)
+            {
+                ballLOD = BALL_LOD_POINT;
+            }
+            else if (radiusPixels < BALL_LOD_LOW_PIXELS)
+            {
+                ballLOD = BALL_LOD_LOW;
+            }
+        }
+
+        lod[ballIndex] = (u8)ballLOD;
+        lodCounts[ballLOD]++;
+    }
+}
+
+void BallVisibility::beginPoints()
+{
+    pointCount = 0;
+}
+
+void BallVisibility::pushPoint(const glm::vec3 &position)
+{
+    points[pointCount++] = position;
+}
+
+void BallVisibility::drawPoints(OpenGLProgram *program, const glm::mat4 &viewProjection, ColorRGBA color)
+{
+    if (pointCount == 0)
+    {
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, pointVertexBuffer);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(pointCount * sizeof(glm::vec3)), (const GLvoid *)points);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glUseProgram(program->id);
+    glBindVertexArray(pointVertexArray);
+
+    glUniformMatrix4fv((GLint)program->modelViewProjectionUniform, 1, GL_FALSE, glm::value_ptr(viewProjection));
+    glUniform4f((GLint)program->colorUniform, color.r, color.g, color.b, color.a);
+    glVertexAttrib4f(program->colorAttribute, 1.0F, 1.0F, 1.0F, 1.0F);
+
+    glPointSize(BALL_POINT_SIZE);
+    glDrawArrays(GL_POINTS, 0, (GLsizei)pointCount);
+
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
\ No newline at end of file
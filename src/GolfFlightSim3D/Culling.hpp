@@ -0,0 +1,51 @@
+// Projected radius thresholds, in pixels, for switching ball levels of detail
+#define BALL_LOD_LOW_PIXELS 6.0F
+#define BALL_LOD_POINT_PIXELS 2.0F
+#define BALL_POINT_SIZE 2.0F
+
+enum BallLOD
+{
+    BALL_LOD_FULL,   // Textured golf_ball.glb
+    BALL_LOD_LOW,    // Untextured sphere.glb
+    BALL_LOD_POINT,  // Single point sprite
+
+    BALL_LOD_COUNT,
+};
+
+struct Frustum
+{
+    // Plane normals point into the frustum and are normalized, so dot(plane, point) is a signed distance
+    glm::vec4 planes[6];
+
+    void extract(const glm::mat4 &viewProjection);
+    bool intersectsSphere(const glm::vec3 &center, f32 radius) const;
+};
+
+struct BallVisibility
+{
+    u32 culledCount;
+    u32 lodCounts[BALL_LOD_COUNT];
+
+    // Per ball results of the last classify()
+    u8 visible[MAX_BALLS];
+    u8 lod[MAX_BALLS];
+
+    void initialize(OpenGLProgram *program);
+    void setCenter(size_t ballIndex, const glm::vec3 &center);
+    void classify(const Frustum *frustum, const glm::mat4 &viewProjection, f32 pixelsPerUnit, size_t ballCount);
+
+    void beginPoints();
+    void pushPoint(const glm::vec3 &position);
+    void drawPoints(OpenGLProgram *program, const glm::mat4 &viewProjection, ColorRGBA color);
+
+private:
+    // Centers are kept as separate arrays so each frustum plane can be tested against a whole batch of balls at once
+    f32 centerX[MAX_BALLS];
+    f32 centerY[MAX_BALLS];
+    f32 centerZ[MAX_BALLS];
+
+    GLuint pointVertexArray;
+    GLuint pointVertexBuffer;
+    glm::vec3 points[MAX_BALLS];
+    u32 pointCount;
+};
\ No newline at end of file
@@ -0,0 +1,257 @@
+static DeterminismConfig determinismConfig = {false, NULL};
+
+DeterminismConfig *getDeterminismConfig()
+{
+    return &determinismConfig;
+}
+
+f32 simSin(f32 x)
+{
+    return determinismConfig.enabled ? portableSin(x) : sinf(x);
+}
+
+f32 simCos(f32 x)
+{
+    return determinismConfig.enabled ? portableCos(x) : cosf(x);
+}
+
+f32 simExp(f32 x)
+{
+    return determinismConfig.enabled ? portableExp(x) : expf(x);
+}
+
+f32 simLog(f32 x)
+{
+    return determinismConfig.enabled ? portableLog(x) : logf(x);
+}
+
+// Minimax polynomials and range reductions from Cephes. Every constant is exact in single precision, and every
+// operation is written out in the order it runs.
+
+// Sine of x when quadrant is even, cosine when it is odd, with quadrant 0 to 3 counting quarter turns added to x
+static f32 portableSinCos(f32 x, u32 quadrant)
+{
+    const f32 fourOverPi = 1.27323954473516F;
+
+    // Pi / 4 split into three parts, each small enough that its product with the octant is exact
+    const f32 quarterPi1 = 0.78515625F;
+    const f32 quarterPi2 = 2.4187564849853515625e-4F;
+    const f32 quarterPi3 = 3.77489497744594108e-8F;
+
+    bool negative = x < 0.0F;
+    if (negative)
+    {
+        x = -x;
+
+        // sin(-x) = -sin(x), but cos(-x) = cos(x)
+        quadrant = (quadrant & 1) != 0 ? quadrant : quadrant + 2;
+    }
+
+    u32 octant = (u32)(x * fourOverPi);
+    f32 y = (f32)octant;
+    if ((octant & 1) != 0)
+    {
+        octant++;
+        y += 1.0F;
+    }
+
+    x = ((x - y * quarterPi1) - y * quarterPi2) - y * quarterPi3;
+    f32 z = x * x;
+
+    // x is now within a quarter turn of 0 and the octant, a multiple of quarter turns, picks the curve and sign
+    u32 turn = (octant / 2 + quadrant) & 3;
+    f32 result;
+    if ((turn & 1) != 0)
+    {
+        result = ((2.443315711809948e-5F * z - 1.388731625493765e-3F) * z + 4.166664568298827e-2F) * z * z;
+        result = result - 0.5F * z + 1.0F;
+    }
+    else
+    {
+        result = ((-1.9515295891e-4F * z + 8.3321608736e-3F) * z - 1.6666654611e-1F) * z * x;
+        result = result + x;
+    }
+
+    return turn >= 2 ? -result : result;
+}
+
+f32 portableSin(f32 x)
+{
+    return portableSinCos(x, 0);
+}
+
+f32 portableCos(f32 x)
+{
+    return portableSinCos(x, 1);
+}
+
+f32 portableExp(f32 x)
+{
+    const f32 log2e = 1.44269504088896341F;
+
+    // ln(2) split in two, the first part has few enough bits that its product with n is exact
+    const f32 ln2High = 0.693359375F;
+    const f32 ln2Low = -2.12194440e-4F;
+
+    if (x > 88.72283905206835F)
+    {
+        return INFINITY;
+    }
+    if (x < -103.278929903431851103F)
+    {
+        return 0.0F;
+    }
+
+    // e^x = 2^n * e^r, with r within half of ln(2) of 0
+    f32 n = floorf(log2e * x + 0.5F);
+    x = x - n * ln2High;
+    x = x - n * ln2Low;
+
+    f32 z = x * x;
+    f32 result = ((((1.9875691500e-4F * x + 1.3981999507e-3F) * x + 8.3334519073e-3F) * x + 4.1665795894e-2F) * x +
+                  1.6666665459e-1F) *
+                     x +
+                 5.0000001201e-1F;
+    result = result * z + x + 1.0F;
+
+    // Scaling by a power of two is exact, short of underflow which rounds the same everywhere
+    return ldexpf(result, (s32)n);
+}
+
+f32 portableLog(f32 x)
+{
+    const f32 halfSqrt2 = 0.707106781186547524F;
+    const f32 ln2High = 0.693359375F;
+    const f32 ln2Low = -2.12194440e-4F;
+
+    if (x <= 0.0F)
+    {
+        return x == 0.0F ? -INFINITY : NAN;
+    }
+    if (x == INFINITY || x != x)
+    {
+        return x;
+    }
+
+    // x = m * 2^e exactly, with m moved into [sqrt(2) / 2, sqrt(2)) so log(m) is small
+    s32 exponent;
+    x = frexpf(x, &exponent);
+    if (x < halfSqrt2)
+    {
+        exponent--;
+        x = x + x - 1.0F;
+    }
+    else
+    {
+        x = x - 1.0F;
+    }
+
+    f32 z = x * x;
+    f32 result = ((((((((7.0376836292e-2F * x - 1.1514610310e-1F) * x + 1.1676998740e-1F) * x - 1.2420140846e-1F) * x +
+                      1.4249322787e-1F) *
+                         x -
+                     1.6668057665e-1F) *
+                        x +
+                    2.0000714765e-1F) *
+                       x -
+                   2.4999993993e-1F) *
+                      x +
+                  3.3333331174e-1F) *
+                 x * z;
+
+    f32 e = (f32)exponent;
+    result = result + ln2Low * e;
+    result = result - 0.5F * z;
+    result = x + result;
+    return result + ln2High * e;
+}
+
+static u64 hashWord(u64 hash, u32 word)
+{
+    hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+    return hash ^ (hash >> 32);
+}
+
+static u64 hashFloats(u64 hash, const f32 *values, u32 count)
+{
+    for (u32 valueIndex = 0; valueIndex < count; valueIndex++)
+    {
+        u32 bits;
+        memcpy(&bits, &values[valueIndex], sizeof(bits));
+        hash = hashWord(hash, bits);
+    }
+    return hash;
+}
+
+u64 hashWorldState(World *world)
+{
+    ZoneScoped;
+
+    BallManager *ballManager = &world->ballManager;
+
+    u64 hash = hashWord(0xCBF29CE484222325ULL, (u32)ballManager->activeBalls);
+    hash = hashFloats(hash, &world->wind.speed, 1);
+    hash = hashFloats(hash, &world->wind.direction, 1);
+
+    for (size_t ballIndex = 0; ballIndex < ballManager->activeBalls; ballIndex++)
+    {
+        const Ball *ball = ballManager->getBall(ballIndex);
+        hash = hashFloats(hash, &ball->startPosition.x, 3);
+        hash = hashFloats(hash, &ball->position.x, 3);
+        hash = hashFloats(hash, &ball->velocity.x, 3);
+        hash = hashFloats(hash, &ball->rotationAxis.x, 3);
+        hash = hashFloats(hash, &ball->spinRate, 1);
+        hash = hashFloats(hash, &ball->launchSpinRate, 1);
+        hash = hashFloats(hash, &ball->currFlightTime, 1);
+        hash = hashFloats(hash, &ball->height, 1);
+        hash = hashFloats(hash, &ball->maxHeight, 1);
+        hash = hashWord(hash, (u32)ball->state | (ball->alive ? 0x100U : 0U));
+        hash = hashWord(hash, ball->bay);
+    }
+
+    return hash;
+}
+
+bool StateHashLog::open(const char *path)
+{
+    step = 0;
+    lastHash = 0;
+    file = NULL;
+
+    if (path == NULL)
+    {
+        return true;
+    }
+
+    file = fopen(path, "w");
+    if (file == NULL)
+    {
+        spdlog::error("Could not open \"{}\" for the state hashes", path);
+        return false;
+    }
+
+    spdlog::info("Determinism: Writing every step's state hash to \"{}\"", path);
+    return true;
+}
+
+void StateHashLog::record(World *world)
+{
+    step++;
+    lastHash = hashWorldState(world);
+
+    if (file != NULL)
+    {
+        fprintf(file, "%llu %016llx\n", (unsigned long long)step, (unsigned long long)lastHash);
+    }
+}
+
+void StateHashLog::close()
+{
+    if (file != NULL)
+    {
+        fclose(file);
+        file = NULL;
+    }
+
+    spdlog::info("Determinism: State hash {:016x} after {} steps", lastHash, step);
+}
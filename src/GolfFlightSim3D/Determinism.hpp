@@ -0,0 +1,44 @@
+// Results of the same shots have to match bit for bit between machines, builds and thread counts to settle disputes
+// over them. Balls never share state within a step and every loop over them runs in ball order, so thread counts
+// already can't change a result, and the build turns off floating point contraction so no compiler fuses a multiply
+// and an add into an FMA that rounds differently. What is left is the C library, whose sinf, cosf, expf and logf
+// differ between platforms and versions. Deterministic mode swaps them for the portable versions below, made only of
+// operations IEEE 754 rounds exactly.
+
+struct DeterminismConfig
+{
+    bool enabled;
+    const char *hashPath;  // Where every step's state hash is written, NULL for nowhere
+};
+
+// The sim's transcendentals, the C library's unless deterministic mode is on
+f32 simSin(f32 x);
+f32 simCos(f32 x);
+f32 simExp(f32 x);
+f32 simLog(f32 x);
+
+// The portable versions, within a few ulps of the exact result for the angles and ranges the sim uses. Angles lose
+// precision beyond a few thousand radians.
+f32 portableSin(f32 x);
+f32 portableCos(f32 x);
+f32 portableExp(f32 x);
+f32 portableLog(f32 x);
+
+// Hashes everything a ball carries from one step to the next, field by field so struct padding is left out
+u64 hashWorldState(World *world);
+
+// Hashes the world after every step, and writes them out as "<step> <hash>" lines that two runs can be diffed by
+struct StateHashLog
+{
+    u64 step;
+    u64 lastHash;
+
+    bool open(const char *path);
+    void record(World *world);
+    void close();
+
+private:
+    FILE *file;
+};
+
+DeterminismConfig *getDeterminismConfig();
@@ -0,0 +1,244 @@
+static DrivingRangeConfig drivingRangeConfig = {1, BAY_DEFAULT_SPACING, 0};
+
+DrivingRangeConfig *getDrivingRangeConfig()
+{
+    return &drivingRangeConfig;
+}
+
+void DrivingRange::initialize(const DrivingRangeConfig *rangeConfig)
+{
+    if (rangeConfig->bayCount > MAX_BAYS)
+    {
+        spdlog::warn("Driving range: {} bays asked for, only {} are supported", rangeConfig->bayCount, MAX_BAYS);
+    }
+
+    bayCount = glm::clamp(rangeConfig->bayCount, 1U, (u32)MAX_BAYS);
+
+    // Bays stand in a row along x, centered on the origin and facing down the range
+    for (u32 bayIndex = 0; bayIndex < bayCount; bayIndex++)
+    {
+        f32 x = ((f32)bayIndex - (f32)(bayCount - 1) * 0.5F) * rangeConfig->baySpacing;
+        bays[bayIndex].tee.position = glm::vec3(x, 0.0F, 0.0F);
+        bays[bayIndex].tee.heading = 0.0F;
+    }
+
+    workerCount = rangeConfig->workerCount != 0 ? rangeConfig->workerCount : std::thread::hardware_concurrency();
+    workerCount = glm::clamp(workerCount, 1U, (u32)RANGE_MAX_WORKERS);
+
+    // The calling thread simulates partitions too
+    for (u32 workerIndex = 1; workerIndex < workerCount; workerIndex++)
+    {
+        workers[workerIndex] = std::thread(&DrivingRange::work, this);
+    }
+
+    spdlog::info("Driving range: {} bays {:.1f} m apart, simulated on {} threads", bayCount,
+                 rangeConfig->baySpacing, workerCount);
+}
+
+void DrivingRange::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quitting = true;
+    }
+    stepStarted.notify_all();
+
+    for (u32 workerIndex = 1; workerIndex < workerCount; workerIndex++)
+    {
+        workers[workerIndex].join();
+    }
+    workerCount = 1;
+}
+
+bool DrivingRange::queueLaunch(u32 bayIndex, const LaunchRequest *request)
+{
+    if (bayIndex >= bayCount)
+    {
+        return false;
+    }
+
+    Bay *bay = &bays[bayIndex];
+    if (bay->queueCount == BAY_LAUNCH_QUEUE_SIZE)
+    {
+        return false;
+    }
+
+    bay->queue[(bay->queueHead + bay->queueCount) % BAY_LAUNCH_QUEUE_SIZE] = *request;
+    bay->queueCount++;
+
+    return true;
+}
+
+const u32 *DrivingRange::getBayBalls(u32 bayIndex, const BallManager *ballManager, u32 *outCount) const
+{
+    const u32 *balls = &partitionBalls[bays[bayIndex].firstBall];
+
+    // Balls cleared since the last step are left out, they are the last ones in ball order
+    u32 count = bays[bayIndex].ballCount;
+    while (count > 0 && balls[count - 1] >= ballManager->activeBalls)
+    {
+        count--;
+    }
+
+    *outCount = count;
+    return balls;
+}
+
+Wind *DrivingRange::getWind(World *world, u32 bayIndex)
+{
+    Bay *bay = &bays[bayIndex];
+    return bay->hasLocalWind ? &bay->localWind : &world->wind;
+}
+
+void DrivingRange::launchQueued(BallManager *ballManager)
+{
+    for (u32 bayIndex = 0; bayIndex < bayCount; bayIndex++)
+    {
+        Bay *bay = &bays[bayIndex];
+        while (bay->queueCount > 0)
+        {
+            // Shots that don't fit wait in their queue until balls are cleared
+            if (ballManager->activeBalls >= MAX_BALLS)
+            {
+                return;
+            }
+
+            const LaunchRequest *request = &bay->queue[bay->queueHead];
+            ballManager->pushBall(request->speed, request->angle, request->heading, request->spinRate,
+                                  request->spinAngle, bayIndex, &bay->tee);
+
+            bay->queueHead = (bay->queueHead + 1) % BAY_LAUNCH_QUEUE_SIZE;
+            bay->queueCount--;
+        }
+    }
+}
+
+void DrivingRange::partition(BallManager *ballManager)
+{
+    for (u32 bayIndex = 0; bayIndex < bayCount; bayIndex++)
+    {
+        bays[bayIndex].ballCount = 0;
+    }
+
+    for (size_t ballIndex = 0; ballIndex < ballManager->activeBalls; ballIndex++)
+    {
+        u32 bayIndex = std::min(ballManager->getBall(ballIndex)->bay, bayCount - 1);
+        bays[bayIndex].ballCount++;
+    }
+
+    u32 firstBall = 0;
+    for (u32 bayIndex = 0; bayIndex < bayCount; bayIndex++)
+    {
+        bays[bayIndex].firstBall = firstBall;
+        firstBall += bays[bayIndex].ballCount;
+        bays[bayIndex].ballCount = 0;
+    }
+
+    for (size_t ballIndex = 0; ballIndex < ballManager->activeBalls; ballIndex++)
+    {
+        Bay *bay = &bays[std::min(ballManager->getBall(ballIndex)->bay, bayCount - 1)];
+        partitionBalls[bay->firstBall + bay->ballCount++] = (u32)ballIndex;
+    }
+
+    partitionCount = 0;
+    for (u32 bayIndex = 0; bayIndex < bayCount; bayIndex++)
+    {
+        const Bay *bay = &bays[bayIndex];
+        for (u32 first = 0; first < bay->ballCount; first += RANGE_PARTITION_SIZE)
+        {
+            RangePartition *partition = &partitions[partitionCount++];
+            partition->bay = bayIndex;
+            partition->firstBall = bay->firstBall + first;
+            partition->ballCount = std::min(bay->ballCount - first, (u32)RANGE_PARTITION_SIZE);
+        }
+    }
+}
+
+void DrivingRange::simulatePartitions()
+{
+    ZoneScoped;
+
+    for (;;)
+    {
+        u32 partitionIndex = nextPartition.fetch_add(1, std::memory_order_relaxed);
+        if (partitionIndex >= partitionCount)
+        {
+            break;
+        }
+
+        const RangePartition *partition = &partitions[partitionIndex];
+        Wind *wind = getWind(stepWorld, partition->bay);
+        FlightPlanner *planner = stepWorld->planner;
+        for (u32 ballIndex = 0; ballIndex < partition->ballCount; ballIndex++)
+        {
+            Ball *ball = stepWorld->ballManager.getBall(partitionBalls[partition->firstBall + ballIndex]);
+            if (planner == NULL || !planner->advance(ball))
+            {
+                ball->simulate(wind, stepGeometry, stepTime);
+            }
+        }
+    }
+}
+
+void DrivingRange::work()
+{
+    u64 lastStep = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            stepStarted.wait(lock, [this, lastStep] { return quitting || stepIndex != lastStep; });
+            if (quitting)
+            {
+                return;
+            }
+            lastStep = stepIndex;
+        }
+
+        simulatePartitions();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            workersRunning--;
+            if (workersRunning == 0)
+            {
+                stepFinished.notify_one();
+            }
+        }
+    }
+}
+
+void DrivingRange::update(World *world, CollisionGeometry *collisionGeometry, f32 dt)
+{
+    ZoneScoped;
+
+    launchQueued(&world->ballManager);
+    partition(&world->ballManager);
+
+    stepWorld = world;
+    stepGeometry = collisionGeometry;
+    stepTime = dt;
+    nextPartition = 0;
+
+    ranInParallel =
+        workerCount > 1 && partitionCount > 1 && world->ballManager.activeBalls >= RANGE_PARALLEL_MIN_BALLS;
+    if (!ranInParallel)
+    {
+        simulatePartitions();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stepIndex++;
+        workersRunning = workerCount - 1;
+    }
+    stepStarted.notify_all();
+
+    simulatePartitions();
+
+    // Every worker has to check in, so none is still reading this step's partitions when the next one rebuilds them
+    std::unique_lock<std::mutex> lock(mutex);
+    stepFinished.wait(lock, [this] { return workersRunning == 0; });
+}
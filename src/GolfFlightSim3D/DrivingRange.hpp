@@ -0,0 +1,106 @@
+#define MAX_BAYS 128
+#define BAY_LAUNCH_QUEUE_SIZE 16
+#define BAY_DEFAULT_SPACING 3.0F  // Meters between neighbouring tees
+#define RANGE_MAX_WORKERS 32
+
+// A bay with more balls than this is split into several partitions, so one busy bay doesn't leave the other workers
+// waiting on it
+#define RANGE_PARTITION_SIZE 256
+#define RANGE_MAX_PARTITIONS (MAX_BAYS + MAX_BALLS / RANGE_PARTITION_SIZE)
+
+// Fewer balls than this are cheaper to simulate on the calling thread than to hand out to the workers
+#define RANGE_PARALLEL_MIN_BALLS 512
+
+struct DrivingRangeConfig
+{
+    u32 bayCount;
+    f32 baySpacing;
+    u32 workerCount;  // Threads simulating partitions, the calling thread included. 0 uses every hardware thread.
+};
+
+struct LaunchRequest
+{
+    f32 speed;
+    f32 angle;
+    f32 heading;  // Relative to the bay
+    f32 spinRate;
+    f32 spinAngle;
+};
+
+struct Bay
+{
+    BayTee tee;
+
+    // Used instead of the range's wind when set, for covered bays or the exposed ones at the ends
+    bool hasLocalWind;
+    Wind localWind;
+
+    // Shots waiting for the next step, launched in the order they came in
+    LaunchRequest queue[BAY_LAUNCH_QUEUE_SIZE];
+    u32 queueHead;
+    u32 queueCount;
+
+    // The bay's balls as of the last step, in ball order, from partitionBalls[firstBall]
+    u32 firstBall;
+    u32 ballCount;
+};
+
+// Runs of one bay's balls that one worker simulates in a row
+struct RangePartition
+{
+    u32 bay;
+    u32 firstBall;
+    u32 ballCount;
+};
+
+// Bays side by side, each hitting its own balls. Every step the queued shots are launched, the balls are grouped by
+// bay with a counting sort, and the groups are handed out to a pool of worker threads that lives as long as the range.
+// Balls of different bays never interact within a step, so partitions need no locking. Ball contacts, which can cross
+// bays, are resolved after every partition is done.
+struct DrivingRange
+{
+    u32 bayCount;
+    u32 workerCount;
+    Bay bays[MAX_BAYS];
+
+    // Last step's counts
+    u32 partitionCount;
+    bool ranInParallel;
+
+    void initialize(const DrivingRangeConfig *rangeConfig);
+    void shutdown();
+
+    bool queueLaunch(u32 bayIndex, const LaunchRequest *request);
+    void update(World *world, CollisionGeometry *collisionGeometry, f32 dt);
+
+    // Indices of the bay's balls as of the last step, for drawing or listing a single bay
+    const u32 *getBayBalls(u32 bayIndex, const BallManager *ballManager, u32 *outCount) const;
+    Wind *getWind(World *world, u32 bayIndex);
+
+    // Groups the balls by bay. Run by every update, and by viewers that draw balls they don't simulate.
+    void partition(BallManager *ballManager);
+
+private:
+    u32 partitionBalls[MAX_BALLS];
+    RangePartition partitions[RANGE_MAX_PARTITIONS];
+
+    // The step being simulated
+    World *stepWorld;
+    CollisionGeometry *stepGeometry;
+    f32 stepTime;
+
+    std::thread workers[RANGE_MAX_WORKERS];
+    std::mutex mutex;
+    std::condition_variable stepStarted;
+    std::condition_variable stepFinished;
+    u64 stepIndex;
+    u32 workersRunning;
+    bool quitting;
+    std::atomic<u32> nextPartition;
+
+    void launchQueued(BallManager *ballManager);
+    void simulatePartitions();
+    void work();
+};
+
+DrivingRangeConfig *getDrivingRangeConfig();
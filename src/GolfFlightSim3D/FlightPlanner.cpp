@@ -0,0 +1,515 @@
+static FlightPlannerConfig flightPlannerConfig = {false, 2};
+
+FlightPlannerConfig *getFlightPlannerConfig()
+{
+    return &flightPlannerConfig;
+}
+
+static f64 getPlannerTime()
+{
+    return std::chrono::duration<f64>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void storeKnot(FlightKnot *knot, const Ball *ball)
+{
+    knot->position = ball->position;
+    knot->velocity = ball->velocity;
+    knot->rotationAxis = ball->rotationAxis;
+    knot->state = ball->state;
+    knot->spinRate = ball->spinRate;
+    knot->currFlightTime = ball->currFlightTime;
+    knot->height = ball->height;
+    knot->maxHeight = ball->maxHeight;
+}
+
+static void loadKnot(Ball *ball, const FlightKnot *knot)
+{
+    ball->position = knot->position;
+    ball->velocity = knot->velocity;
+    ball->rotationAxis = knot->rotationAxis;
+    ball->state = knot->state;
+    ball->spinRate = knot->spinRate;
+    ball->currFlightTime = knot->currFlightTime;
+    ball->height = knot->height;
+    ball->maxHeight = knot->maxHeight;
+}
+
+static bool windsMatch(const Wind *a, const Wind *b)
+{
+    return a->speed == b->speed && a->direction == b->direction && a->logWind == b->logWind;
+}
+
+// The path turns a corner at a step where the ball bounced or changed state, so no segment runs across it
+static bool isCorner(const FlightKnot *knots, u32 step)
+{
+    return knots[step].state != knots[step - 1].state || knots[step].currFlightTime < knots[step - 1].currFlightTime;
+}
+
+// Metres per step at a knot, from both neighbours where the path is smooth through it and from the neighbour on the
+// segment's side where it isn't
+static glm::vec3 getTangent(const FlightKnot *knots, u32 stepCount, u32 step, bool forward)
+{
+    bool smoothBefore = step > 0 && !isCorner(knots, step);
+    bool smoothAfter = step < stepCount && !isCorner(knots, step + 1);
+    if (smoothBefore && smoothAfter)
+    {
+        return (knots[step + 1].position - knots[step - 1].position) * 0.5F;
+    }
+    if (forward)
+    {
+        return knots[step + 1].position - knots[step].position;
+    }
+    return knots[step].position - knots[step - 1].position;
+}
+
+// The cubic Hermite from the first knot to the last one, in the power basis so it is cheap to evaluate
+static void fitSegment(FlightSegment *segment, const FlightKnot *knots, u32 stepCount, u32 first, u32 last)
+{
+    f32 length = (f32)(last - first);
+    glm::vec3 slope = (knots[last].position - knots[first].position) / length;
+    glm::vec3 startTangent = getTangent(knots, stepCount, first, true);
+    glm::vec3 endTangent = getTangent(knots, stepCount, last, false);
+
+    segment->knot = knots[first];
+    segment->b = startTangent;
+    segment->c = (3.0F * slope - 2.0F * startTangent - endTangent) / length;
+    segment->d = (startTangent + endTangent - 2.0F * slope) / (length * length);
+    segment->firstStep = first;
+    segment->stepCount = last - first;
+}
+
+static glm::vec3 evaluateSegment(const FlightSegment *segment, f32 u)
+{
+    return segment->knot.position + u * (segment->b + u * (segment->c + u * segment->d));
+}
+
+static bool segmentFits(const FlightSegment *segment, const FlightKnot *knots)
+{
+    for (u32 u = 1; u < segment->stepCount; u++)
+    {
+        glm::vec3 error = evaluateSegment(segment, (f32)u) - knots[segment->firstStep + u].position;
+        if (glm::length2(error) > FLIGHT_PLAN_TOLERANCE * FLIGHT_PLAN_TOLERANCE)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The segment a step of the plan is on, searching forward from one at or before it
+static u32 findSegment(const FlightPlan *plan, u32 step, u32 segmentIndex)
+{
+    while (segmentIndex + 1 < plan->segmentCount && plan->segments[segmentIndex + 1].firstStep <= step)
+    {
+        segmentIndex++;
+    }
+    return segmentIndex;
+}
+
+void FlightPlanner::initialize(const FlightPlannerConfig *plannerConfig)
+{
+    // Handed out from the back, so the first launches get the first plans
+    for (u32 planIndex = 0; planIndex < FLIGHT_PLAN_MAX_PLANS; planIndex++)
+    {
+        freePlans[planIndex] = FLIGHT_PLAN_MAX_PLANS - 1 - planIndex;
+    }
+    freeCount = FLIGHT_PLAN_MAX_PLANS;
+
+    workerCount = glm::clamp(plannerConfig->workerCount, 1U, (u32)FLIGHT_PLAN_MAX_WORKERS);
+    for (u32 workerIndex = 0; workerIndex < workerCount; workerIndex++)
+    {
+        workers[workerIndex] = std::thread(&FlightPlanner::work, this, workerIndex);
+    }
+
+    spdlog::info("Flight planner: Solving launches on {} threads", workerCount);
+}
+
+void FlightPlanner::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quitting = true;
+    }
+    planQueued.notify_all();
+
+    for (u32 workerIndex = 0; workerIndex < workerCount; workerIndex++)
+    {
+        workers[workerIndex].join();
+    }
+    workerCount = 0;
+}
+
+FlightPlan *FlightPlanner::getPlan(u32 handle)
+{
+    // Handles are the plan's index plus one in the low half and its generation in the high half, so 0 is none
+    u32 planIndex = (handle & 0xFFFF) - 1;
+    if (planIndex >= FLIGHT_PLAN_MAX_PLANS)
+    {
+        return NULL;
+    }
+
+    FlightPlan *plan = &plans[planIndex];
+    if ((plan->generation & 0xFFFF) != handle >> 16 ||
+        plan->state.load(std::memory_order_acquire) == FLIGHT_PLAN_FREE)
+    {
+        return NULL;
+    }
+    return plan;
+}
+
+bool FlightPlanner::request(Ball *ball, const Wind *wind, CollisionGeometry *collisionGeometry, f32 dt)
+{
+    if (freeCount == 0)
+    {
+        return false;
+    }
+
+    u32 planIndex = freePlans[--freeCount];
+    usedPlans[usedCount++] = planIndex;
+    FlightPlan *plan = &plans[planIndex];
+    plan->generation++;
+    plan->start = *ball;
+    plan->wind = *wind;
+    plan->dt = dt;
+    plan->geometry = collisionGeometry;
+    plan->firstStep = steps;
+    plan->cursor = 0;
+    plan->adopted = false;
+    plan->seenStep = steps;
+    plan->counted = false;
+    plan->state.store(FLIGHT_PLAN_SOLVING, std::memory_order_relaxed);
+
+    ball->plan = ((plan->generation & 0xFFFF) << 16) | (planIndex + 1);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue[(queueHead + queueCount) % FLIGHT_PLAN_MAX_PLANS] = planIndex;
+        queueCount++;
+    }
+    planQueued.notify_one();
+
+    return true;
+}
+
+void FlightPlanner::solve(FlightPlan *plan, FlightKnot *knots)
+{
+    ZoneScoped;
+
+    f64 startTime = getPlannerTime();
+
+    // The same steps the sim would take, so every knot is exactly where integrating the ball gets it
+    Ball ball = plan->start;
+    Wind wind = plan->wind;
+    storeKnot(&knots[0], &ball);
+
+    u32 stepCount = 0;
+    while (stepCount < FLIGHT_PLAN_MAX_STEPS && ball.state != BALL_STATE_IDLE)
+    {
+        ball.simulate(&wind, plan->geometry, plan->dt);
+        storeKnot(&knots[++stepCount], &ball);
+    }
+
+    // Each segment is the longest one up to the next corner that stays within the tolerance, one step always does
+    u32 segmentCount = 0;
+    u32 first = 0;
+    while (first < stepCount && segmentCount < FLIGHT_PLAN_MAX_SEGMENTS - 1)
+    {
+        u32 last = first + 1;
+        while (last < stepCount && last - first < FLIGHT_PLAN_MAX_SEGMENT_STEPS && !isCorner(knots, last))
+        {
+            last++;
+        }
+
+        FlightSegment *segment = &plan->segments[segmentCount++];
+        for (;; last--)
+        {
+            fitSegment(segment, knots, stepCount, first, last);
+            if (last == first + 1 || segmentFits(segment, knots))
+            {
+                break;
+            }
+        }
+        first = last;
+    }
+
+    // Where the plan ends, at rest or where a new plan takes over when it ran out of steps or segments
+    FlightSegment *end = &plan->segments[segmentCount++];
+    end->knot = knots[first];
+    end->b = glm::vec3(0.0F);
+    end->c = glm::vec3(0.0F);
+    end->d = glm::vec3(0.0F);
+    end->firstStep = first;
+    end->stepCount = 0;
+
+    plan->segmentCount = segmentCount;
+    plan->stepCount = first;
+    plan->solveTime = getPlannerTime() - startTime;
+}
+
+void FlightPlanner::work(u32 workerIndex)
+{
+    for (;;)
+    {
+        u32 planIndex;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            planQueued.wait(lock, [this] { return quitting || queueCount > 0; });
+            if (quitting)
+            {
+                return;
+            }
+
+            planIndex = queue[queueHead];
+            queueHead = (queueHead + 1) % FLIGHT_PLAN_MAX_PLANS;
+            queueCount--;
+        }
+
+        FlightPlan *plan = &plans[planIndex];
+        solve(plan, solvedSteps[workerIndex]);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            plan->state.store(FLIGHT_PLAN_READY, std::memory_order_release);
+        }
+        planSolved.notify_all();
+    }
+}
+
+// Puts a ball following a plan where integrating it would have it, from the knot it last passed
+void FlightPlanner::rewind(Ball *ball, FlightPlan *plan)
+{
+    ZoneScoped;
+
+    u32 step = std::min((u32)(steps - plan->firstStep), plan->stepCount);
+    const FlightSegment *segment = &plan->segments[plan->cursor];
+    loadKnot(ball, &segment->knot);
+
+    for (u32 replayed = segment->firstStep; replayed < step; replayed++)
+    {
+        ball->simulate(&plan->wind, plan->geometry, plan->dt);
+    }
+}
+
+void FlightPlanner::beginStep(World *world, CollisionGeometry *collisionGeometry, f32 dt)
+{
+    ZoneScoped;
+
+    steps++;
+
+    bool deterministic = getDeterminismConfig()->enabled;
+    BallManager *ballManager = &world->ballManager;
+    DrivingRange *range = world->range;
+
+    stats.plannedBalls = 0;
+    stats.pendingBalls = 0;
+    for (size_t ballIndex = 0; ballIndex < ballManager->activeBalls; ballIndex++)
+    {
+        Ball *ball = ballManager->getBall(ballIndex);
+        if (!ball->alive || ball->plan == FLIGHT_PLAN_NONE)
+        {
+            continue;
+        }
+
+        const Wind *wind =
+            range != NULL ? range->getWind(world, std::min(ball->bay, range->bayCount - 1)) : &world->wind;
+
+        FlightPlan *plan = getPlan(ball->plan);
+        if (plan != NULL && !windsMatch(&plan->wind, wind))
+        {
+            // A ball that isn't following its plan yet is still where integrating it got it
+            if (plan->adopted)
+            {
+                rewind(ball, plan);
+            }
+            stats.windChanges++;
+            plan = NULL;
+        }
+
+        if (plan == NULL)
+        {
+            bool refused = ball->plan == FLIGHT_PLAN_REFUSED;
+            ball->plan = 0;
+            if (ball->state == BALL_STATE_IDLE)
+            {
+                continue;
+            }
+            if (!request(ball, wind, collisionGeometry, dt))
+            {
+                // Counted once, not every step it waits for a plan
+                if (!refused)
+                {
+                    stats.overflows++;
+                }
+                ball->plan = FLIGHT_PLAN_REFUSED;
+                continue;
+            }
+            plan = getPlan(ball->plan);
+        }
+        plan->seenStep = steps;
+
+        if (deterministic && steps - plan->firstStep + 1 > FLIGHT_PLAN_DETERMINISTIC_LATENCY)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            planSolved.wait(lock, [plan] { return plan->state.load() == FLIGHT_PLAN_READY; });
+        }
+
+        if (plan->state.load(std::memory_order_acquire) == FLIGHT_PLAN_READY)
+        {
+            stats.plannedBalls++;
+        }
+        else
+        {
+            stats.pendingBalls++;
+        }
+    }
+
+    // Plans no ball holds any more, once their worker is done with them
+    u32 keptCount = 0;
+    for (u32 usedIndex = 0; usedIndex < usedCount; usedIndex++)
+    {
+        u32 planIndex = usedPlans[usedIndex];
+        FlightPlan *plan = &plans[planIndex];
+
+        // Deterministic mode frees a plan on the step its ball lets go of it, so which launches find a free plan
+        // doesn't depend on how far the workers have got
+        if (deterministic && plan->seenStep != steps &&
+            plan->state.load(std::memory_order_acquire) == FLIGHT_PLAN_SOLVING)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            planSolved.wait(lock, [plan] { return plan->state.load() == FLIGHT_PLAN_READY; });
+        }
+
+        if (plan->state.load(std::memory_order_acquire) == FLIGHT_PLAN_READY)
+        {
+            if (!plan->counted)
+            {
+                stats.plansSolved++;
+                stats.stepsSolved += plan->stepCount;
+                stats.segments += plan->segmentCount;
+                stats.solveTime += plan->solveTime;
+                plan->counted = true;
+            }
+
+            if (plan->seenStep != steps)
+            {
+                plan->state.store(FLIGHT_PLAN_FREE, std::memory_order_relaxed);
+                freePlans[freeCount++] = planIndex;
+                continue;
+            }
+        }
+        usedPlans[keptCount++] = planIndex;
+    }
+    usedCount = keptCount;
+}
+
+bool FlightPlanner::advance(Ball *ball)
+{
+    FlightPlan *plan = getPlan(ball->plan);
+    if (plan == NULL || plan->state.load(std::memory_order_acquire) != FLIGHT_PLAN_READY)
+    {
+        return false;
+    }
+
+    // Steps into the plan this step takes the ball to
+    u32 step = (u32)(steps - plan->firstStep) + 1;
+    if (!plan->adopted)
+    {
+        if (getDeterminismConfig()->enabled && step <= FLIGHT_PLAN_DETERMINISTIC_LATENCY)
+        {
+            return false;
+        }
+
+        // Solved after the ball had already been integrated past its end
+        if (step > plan->stepCount)
+        {
+            ball->plan = 0;
+            return false;
+        }
+
+        // Integrating the ball can't have taken it further than the tolerance from the plan unless a contact moved it
+        plan->cursor = findSegment(plan, step - 1, 0);
+        const FlightSegment *segment = &plan->segments[plan->cursor];
+        glm::vec3 plannedPosition = evaluateSegment(segment, (f32)(step - 1 - segment->firstStep));
+        plan->lastPosition = plannedPosition;
+        if (glm::length2(ball->position - plannedPosition) <= FLIGHT_PLAN_TOLERANCE * FLIGHT_PLAN_TOLERANCE)
+        {
+            plan->lastPosition = ball->position;
+        }
+        plan->adopted = true;
+    }
+
+    // Anything else that moves the ball takes it off the plan for good
+    if (ball->position != plan->lastPosition)
+    {
+        ball->plan = FLIGHT_PLAN_NONE;
+        stats.dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    plan->cursor = findSegment(plan, step, plan->cursor);
+    const FlightSegment *segment = &plan->segments[plan->cursor];
+    u32 u = step - segment->firstStep;
+    if (u == 0)
+    {
+        loadKnot(ball, &segment->knot);
+    }
+    else
+    {
+        // The state, rotation axis and heights only change at knots, the spin decays slowly enough to interpolate
+        const FlightSegment *next = segment + 1;
+        f32 t = (f32)u;
+        ball->position = evaluateSegment(segment, t);
+        ball->velocity = (segment->b + t * (2.0F * segment->c + 3.0F * t * segment->d)) / plan->dt;
+        ball->rotationAxis = segment->knot.rotationAxis;
+        ball->state = segment->knot.state;
+        ball->spinRate = glm::mix(segment->knot.spinRate, next->knot.spinRate, t / (f32)segment->stepCount);
+        ball->currFlightTime = segment->knot.currFlightTime + t * plan->dt;
+        ball->height = segment->knot.height;
+        ball->maxHeight = segment->knot.maxHeight;
+    }
+    plan->lastPosition = ball->position;
+
+    // The ball is at the plan's last knot, at rest or to be given a new plan next step
+    if (step == plan->stepCount)
+    {
+        ball->plan = 0;
+    }
+
+    return true;
+}
+
+bool FlightPlanner::samplePosition(const Ball *ball, f32 alpha, glm::vec3 *outPosition)
+{
+    FlightPlan *plan = getPlan(ball->plan);
+    if (plan == NULL || !plan->adopted)
+    {
+        return false;
+    }
+
+    f32 step = (f32)(steps - plan->firstStep) + alpha;
+    u32 segmentIndex = plan->cursor;
+    while (segmentIndex > 0 && (f32)plan->segments[segmentIndex].firstStep > step)
+    {
+        segmentIndex--;
+    }
+
+    const FlightSegment *segment = &plan->segments[segmentIndex];
+    *outPosition = evaluateSegment(segment, std::min(step - (f32)segment->firstStep, (f32)segment->stepCount));
+    return true;
+}
+
+void FlightPlanner::logReport() const
+{
+    if (stats.plansSolved == 0)
+    {
+        spdlog::info("Flight planner: No plans solved");
+        return;
+    }
+
+    spdlog::info("Flight planner: {} plans solved, {:.1f} steps and {:.1f} segments each, {:.3f} ms to solve each",
+                 stats.plansSolved, (f64)stats.stepsSolved / (f64)stats.plansSolved,
+                 (f64)stats.segments / (f64)stats.plansSolved, stats.solveTime * 1000.0 / (f64)stats.plansSolved);
+    spdlog::info("Flight planner: {} solved again for a change of wind, {} dropped by contacts, {} launches integrated "
+                 "for want of a free plan",
+                 stats.windChanges, stats.dropped.load(), stats.overflows);
+}
@@ -0,0 +1,156 @@
+#define FLIGHT_PLAN_MAX_PLANS 2048  // Balls launched while every plan is in use are integrated until one frees up
+#define FLIGHT_PLAN_MAX_STEPS 2048  // A flight that lasts longer goes on in a new plan from where this one ends
+#define FLIGHT_PLAN_MAX_SEGMENTS 96
+#define FLIGHT_PLAN_MAX_SEGMENT_STEPS 64
+#define FLIGHT_PLAN_TOLERANCE 0.001F  // Metres a segment may stray from the solved positions between its knots
+#define FLIGHT_PLAN_MAX_WORKERS 8
+
+// Steps after a launch its plan is picked up in deterministic mode, waiting for it if the workers are behind
+#define FLIGHT_PLAN_DETERMINISTIC_LATENCY 4
+
+// Ball plan handle of a ball that was moved off its plan, it is integrated until it comes to rest
+#define FLIGHT_PLAN_NONE 0xFFFFFFFFU
+
+// Ball plan handle of a ball launched while every plan was in use, it asks again every step until one frees up
+#define FLIGHT_PLAN_REFUSED 0xFFFFFFFEU
+
+struct FlightPlannerConfig
+{
+    bool enabled;
+    u32 workerCount;  // Threads solving plans
+};
+
+struct FlightPlannerStats
+{
+    // Plans the workers finished
+    u64 plansSolved;
+    u64 stepsSolved;
+    u64 segments;
+    f64 solveTime;  // Seconds the workers spent on them
+
+    // Last step's balls
+    u32 plannedBalls;  // Following a plan instead of being integrated
+    u32 pendingBalls;  // Integrated while their plan is being solved
+
+    u64 windChanges;           // Plans solved again because the wind changed under them
+    u64 overflows;             // Balls integrated because every plan was in use when they were launched
+    std::atomic<u64> dropped;  // Plans dropped because a contact moved their ball
+};
+
+// A ball's state where a segment starts, exactly as integrating it got there
+struct FlightKnot
+{
+    glm::vec3 position;
+    glm::vec3 velocity;
+    glm::vec3 rotationAxis;
+    BallState state;
+    f32 spinRate;
+    f32 currFlightTime;
+    f32 height;
+    f32 maxHeight;
+};
+
+// A cubic through the positions from a knot to the next one. u steps after the knot the ball is at
+// knot.position + u * (b + u * (c + u * d)).
+struct FlightSegment
+{
+    FlightKnot knot;
+    glm::vec3 b, c, d;
+    u32 firstStep;  // Steps into the plan its knot is at
+    u32 stepCount;  // 0 for the plan's last, which only holds where the ball ends up
+};
+
+enum FlightPlanState
+{
+    FLIGHT_PLAN_FREE,
+    FLIGHT_PLAN_SOLVING,
+    FLIGHT_PLAN_READY,
+};
+
+// One ball's flight from the state it had when it was asked for to where it comes to rest, solved under a fixed wind
+struct FlightPlan
+{
+    std::atomic<u32> state;
+    u32 generation;  // Bumped every time it is handed out, so a stale ball handle never matches it
+
+    // What it was solved from
+    Ball start;
+    Wind wind;
+    f32 dt;
+    CollisionGeometry *geometry;
+    u64 firstStep;  // Planner step the start state is from
+
+    // Written by the worker that solved it
+    FlightSegment segments[FLIGHT_PLAN_MAX_SEGMENTS];
+    u32 segmentCount;
+    u32 stepCount;
+    f64 solveTime;
+
+    // Kept by the one ball following it
+    u32 cursor;  // Segment of the ball's last step
+    bool adopted;
+    glm::vec3 lastPosition;
+
+    // Sim thread
+    u64 seenStep;  // Last step a ball still held it
+    bool counted;
+};
+
+// Solves the whole flight, bounces and roll of a ball once, when it is launched, by integrating it on a worker thread
+// exactly as the sim would. The result is a piecewise cubic with a knot at every bounce and change of state, and the
+// ball then follows that curve instead of being integrated and collided with every step. At the knots the ball has
+// exactly the state integration would give it, and in between it is within FLIGHT_PLAN_TOLERANCE of it.
+//
+// Until its plan is solved a ball is integrated as usual, and picks the plan up at whatever step it is on. When the
+// wind over a ball changes, it goes back to its last knot, is integrated to the current step under the old wind, and
+// a new plan is solved from there. Ball contacts move balls off their plans, those balls are integrated from then on.
+struct FlightPlanner
+{
+    FlightPlannerStats stats;
+    u32 workerCount;
+
+    void initialize(const FlightPlannerConfig *plannerConfig);
+    void shutdown();
+
+    // Run before the balls are stepped, on the sim thread. Hands newly launched balls to the workers, solves plans
+    // again where the wind changed and frees the plans no ball holds any more.
+    void beginStep(World *world, CollisionGeometry *collisionGeometry, f32 dt);
+
+    // Moves a ball one step along its plan. False when it has none yet and has to be integrated. Balls are only
+    // touched by their own plan, so partitions of balls can be advanced on several threads.
+    bool advance(Ball *ball);
+
+    // Where a ball following a plan is alpha of the way from its previous step to its current one, for drawing it
+    // between steps. False when it isn't following one.
+    bool samplePosition(const Ball *ball, f32 alpha, glm::vec3 *outPosition);
+
+    void logReport() const;
+
+private:
+    FlightPlan plans[FLIGHT_PLAN_MAX_PLANS];
+    u32 freePlans[FLIGHT_PLAN_MAX_PLANS];
+    u32 freeCount;
+    u32 usedPlans[FLIGHT_PLAN_MAX_PLANS];
+    u32 usedCount;
+    u64 steps;
+
+    // Positions of the flight being solved, per worker
+    FlightKnot solvedSteps[FLIGHT_PLAN_MAX_WORKERS][FLIGHT_PLAN_MAX_STEPS + 1];
+
+    std::thread workers[FLIGHT_PLAN_MAX_WORKERS];
+    std::mutex mutex;
+    std::condition_variable planQueued;
+    std::condition_variable planSolved;
+    u32 queue[FLIGHT_PLAN_MAX_PLANS];
+    u32 queueHead;
+    u32 queueCount;
+    bool quitting;
+
+    FlightPlan *getPlan(u32 handle);
+    bool request(Ball *ball, const Wind *wind, CollisionGeometry *collisionGeometry, f32 dt);
+    void rewind(Ball *ball, FlightPlan *plan);
+    void solve(FlightPlan *plan, FlightKnot *knots);
+    void work(u32 workerIndex);
+};
+
+FlightPlannerConfig *getFlightPlannerConfig();
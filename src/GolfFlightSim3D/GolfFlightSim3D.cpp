@@ -127,12 +127,12 @@ void Ball::computeSpinRate()
     // Spin decreases roughly 4% per second
     const f32 spinDecayRate = 24.5F;
 
-    spinRate = launchSpinRate * expf(-currFlightTime / spinDecayRate);
+    spinRate = launchSpinRate * simExp(-currFlightTime / spinDecayRate);
 }
 
 void Ball::computeWindForce(Wind *wind)
 {
-    windVector = glm::vec3(wind->speed * sinf(wind->direction), 0.0F, wind->speed * cosf(wind->direction));
+    windVector = glm::vec3(wind->speed * simSin(wind->direction), 0.0F, wind->speed * simCos(wind->direction));
 
     if (!wind->logWind)
     {
@@ -152,7 +152,7 @@ void Ball::computeWindForce(Wind *wind)
         ballHeight = roughnessLengthScale;
     }
 
-    windVector *= logf(ballHeight / roughnessLengthScale) / logf(referenceHeight / roughnessLengthScale);
+    windVector *= simLog(ballHeight / roughnessLengthScale) / simLog(referenceHeight / roughnessLengthScale);
 }
 
 void Ball::computeLiftForce(const glm::vec3 &groundSpeed, f32 liftCoefficient)
@@ -190,6 +190,8 @@ void Ball::computeDragForce(const glm::vec3 &groundSpeed, f32 dragCoefficient)
 
 void Ball::simulateFlying(Wind *wind, f32 dt)
 {
+    ZoneScoped;
+
     computeSpinRate();
 
     computeWindForce(wind);
@@ -210,50 +212,84 @@ void Ball::simulateFlying(Wind *wind, f32 dt)
     currFlightTime += dt;
 }
 
-bool Ball::intersectsWithPlane(glm::vec3 &normal, f32 d, f32 *outCollisionTime, glm::vec3 &outIntersectionPoint) const
+bool CollisionTileGrid::covers(s32 x, s32 z) const
 {
-    f32 distance = glm::dot(normal, position) - d;
+    return x >= minX && z >= minZ && (u32)(x - minX) < width && (u32)(z - minZ) < depth;
+}
 
-    if (fabsf(distance) <= BALL_RADIUS)
-    {
-        // Sphere is already overlapping
-        *outCollisionTime = 0.0F;
-        outIntersectionPoint = position;
+CollisionTile *CollisionTileGrid::getTile(s32 x, s32 z) const
+{
+    return covers(x, z) ? tiles[(size_t)(z - minZ) * width + (size_t)(x - minX)] : NULL;
+}
 
-        return true;
-    }
+void Ball::checkMesh(const CollisionMesh *mesh, const CollisionSweep *sweep, CollisionHit *hit)
+{
+    CollisionKernel *kernel = getCollisionKernel();
 
-    f32 denom = glm::dot(normal, velocity);
-    if (denom * distance >= 0.0F)
+    for (size_t blockIndex = 0; blockIndex < mesh->blockCount; blockIndex++)
     {
-        // No intersection if the ball is moving parallel to or away from the plane
-        return false;
-    }
+        const CollisionBlock *block = &mesh->blocks[blockIndex];
 
-    f32 r = distance > 0.0F ? BALL_RADIUS : -BALL_RADIUS;
+        CollisionLanes lanes;
+        kernel(block, sweep, &lanes);
 
-    *outCollisionTime = (r - distance) / denom;
-    outIntersectionPoint = position + *outCollisionTime * velocity - r * normal;
+        hit->heightAbove = std::max(hit->heightAbove, lanes.height);
+        if ((lanes.faceMask | lanes.edgeMask) == 0)
+        {
+            continue;
+        }
 
-    return true;
-}
+        for (u32 lane = 0; lane < COLLISION_BLOCK_WIDTH; lane++)
+        {
+            u32 laneBit = 1U << lane;
+            if ((lanes.faceMask & laneBit) != 0)
+            {
+                f32 collisionTime = lanes.times[lane];
+                if (hit->found && collisionTime >= hit->time)
+                {
+                    continue;
+                }
 
-bool Ball::intersectsWithTriangle(glm::vec3 &p,
-                                  glm::vec3 &normal,
-                                  f32 *outCollisionTime,
-                                  glm::vec3 &outIntersectionPoint)
-{
-    // Test against the plane representing the triangle
-    const f32 d = glm::dot(normal, p);
-    bool colliding = intersectsWithPlane(normal, d, outCollisionTime, outIntersectionPoint);
+                glm::vec3 normal(block->normalX[lane], block->normalY[lane], block->normalZ[lane]);
+                f32 distance = glm::dot(normal, position) - block->d[lane];
+                f32 r = distance > 0.0F ? BALL_RADIUS : -BALL_RADIUS;
 
-    return colliding;
-}
+                hit->time = collisionTime;
+                hit->point = collisionTime > 0.0F ? position + collisionTime * velocity - r * normal : position;
+                hit->normal = normal;
+                hit->found = true;
+            }
+            else if ((lanes.edgeMask & laneBit) != 0)
+            {
+                const Triangle *triangle = &mesh->triangles[block->triangleIndices[lane]];
+                glm::vec3 corners[3] = {
+                    *(const glm::vec3 *)(mesh->positions + triangle->a * mesh->positionStride),
+                    *(const glm::vec3 *)(mesh->positions + triangle->b * mesh->positionStride),
+                    *(const glm::vec3 *)(mesh->positions + triangle->c * mesh->positionStride),
+                };
+
+                f32 collisionTime;
+                glm::vec3 contact;
+                if (!sweepTriangleEdges(sweep, corners, &collisionTime, contact) ||
+                    (hit->found && collisionTime >= hit->time))
+                {
+                    continue;
+                }
 
-f32 Ball::getCurrentHeight(const glm::vec3 &a, const glm::vec3 &normal) const
-{
-    f32 currentHeight = glm::dot(position - a, normal);
-    return currentHeight;
+                // Edges and corners push straight back towards the center
+                glm::vec3 center = position + collisionTime * velocity;
+                glm::vec3 away = center - contact;
+                f32 awayLength = glm::length(away);
+
+                hit->time = collisionTime;
+                hit->point = collisionTime > 0.0F ? contact : position;
+                hit->normal = awayLength > 0.0F ? away / awayLength : triangle->normal;
+                hit->found = true;
+            }
+        }
+    }
+
+    profileCount(trianglesTested, mesh->blockCount * COLLISION_BLOCK_WIDTH);
 }
 
 bool Ball::checkCollision(CollisionGeometry *collisionGeometry,
@@ -262,34 +298,81 @@ bool Ball::checkCollision(CollisionGeometry *collisionGeometry,
                           glm::vec3 &outIntersectionPoint,
                           glm::vec3 &outNormal)
 {
-    for (size_t triangleIndex = 0; triangleIndex < collisionGeometry->triangleCount; triangleIndex++)
-    {
-        Triangle *triangle = &collisionGeometry->triangles[triangleIndex];
-
-        glm::vec3 &p = collisionGeometry->vertices[triangle->a].position;
-        glm::vec3 &normal = triangle->normal;
+    ZoneScoped;
+
+    CollisionSweep sweep;
+    setupCollisionSweep(&sweep, position, velocity, dt);
+
+    CollisionHit hit;
+    hit.found = false;
+    hit.heightAbove = -FLT_MAX;
+
+    CollisionMesh mesh;
+    mesh.positions = (const u8 *)&collisionGeometry->vertices[0].position;
+    mesh.positionStride = sizeof(Vtx);
+    mesh.triangles = collisionGeometry->triangles;
+    mesh.blocks = collisionGeometry->blocks;
+    mesh.blockCount = collisionGeometry->blockCount;
+    checkMesh(&mesh, &sweep, &hit);
+
+    // Triangles are stored in every tile they overlap, so the tiles the swept sphere overlaps hold every triangle it
+    // can touch. That is one tile, or up to four near a seam.
+    CollisionTileGrid *course = collisionGeometry->course;
+    if (course != NULL)
+    {
+        s32 minX = (s32)floorf(sweep.boundsMin[0] / course->tileSize);
+        s32 maxX = (s32)floorf(sweep.boundsMax[0] / course->tileSize);
+        s32 minZ = (s32)floorf(sweep.boundsMin[2] / course->tileSize);
+        s32 maxZ = (s32)floorf(sweep.boundsMax[2] / course->tileSize);
+
+        for (s32 z = minZ; z <= maxZ; z++)
+        {
+            for (s32 x = minX; x <= maxX; x++)
+            {
+                CollisionTile *tile = course->getTile(x, z);
+                if (tile == NULL)
+                {
+                    continue;
+                }
+                if (tile->triangles == NULL)
+                {
+                    course->misses.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
 
-        f32 collisionTime;
-        glm::vec3 intersectionPoint;
+                CollisionMesh tileMesh;
+                tileMesh.positions = (const u8 *)tile->positions;
+                tileMesh.positionStride = sizeof(glm::vec3);
+                tileMesh.triangles = tile->triangles;
+                tileMesh.blocks = tile->blocks;
+                tileMesh.blockCount = getCollisionBlockCount(tile->triangleCount);
+                checkMesh(&tileMesh, &sweep, &hit);
+            }
+        }
+    }
 
-        height = getCurrentHeight(p, normal);
+    // Height is measured from the triangles right under the ball, the ones it can land on, highest of every mesh and
+    // tile checked
+    if (hit.heightAbove > -FLT_MAX)
+    {
+        height = hit.heightAbove;
         if (height > maxHeight)
         {
             maxHeight = height;
         }
+    }
 
-        bool intersects = intersectsWithTriangle(p, normal, &collisionTime, intersectionPoint);
-
-        if (intersects && collisionTime <= dt && collisionTime >= 0.0F)
-        {
-            *outCollisionTime = collisionTime;
-            outIntersectionPoint = intersectionPoint;
-            outNormal = normal;
-            return true;
-        }
+    if (!hit.found)
+    {
+        return false;
     }
 
-    return false;
+    *outCollisionTime = hit.time;
+    outIntersectionPoint = hit.point;
+    outNormal = hit.normal;
+
+    profileCount(collisions, 1);
+    return true;
 }
 
 void Ball::integrate(f32 dt)
@@ -303,6 +386,8 @@ void Ball::integrate(f32 dt)
 
 void Ball::computeRebound(const glm::vec3 &surfaceNormal)
 {
+    ZoneScoped;
+
     const f32 e = 0.5F;
     const f32 mu = 0.4F;
     const f32 r = BALL_RADIUS;
@@ -377,6 +462,8 @@ void Ball::resolveCollision(const glm::vec3 &surfaceNormal)
 
 void Ball::simulateRolling(f32 dt)
 {
+    ZoneScoped;
+
     const f32 frictionMagnitude = 0.04F;
 
     acceleration = glm::vec3(0.0F);
@@ -468,36 +555,83 @@ void Ball::simulate(Wind *wind, CollisionGeometry *collisionGeometry, f32 dt)
     }
 }
 
+// The same as glm's rotations, through the sim's sine and cosine
+static glm::vec3 rotateAboutX(const glm::vec3 &v, f32 angle)
+{
+    f32 c = simCos(angle);
+    f32 s = simSin(angle);
+    return glm::vec3(v.x, v.y * c - v.z * s, v.y * s + v.z * c);
+}
+
+static glm::vec3 rotateAboutY(const glm::vec3 &v, f32 angle)
+{
+    f32 c = simCos(angle);
+    f32 s = simSin(angle);
+    return glm::vec3(v.x * c + v.z * s, v.y, -v.x * s + v.z * c);
+}
+
+static glm::vec3 rotateAboutZ(const glm::vec3 &v, f32 angle)
+{
+    f32 c = simCos(angle);
+    f32 s = simSin(angle);
+    return glm::vec3(v.x * c - v.y * s, v.x * s + v.y * c, v.z);
+}
+
 void BallManager::popBall()
 {
     bzero(&balls[activeBalls--], sizeof(Ball));
 }
 
-void BallManager::pushBall(f32 launchSpeed, f32 launchAngle, f32 launchHeading, f32 launchSpinRate, f32 spinAngle)
+void BallManager::pushBall(f32 launchSpeed,
+                           f32 launchAngle,
+                           f32 launchHeading,
+                           f32 launchSpinRate,
+                           f32 spinAngle,
+                           u32 bay,
+                           const BayTee *tee)
 {
     Ball *ball = &balls[activeBalls++];
 
     const f32 teeHeight = 0.0381F;  // 1.5 in
 
     ball->startPosition = glm::vec3(0.0F, teeHeight + BALL_RADIUS, 0.0F);
+    if (tee != NULL)
+    {
+        ball->startPosition += tee->position;
+    }
     ball->position = ball->startPosition;
 
     ball->state = BALL_STATE_FLYING;
 
     ball->gravityForce = gravityVec;
 
-    ball->velocity = glm::rotateX(glm::vec3(0.0F, 0.0F, launchSpeed), -launchAngle);
-    ball->velocity = glm::rotateY(ball->velocity, launchHeading);
+    ball->velocity = rotateAboutX(glm::vec3(0.0F, 0.0F, launchSpeed), -launchAngle);
+    ball->velocity = rotateAboutY(ball->velocity, launchHeading);
+
+    ball->rotationAxis = rotateAboutY(glm::vec3(1.0F, 0.0F, 0.0F), launchHeading);
+    ball->rotationAxis = rotateAboutZ(ball->rotationAxis, spinAngle);
 
-    ball->rotationAxis = glm::rotateY(glm::vec3(1.0F, 0.0F, 0.0F), launchHeading);
-    ball->rotationAxis = glm::rotateZ(ball->rotationAxis, spinAngle);
+    // The shot is set up as if the bay faced +z, then turned with it
+    if (tee != NULL)
+    {
+        ball->velocity = rotateAboutY(ball->velocity, tee->heading);
+        ball->rotationAxis = rotateAboutY(ball->rotationAxis, tee->heading);
+    }
 
     ball->launchSpinRate = launchSpinRate;
 
     ball->alive = true;
+    ball->bay = bay;
+    ball->plan = 0;
 }
 
-bool BallManager::spawnBall(f32 launchSpeed, f32 launchAngle, f32 launchHeading, f32 launchSpinRate, f32 spinAngle)
+bool BallManager::spawnBall(f32 launchSpeed,
+                            f32 launchAngle,
+                            f32 launchHeading,
+                            f32 launchSpinRate,
+                            f32 spinAngle,
+                            u32 bay,
+                            const BayTee *tee)
 {
     if (activeBalls >= MAX_BALLS)
     {
@@ -506,7 +640,7 @@ bool BallManager::spawnBall(f32 launchSpeed, f32 launchAngle, f32 launchHeading,
         return false;
     }
 
-    pushBall(launchSpeed, launchAngle, launchHeading, launchSpinRate, spinAngle);
+    pushBall(launchSpeed, launchAngle, launchHeading, launchSpinRate, spinAngle, bay, tee);
 
     return true;
 }
@@ -517,11 +651,214 @@ Ball *BallManager::getBall(size_t ballIndex)
     return ball;
 }
 
+u32 BallManager::clearRestingBalls(u32 *outNewIndices)
+{
+    size_t kept = 0;
+    for (size_t ballIndex = 0; ballIndex < activeBalls; ballIndex++)
+    {
+        if (balls[ballIndex].state == BALL_STATE_IDLE)
+        {
+            if (outNewIndices != NULL)
+            {
+                outNewIndices[ballIndex] = BALL_CLEARED;
+            }
+            continue;
+        }
+
+        if (outNewIndices != NULL)
+        {
+            outNewIndices[ballIndex] = (u32)kept;
+        }
+
+        if (kept != ballIndex)
+        {
+            balls[kept] = balls[ballIndex];
+        }
+        kept++;
+    }
+
+    u32 cleared = (u32)(activeBalls - kept);
+    bzero(&balls[kept], cleared * sizeof(Ball));
+    activeBalls = kept;
+
+    return cleared;
+}
+
+u32 BallContacts::getBucket(s32 x, s32 z) const
+{
+    return ((u32)x * 73856093U ^ (u32)z * 19349663U) & bucketMask;
+}
+
+void BallContacts::resolvePair(Ball *a, Ball *b)
+{
+    // Only balls on the same stretch of ground touch, their contact normal is kept level with it
+    glm::vec3 offset = b->position - a->position;
+    if (fabsf(offset.y) >= BALL_RADIUS)
+    {
+        return;
+    }
+
+    f32 distanceSquared = offset.x * offset.x + offset.z * offset.z;
+    const f32 touchingDistance = 2.0F * BALL_RADIUS;
+    if (distanceSquared >= touchingDistance * touchingDistance || distanceSquared == 0.0F)
+    {
+        return;
+    }
+
+    f32 distance = sqrtf(distanceSquared);
+    glm::vec3 normal(offset.x / distance, 0.0F, offset.z / distance);
+
+    // Push the pair apart so they don't sink into each other over the coming steps
+    glm::vec3 separation = (0.5F * (touchingDistance - distance)) * normal;
+    a->position -= separation;
+    b->position += separation;
+
+    // Equal masses, so the impulse is shared evenly
+    f32 approachSpeed = glm::dot(a->velocity - b->velocity, normal);
+    if (approachSpeed > 0.0F)
+    {
+        glm::vec3 impulse = (0.5F * (1.0F + BALL_CONTACT_RESTITUTION) * approachSpeed) * normal;
+        a->velocity -= impulse;
+        b->velocity += impulse;
+
+        a->state = BALL_STATE_ROLLING;
+        b->state = BALL_STATE_ROLLING;
+    }
+
+    contacts++;
+}
+
+void BallContacts::resolve(BallManager *ballManager)
+{
+    ZoneScoped;
+
+    candidateCount = 0;
+    pairsTested = 0;
+    contacts = 0;
+
+    for (size_t ballIndex = 0; ballIndex < ballManager->activeBalls; ballIndex++)
+    {
+        Ball *ball = ballManager->getBall(ballIndex);
+        if (ball->alive && (ball->state == BALL_STATE_ROLLING || ball->state == BALL_STATE_IDLE))
+        {
+            candidates[candidateCount++] = (u32)ballIndex;
+        }
+    }
+
+    if (candidateCount < 2)
+    {
+        return;
+    }
+
+    // About two buckets per ball keeps different cells from sharing one without clearing the whole table
+    u32 bucketCount = 16;
+    while (bucketCount < 2 * candidateCount && bucketCount < BALL_CONTACT_MAX_BUCKETS)
+    {
+        bucketCount *= 2;
+    }
+    bucketMask = bucketCount - 1;
+    bzero(bucketStarts, (bucketCount + 1) * sizeof(u32));
+
+    for (u32 candidateIndex = 0; candidateIndex < candidateCount; candidateIndex++)
+    {
+        const glm::vec3 &position = ballManager->getBall(candidates[candidateIndex])->position;
+        cellX[candidateIndex] = (s32)floorf(position.x / BALL_CONTACT_CELL_SIZE);
+        cellZ[candidateIndex] = (s32)floorf(position.z / BALL_CONTACT_CELL_SIZE);
+        buckets[candidateIndex] = getBucket(cellX[candidateIndex], cellZ[candidateIndex]);
+        bucketStarts[buckets[candidateIndex] + 1]++;
+    }
+
+    for (u32 bucket = 0; bucket < bucketCount; bucket++)
+    {
+        bucketStarts[bucket + 1] += bucketStarts[bucket];
+    }
+
+    // Filled in candidate order, so every bucket lists its balls in ball order and the pairs resolve the same way
+    // on every run. The starts are shifted up by one bucket while filling and end up back in place.
+    for (u32 candidateIndex = 0; candidateIndex < candidateCount; candidateIndex++)
+    {
+        sortedCandidates[bucketStarts[buckets[candidateIndex]]++] = candidateIndex;
+    }
+    for (u32 bucket = bucketCount; bucket > 0; bucket--)
+    {
+        bucketStarts[bucket] = bucketStarts[bucket - 1];
+    }
+    bucketStarts[0] = 0;
+
+    for (u32 candidateIndex = 0; candidateIndex < candidateCount; candidateIndex++)
+    {
+        Ball *ball = ballManager->getBall(candidates[candidateIndex]);
+
+        for (s32 z = cellZ[candidateIndex] - 1; z <= cellZ[candidateIndex] + 1; z++)
+        {
+            for (s32 x = cellX[candidateIndex] - 1; x <= cellX[candidateIndex] + 1; x++)
+            {
+                u32 bucket = getBucket(x, z);
+                for (u32 sortedIndex = bucketStarts[bucket]; sortedIndex < bucketStarts[bucket + 1]; sortedIndex++)
+                {
+                    // Each pair once, from its lower ball, and only from the cell the other ball is really in since
+                    // neighbouring cells can share a bucket
+                    u32 otherIndex = sortedCandidates[sortedIndex];
+                    if (otherIndex <= candidateIndex || cellX[otherIndex] != x || cellZ[otherIndex] != z)
+                    {
+                        continue;
+                    }
+
+                    pairsTested++;
+                    resolvePair(ball, ballManager->getBall(candidates[otherIndex]));
+                }
+            }
+        }
+    }
+}
+
 void World::update(CollisionGeometry *collisionGeometry, f32 dt)
 {
+    ZoneScoped;
+
+#ifdef TRACY_ENABLE
+    simulationCounters.trianglesTested = 0;
+    simulationCounters.collisions = 0;
+#endif
+
+    if (planner != NULL)
+    {
+        planner->beginStep(this, collisionGeometry, dt);
+    }
+
+    if (range != NULL)
+    {
+        range->update(this, collisionGeometry, dt);
+    }
+    else
+    {
+        for (size_t ballIndex = 0; ballIndex < ballManager.activeBalls; ballIndex++)
+        {
+            Ball *ball = ballManager.getBall(ballIndex);
+            if (planner == NULL || !planner->advance(ball))
+            {
+                ball->simulate(&wind, collisionGeometry, dt);
+            }
+        }
+    }
+
+#ifdef TRACY_ENABLE
+    u32 ballsInState[BALL_STATE_COUNT] = {};
     for (size_t ballIndex = 0; ballIndex < ballManager.activeBalls; ballIndex++)
     {
-        Ball *ball = ballManager.getBall(ballIndex);
-        ball->simulate(&wind, collisionGeometry, dt);
+        ballsInState[ballManager.getBall(ballIndex)->state]++;
     }
+#endif
+
+    if (contacts != NULL && contacts->enabled)
+    {
+        contacts->resolve(&ballManager);
+        TracyPlot("Ball Contacts", (s64)contacts->contacts);
+    }
+
+    TracyPlot("Balls Active", (s64)ballManager.activeBalls);
+    TracyPlot("Balls Flying", (s64)ballsInState[BALL_STATE_FLYING]);
+    TracyPlot("Balls Rolling", (s64)ballsInState[BALL_STATE_ROLLING]);
+    TracyPlot("Triangles Tested", (s64)simulationCounters.trianglesTested.load());
+    TracyPlot("Collisions", (s64)simulationCounters.collisions.load());
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #define MAX_BALLS 10000
+#define BALL_CLEARED 0xFFFFFFFFU
 #define MAX_COLLIDABLE_TRIANGLES 10000000
 #define MAX_VERTICES 10000000
 
@@ -10,6 +11,11 @@
 #define MIN_BOUNCE_HEIGHT 0.1F  // 50mm
 #define SPEED_EPSILON 0.0001F
 
+// Balls on the ground only touch balls in their own or a neighbouring cell of this size
+#define BALL_CONTACT_CELL_SIZE (2.0F * BALL_RADIUS)
+#define BALL_CONTACT_MAX_BUCKETS 32768  // Power of two, at least twice MAX_BALLS
+#define BALL_CONTACT_RESTITUTION 0.85F
+
 #define rpmToRadS(n) ((n) * 0.10471975511965977F)
 #define radSToRPM(n) ((n) * 9.549296585513727F)
 
@@ -18,12 +24,29 @@ const f32 k = 0.0008551855026042919F;
 
 const glm::vec3 gravityVec(0.0F, BALL_MASS * GRAVITY, 0.0F);
 
+// Per step counters that only exist to be plotted in the profiler, so they cost nothing when it is compiled out. Bays
+// are simulated on several threads, so they are atomic.
+#ifdef TRACY_ENABLE
+struct SimulationCounters
+{
+    std::atomic<u32> trianglesTested;
+    std::atomic<u32> collisions;
+};
+
+static SimulationCounters simulationCounters;
+
+#define profileCount(counter, n) (simulationCounters.counter.fetch_add((u32)(n), std::memory_order_relaxed))
+#else
+#define profileCount(counter, n)
+#endif
+
 struct Triangle
 {
     glm::vec3 normal;
+    f32 d;  // Plane constant, dot(normal, p) for any point p on the triangle
 
     // Indices to the vertices in the vertex buffer.
-    u16 a, b, c;
+    u32 a, b, c;
 };
 
 struct Vtx
@@ -32,6 +55,71 @@ struct Vtx
     glm::vec3 normal;
 };
 
+#define COLLISION_BLOCK_WIDTH 8
+#define getCollisionBlockCount(triangleCount) (((triangleCount) + COLLISION_BLOCK_WIDTH - 1) / COLLISION_BLOCK_WIDTH)
+
+// Eight triangles with everything the collision kernels test precomputed, one array per value so a single SIMD load
+// reads that value for every triangle. Unused lanes of the last block have empty bounds and never hit.
+struct CollisionBlock
+{
+    f32 normalX[COLLISION_BLOCK_WIDTH];
+    f32 normalY[COLLISION_BLOCK_WIDTH];
+    f32 normalZ[COLLISION_BLOCK_WIDTH];
+    f32 d[COLLISION_BLOCK_WIDTH];
+
+    // Planes through each edge, at right angles to the triangle and facing into it. A point on the triangle's plane is
+    // inside the triangle when it is in front of all three.
+    f32 edgeNormalX[3][COLLISION_BLOCK_WIDTH];
+    f32 edgeNormalY[3][COLLISION_BLOCK_WIDTH];
+    f32 edgeNormalZ[3][COLLISION_BLOCK_WIDTH];
+    f32 edgeD[3][COLLISION_BLOCK_WIDTH];
+
+    f32 boundsMinX[COLLISION_BLOCK_WIDTH];
+    f32 boundsMinY[COLLISION_BLOCK_WIDTH];
+    f32 boundsMinZ[COLLISION_BLOCK_WIDTH];
+    f32 boundsMaxX[COLLISION_BLOCK_WIDTH];
+    f32 boundsMaxY[COLLISION_BLOCK_WIDTH];
+    f32 boundsMaxZ[COLLISION_BLOCK_WIDTH];
+
+    u32 triangleIndices[COLLISION_BLOCK_WIDTH];
+};
+
+// A set of triangles with their blocks, either the loaded meshes or one course tile
+struct CollisionMesh
+{
+    const u8 *positions;  // Position of the first vertex, the next one is positionStride bytes further
+    size_t positionStride;
+    const Triangle *triangles;
+    const CollisionBlock *blocks;
+    size_t blockCount;
+};
+
+// One resident square of a streamed course, triangle indices are local to the tile
+struct CollisionTile
+{
+    const glm::vec3 *positions;
+    const Triangle *triangles;
+    const CollisionBlock *blocks;
+    u32 vertexCount;
+    u32 triangleCount;
+};
+
+// Lookup from grid coordinates to the course tiles, NULL where the course has no triangles. A tile that is not
+// resident has no positions or triangles.
+struct CollisionTileGrid
+{
+    CollisionTile **tiles;
+    s32 minX, minZ;
+    u32 width, depth;
+    f32 tileSize;
+
+    // Balls that needed a tile that was not resident, they fly through it instead of stalling the step
+    std::atomic<u32> misses;
+
+    bool covers(s32 x, s32 z) const;
+    CollisionTile *getTile(s32 x, s32 z) const;
+};
+
 struct CollisionGeometry
 {
     Vtx vertices[MAX_VERTICES];
@@ -39,6 +127,13 @@ struct CollisionGeometry
 
     size_t vertexCount;
     size_t triangleCount;
+
+    // The triangles above packed for the collision kernels, repacked whenever they change
+    CollisionBlock *blocks;
+    size_t blockCount;
+
+    // Streamed course tiles checked after the triangles above, NULL when no course is loaded
+    CollisionTileGrid *course;
 };
 
 struct Coefficients
@@ -54,6 +149,27 @@ struct Wind
     bool logWind;
 };
 
+struct CollisionSweep;
+
+// Earliest contact found so far in a step's collision checks
+struct CollisionHit
+{
+    f32 time;
+    glm::vec3 point;
+    glm::vec3 normal;
+    bool found;
+
+    // Highest distance above the triangles right under the ball, -FLT_MAX when none of the meshes checked has any
+    f32 heightAbove;
+};
+
+// Where a bay tees its balls up. The heading turns every shot from the bay about the tee.
+struct BayTee
+{
+    glm::vec3 position;
+    f32 heading;
+};
+
 enum BallState
 {
     BALL_STATE_IDLE,
@@ -85,6 +201,8 @@ public:
     f32 height;
     f32 maxHeight;
     bool alive;
+    u32 bay;   // Bay the ball was hit from
+    u32 plan;  // Handle of the flight plan it follows instead of being integrated, 0 for none yet
 
     void simulate(Wind *wind, CollisionGeometry *collisionGeometry, f32 dt);
 
@@ -93,19 +211,13 @@ private:
     void computeWindForce(Wind *wind);
     void computeLiftForce(const glm::vec3 &groundSpeed, f32 liftCoefficient);
     void computeDragForce(const glm::vec3 &groundSpeed, f32 dragCoefficient);
-    f32 getCurrentHeight(const glm::vec3 &a, const glm::vec3 &normal) const;
-
-    bool intersectsWithPlane(glm::vec3 &normal, f32 d, f32 *outCollisionTime, glm::vec3 &outIntersectionPoint) const;
-    bool intersectsWithTriangle(glm::vec3 &p,
-                                glm::vec3 &normal,
-                                f32 *outCollisionTime,
-                                glm::vec3 &outIntersectionPoint);
 
     bool checkCollision(CollisionGeometry *collisionGeometry,
                         f32 dt,
                         f32 *outCollisionTime,
                         glm::vec3 &outIntersectionPoint,
                         glm::vec3 &outNormal);
+    void checkMesh(const CollisionMesh *mesh, const CollisionSweep *sweep, CollisionHit *hit);
     void resolveCollision(const glm::vec3 &normal);
     void computeRebound(const glm::vec3 &surfaceNormal);
 
@@ -113,6 +225,9 @@ private:
     void simulateRolling(f32 dt);
 
     void integrate(f32 dt);
+
+    // Lets the benchmarks time the collision and rebound steps on their own
+    friend struct BallInternals;
 };
 
 struct BallManager
@@ -120,18 +235,76 @@ struct BallManager
     size_t activeBalls;
 
     void popBall();
-    void pushBall(f32 launchSpeed, f32 launchAngle, f32 launchHeading, f32 launchSpinRate, f32 spinAngle);
-    bool spawnBall(f32 launchSpeed, f32 launchAngle, f32 launchHeading, f32 launchSpinRate, f32 spinAngle);
+    // Without a tee the ball is hit from the origin towards +z
+    void pushBall(f32 launchSpeed,
+                  f32 launchAngle,
+                  f32 launchHeading,
+                  f32 launchSpinRate,
+                  f32 spinAngle,
+                  u32 bay = 0,
+                  const BayTee *tee = NULL);
+    bool spawnBall(f32 launchSpeed,
+                   f32 launchAngle,
+                   f32 launchHeading,
+                   f32 launchSpinRate,
+                   f32 spinAngle,
+                   u32 bay = 0,
+                   const BayTee *tee = NULL);
     Ball *getBall(size_t ballIndex);
+    // Drops the balls at rest, keeping the others in order. Returns how many were dropped. outNewIndices, when given,
+    // gets the index each of the balls that were active moved to, BALL_CLEARED for the dropped ones.
+    u32 clearRestingBalls(u32 *outNewIndices = NULL);
 
 private:
     Ball balls[MAX_BALLS];
 };
 
+// Resolves balls rolling or resting on the ground running into each other. Balls are hashed into a uniform grid
+// every step by a counting sort on their cell's bucket, into arrays sized for every ball, so a step never allocates
+// and each ball only checks the few balls in the cells around it.
+struct BallContacts
+{
+    bool enabled;
+
+    // Last step's counts
+    u32 candidateCount;
+    u32 pairsTested;
+    u32 contacts;
+
+    void resolve(BallManager *ballManager);
+
+private:
+    u32 candidates[MAX_BALLS];  // Indices of the balls on the ground, in ball order
+    s32 cellX[MAX_BALLS];
+    s32 cellZ[MAX_BALLS];
+    u32 buckets[MAX_BALLS];
+
+    // Candidates grouped by bucket, the ones of a bucket run from bucketStarts[b] to bucketStarts[b + 1]
+    u32 sortedCandidates[MAX_BALLS];
+    u32 bucketStarts[BALL_CONTACT_MAX_BUCKETS + 1];
+    u32 bucketMask;
+
+    u32 getBucket(s32 x, s32 z) const;
+    void resolvePair(Ball *a, Ball *b);
+};
+
+struct DrivingRange;
+struct FlightPlanner;
+
 struct World
 {
     BallManager ballManager;
-    Wind wind;
+    Wind wind;  // Blows over every bay that has no wind of its own
+
+    // Bays with their own tees, launch queues and winds, simulated in partitions across threads. NULL simulates every
+    // ball in one pass on the calling thread.
+    DrivingRange *range;
+
+    // Shared scratch for ball to ball contacts, NULL when they are never resolved
+    BallContacts *contacts;
+
+    // Flights solved once at launch that balls follow instead of being integrated, NULL when every ball is integrated
+    FlightPlanner *planner;
 
     void update(CollisionGeometry *collisionGeometry, f32 dt);
 };
\ No newline at end of file
@@ -8,12 +8,24 @@
 
 #include <glad/glad.h>
 
+#include <tracy/Tracy.hpp>
+#include <tracy/TracyOpenGL.hpp>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/norm.hpp>
 #include <glm/gtx/rotate_vector.hpp>
 
+// Both loaders allocate through the memory accounting in MemoryArena.cpp
+static void *assetMalloc(size_t size);
+static void *assetRealloc(void *memory, size_t size);
+static void assetFree(void *memory);
+
+#define STBI_MALLOC(size) assetMalloc(size)
+#define STBI_REALLOC(memory, size) assetRealloc(memory, size)
+#define STBI_FREE(memory) assetFree(memory)
+
 #include <cgltf.h>
 #include <stb_image.h>
 
@@ -23,12 +35,78 @@
 #include <spdlog/spdlog.h>
 #include <spdlog/fmt/fmt.h>
 
+#include <ctype.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
 #include "GolfFlightSim3D.hpp"
+#include "CollisionKernels.hpp"
+#include "Determinism.hpp"
 #include "MemoryArena.hpp"
+#include "MappedFile.hpp"
+#include "CookedAssets.hpp"
 #include "Main.hpp"
+#include "RenderQueue.hpp"
+#include "TracerTrails.hpp"
+#include "Culling.hpp"
+#include "TextureLoader.hpp"
+#include "PerfOverlay.hpp"
+#include "SimScheduler.hpp"
+#include "CourseStreamer.hpp"
+#include "CollisionImporter.hpp"
+#include "DrivingRange.hpp"
+#include "FlightPlanner.hpp"
+#include "ShotIngest.hpp"
+#include "WorldShare.hpp"
+#include "Checkpoint.hpp"
+#include "TrajectoryHistory.hpp"
 
 #include "GolfFlightSim3D.cpp"
+#include "CollisionKernels.cpp"
+#include "Determinism.cpp"
 #include "MemoryArena.cpp"
+#include "MappedFile.cpp"
+#include "RenderQueue.cpp"
+#include "TracerTrails.cpp"
+#include "Culling.cpp"
+#include "TextureLoader.cpp"
+#include "PerfOverlay.cpp"
+#include "SimScheduler.cpp"
+#include "CourseStreamer.cpp"
+#include "CollisionImporter.cpp"
+#include "DrivingRange.cpp"
+#include "FlightPlanner.cpp"
+#include "ShotIngest.cpp"
+#include "WorldShare.cpp"
+#include "Checkpoint.cpp"
+#include "TrajectoryHistory.cpp"
 // clang-format on
 
 #define GIGABYTES(n) ((n) * 1024ULL * 1024ULL * 1024ULL)
@@ -141,13 +219,16 @@ static CameraID currentCamera = CAMERA_3;
 
 static bool wireframe = false;
 static bool showForceVectors = true;
+static bool showTracers = true;
+static bool showPerformance = false;
+static bool ballContacts = false;
+static s32 shownBay = -1;  // Bay the scene and UI are filtered to, -1 shows every bay
 
 static glm::mat4 projection;
 static glm::mat4 view;
 
 static f32 elapsedTime = 0.0F;
 static f32 deltaTime = 1.0F / 60.0F;
-static f32 accumulator = 0.0F;
 
 static void onResize(GLFWwindow *window, s32 width, s32 height)
 {
@@ -167,7 +248,6 @@ static void onKeyPressed(GLFWwindow *window, int key, int scancode, int action,
 {
     (void)window;
     (void)mods;
-    (void)action;
     (void)scancode;
 
     switch (key)
@@ -202,6 +282,14 @@ static void onKeyPressed(GLFWwindow *window, int key, int scancode, int action,
             wireframe = false;
             break;
         }
+        case GLFW_KEY_P:
+        {
+            if (action == GLFW_PRESS)
+            {
+                showPerformance = !showPerformance;
+            }
+            break;
+        }
         default:
         {
             break;
@@ -319,9 +407,24 @@ static ColorRGBA getColorRGBA(Color color)
     return result;
 }
 
+static void *cgltfAlloc(void *user, cgltf_size size)
+{
+    (void)user;
+    return assetMalloc(size);
+}
+
+static void cgltfFree(void *user, void *memory)
+{
+    (void)user;
+    assetFree(memory);
+}
+
 static bool loadGLTF(const char *filepath, Mesh *result)
 {
     cgltf_options options = {};
+    options.memory.alloc_func = cgltfAlloc;
+    options.memory.free_func = cgltfFree;
+
     cgltf_data *gltfData = NULL;
     if (cgltf_parse_file(&options, filepath, &gltfData) != cgltf_result_success)
     {
@@ -329,11 +432,17 @@ static bool loadGLTF(const char *filepath, Mesh *result)
         return false;
     }
 
-    cgltf_load_buffers(&options, gltfData, filepath);
+    if (cgltf_load_buffers(&options, gltfData, filepath) != cgltf_result_success)
+    {
+        spdlog::error("Could not load buffers for \"{}\"", filepath);
+        cgltf_free(gltfData);
+        return false;
+    }
 
     cgltf_mesh *mesh = &gltfData->meshes[0];
     cgltf_primitive *primitive = &mesh->primitives[0];
 
+    cgltf_accessor *positionAccessor = NULL;
     cgltf_buffer_view *positionData = NULL;
     cgltf_buffer_view *normalData = NULL;
     cgltf_buffer_view *colorData = NULL;
@@ -347,6 +456,7 @@ static bool loadGLTF(const char *filepath, Mesh *result)
         {
             case cgltf_attribute_type_position:
             {
+                positionAccessor = attribute->data;
                 positionData = attribute->data->buffer_view;
                 break;
             }
@@ -376,21 +486,25 @@ static bool loadGLTF(const char *filepath, Mesh *result)
     if (positionData == NULL)
     {
         spdlog::error("No position data for \"{}\"", filepath);
+        cgltf_free(gltfData);
         return false;
     }
     if (normalData == NULL)
     {
         spdlog::error("No normal data for \"{}\"", filepath);
+        cgltf_free(gltfData);
         return false;
     }
     if (colorData == NULL)
     {
         spdlog::error("No color data for \"{}\"", filepath);
+        cgltf_free(gltfData);
         return false;
     }
     if (uvData == NULL)
     {
         spdlog::error("No UV data for \"{}\"", filepath);
+        cgltf_free(gltfData);
         return false;
     }
 
@@ -414,88 +528,98 @@ static bool loadGLTF(const char *filepath, Mesh *result)
 
     result->vertexCount = primitive->indices->count;
 
-    return true;
-}
-
-bool GolfFlightSim3D::loadTexture(TextureID textureID,
-                                  const char *filepath,
-                                  GLint wrapS = GL_REPEAT,
-                                  GLint wrapT = GL_REPEAT)
-{
-    s32 width, height, comp;
-    u8 *pixels = stbi_load(filepath, &width, &height, &comp, STBI_rgb_alpha);
-    if (pixels == NULL)
+    switch (primitive->indices->component_type)
     {
-        spdlog::error("Failed to load \"{}\"", filepath);
-        return false;
+        case cgltf_component_type_r_8u:
+        {
+            result->indexType = GL_UNSIGNED_BYTE;
+            break;
+        }
+        case cgltf_component_type_r_16u:
+        {
+            result->indexType = GL_UNSIGNED_SHORT;
+            break;
+        }
+        case cgltf_component_type_r_32u:
+        {
+            result->indexType = GL_UNSIGNED_INT;
+            break;
+        }
+        default:
+        {
+            spdlog::error("Unsupported index type for \"{}\"", filepath);
+            cgltf_free(gltfData);
+            return false;
+        }
     }
 
-    glGenTextures(1, &renderer->textures[textureID]);
-    glBindTexture(GL_TEXTURE_2D, renderer->textures[textureID]);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, (const GLvoid *)pixels);
-    glGenerateMipmap(GL_TEXTURE_2D);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapS);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapT);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // The buffers stay alive until the caller has uploaded them and releases gltfData
+    result->gltfData = gltfData;
 
-    stbi_image_free((void *)pixels);
+    if (positionAccessor->has_min && positionAccessor->has_max)
+    {
+        result->boundsMin = glm::vec3(positionAccessor->min[0], positionAccessor->min[1], positionAccessor->min[2]);
+        result->boundsMax = glm::vec3(positionAccessor->max[0], positionAccessor->max[1], positionAccessor->max[2]);
+    }
+    else
+    {
+        // Bounds are required by the spec for positions, but don't cull anything we can't bound
+        result->boundsMin = glm::vec3(-FLT_MAX);
+        result->boundsMax = glm::vec3(FLT_MAX);
+    }
 
     return true;
 }
 
-void GolfFlightSim3D::loadCollidableGeometry(Mesh *mesh)
+static_assert(sizeof(Vertex) == sizeof(CookedVertex), "Cooked vertex layout must match Vertex");
+
+void GolfFlightSim3D::loadCollidableGeometryCooked(const CookedMeshHeader *header,
+                                                   const Vertex *vertices,
+                                                   const CookedCollisionTriangle *triangles,
+                                                   const glm::mat4 &transform)
 {
-    size_t numVertices = mesh->vertexDataSize / sizeof(Vertex);
+    size_t baseVertexIndex = collidableTriangles->vertexCount;
+    size_t baseTriangleIndex = collidableTriangles->triangleCount;
 
-    for (size_t baseVertexIndex = collidableTriangles->vertexCount;
-         baseVertexIndex < collidableTriangles->vertexCount + numVertices; baseVertexIndex++)
+    if (baseVertexIndex + header->vertexCount > MAX_VERTICES ||
+        baseTriangleIndex + header->collisionTriangleCount > MAX_COLLIDABLE_TRIANGLES)
     {
-        Vtx *vertex = &collidableTriangles->vertices[baseVertexIndex];
-
-        size_t vertexIndex = baseVertexIndex - collidableTriangles->vertexCount;
-
-        u8 *basePtr = (u8 *)mesh->vertexData;
-
-        vertex->position = *((glm::vec3 *)(basePtr + (size_t)mesh->positionDataOffset) + vertexIndex);
-        vertex->normal = *((glm::vec3 *)(basePtr + (size_t)mesh->normalDataOffset) + vertexIndex);
+        spdlog::error("Collision geometry does not fit in the collision buffers");
+        return;
     }
 
-    collidableTriangles->vertexCount += numVertices;
-
-    size_t numTriangles = mesh->vertexCount / 3;
-
-    for (size_t baseTriangleIndex = collidableTriangles->triangleCount;
-         baseTriangleIndex < collidableTriangles->triangleCount + numTriangles; baseTriangleIndex++)
+    glm::mat3 normalTransform = glm::transpose(glm::inverse(glm::mat3(transform)));
+    for (size_t vertexIndex = 0; vertexIndex < header->vertexCount; vertexIndex++)
     {
-        Triangle *triangle = &collidableTriangles->triangles[baseTriangleIndex];
-
-        size_t triangleIndex = baseTriangleIndex - collidableTriangles->triangleCount;
-
-        size_t offsetA = (triangleIndex * 3) * sizeof(u16);
-        size_t offsetB = ((triangleIndex * 3) + 1) * sizeof(u16);
-        size_t offsetC = ((triangleIndex * 3) + 2) * sizeof(u16);
-
-        triangle->a = *((u8 *)mesh->indexData + offsetA);
-        triangle->b = *((u8 *)mesh->indexData + offsetB);
-        triangle->c = *((u8 *)mesh->indexData + offsetC);
+        Vtx *vertex = &collidableTriangles->vertices[baseVertexIndex + vertexIndex];
+        glm::vec4 worldPosition = transform * glm::vec4(vertices[vertexIndex].position, 1.0F);
+        vertex->position = glm::vec3(worldPosition.x, worldPosition.y, worldPosition.z);
+        vertex->normal = glm::normalize(normalTransform * vertices[vertexIndex].normal);
+    }
 
-        glm::vec3 n0 = collidableTriangles->vertices[triangle->a].normal;
-        glm::vec3 n1 = collidableTriangles->vertices[triangle->b].normal;
-        glm::vec3 n2 = collidableTriangles->vertices[triangle->c].normal;
+    for (size_t triangleIndex = 0; triangleIndex < header->collisionTriangleCount; triangleIndex++)
+    {
+        const CookedCollisionTriangle *cooked = &triangles[triangleIndex];
+        Triangle *triangle = &collidableTriangles->triangles[baseTriangleIndex + triangleIndex];
 
-        glm::vec3 triangleNormal = glm::normalize((n0 + n1 + n2) / 3.0F);
+        triangle->a = (u32)(baseVertexIndex + cooked->a);
+        triangle->b = (u32)(baseVertexIndex + cooked->b);
+        triangle->c = (u32)(baseVertexIndex + cooked->c);
 
-        triangle->normal = triangleNormal;
+        // The cooked plane is in the mesh's own space, it moves with the transform
+        glm::vec3 normal(cooked->normal[0], cooked->normal[1], cooked->normal[2]);
+        triangle->normal = glm::normalize(normalTransform * normal);
+        triangle->d = glm::dot(triangle->normal, collidableTriangles->vertices[triangle->a].position);
     }
 
-    collidableTriangles->triangleCount += numTriangles;
+    collidableTriangles->vertexCount += header->vertexCount;
+    collidableTriangles->triangleCount += header->collisionTriangleCount;
 }
 
 void GolfFlightSim3D::loadMesh(MeshID meshId,
-                               Vertex *vertexData,
-                               u16 *indexData,
+                               const Vertex *vertexData,
+                               const GLvoid *indexData,
+                               GLenum indexType,
                                size_t vertexDataSize,
                                size_t indexDataSize,
                                size_t vertexCount)
@@ -550,10 +674,101 @@ void GolfFlightSim3D::loadMesh(MeshID meshId,
     glBindVertexArray(NULL);
 
     renderer->vertexCounts[meshId] = (GLuint)vertexCount;
+    renderer->indexTypes[meshId] = indexType;
 }
 
-bool GolfFlightSim3D::loadMeshGLTF(MeshID meshId, const char *filepath, bool collidable = false)
+// Every index of the draw list and the collision triangles has to name a vertex of the file, or drawing and
+// collision would read past the vertex section
+static bool cookedMeshIndicesValid(const CookedMeshHeader *header, const u8 *data)
 {
+    const u32 *indices = (const u32 *)(data + header->indexDataOffset);
+    for (u32 indexIndex = 0; indexIndex < header->indexCount; indexIndex++)
+    {
+        if (indices[indexIndex] >= header->vertexCount)
+        {
+            return false;
+        }
+    }
+
+    const CookedCollisionTriangle *triangles = (const CookedCollisionTriangle *)(data + header->collisionDataOffset);
+    for (u32 triangleIndex = 0; triangleIndex < header->collisionTriangleCount; triangleIndex++)
+    {
+        const CookedCollisionTriangle *triangle = &triangles[triangleIndex];
+        if (triangle->a >= header->vertexCount || triangle->b >= header->vertexCount ||
+            triangle->c >= header->vertexCount)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool GolfFlightSim3D::loadMeshCooked(MeshID meshId, const char *filepath, const glm::mat4 *collisionTransform)
+{
+    ZoneScoped;
+    ZoneText(filepath, strlen(filepath));
+
+    MappedFile file;
+    if (!file.open(filepath))
+    {
+        return false;
+    }
+
+    const CookedMeshHeader *header = (const CookedMeshHeader *)file.data;
+
+    bool valid = file.size >= sizeof(CookedMeshHeader) && header->magic == COOKED_MESH_MAGIC &&
+                 header->version == COOKED_MESH_VERSION &&
+                 header->vertexDataOffset + (u64)header->vertexCount * sizeof(CookedVertex) <= file.size &&
+                 header->indexDataOffset + (u64)header->indexCount * sizeof(u32) <= file.size &&
+                 header->collisionDataOffset + (u64)header->collisionTriangleCount * sizeof(CookedCollisionTriangle) <=
+                     file.size &&
+                 cookedMeshIndicesValid(header, file.data);
+    if (!valid)
+    {
+        spdlog::warn("Ignoring stale or corrupt cooked mesh \"{}\"", filepath);
+        file.close();
+        return false;
+    }
+
+    // The mapping is handed to GL as is, the only copy made is the driver's own
+    const Vertex *vertices = (const Vertex *)(file.data + header->vertexDataOffset);
+    const u32 *indices = (const u32 *)(file.data + header->indexDataOffset);
+
+    loadMesh(meshId, vertices, indices, GL_UNSIGNED_INT, header->vertexCount * sizeof(Vertex),
+             header->indexCount * sizeof(u32), header->indexCount);
+
+    glm::vec3 boundsMin(header->boundsMin[0], header->boundsMin[1], header->boundsMin[2]);
+    glm::vec3 boundsMax(header->boundsMax[0], header->boundsMax[1], header->boundsMax[2]);
+    setMeshBounds(meshId, boundsMin, boundsMax);
+
+    if (collisionTransform != NULL)
+    {
+        const CookedCollisionTriangle *triangles =
+            (const CookedCollisionTriangle *)(file.data + header->collisionDataOffset);
+        loadCollidableGeometryCooked(header, vertices, triangles, *collisionTransform);
+    }
+
+    file.close();
+
+    return true;
+}
+
+bool GolfFlightSim3D::loadMeshGLTF(MeshID meshId, const char *filepath, const glm::mat4 *collisionTransform = NULL)
+{
+    ZoneScoped;
+    ZoneText(filepath, strlen(filepath));
+
+    // Prefer the cooked version of the file produced by the AssetCooker, if there is an up to date one next to it
+    char cookedFilepath[512];
+    if (cookedAssetPath(cookedFilepath, sizeof(cookedFilepath), filepath, COOKED_MESH_EXTENSION) &&
+        loadMeshCooked(meshId, cookedFilepath, collisionTransform))
+    {
+        return true;
+    }
+
+    spdlog::debug("No cooked mesh for \"{}\", parsing glTF", filepath);
+
     Mesh mesh;
 
     if (!loadGLTF(filepath, &mesh))
@@ -612,47 +827,77 @@ bool GolfFlightSim3D::loadMeshGLTF(MeshID meshId, const char *filepath, bool col
     glBindVertexArray(NULL);
 
     renderer->vertexCounts[meshId] = (GLuint)mesh.vertexCount;
+    renderer->indexTypes[meshId] = mesh.indexType;
+
+    setMeshBounds(meshId, mesh.boundsMin, mesh.boundsMax);
 
-    if (collidable)
+    if (collisionTransform != NULL)
     {
-        loadCollidableGeometry(&mesh);
+        f64 importStartTime = getTime();
+
+        CollisionImporter importer;
+        if (importer.import(mesh.gltfData, filepath, *collisionTransform, collidableTriangles))
+        {
+            spdlog::info("Collision: Imported {} primitives of \"{}\" in {:.2f} ms on {} threads",
+                         importer.primitiveCount, filepath, (getTime() - importStartTime) * 1000.0,
+                         importer.workerCount);
+        }
     }
 
+    cgltf_free(mesh.gltfData);
+
     return true;
 }
 
+void GolfFlightSim3D::setMeshBounds(MeshID meshId, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax)
+{
+    if (boundsMax.x < boundsMin.x || boundsMax.x - boundsMin.x >= FLT_MAX)
+    {
+        // Unbounded, never cull
+        renderer->boundsCenters[meshId] = glm::vec3(0.0F);
+        renderer->boundsRadii[meshId] = FLT_MAX;
+        return;
+    }
+
+    renderer->boundsCenters[meshId] = (boundsMin + boundsMax) * 0.5F;
+    renderer->boundsRadii[meshId] = glm::length(boundsMax - boundsMin) * 0.5F;
+}
+
+bool GolfFlightSim3D::meshIsVisible(MeshID meshId, glm::mat4 *transform, const Frustum *frustum)
+{
+    f32 radius = renderer->boundsRadii[meshId];
+    if (radius >= FLT_MAX)
+    {
+        return true;
+    }
+
+    glm::mat4 &m = *transform;
+    glm::vec4 center = m * glm::vec4(renderer->boundsCenters[meshId], 1.0F);
+
+    // Scale the radius by the largest axis scale so the sphere stays conservative under non-uniform scaling
+    f32 scaleSq = glm::max(glm::max(glm::length2(glm::vec3(m[0].x, m[0].y, m[0].z)),
+                                    glm::length2(glm::vec3(m[1].x, m[1].y, m[1].z))),
+                           glm::length2(glm::vec3(m[2].x, m[2].y, m[2].z)));
+
+    return frustum->intersectsSphere(glm::vec3(center.x, center.y, center.z), radius * sqrtf(scaleSq));
+}
+
 void GolfFlightSim3D::drawTextured(glm::mat4 *model,
                                    GLenum mode,
                                    MeshID meshId,
                                    TextureID textureID,
                                    f32 uvScale = 1.0F)
 {
-    glm::mat4 modelViewProjection = projection * view * *model;
-    OpenGLProgram *texturedVertexProgram = &renderer->programs[OPENGL_PROGRAM_TEXTURED_VERTICES];
-
-    glUseProgram(texturedVertexProgram->id);
-
-    glBindVertexArray(renderer->vertexArrays[meshId]);
-    glUniformMatrix4fv((GLint)texturedVertexProgram->modelViewProjectionUniform, 1, GL_FALSE,
-                       glm::value_ptr(modelViewProjection));
-    glUniform1f((GLint)texturedVertexProgram->uvScaleUniform, uvScale);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, renderer->textures[textureID]);
-
-    if (wireframe)
-    {
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-    }
-    else
+    RenderCommand *command = renderQueue->push(OPENGL_PROGRAM_TEXTURED_VERTICES, meshId, textureID);
+    if (command == NULL)
     {
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        return;
     }
 
-    glDrawElements(mode, (GLsizei)renderer->vertexCounts[meshId], GL_UNSIGNED_SHORT, 0);
-    glBindVertexArray(0);
-
-    glUseProgram(0);
+    command->modelViewProjection = projection * view * *model;
+    command->uvScale = uvScale;
+    command->mode = mode;
+    command->wireframe = wireframe;
 }
 
 void GolfFlightSim3D::drawTexturedTriangles(glm::mat4 *model, MeshID meshId, TextureID textureID, f32 uvScale = 1.0F)
@@ -694,30 +939,19 @@ void GolfFlightSim3D::drawTexturedMesh(MeshID meshId, glm::mat4 *transform, Text
 
 void GolfFlightSim3D::drawColored(glm::mat4 *model, GLenum mode, MeshID meshId, f32 r, f32 g, f32 b, f32 a)
 {
-    glm::mat4 modelViewProjection = projection * view * *model;
-    OpenGLProgram *coloredVertexProgram = &renderer->programs[OPENGL_PROGRAM_COLORED_VERTICES];
-
-    glUseProgram(coloredVertexProgram->id);
-
-    glBindVertexArray(renderer->vertexArrays[meshId]);
-    glUniformMatrix4fv((GLint)coloredVertexProgram->modelViewProjectionUniform, 1, GL_FALSE,
-                       glm::value_ptr(modelViewProjection));
-
-    glUniform4f((GLint)coloredVertexProgram->colorUniform, r, g, b, a);
-
-    if (wireframe)
+    RenderCommand *command = renderQueue->push(OPENGL_PROGRAM_COLORED_VERTICES, meshId, TEXTURE_NONE);
+    if (command == NULL)
     {
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+        return;
     }
-    else
-    {
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    }
-
-    glDrawElements(mode, (GLsizei)renderer->vertexCounts[meshId], GL_UNSIGNED_SHORT, 0);
-    glBindVertexArray(0);
 
-    glUseProgram(0);
+    command->modelViewProjection = projection * view * *model;
+    command->color[0] = r;
+    command->color[1] = g;
+    command->color[2] = b;
+    command->color[3] = a;
+    command->mode = mode;
+    command->wireframe = wireframe;
 }
 
 void GolfFlightSim3D::drawColoredTriangles(glm::mat4 *model, MeshID meshId, f32 r, f32 g, f32 b, f32 a)
@@ -783,6 +1017,22 @@ void GolfFlightSim3D::drawVector(const glm::vec3 &v, const glm::vec3 &origin, Co
     stack.pop();
 }
 
+const u32 *GolfFlightSim3D::getShownBalls(u32 *outCount)
+{
+    if (shownBay < 0)
+    {
+        *outCount = (u32)world->ballManager.activeBalls;
+        return NULL;
+    }
+
+    return world->range->getBayBalls((u32)shownBay, &world->ballManager, outCount);
+}
+
+Wind *GolfFlightSim3D::getShownWind()
+{
+    return shownBay < 0 ? &world->wind : world->range->getWind(world, (u32)shownBay);
+}
+
 void GolfFlightSim3D::drawWindArrow(f32 x, f32 y, f32 scale)
 {
     MatrixStack stack;
@@ -792,7 +1042,7 @@ void GolfFlightSim3D::drawWindArrow(f32 x, f32 y, f32 scale)
     stack.push();
     stack.translate(x, y, 0.5F);
     stack.rotateX(glm::radians(18.0F));
-    stack.rotateY(world->wind.direction);
+    stack.rotateY(getShownWind()->direction);
     stack.scale(scale, scale * aspect, scale);
     drawMesh(MESH_ARROW, stack.top(), 0.0F, 0.75F, 1.0F, 1.0F);
     stack.pop();
@@ -810,21 +1060,102 @@ bool GolfFlightSim3D::initialize()
         return false;
     }
 
-    world = (World *)mainArena.allocateFromArena(sizeof(World));
-    previous = (World *)mainArena.allocateFromArena(sizeof(World));
-    collidableTriangles = (CollisionGeometry *)mainArena.allocateFromArena(sizeof(CollisionGeometry));
-    renderer = (OpenGLRenderer *)mainArena.allocateFromArena(sizeof(OpenGLRenderer));
+    world = (World *)mainArena.allocateFromArena(sizeof(World), MEMORY_TAG_WORLD);
+    previous = (World *)mainArena.allocateFromArena(sizeof(World), MEMORY_TAG_WORLD);
+    collidableTriangles =
+        (CollisionGeometry *)mainArena.allocateFromArena(sizeof(CollisionGeometry), MEMORY_TAG_COLLISION);
+    renderer = (OpenGLRenderer *)mainArena.allocateFromArena(sizeof(OpenGLRenderer), MEMORY_TAG_RENDERER);
+    renderQueue = (RenderQueue *)mainArena.allocateFromArena(sizeof(RenderQueue), MEMORY_TAG_RENDERER);
+    tracerTrails = (TracerTrails *)mainArena.allocateFromArena(sizeof(TracerTrails), MEMORY_TAG_RENDERER);
+    ballVisibility = (BallVisibility *)mainArena.allocateFromArena(sizeof(BallVisibility), MEMORY_TAG_RENDERER);
+    perfOverlay = (PerfOverlay *)mainArena.allocateFromArena(sizeof(PerfOverlay), MEMORY_TAG_RENDERER);
+    simScheduler = (SimScheduler *)mainArena.allocateFromArena(sizeof(SimScheduler), MEMORY_TAG_WORLD);
+    courseStreamer = (CourseStreamer *)mainArena.allocateFromArena(sizeof(CourseStreamer), MEMORY_TAG_COLLISION);
+
+    world->contacts = (BallContacts *)mainArena.allocateFromArena(sizeof(BallContacts), MEMORY_TAG_WORLD);
+    world->contacts->enabled = ballContacts;
+
+    // Owns worker threads and locks, so it is constructed in place rather than used as zeroed memory
+    world->range = new (mainArena.allocateFromArena(sizeof(DrivingRange), MEMORY_TAG_WORLD)) DrivingRange();
+    world->range->initialize(getDrivingRangeConfig());
+
+    shotIngest = NULL;
+    if (getShotIngestConfig()->path != NULL)
+    {
+        shotIngest = new (mainArena.allocateFromArena(sizeof(ShotIngest), MEMORY_TAG_WORLD)) ShotIngest();
+    }
+
+    worldShare = NULL;
+    viewingSharedWorld = getWorldShareConfig()->mode == WORLD_SHARE_VIEW;
+    ballEpoch = 0;
+    if (getWorldShareConfig()->mode != WORLD_SHARE_OFF)
+    {
+        worldShare = (WorldShare *)mainArena.allocateFromArena(sizeof(WorldShare), MEMORY_TAG_WORLD);
+    }
+
+    checkpoint = NULL;
+    if (getCheckpointConfig()->path != NULL)
+    {
+        checkpoint = new (mainArena.allocateFromArena(sizeof(Checkpoint), MEMORY_TAG_WORLD)) Checkpoint();
+        checkpoint->initialize(getCheckpointConfig());
+    }
+
+    // Solves launches on its own threads, so like the range it is constructed in place. Shots could land on course
+    // tiles that aren't loaded yet when they are solved, so it is left off when a course is streamed.
+    world->planner = NULL;
+    if (getFlightPlannerConfig()->enabled && getCourseStreamerConfig()->path != NULL)
+    {
+        spdlog::warn("Flight planner: Not used with a streamed course, every ball is integrated");
+    }
+    else if (getFlightPlannerConfig()->enabled && !viewingSharedWorld)
+    {
+        world->planner = new (mainArena.allocateFromArena(sizeof(FlightPlanner), MEMORY_TAG_WORLD)) FlightPlanner();
+        world->planner->initialize(getFlightPlannerConfig());
+    }
 
-    glfwSetFramebufferSizeCallback(_windowHandle, onResize);
-    glfwSetKeyCallback(_windowHandle, onKeyPressed);
+    stateHashes = NULL;
+    if (getDeterminismConfig()->enabled || getDeterminismConfig()->hashPath != NULL)
+    {
+        stateHashes = (StateHashLog *)mainArena.allocateFromArena(sizeof(StateHashLog), MEMORY_TAG_WORLD);
+    }
+
+    trajectoryHistory = NULL;
+    if (getTrajectoryHistoryConfig()->budget != 0)
+    {
+        trajectoryHistory =
+            (TrajectoryHistory *)mainArena.allocateFromArena(sizeof(TrajectoryHistory), MEMORY_TAG_WORLD);
+    }
+
+    // Headless output has to be the same however fast the machine is, so it never drops simulated time
+    SimSchedulerConfig schedulerConfig = *getSimSchedulerConfig();
+    if (_headless)
+    {
+        schedulerConfig.frameBudget = 0.0F;
+    }
+    simScheduler->initialize(&schedulerConfig, deltaTime);
+
+    if (!_headless)
+    {
+        glfwSetFramebufferSizeCallback(_windowHandle, onResize);
+        glfwSetKeyCallback(_windowHandle, onKeyPressed);
+    }
 
     return true;
 }
 
 bool GolfFlightSim3D::load()
 {
+    ZoneScopedN("Load Assets");
+
     Application::load();
 
+    TracyPlotConfig("Balls Active", tracy::PlotFormatType::Number, true, false, 0);
+    TracyPlotConfig("Balls Flying", tracy::PlotFormatType::Number, true, false, 0);
+    TracyPlotConfig("Balls Rolling", tracy::PlotFormatType::Number, true, false, 0);
+    TracyPlotConfig("Triangles Tested", tracy::PlotFormatType::Number, true, false, 0);
+    TracyPlotConfig("Collisions", tracy::PlotFormatType::Number, true, false, 0);
+    TracyPlotConfig("Ball Contacts", tracy::PlotFormatType::Number, true, false, 0);
+
     glEnable(GL_BLEND);
     glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
@@ -835,16 +1166,56 @@ bool GolfFlightSim3D::load()
     openGLCreateProgram(&renderer->programs[OPENGL_PROGRAM_TEXTURED_VERTICES], texturedVertexShader,
                         texturedFragmentShader);
 
-    loadTexture(TEXTURE_SKYBOX_SKY, "./assets/textures/skybox_sky.png");
-    loadTexture(TEXTURE_SKYBOX_BG, "./assets/textures/skybox_bg.png", GL_REPEAT, GL_CLAMP_TO_EDGE);
-    loadTexture(TEXTURE_SKYBOX_GROUND, "./assets/textures/skybox_ground.png");
-    loadTexture(TEXTURE_FAIRWAY, "./assets/textures/fairway.png");
-    loadTexture(TEXTURE_GOLF_BALL, "./assets/textures/golf_ball.png");
+    TextureLoadRequest textureRequests[] = {
+        {TEXTURE_SKYBOX_SKY, "./assets/textures/skybox_sky.png", GL_REPEAT, GL_REPEAT},
+        {TEXTURE_SKYBOX_BG, "./assets/textures/skybox_bg.png", GL_REPEAT, GL_CLAMP_TO_EDGE},
+        {TEXTURE_SKYBOX_GROUND, "./assets/textures/skybox_ground.png", GL_REPEAT, GL_REPEAT},
+        {TEXTURE_FAIRWAY, "./assets/textures/fairway.png", GL_REPEAT, GL_REPEAT},
+        {TEXTURE_GOLF_BALL, "./assets/textures/golf_ball.png", GL_REPEAT, GL_REPEAT},
+    };
+
+    f64 textureLoadStartTime = getTime();
+
+    TextureLoader textureLoader;
+    textureLoader.load(textureRequests, arrayCount(textureRequests), renderer->textures);
+
+    spdlog::info("Assets: Textures loaded in {:.2f} ms ({} cooked, {} decoded)",
+                 (getTime() - textureLoadStartTime) * 1000.0, textureLoader.cookedCount,
+                 textureLoader.decodedCount);
+
+    world->wind.direction = glm::radians(180.0F);
+    world->wind.speed = 0.0F;
+    world->wind.logWind = false;
+
+    // A streamed course takes over collision from the flat ground, which is still drawn. The ground collides where
+    // it is drawn, scaled up from the unit plane.
+    const CourseStreamerConfig *courseConfig = getCourseStreamerConfig();
+    const char *groundPath = "./assets/primitives/plane.glb";
+    glm::mat4 groundTransform = glm::scale(glm::mat4(1.0F), glm::vec3(GROUND_SCALE));
+    const glm::mat4 *groundCollision = courseConfig->path == NULL ? &groundTransform : NULL;
+
+    // A checkpoint of the same collidable meshes brings their packed geometry back with the session, so they are only
+    // loaded to be drawn
+    bool restored = false;
+    if (checkpoint != NULL)
+    {
+        f64 restoreStartTime = getTime();
+        u64 geometryKey = groundCollision != NULL ? hashCheckpointSource(0, groundPath, groundCollision) : 0;
+        restored = checkpoint->restore(world, collidableTriangles, geometryKey);
+        if (restored)
+        {
+            spdlog::info("Assets: Session and collision geometry restored in {:.2f} ms",
+                         (getTime() - restoreStartTime) * 1000.0);
+        }
+    }
+
+    f64 meshLoadStartTime = getTime();
 
-    loadMeshGLTF(MESH_GROUND, "./assets/primitives/plane.glb", true);
+    loadMeshGLTF(MESH_GROUND, groundPath, restored ? NULL : groundCollision);
     loadMeshGLTF(MESH_SPHERE, "./assets/primitives/sphere.glb");
-    loadMesh(MESH_LINE, lineVertexData, lineIndexData, sizeof(lineVertexData), sizeof(lineIndexData),
-             arrayCount(lineIndexData));
+    loadMesh(MESH_LINE, lineVertexData, lineIndexData, GL_UNSIGNED_SHORT, sizeof(lineVertexData),
+             sizeof(lineIndexData), arrayCount(lineIndexData));
+    setMeshBounds(MESH_LINE, glm::vec3(0.0F), glm::vec3(1.0F));
 
     loadMeshGLTF(MESH_SKYBOX_SKY, "./assets/models/skybox_sky.glb");
     loadMeshGLTF(MESH_SKYBOX_BG, "./assets/models/skybox_bg.glb");
@@ -854,39 +1225,243 @@ bool GolfFlightSim3D::load()
 
     loadMeshGLTF(MESH_ARROW, "./assets/models/arrow.glb");
 
-    world->wind.direction = glm::radians(180.0F);
-    world->wind.speed = 0.0F;
-    world->wind.logWind = false;
+    spdlog::info("Assets: Meshes loaded in {:.2f} ms", (getTime() - meshLoadStartTime) * 1000.0);
+
+    // Sized by what was actually loaded, the arena would have to hold blocks for the largest possible geometry
+    if (!restored)
+    {
+        collidableTriangles->blockCount = getCollisionBlockCount(collidableTriangles->triangleCount);
+        collidableTriangles->blocks =
+            (CollisionBlock *)malloc(std::max(collidableTriangles->blockCount, (size_t)1) * sizeof(CollisionBlock));
+        if (collidableTriangles->blocks == NULL)
+        {
+            spdlog::error("Failed to allocate {} collision blocks", collidableTriangles->blockCount);
+            return false;
+        }
+        trackAllocation(MEMORY_TAG_COLLISION, collidableTriangles->blocks,
+                        std::max(collidableTriangles->blockCount, (size_t)1) * sizeof(CollisionBlock));
+        packCollisionBlocks((const u8 *)&collidableTriangles->vertices[0].position, sizeof(Vtx),
+                            collidableTriangles->triangles, collidableTriangles->triangleCount,
+                            collidableTriangles->blocks);
+    }
+    spdlog::info("Collision: {} triangles in {} blocks, {} kernel", collidableTriangles->triangleCount,
+                 collidableTriangles->blockCount, getCollisionKernelName(getCollisionKernelType()));
+
+    tracerTrails->initialize(&renderer->programs[OPENGL_PROGRAM_COLORED_VERTICES]);
+    ballVisibility->initialize(&renderer->programs[OPENGL_PROGRAM_COLORED_VERTICES]);
+    perfOverlay->initialize();
+
+    if (courseConfig->path != NULL)
+    {
+        if (!courseStreamer->open(courseConfig))
+        {
+            return false;
+        }
+        collidableTriangles->course = &courseStreamer->grid;
+    }
+
+    // Shots start coming in as soon as the reader is up, so the range has to be ready for them
+    if (shotIngest != NULL && !shotIngest->open(getShotIngestConfig()))
+    {
+        return false;
+    }
+
+    if (worldShare != NULL && !worldShare->open(getWorldShareConfig()))
+    {
+        return false;
+    }
+
+    if (stateHashes != NULL && !stateHashes->open(getDeterminismConfig()->hashPath))
+    {
+        return false;
+    }
+
+    if (trajectoryHistory != NULL && !trajectoryHistory->initialize(getTrajectoryHistoryConfig()))
+    {
+        return false;
+    }
+
+    logMemoryReport(&mainArena);
 
     return true;
 }
 
+void GolfFlightSim3D::unload()
+{
+    world->range->shutdown();
+    simScheduler->logReport();
+
+    if (world->planner != NULL)
+    {
+        world->planner->shutdown();
+        world->planner->logReport();
+    }
+
+    // Taken before the collision blocks are freed below, so the next start picks up where this one left off
+    if (checkpoint != NULL)
+    {
+        checkpoint->close(world, collidableTriangles);
+        checkpoint->logReport();
+    }
+
+    if (shotIngest != NULL)
+    {
+        shotIngest->logReport();
+        shotIngest->close();
+    }
+
+    if (worldShare != NULL)
+    {
+        worldShare->close();
+    }
+
+    if (stateHashes != NULL)
+    {
+        stateHashes->close();
+    }
+
+    if (trajectoryHistory != NULL)
+    {
+        trajectoryHistory->logReport();
+        trajectoryHistory->shutdown();
+    }
+
+    if (collidableTriangles->course != NULL)
+    {
+        courseStreamer->logReport();
+        courseStreamer->close();
+        collidableTriangles->course = NULL;
+    }
+
+    if (collidableTriangles->blocks != NULL)
+    {
+        trackFree(MEMORY_TAG_COLLISION, collidableTriangles->blocks,
+                  std::max(collidableTriangles->blockCount, (size_t)1) * sizeof(CollisionBlock));
+        free(collidableTriangles->blocks);
+        collidableTriangles->blocks = NULL;
+        collidableTriangles->blockCount = 0;
+    }
+
+    Application::unload();
+}
+
 void GolfFlightSim3D::update(float frameTime)
 {
-    accumulator += frameTime;
+    f64 frameStartTime = getTime();
+    perfOverlay->beginFrame(frameStartTime);
 
-    while (accumulator >= deltaTime)
+    // Viewers draw the steps another process simulates instead of taking any of their own
+    if (viewingSharedWorld)
+    {
+        bool ballsMoved;
+        if (worldShare->view(world, &ballsMoved))
+        {
+            if (ballsMoved)
+            {
+                tracerTrails->reset();
+                if (trajectoryHistory != NULL)
+                {
+                    trajectoryHistory->closeTracks();
+                }
+            }
+            tracerTrails->record(&world->ballManager);
+
+            if (trajectoryHistory != NULL)
+            {
+                trajectoryHistory->record(&world->ballManager, deltaTime);
+            }
+        }
+        perfOverlay->endUpdate(0);
+        return;
+    }
+
+    simScheduler->beginFrame(frameTime, frameStartTime);
+
+    if (collidableTriangles->course != NULL)
+    {
+        courseStreamer->update(&world->ballManager, cameras[currentCamera].target, simScheduler->getFrameLookahead());
+    }
+
+    u32 stepCount = 0;
+    f64 stepStartTime = frameStartTime;
+    while (simScheduler->nextStep(stepStartTime))
     {
         previous = world;
 
+        // Trails follow ball indices, which clearing balls to make room for ingested shots changes
+        if (shotIngest != NULL && shotIngest->spawnQueued(&world->ballManager, world->range))
+        {
+            tracerTrails->reset();
+            ballEpoch++;
+
+            if (trajectoryHistory != NULL)
+            {
+                trajectoryHistory->moveBalls(shotIngest->recycledIndices, shotIngest->recycledBallCount);
+            }
+        }
+
         world->update(collidableTriangles, deltaTime);
 
-        accumulator -= deltaTime;
+        if (stateHashes != NULL)
+        {
+            stateHashes->record(world);
+        }
+
+        if (trajectoryHistory != NULL)
+        {
+            trajectoryHistory->record(&world->ballManager, deltaTime);
+        }
+
+        if (worldShare != NULL)
+        {
+            worldShare->publish(world, ballEpoch);
+        }
+
+        if (checkpoint != NULL)
+        {
+            checkpoint->update(world, collidableTriangles, deltaTime);
+        }
+
+        tracerTrails->record(&world->ballManager);
+
+        f64 stepEndTime = getTime();
+        perfOverlay->recordSimStep(stepEndTime - stepStartTime);
+        stepStartTime = stepEndTime;
+        stepCount++;
+
+        FrameMarkNamed("Sim Step");
     }
+
+    simScheduler->endFrame(stepStartTime);
+
+    if (worldShare != NULL)
+    {
+        worldShare->updateReaders();
+    }
+
+    perfOverlay->endUpdate(stepCount);
 }
 
 void GolfFlightSim3D::renderScene(f32 frameTime)
 {
+    ZoneScoped;
     (void)frameTime;
 
+    perfOverlay->beginRender(getTime());
+
+    renderQueue->beginFrame();
+
     Camera *camera = &cameras[currentCamera];
     glm::vec3 target = camera->target;
 
     BallManager *ballManager = &world->ballManager;
 
-    if (ballManager->activeBalls > 0 && currentCamera == CAMERA_3)
+    u32 shownCount;
+    const u32 *shownBalls = getShownBalls(&shownCount);
+
+    if (shownCount > 0 && currentCamera == CAMERA_3)
     {
-        size_t currentBallIndex = ballManager->activeBalls - 1;
+        size_t currentBallIndex = shownBalls != NULL ? shownBalls[shownCount - 1] : shownCount - 1;
         camera->position = ballManager->getBall(currentBallIndex)->position + glm::vec3(-0.6F, 1.05F, -3.0F);
         target = ballManager->getBall(currentBallIndex)->position;
     }
@@ -902,52 +1477,125 @@ void GolfFlightSim3D::renderScene(f32 frameTime)
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    glm::mat4 viewProjection = projection * view;
+
+    Frustum frustum;
+    frustum.extract(viewProjection);
+
     MatrixStack stack;
 
     stack.push();
-    stack.rotateY(elapsedTime * world->wind.speed * 0.00033F);
+    stack.rotateY(elapsedTime * getShownWind()->speed * 0.00033F);
     stack.scale(1000.0F);
     stack.translate(0.0F, -0.1F, 0.0F);
-    drawMesh(MESH_SKYBOX_SKY, stack.top(), TEXTURE_SKYBOX_SKY);
+    if (meshIsVisible(MESH_SKYBOX_SKY, stack.top(), &frustum))
+    {
+        drawMesh(MESH_SKYBOX_SKY, stack.top(), TEXTURE_SKYBOX_SKY);
+    }
     stack.pop();
 
     stack.push();
     stack.scale(1000.0F);
     stack.translate(0.0F, -0.1F, 0.0F);
-    drawMesh(MESH_SKYBOX_GROUND, stack.top(), TEXTURE_SKYBOX_GROUND);
-    drawMesh(MESH_SKYBOX_BG, stack.top(), TEXTURE_SKYBOX_BG);
+    if (meshIsVisible(MESH_SKYBOX_GROUND, stack.top(), &frustum))
+    {
+        drawMesh(MESH_SKYBOX_GROUND, stack.top(), TEXTURE_SKYBOX_GROUND);
+    }
+    if (meshIsVisible(MESH_SKYBOX_BG, stack.top(), &frustum))
+    {
+        drawMesh(MESH_SKYBOX_BG, stack.top(), TEXTURE_SKYBOX_BG);
+    }
     stack.pop();
 
     stack.push();
-    stack.scale(1000.0F);
-    drawMesh(MESH_GROUND, stack.top(), TEXTURE_FAIRWAY, 1000.0F);
+    stack.scale(GROUND_SCALE);
+    if (meshIsVisible(MESH_GROUND, stack.top(), &frustum))
+    {
+        drawMesh(MESH_GROUND, stack.top(), TEXTURE_FAIRWAY, GROUND_SCALE);
+    }
     stack.pop();
 
-    f32 alpha = accumulator / deltaTime;
+    // A catch-up backlog can hold more than one step, which must not extrapolate past the latest step
+    f32 alpha = std::min(simScheduler->accumulator / deltaTime, 1.0F);
 
     BallManager *ballManagerCurrentIteration = &world->ballManager;
     BallManager *ballManagerPreviousIteration = &previous->ballManager;
 
-    for (size_t ballIndex = 0; ballIndex < world->ballManager.activeBalls; ballIndex++)
+    // Visibility is worked out per shown ball, so a filtered view only classifies the balls of its bay
+    for (u32 shownIndex = 0; shownIndex < shownCount; shownIndex++)
     {
+        size_t ballIndex = shownBalls != NULL ? shownBalls[shownIndex] : shownIndex;
+        glm::vec3 &previousPosition = ballManagerPreviousIteration->getBall(ballIndex)->position;
+        glm::vec3 &currentPosition = ballManagerCurrentIteration->getBall(ballIndex)->position;
+        glm::vec3 interpolatedPosition = glm::mix(previousPosition, currentPosition, alpha);
+
+        // Balls following a flight plan are drawn on its curve rather than on the line between their steps
+        if (world->planner != NULL)
+        {
+            world->planner->samplePosition(ballManagerCurrentIteration->getBall(ballIndex), alpha,
+                                           &interpolatedPosition);
+        }
+        ballVisibility->setCenter(shownIndex, interpolatedPosition);
+    }
+
+    // Number of pixels covered by one unit of length at unit distance from the camera
+    f32 pixelsPerUnit = projection[1][1] * (f32)_windowHeight * 0.5F;
+    ballVisibility->classify(&frustum, viewProjection, pixelsPerUnit, shownCount);
+    ballVisibility->beginPoints();
+
+    for (u32 shownIndex = 0; shownIndex < shownCount; shownIndex++)
+    {
+        size_t ballIndex = shownBalls != NULL ? shownBalls[shownIndex] : shownIndex;
         Ball *ballCurrentIteration = ballManagerCurrentIteration->getBall(ballIndex);
         Ball *ballPreviousIteration = ballManagerPreviousIteration->getBall(ballIndex);
 
         glm::vec3 &previousPosition = ballPreviousIteration->position;
         glm::vec3 &currentPosition = ballCurrentIteration->position;
         glm::vec3 interpolatedPosition = glm::mix(previousPosition, currentPosition, alpha);
+        if (world->planner != NULL)
+        {
+            world->planner->samplePosition(ballCurrentIteration, alpha, &interpolatedPosition);
+        }
 
-        stack.push();
-        stack.translate(interpolatedPosition);
-        drawMesh(MESH_GOLF_BALL, stack.top(), TEXTURE_GOLF_BALL);
-        stack.pop();
+        if (ballVisibility->visible[shownIndex])
+        {
+            switch (ballVisibility->lod[shownIndex])
+            {
+                case BALL_LOD_FULL:
+                {
+                    stack.push();
+                    stack.translate(interpolatedPosition);
+                    drawMesh(MESH_GOLF_BALL, stack.top(), TEXTURE_GOLF_BALL);
+                    stack.pop();
+                    break;
+                }
+                case BALL_LOD_LOW:
+                {
+                    stack.push();
+                    stack.translate(interpolatedPosition);
+                    stack.scale(BALL_RADIUS);
+                    drawMesh(MESH_SPHERE, stack.top(), WHITE);
+                    stack.pop();
+                    break;
+                }
+                case BALL_LOD_POINT:
+                {
+                    ballVisibility->pushPoint(interpolatedPosition);
+                    break;
+                }
+                default:
+                {
+                    invalidDefaultCase;
+                }
+            }
+        }
 
         if (glm::length2(ballCurrentIteration->velocity) <= FLT_EPSILON || !showForceVectors)
         {
             continue;
         }
 
-        glDisable(GL_DEPTH_TEST);
+        renderQueue->layer = RENDER_LAYER_OVERLAY;
 
         // Gravity
         drawVector(ballCurrentIteration->gravityForce * INV_BALL_MASS, interpolatedPosition, CYAN);
@@ -970,12 +1618,37 @@ void GolfFlightSim3D::renderScene(f32 frameTime)
         // Rotation axis
         drawVector(ballCurrentIteration->rotationAxis, interpolatedPosition, WHITE);
 
-        glEnable(GL_DEPTH_TEST);
+        renderQueue->layer = RENDER_LAYER_SCENE;
+    }
+
+    {
+        TracyGpuZone("Scene");
+        renderQueue->flush(renderer);
+    }
+
+    if (ballVisibility->lodCounts[BALL_LOD_POINT] > 0)
+    {
+        TracyGpuZone("Ball Points");
+        ballVisibility->drawPoints(&renderer->programs[OPENGL_PROGRAM_COLORED_VERTICES], viewProjection,
+                                   getColorRGBA(WHITE));
+        renderQueue->frameStats.drawCalls++;
+    }
+
+    if (showTracers)
+    {
+        ZoneScopedN("Tracers");
+        TracyGpuZone("Tracers");
+        tracerTrails->upload(world->ballManager.activeBalls);
+        tracerTrails->draw(&renderer->programs[OPENGL_PROGRAM_COLORED_VERTICES], viewProjection, shownBalls,
+                           shownCount, ColorRGBA(1.0F, 0.85F, 0.2F, 1.0F));
+        renderQueue->frameStats.drawCalls++;
     }
 }
 
 void GolfFlightSim3D::renderUI(f32 frameTime)
 {
+    ZoneScopedN("Build UI");
+
     view = glm::mat4(1.0F);
 
     f32 top = 1.0F;
@@ -990,7 +1663,12 @@ void GolfFlightSim3D::renderUI(f32 frameTime)
     const f32 arrowPosX = 1.0F - 0.2F;
     const f32 arrowPosY = 1.0F - (4.0F / 15.0F);
     const f32 arrowScale = 0.08F;
+    renderQueue->layer = RENDER_LAYER_UI;
     drawWindArrow(arrowPosX, arrowPosY, arrowScale);
+    {
+        TracyGpuZone("Wind Arrow");
+        renderQueue->flush(renderer);
+    }
 
     const ImGuiWindowFlags standardWindowFlags = ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove |
                                                  ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoTitleBar;
@@ -1035,31 +1713,92 @@ void GolfFlightSim3D::renderUI(f32 frameTime)
         ImGui::Separator();
         ImGui::Spacing();
 
+        DrivingRange *range = world->range;
+        if (range->bayCount > 1)
+        {
+            ImGui::Text("Bays");
+            ImGui::Spacing();
+
+            s32 bayNumber = shownBay + 1;
+            ImGui::SliderInt("Shown Bay", &bayNumber, 0, (s32)range->bayCount, bayNumber == 0 ? "All" : "%d");
+            shownBay = bayNumber - 1;
+        }
+
+        if (shownBay >= 0)
+        {
+            Bay *bay = &range->bays[shownBay];
+
+            ImGui::DragFloat3("Tee Position (m)", &bay->tee.position.x, 0.1F);
+            ImGui::SliderAngle("Tee Heading (deg)", &bay->tee.heading, -45.0F, 45.0F);
+
+            // Replaces the range's wind for this bay only
+            ImGui::Checkbox("Local wind", &bay->hasLocalWind);
+            if (bay->hasLocalWind)
+            {
+                f32 localWindSpeedMph = msToMph(bay->localWind.speed);
+                ImGui::SliderFloat("Local Wind Speed (mph)", &localWindSpeedMph, 0.0F, 30.0F);
+                ImGui::SliderAngle("Local Wind Heading (deg)", &bay->localWind.direction, 0.0F, 360.0F);
+                bay->localWind.speed = mphToMs(localWindSpeedMph);
+                bay->localWind.logWind = world->wind.logWind;
+            }
+        }
+
+        if (range->bayCount > 1)
+        {
+            ImGui::Spacing();
+            ImGui::Separator();
+            ImGui::Spacing();
+        }
+
         ImGui::Text("Misc.");
         ImGui::Spacing();
 
         ImGui::Checkbox("Show forces", &showForceVectors);
+        ImGui::Checkbox("Show tracers", &showTracers);
+        ImGui::Checkbox("Show performance", &showPerformance);
+        ImGui::Checkbox("Ball contacts", &world->contacts->enabled);
 
         ImGui::Spacing();
         ImGui::Separator();
         ImGui::Spacing();
 
-        if (ImGui::Button("Launch Ball"))
+        // Shots are queued on their bay and launched at the start of the next step. Viewers don't simulate any.
+        const char *launchLabel = shownBay < 0 && range->bayCount > 1 ? "Launch From Every Bay" : "Launch Ball";
+        if (!viewingSharedWorld && ImGui::Button(launchLabel))
         {
-            f32 launchSpeedMs = mphToMs(launchSpeedMph);
-            f32 launchAngleRadians = glm::radians(launchAngleDegrees);
-            f32 launchHeadingRadians = glm::radians(launchHeadingDegrees);
-
-            f32 spinAngleRadians = glm::radians(spinAngleDegrees);
-            world->ballManager.spawnBall(launchSpeedMs, launchAngleRadians, launchHeadingRadians, launchSpinRate,
-                                         spinAngleRadians);
+            LaunchRequest request;
+            request.speed = mphToMs(launchSpeedMph);
+            request.angle = glm::radians(launchAngleDegrees);
+            request.heading = glm::radians(launchHeadingDegrees);
+            request.spinRate = launchSpinRate;
+            request.spinAngle = glm::radians(spinAngleDegrees);
+
+            u32 firstBay = shownBay < 0 ? 0 : (u32)shownBay;
+            u32 lastBay = shownBay < 0 ? range->bayCount : firstBay + 1;
+            for (u32 bayIndex = firstBay; bayIndex < lastBay; bayIndex++)
+            {
+                if (!range->queueLaunch(bayIndex, &request))
+                {
+                    spdlog::warn("Bay {} has {} shots waiting already", bayIndex + 1, BAY_LAUNCH_QUEUE_SIZE);
+                }
+            }
         }
 
-        ImGui::SameLine();
+        if (!viewingSharedWorld)
+        {
+            ImGui::SameLine();
+        }
 
-        if (ImGui::Button("Clear Balls"))
+        if (!viewingSharedWorld && ImGui::Button("Clear Balls"))
         {
             bzero(&world->ballManager, sizeof(BallManager));
+            tracerTrails->reset();
+            ballEpoch++;
+
+            if (trajectoryHistory != NULL)
+            {
+                trajectoryHistory->closeTracks();
+            }
         }
 
         launchParamWindowWidth = ImGui::GetWindowWidth();
@@ -1079,8 +1818,12 @@ void GolfFlightSim3D::renderUI(f32 frameTime)
         {
             BallManager *ballManager = &world->ballManager;
 
-            for (size_t ballIndex = 0; ballIndex < ballManager->activeBalls; ballIndex++)
+            u32 shownCount;
+            const u32 *shownBalls = getShownBalls(&shownCount);
+
+            for (u32 shownIndex = 0; shownIndex < shownCount; shownIndex++)
             {
+                size_t ballIndex = shownBalls != NULL ? shownBalls[shownIndex] : shownIndex;
                 Ball *ball = ballManager->getBall(ballIndex);
 
                 ImGui::TableNextRow();
@@ -1150,28 +1893,147 @@ void GolfFlightSim3D::renderUI(f32 frameTime)
     if (ImGui::Begin("Counters", NULL, standardWindowFlags))
     {
         ImGui::Text("Balls Spawned: %d", (s32)world->ballManager.activeBalls);
+        ImGui::Text("Bays: %u (%u partitions on %u threads)", world->range->bayCount, world->range->partitionCount,
+                    world->range->ranInParallel ? world->range->workerCount : 1);
+
+        if (shotIngest != NULL)
+        {
+            const ShotIngestStats *ingestStats = &shotIngest->stats;
+            ImGui::Text("Ingest: %llu shots queued, %llu spawned, %llu bad lines%s",
+                        (unsigned long long)ingestStats->shotsQueued.load(),
+                        (unsigned long long)ingestStats->shotsSpawned,
+                        (unsigned long long)ingestStats->parseErrors.load(),
+                        shotIngest->isFinished() ? ", input ended" : "");
+        }
+
+        if (worldShare != NULL)
+        {
+            const WorldShareStats *shareStats = &worldShare->stats;
+            if (viewingSharedWorld)
+            {
+                ImGui::Text("Viewing step %llu, %llu steps behind (%.1f ms), %llu skipped, %llu torn reads",
+                            (unsigned long long)shareStats->step, (unsigned long long)shareStats->stepLag,
+                            shareStats->timeLag * 1000.0, (unsigned long long)shareStats->skippedSteps,
+                            (unsigned long long)shareStats->tornReads);
+            }
+            else
+            {
+                ImGui::Text("Viewers: %u, furthest behind %llu steps (%.1f ms)", shareStats->readerCount,
+                            (unsigned long long)shareStats->maxReaderLag,
+                            (f64)shareStats->maxReaderLag * deltaTime * 1000.0);
+            }
+        }
+
+        if (checkpoint != NULL)
+        {
+            const CheckpointStats *checkpointStats = &checkpoint->stats;
+            ImGui::Text("Checkpoints: %u written, %u skipped, the last %.1f MiB in %.1f ms (%.2f ms stalled)",
+                        checkpointStats->writes.load(), checkpointStats->skippedWrites,
+                        (f64)checkpointStats->lastWriteSize.load() / (1024.0 * 1024.0),
+                        checkpointStats->lastWriteTime.load() * 1000.0, checkpointStats->lastSnapshotTime * 1000.0);
+        }
+
+        if (stateHashes != NULL)
+        {
+            ImGui::Text("State hash: %016llx at step %llu%s", (unsigned long long)stateHashes->lastHash,
+                        (unsigned long long)stateHashes->step,
+                        getDeterminismConfig()->enabled ? " (deterministic)" : "");
+        }
+
+        if (world->planner != NULL)
+        {
+            const FlightPlannerStats *plannerStats = &world->planner->stats;
+            ImGui::Text("Flight plans: %u balls following one, %u waiting, %llu solved in %.2f ms each",
+                        plannerStats->plannedBalls, plannerStats->pendingBalls,
+                        (unsigned long long)plannerStats->plansSolved,
+                        plannerStats->solveTime * 1000.0 / (f64)std::max(plannerStats->plansSolved, (u64)1));
+        }
+
+        if (trajectoryHistory != NULL)
+        {
+            const TrajectoryHistoryStats *historyStats = &trajectoryHistory->stats;
+            f64 ratio = (f64)historyStats->encodedSamples * sizeof(glm::vec3) /
+                        (f64)std::max(historyStats->encodedBytes, (u64)1);
+            ImGui::Text("History: %u tracks in %.1f MiB, %.1fx smaller than glm::vec3, %llu positions dropped",
+                        trajectoryHistory->trackCount, (f64)historyStats->encodedBytes / (1024.0 * 1024.0), ratio,
+                        (unsigned long long)historyStats->droppedSamples);
+        }
 
         ImGui::Spacing();
 
-        ImGui::Text("FPS: %.2f", 1.0F / frameTime);
+        ImGui::Text("FPS: %.2f", ImGui::GetIO().Framerate);
+
+        const SimSchedulerStats *simStats = &simScheduler->total;
+        ImGui::Text("Sim Speed: %.0f%% (dropped %.2f s in %u overloaded frames)", simScheduler->dilation * 100.0F,
+                    simStats->droppedTime, simStats->overloadedFrames);
 
-        s32 width, height;
-        glfwGetWindowSize(_windowHandle, &width, &height);
+        if (world->contacts->enabled)
+        {
+            ImGui::Text("Ball Contacts: %u (%u pairs tested, %u balls on the ground)", world->contacts->contacts,
+                        world->contacts->pairsTested, world->contacts->candidateCount);
+        }
 
-        ImGui::SetWindowPos(ImVec2(0, (f32)height - ImGui::GetWindowHeight()));
+        if (collidableTriangles->course != NULL)
+        {
+            const CourseStreamerStats *courseStats = &courseStreamer->stats;
+            ImGui::Text("Course Tiles: %u resident (%.1f MiB), %llu loads, %llu evictions, %u misses",
+                        courseStats->residentTiles, bytesToMiB(courseStats->residentBytes),
+                        (unsigned long long)courseStats->loads, (unsigned long long)courseStats->evictions,
+                        collidableTriangles->course->misses.load());
+        }
+
+        ImGui::Spacing();
+
+        RenderStats *renderStats = &renderQueue->lastFrameStats;
+        ImGui::Text("Draw Calls: %u", renderStats->drawCalls);
+        ImGui::Text("State Changes: %u (program %u, vao %u, texture %u, raster %u)", renderStats->stateChanges,
+                    renderStats->programChanges, renderStats->vertexArrayChanges, renderStats->textureChanges,
+                    renderStats->rasterStateChanges);
+        ImGui::Text("Uniform Uploads: %u", renderStats->uniformUploads);
+        ImGui::Text("Tracer Points Uploaded: %u", tracerTrails->pointsUploaded);
+
+        ImGui::Spacing();
+
+        ImGui::Text("Balls Culled: %u", ballVisibility->culledCount);
+        ImGui::Text("Ball LODs: %u full, %u low, %u points", ballVisibility->lodCounts[BALL_LOD_FULL],
+                    ballVisibility->lodCounts[BALL_LOD_LOW], ballVisibility->lodCounts[BALL_LOD_POINT]);
+
+        ImGui::Spacing();
+
+        for (u32 tagIndex = 0; tagIndex < MEMORY_TAG_COUNT; tagIndex++)
+        {
+            MemoryTagStats *stats = getMemoryTagStats((MemoryTag)tagIndex);
+            ImGui::Text("%s Memory: %.2f MiB (peak %.2f MiB)", getMemoryTagName((MemoryTag)tagIndex),
+                        bytesToMiB(stats->current.load()), bytesToMiB(stats->peak.load()));
+        }
+
+        ImVec2 displaySize = ImGui::GetIO().DisplaySize;
+        ImGui::SetWindowPos(ImVec2(0, displaySize.y - ImGui::GetWindowHeight()));
     }
     ImGui::End();
 
+    if (showPerformance)
+    {
+        ImGui::SetNextWindowBgAlpha(0.6F);
+        if (ImGui::Begin("Performance", NULL, standardWindowFlags))
+        {
+            perfOverlay->draw();
+
+            ImVec2 displaySize = ImGui::GetIO().DisplaySize;
+            ImGui::SetWindowPos(ImVec2(displaySize.x - ImGui::GetWindowWidth(), displaySize.y * 0.35F));
+        }
+        ImGui::End();
+    }
+
     ImGui::SetNextWindowBgAlpha(bgAlpha);
     if (ImGui::Begin("Info Hint", NULL, standardWindowFlags))
     {
         ImGui::Text("Cameras: 1-3");
+        ImGui::Text("Performance: P");
         ImGui::Text("Quit: ESC");
 
-        s32 width, height;
-        glfwGetWindowSize(_windowHandle, &width, &height);
-
-        ImGui::SetWindowPos(ImVec2((f32)width - ImGui::GetWindowWidth(), (f32)height - ImGui::GetWindowHeight()));
+        ImVec2 displaySize = ImGui::GetIO().DisplaySize;
+        ImGui::SetWindowPos(ImVec2(displaySize.x - ImGui::GetWindowWidth(), displaySize.y - ImGui::GetWindowHeight()));
     }
     ImGui::End();
 
@@ -1180,13 +2042,191 @@ void GolfFlightSim3D::renderUI(f32 frameTime)
     elapsedTime += frameTime;
 }
 
+void GolfFlightSim3D::afterRender(f32 frameTime)
+{
+    (void)frameTime;
+
+    // After the UI is drawn, so its draw counts towards the frame's render time
+    perfOverlay->endRender(getTime());
+}
+
+static void printUsage()
+{
+    fprintf(stderr, "Usage: GolfFlightSim3D [--headless] [--frames <count>] [--size <width>x<height>]\n");
+    fprintf(stderr, "                       [--capture <video.y4m | frame_%%05u.ppm>]\n");
+    fprintf(stderr, "                       [--memory-budget <world|collision|renderer|assets>=<size>[K|M|G]]...\n");
+    fprintf(stderr, "                       [--sim-budget <ms>] [--sim-max-steps <count>]\n");
+    fprintf(stderr, "                       [--sim-overload <dilate|catch-up>] [--sim-max-backlog <ms>]\n");
+    fprintf(stderr, "                       [--course <course%s>] [--course-cache <size>[K|M|G]]\n",
+            COOKED_COURSE_EXTENSION);
+    fprintf(stderr, "                       [--collision-kernel <scalar|sse2|avx2>] [--ball-contacts]\n");
+    fprintf(stderr, "                       [--bays <count>] [--bay-spacing <m>] [--sim-threads <count>]\n");
+    fprintf(stderr, "                       [--ingest <shots.csv | shots.ndjson | ->] [--ingest-rate <count>]\n");
+    fprintf(stderr, "                       [--publish | --view] [--share-name </name>]\n");
+    fprintf(stderr, "                       [--checkpoint <session.gcheckpoint>] [--checkpoint-interval <s>]\n");
+    fprintf(stderr, "                       [--deterministic] [--state-hash <hashes.txt>]\n");
+    fprintf(stderr, "                       [--history <size>[K|M|G]]\n");
+    fprintf(stderr, "                       [--precompute-flight] [--planner-threads <count>]\n");
+}
+
 int main(int argc, char *argv[])
 {
-    (void)argc;
-    (void)argv;
+    ApplicationOptions options;
+
+    for (s32 argIndex = 1; argIndex < argc; argIndex++)
+    {
+        const char *arg = argv[argIndex];
+        const char *value = argIndex + 1 < argc ? argv[argIndex + 1] : NULL;
+
+        if (strcmp(arg, "--headless") == 0)
+        {
+            options.headless = true;
+        }
+        else if (strcmp(arg, "--frames") == 0 && value != NULL)
+        {
+            options.frameCount = (u32)strtoul(value, NULL, 10);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--memory-budget") == 0 && value != NULL && parseMemoryBudget(value))
+        {
+            argIndex++;
+        }
+        else if (strcmp(arg, "--sim-budget") == 0 && value != NULL && atof(value) >= 0.0)
+        {
+            getSimSchedulerConfig()->frameBudget = (f32)(atof(value) / 1000.0);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--sim-max-steps") == 0 && value != NULL)
+        {
+            getSimSchedulerConfig()->maxStepsPerFrame = (u32)strtoul(value, NULL, 10);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--sim-overload") == 0 && value != NULL && parseSimOverloadPolicy(value))
+        {
+            argIndex++;
+        }
+        else if (strcmp(arg, "--sim-max-backlog") == 0 && value != NULL && atof(value) >= 0.0)
+        {
+            getSimSchedulerConfig()->maxBacklog = (f32)(atof(value) / 1000.0);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--course") == 0 && value != NULL)
+        {
+            getCourseStreamerConfig()->path = value;
+            argIndex++;
+        }
+        else if (strcmp(arg, "--course-cache") == 0 && value != NULL &&
+                 parseByteSize(value, &getCourseStreamerConfig()->cacheSize))
+        {
+            argIndex++;
+        }
+        else if (strcmp(arg, "--collision-kernel") == 0 && value != NULL && parseCollisionKernel(value))
+        {
+            argIndex++;
+        }
+        else if (strcmp(arg, "--ball-contacts") == 0)
+        {
+            ballContacts = true;
+        }
+        else if (strcmp(arg, "--bays") == 0 && value != NULL && strtoul(value, NULL, 10) > 0)
+        {
+            getDrivingRangeConfig()->bayCount = (u32)strtoul(value, NULL, 10);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--bay-spacing") == 0 && value != NULL && atof(value) > 0.0)
+        {
+            getDrivingRangeConfig()->baySpacing = (f32)atof(value);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--sim-threads") == 0 && value != NULL)
+        {
+            getDrivingRangeConfig()->workerCount = (u32)strtoul(value, NULL, 10);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--ingest") == 0 && value != NULL)
+        {
+            getShotIngestConfig()->path = value;
+            argIndex++;
+        }
+        else if (strcmp(arg, "--ingest-rate") == 0 && value != NULL && strtoul(value, NULL, 10) > 0)
+        {
+            getShotIngestConfig()->shotsPerStep = (u32)strtoul(value, NULL, 10);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--publish") == 0)
+        {
+            getWorldShareConfig()->mode = WORLD_SHARE_PUBLISH;
+        }
+        else if (strcmp(arg, "--view") == 0)
+        {
+            getWorldShareConfig()->mode = WORLD_SHARE_VIEW;
+        }
+        else if (strcmp(arg, "--share-name") == 0 && value != NULL && value[0] == '/')
+        {
+            getWorldShareConfig()->name = value;
+            argIndex++;
+        }
+        else if (strcmp(arg, "--checkpoint") == 0 && value != NULL)
+        {
+            getCheckpointConfig()->path = value;
+            argIndex++;
+        }
+        else if (strcmp(arg, "--checkpoint-interval") == 0 && value != NULL && atof(value) > 0.0)
+        {
+            getCheckpointConfig()->interval = (f32)atof(value);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--deterministic") == 0)
+        {
+            getDeterminismConfig()->enabled = true;
+        }
+        else if (strcmp(arg, "--state-hash") == 0 && value != NULL)
+        {
+            getDeterminismConfig()->hashPath = value;
+            argIndex++;
+        }
+        else if (strcmp(arg, "--precompute-flight") == 0)
+        {
+            getFlightPlannerConfig()->enabled = true;
+        }
+        else if (strcmp(arg, "--planner-threads") == 0 && value != NULL)
+        {
+            getFlightPlannerConfig()->workerCount = (u32)strtoul(value, NULL, 10);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--history") == 0 && value != NULL &&
+                 parseByteSize(value, &getTrajectoryHistoryConfig()->budget))
+        {
+            argIndex++;
+        }
+        else if (strcmp(arg, "--capture") == 0 && value != NULL)
+        {
+            options.capturePath = value;
+            argIndex++;
+        }
+        else if (strcmp(arg, "--size") == 0 && value != NULL &&
+                 sscanf(value, "%ux%u", &options.width, &options.height) == 2 && options.width > 0 &&
+                 options.height > 0)
+        {
+            argIndex++;
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // A viewer's balls are overwritten by the publisher's every frame, so it has nothing to spawn or checkpoint
+    if (getWorldShareConfig()->mode == WORLD_SHARE_VIEW &&
+        (getShotIngestConfig()->path != NULL || getCheckpointConfig()->path != NULL))
+    {
+        printUsage();
+        return 1;
+    }
 
     GolfFlightSim3D golfFlightSim3D;
-    golfFlightSim3D.run();
+    golfFlightSim3D.run(options);
 
     return 0;
 }
\ No newline at end of file
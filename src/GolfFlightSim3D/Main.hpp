@@ -1,3 +1,6 @@
+// The unit ground plane is drawn and collided with at this size
+#define GROUND_SCALE 1000.0F
+
 enum OpenGLProgramID
 {
     OPENGL_PROGRAM_TEXTURED_VERTICES,
@@ -65,6 +68,8 @@ struct Vertex
 
 struct Mesh
 {
+    cgltf_data *gltfData;
+
     const GLvoid *vertexData;
     const GLvoid *indexData;
     GLsizeiptr vertexDataSize;
@@ -80,6 +85,10 @@ struct Mesh
     GLsizei uvDataStride;
 
     size_t vertexCount;
+    GLenum indexType;
+
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
 };
 
 struct OpenGLRenderer
@@ -88,6 +97,11 @@ struct OpenGLRenderer
     GLuint vertexBuffers[MESH_COUNT];
     GLuint indexBuffers[MESH_COUNT];
     GLuint vertexCounts[MESH_COUNT];
+    GLenum indexTypes[MESH_COUNT];
+
+    // Bounding spheres in model space, used for culling
+    glm::vec3 boundsCenters[MESH_COUNT];
+    f32 boundsRadii[MESH_COUNT];
 
     GLuint textures[TEXTURE_COUNT];
 
@@ -131,13 +145,28 @@ struct Camera
     glm::vec3 target;
 };
 
+struct RenderQueue;
+struct TracerTrails;
+struct BallVisibility;
+struct PerfOverlay;
+struct SimScheduler;
+struct CourseStreamer;
+struct ShotIngest;
+struct WorldShare;
+struct Checkpoint;
+struct StateHashLog;
+struct TrajectoryHistory;
+struct Frustum;
+
 class GolfFlightSim3D : public Application
 {
 protected:
     bool initialize() override;
     bool load() override;
+    void unload() override;
     void renderScene(f32 frameTime) override;
     void renderUI(f32 frameTime) override;
+    void afterRender(f32 frameTime) override;
     void update(f32 frameTime) override;
 
 private:
@@ -148,16 +177,36 @@ private:
     CollisionGeometry *collidableTriangles;
 
     OpenGLRenderer *renderer;
-
-    bool loadTexture(TextureID textureID, const char *filepath, GLint wrapS, GLint wrapT);
-    void loadCollidableGeometry(Mesh *mesh);
+    RenderQueue *renderQueue;
+    TracerTrails *tracerTrails;
+    BallVisibility *ballVisibility;
+    PerfOverlay *perfOverlay;
+    SimScheduler *simScheduler;
+    CourseStreamer *courseStreamer;
+    ShotIngest *shotIngest;  // NULL when no shots are ingested
+    WorldShare *worldShare;  // NULL when the world isn't shared
+    Checkpoint *checkpoint;  // NULL when the session isn't checkpointed
+    StateHashLog *stateHashes;  // NULL unless deterministic mode is on or the hashes are written out
+    TrajectoryHistory *trajectoryHistory;  // NULL when no history is kept
+    bool viewingSharedWorld;
+    u32 ballEpoch;  // Bumped whenever balls move to new indices
+
+    void loadCollidableGeometryCooked(const CookedMeshHeader *header,
+                                      const Vertex *vertices,
+                                      const CookedCollisionTriangle *triangles,
+                                      const glm::mat4 &transform);
     void loadMesh(MeshID meshId,
-                  Vertex *vertexData,
-                  u16 *indexData,
+                  const Vertex *vertexData,
+                  const GLvoid *indexData,
+                  GLenum indexType,
                   size_t vertexDataSize,
                   size_t indexDataSize,
                   size_t vertexCount);
-    bool loadMeshGLTF(MeshID meshId, const char *filepath, bool collidable);
+    // Meshes given a collision transform are also added to the collision geometry, placed by it
+    bool loadMeshCooked(MeshID meshId, const char *filepath, const glm::mat4 *collisionTransform);
+    bool loadMeshGLTF(MeshID meshId, const char *filepath, const glm::mat4 *collisionTransform);
+    void setMeshBounds(MeshID meshId, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax);
+    bool meshIsVisible(MeshID meshId, glm::mat4 *transform, const Frustum *frustum);
 
     void drawTextured(glm::mat4 *model, GLenum mode, MeshID meshId, TextureID textureID, f32 uvScale);
     void drawTexturedTriangles(glm::mat4 *model, MeshID meshId, TextureID textureID, f32 uvScale);
@@ -173,6 +222,10 @@ private:
     void drawMesh(MeshID meshId, glm::mat4 *transform, f32 r, f32 g, f32 b, f32 a);
     void drawMesh(MeshID meshId, glm::mat4 *transform, TextureID texture, f32 uvScale);
 
+    // Balls of the bay the view is filtered to, NULL when every ball is shown
+    const u32 *getShownBalls(u32 *outCount);
+    Wind *getShownWind();
+
     void drawVector(const glm::vec3 &v, const glm::vec3 &origin, Color color);
     void drawWindArrow(f32 x, f32 y, f32 scale);
 };
\ No newline at end of file
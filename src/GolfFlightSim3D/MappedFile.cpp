@@ -0,0 +1,105 @@
+#ifdef _WIN32
+
+bool MappedFile::open(const char *filepath)
+{
+    data = NULL;
+    size = 0;
+    mappingHandle = NULL;
+
+    fileHandle = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mappingHandle == NULL)
+    {
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    data = (const u8 *)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL)
+    {
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    size = (size_t)fileSize.QuadPart;
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data != NULL)
+    {
+        UnmapViewOfFile(data);
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+    }
+
+    data = NULL;
+    size = 0;
+}
+
+#else
+
+bool MappedFile::open(const char *filepath)
+{
+    data = NULL;
+    size = 0;
+
+    fileDescriptor = ::open(filepath, O_RDONLY);
+    if (fileDescriptor < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStatus;
+    if (fstat(fileDescriptor, &fileStatus) != 0 || fileStatus.st_size == 0)
+    {
+        ::close(fileDescriptor);
+        return false;
+    }
+
+    void *mapping = mmap(NULL, (size_t)fileStatus.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    if (mapping == MAP_FAILED)
+    {
+        ::close(fileDescriptor);
+        return false;
+    }
+
+    data = (const u8 *)mapping;
+    size = (size_t)fileStatus.st_size;
+
+    // Everything in here is read front to back exactly once
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    madvise(mapping, size, MADV_WILLNEED);
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data != NULL)
+    {
+        munmap((void *)data, size);
+        ::close(fileDescriptor);
+    }
+
+    data = NULL;
+    size = 0;
+}
+
+#endif
\ No newline at end of file
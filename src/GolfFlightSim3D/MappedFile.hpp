@@ -0,0 +1,17 @@
+// Read-only view of a whole file mapped into the address space
+struct MappedFile
+{
+    const u8 *data;
+    size_t size;
+
+    bool open(const char *filepath);
+    void close();
+
+private:
+#ifdef _WIN32
+    void *fileHandle;
+    void *mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+};
\ No newline at end of file
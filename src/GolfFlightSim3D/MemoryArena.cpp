@@ -1,3 +1,221 @@
+#define ASSET_ALLOCATION_HEADER_SIZE 16
+
+#define bytesToMiB(n) ((f64)(n) / (1024.0 * 1024.0))
+
+// Also the names of the pools in Tracy's memory profiler, which compares them by pointer
+static const char *memoryTagNames[MEMORY_TAG_COUNT] = {
+    "World",
+    "Collision",
+    "Renderer",
+    "Assets",
+};
+
+static MemoryTagStats memoryTagStats[MEMORY_TAG_COUNT];
+
+const char *getMemoryTagName(MemoryTag tag)
+{
+    return memoryTagNames[tag];
+}
+
+MemoryTagStats *getMemoryTagStats(MemoryTag tag)
+{
+    return &memoryTagStats[tag];
+}
+
+// Bytes with an optional K, M or G suffix, e.g. "512M"
+bool parseByteSize(const char *text, size_t *outSize)
+{
+    char *suffix;
+    unsigned long long size = strtoull(text, &suffix, 10);
+    switch (*suffix)
+    {
+        case '\0':
+            break;
+        case 'K':
+        case 'k':
+            size *= 1024ULL;
+            break;
+        case 'M':
+        case 'm':
+            size *= 1024ULL * 1024ULL;
+            break;
+        case 'G':
+        case 'g':
+            size *= 1024ULL * 1024ULL * 1024ULL;
+            break;
+        default:
+            return false;
+    }
+
+    if (suffix == text || (*suffix != '\0' && suffix[1] != '\0'))
+    {
+        return false;
+    }
+
+    *outSize = (size_t)size;
+    return true;
+}
+
+// Takes "<tag>=<size>", where size is parsed by parseByteSize, e.g. "collision=512M"
+bool parseMemoryBudget(const char *budget)
+{
+    const char *separator = strchr(budget, '=');
+    if (separator == NULL)
+    {
+        return false;
+    }
+
+    size_t nameLength = (size_t)(separator - budget);
+
+    for (u32 tagIndex = 0; tagIndex < MEMORY_TAG_COUNT; tagIndex++)
+    {
+        const char *name = memoryTagNames[tagIndex];
+        if (strlen(name) != nameLength)
+        {
+            continue;
+        }
+
+        bool matches = true;
+        for (size_t charIndex = 0; charIndex < nameLength && matches; charIndex++)
+        {
+            matches = tolower((unsigned char)name[charIndex]) == tolower((unsigned char)budget[charIndex]);
+        }
+
+        if (!matches)
+        {
+            continue;
+        }
+
+        size_t size;
+        if (!parseByteSize(separator + 1, &size))
+        {
+            return false;
+        }
+
+        memoryTagStats[tagIndex].budget = size;
+        return true;
+    }
+
+    return false;
+}
+
+void trackAllocation(MemoryTag tag, void *memory, size_t size)
+{
+    MemoryTagStats *stats = &memoryTagStats[tag];
+
+    size_t current = stats->current.fetch_add(size) + size;
+    stats->allocationCount.fetch_add(1);
+
+    size_t peak = stats->peak.load();
+    while (current > peak && !stats->peak.compare_exchange_weak(peak, current))
+    {
+    }
+
+    // Warn once each time a subsystem goes over, not on every allocation while it stays there
+    if (stats->budget != 0 && current > stats->budget && !stats->overBudget.exchange(true))
+    {
+        spdlog::warn("Memory: {} is over budget, {:.2f} MiB used of {:.2f} MiB", memoryTagNames[tag],
+                     bytesToMiB(current), bytesToMiB(stats->budget));
+    }
+
+    (void)memory;
+    TracyAllocN(memory, size, memoryTagNames[tag]);
+}
+
+void trackFree(MemoryTag tag, void *memory, size_t size)
+{
+    MemoryTagStats *stats = &memoryTagStats[tag];
+
+    size_t current = stats->current.fetch_sub(size) - size;
+    if (stats->budget != 0 && current <= stats->budget)
+    {
+        stats->overBudget = false;
+    }
+
+    (void)memory;
+    TracyFreeN(memory, memoryTagNames[tag]);
+}
+
+// cgltf and stb_image allocate through these, with the size stored in front of each block so frees can be accounted
+// for. Inline so the tools that never load assets can include this file without unused function warnings.
+static inline void *assetMalloc(size_t size)
+{
+    u8 *block = (u8 *)malloc(size + ASSET_ALLOCATION_HEADER_SIZE);
+    if (block == NULL)
+    {
+        return NULL;
+    }
+
+    *(size_t *)block = size;
+
+    u8 *memory = block + ASSET_ALLOCATION_HEADER_SIZE;
+    trackAllocation(MEMORY_TAG_ASSETS, memory, size);
+
+    return memory;
+}
+
+static inline void assetFree(void *memory)
+{
+    if (memory == NULL)
+    {
+        return;
+    }
+
+    u8 *block = (u8 *)memory - ASSET_ALLOCATION_HEADER_SIZE;
+    trackFree(MEMORY_TAG_ASSETS, memory, *(size_t *)block);
+
+    free(block);
+}
+
+static inline void *assetRealloc(void *memory, size_t size)
+{
+    if (memory == NULL)
+    {
+        return assetMalloc(size);
+    }
+
+    u8 *block = (u8 *)memory - ASSET_ALLOCATION_HEADER_SIZE;
+    size_t oldSize = *(size_t *)block;
+
+    u8 *newBlock = (u8 *)realloc(block, size + ASSET_ALLOCATION_HEADER_SIZE);
+    if (newBlock == NULL)
+    {
+        return NULL;
+    }
+
+    *(size_t *)newBlock = size;
+
+    u8 *newMemory = newBlock + ASSET_ALLOCATION_HEADER_SIZE;
+    trackFree(MEMORY_TAG_ASSETS, memory, oldSize);
+    trackAllocation(MEMORY_TAG_ASSETS, newMemory, size);
+
+    return newMemory;
+}
+
+void logMemoryReport(const MemoryArena *arena)
+{
+    spdlog::info("Memory: Arena {:.2f} MiB committed of {:.2f} MiB", bytesToMiB(arena->used()),
+                 bytesToMiB(arena->capacity()));
+
+    for (u32 tagIndex = 0; tagIndex < MEMORY_TAG_COUNT; tagIndex++)
+    {
+        MemoryTagStats *stats = &memoryTagStats[tagIndex];
+
+        if (stats->budget != 0)
+        {
+            spdlog::info("Memory:   {:<10} {:>10.2f} MiB, peak {:>10.2f} MiB, {:>6} allocations, budget {:.2f} MiB",
+                         memoryTagNames[tagIndex], bytesToMiB(stats->current.load()), bytesToMiB(stats->peak.load()),
+                         stats->allocationCount.load(), bytesToMiB(stats->budget));
+        }
+        else
+        {
+            spdlog::info("Memory:   {:<10} {:>10.2f} MiB, peak {:>10.2f} MiB, {:>6} allocations",
+                         memoryTagNames[tagIndex], bytesToMiB(stats->current.load()), bytesToMiB(stats->peak.load()),
+                         stats->allocationCount.load());
+        }
+    }
+}
+
 bool MemoryArena::initialize(size_t size)
 {
     void *memory = calloc(1, size);
@@ -18,15 +236,27 @@ bool MemoryArena::initialize(size_t size)
     return true;
 }
 
-u8 *MemoryArena::allocateFromArena(size_t size)
+u8 *MemoryArena::allocateFromArena(size_t size, MemoryTag tag)
 {
-    spdlog::debug("Allocating {} bytes", size);
+    spdlog::debug("Allocating {} bytes for {}", size, memoryTagNames[tag]);
 
     assert(current + size <= end);
     u8 *allocated_memory = current;
     current += size;
 
+    trackAllocation(tag, allocated_memory, size);
+
     spdlog::debug("{} bytes left ({:.2f}% used)", end - current, (f32)(current - start) / (f32)(end - start));
 
     return allocated_memory;
-}
\ No newline at end of file
+}
+
+size_t MemoryArena::used() const
+{
+    return (size_t)(current - start);
+}
+
+size_t MemoryArena::capacity() const
+{
+    return (size_t)(end - start);
+}
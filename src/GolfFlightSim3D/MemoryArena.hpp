@@ -1,11 +1,46 @@
+enum MemoryTag
+{
+    MEMORY_TAG_WORLD,
+    MEMORY_TAG_COLLISION,
+    MEMORY_TAG_RENDERER,
+    MEMORY_TAG_ASSETS,
+
+    MEMORY_TAG_COUNT,
+};
+
+// Live bytes and high-water mark of one subsystem. Asset loading allocates from worker threads, so everything that
+// changes after startup is atomic.
+struct MemoryTagStats
+{
+    std::atomic<size_t> current;
+    std::atomic<size_t> peak;
+    std::atomic<u32> allocationCount;
+    std::atomic<bool> overBudget;
+
+    size_t budget;  // 0 means unlimited
+};
+
 struct MemoryArena
 {
 public:
     bool initialize(size_t size);
-    u8 *allocateFromArena(size_t size);
+    u8 *allocateFromArena(size_t size, MemoryTag tag);
+
+    size_t used() const;
+    size_t capacity() const;
 
 private:
     u8 *start;
     u8 *end;
     u8 *current;
-};
\ No newline at end of file
+};
+
+const char *getMemoryTagName(MemoryTag tag);
+MemoryTagStats *getMemoryTagStats(MemoryTag tag);
+bool parseByteSize(const char *text, size_t *outSize);
+bool parseMemoryBudget(const char *budget);
+
+void trackAllocation(MemoryTag tag, void *memory, size_t size);
+void trackFree(MemoryTag tag, void *memory, size_t size);
+
+void logMemoryReport(const MemoryArena *arena);
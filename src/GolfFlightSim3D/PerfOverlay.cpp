@@ -0,0 +1,185 @@
+void PerfHistory::push(f32 value)
+{
+    values[head] = value;
+    head = (head + 1) % PERF_HISTORY_LENGTH;
+    if (count < PERF_HISTORY_LENGTH)
+    {
+        count++;
+    }
+}
+
+void PerfHistory::computeStatistics()
+{
+    p50 = p99 = max = 0.0F;
+    spikeCount = 0;
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    // Until the ring wraps the valid samples are the first count slots
+    f32 sorted[PERF_HISTORY_LENGTH];
+    memcpy(sorted, values, count * sizeof(f32));
+
+    u32 p50Index = (count - 1) / 2;
+    u32 p99Index = ((count - 1) * 99) / 100;
+
+    std::nth_element(sorted, sorted + p50Index, sorted + count);
+    p50 = sorted[p50Index];
+
+    std::nth_element(sorted + p50Index, sorted + p99Index, sorted + count);
+    p99 = sorted[p99Index];
+
+    max = *std::max_element(sorted + p99Index, sorted + count);
+
+    for (u32 sampleIndex = 0; sampleIndex < count; sampleIndex++)
+    {
+        if (values[sampleIndex] > p50 * PERF_SPIKE_FACTOR)
+        {
+            spikeCount++;
+        }
+    }
+}
+
+void PerfOverlay::initialize()
+{
+    bzero(history, sizeof(history));
+
+    frameStartTime = 0.0;
+    renderStartTime = 0.0;
+
+    glGenQueries(PERF_GPU_QUERY_LATENCY * 2, &gpuQueries[0][0]);
+    gpuFrameIndex = 0;
+    gpuSamplesDropped = 0;
+}
+
+void PerfOverlay::beginFrame(f64 time)
+{
+    if (frameStartTime > 0.0)
+    {
+        history[PERF_SERIES_FRAME_TIME].push((f32)((time - frameStartTime) * 1000.0));
+    }
+    frameStartTime = time;
+}
+
+void PerfOverlay::recordSimStep(f64 seconds)
+{
+    history[PERF_SERIES_SIM_STEP].push((f32)(seconds * 1000.0));
+}
+
+void PerfOverlay::endUpdate(u32 stepCount)
+{
+    history[PERF_SERIES_STEPS_PER_FRAME].push((f32)stepCount);
+}
+
+void PerfOverlay::readGPUTime(u32 slot)
+{
+    GLint available = 0;
+    glGetQueryObjectiv(gpuQueries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+    {
+        // The GPU is more than PERF_GPU_QUERY_LATENCY frames behind, losing the sample beats waiting for it
+        gpuSamplesDropped++;
+        return;
+    }
+
+    GLuint64 begin, end;
+    glGetQueryObjectui64v(gpuQueries[slot][0], GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(gpuQueries[slot][1], GL_QUERY_RESULT, &end);
+
+    history[PERF_SERIES_GPU].push((f32)((f64)(end - begin) / 1e6));
+}
+
+void PerfOverlay::beginRender(f64 time)
+{
+    renderStartTime = time;
+
+    // The slot about to be reused holds the queries from PERF_GPU_QUERY_LATENCY frames ago
+    u32 slot = gpuFrameIndex % PERF_GPU_QUERY_LATENCY;
+    if (gpuFrameIndex >= PERF_GPU_QUERY_LATENCY)
+    {
+        readGPUTime(slot);
+    }
+
+    glQueryCounter(gpuQueries[slot][0], GL_TIMESTAMP);
+}
+
+void PerfOverlay::endRender(f64 time)
+{
+    u32 slot = gpuFrameIndex % PERF_GPU_QUERY_LATENCY;
+    glQueryCounter(gpuQueries[slot][1], GL_TIMESTAMP);
+    gpuFrameIndex++;
+
+    history[PERF_SERIES_RENDER_CPU].push((f32)((time - renderStartTime) * 1000.0));
+}
+
+void PerfOverlay::drawSeries(PerfSeries series, const char *label, const char *unit, f32 budget)
+{
+    PerfHistory *samples = &history[series];
+    samples->computeStatistics();
+
+    ImGui::Text("%-12s p50 %6.2f  p99 %6.2f  max %6.2f %s", label, samples->p50, samples->p99, samples->max, unit);
+
+    // Keep the budget line on the plot so a good frame and a bad one can be told apart at a glance
+    f32 scaleMax = std::max(samples->max, budget) * 1.1F;
+    if (scaleMax <= 0.0F)
+    {
+        scaleMax = 1.0F;
+    }
+
+    // Oldest sample first, the ring only starts at head once it has wrapped
+    s32 offset = samples->count == PERF_HISTORY_LENGTH ? (s32)samples->head : 0;
+
+    ImGui::PushID(label);
+    ImGui::PlotHistogram("", samples->values, (s32)samples->count, offset, NULL, 0.0F, scaleMax,
+                         ImVec2((f32)PERF_HISTORY_LENGTH * 1.5F, 40.0F));
+    ImGui::PopID();
+
+    ImVec2 plotMin = ImGui::GetItemRectMin();
+    ImVec2 plotMax = ImGui::GetItemRectMax();
+    ImDrawList *drawList = ImGui::GetWindowDrawList();
+    f32 plotHeight = plotMax.y - plotMin.y;
+
+    if (budget > 0.0F)
+    {
+        f32 budgetY = plotMax.y - plotHeight * (budget / scaleMax);
+        drawList->AddLine(ImVec2(plotMin.x, budgetY), ImVec2(plotMax.x, budgetY), IM_COL32(80, 220, 80, 160));
+    }
+
+    if (samples->count == 0 || samples->p50 <= 0.0F)
+    {
+        return;
+    }
+
+    // Spike markers along the top of the plot, above the samples that caused them
+    f32 sampleWidth = (plotMax.x - plotMin.x) / (f32)samples->count;
+    f32 spikeThreshold = samples->p50 * PERF_SPIKE_FACTOR;
+    for (u32 sampleIndex = 0; sampleIndex < samples->count; sampleIndex++)
+    {
+        f32 value = samples->values[(offset + sampleIndex) % PERF_HISTORY_LENGTH];
+        if (value > spikeThreshold)
+        {
+            f32 x = plotMin.x + sampleWidth * ((f32)sampleIndex + 0.5F);
+            drawList->AddLine(ImVec2(x, plotMin.y), ImVec2(x, plotMin.y + 6.0F), IM_COL32(255, 60, 60, 255), 2.0F);
+        }
+    }
+}
+
+void PerfOverlay::draw()
+{
+    const f32 frameBudget = 1000.0F / 60.0F;
+
+    drawSeries(PERF_SERIES_FRAME_TIME, "Frame", "ms", frameBudget);
+    drawSeries(PERF_SERIES_SIM_STEP, "Sim Step", "ms", 0.0F);
+    drawSeries(PERF_SERIES_STEPS_PER_FRAME, "Steps/Frame", "", 1.0F);
+    drawSeries(PERF_SERIES_RENDER_CPU, "Render CPU", "ms", 0.0F);
+    drawSeries(PERF_SERIES_GPU, "GPU", "ms", 0.0F);
+
+    ImGui::Spacing();
+
+    PerfHistory *frameTimes = &history[PERF_SERIES_FRAME_TIME];
+    ImGui::Text("Frame spikes (> %.0fx p50): %u in last %u frames", PERF_SPIKE_FACTOR, frameTimes->spikeCount,
+                frameTimes->count);
+    ImGui::Text("GPU samples dropped: %u", gpuSamplesDropped);
+}
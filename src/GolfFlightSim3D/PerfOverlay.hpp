@@ -0,0 +1,61 @@
+// Four seconds of history at 60 Hz
+#define PERF_HISTORY_LENGTH 240
+
+// Frames a GPU timer query is given to finish before its result is read, so reading it never stalls the pipeline
+#define PERF_GPU_QUERY_LATENCY 4
+
+// A sample is marked as a spike when it takes this many times the median of its history
+#define PERF_SPIKE_FACTOR 2.0F
+
+enum PerfSeries
+{
+    PERF_SERIES_FRAME_TIME,       // Wall time between the starts of consecutive frames
+    PERF_SERIES_SIM_STEP,         // One fixed simulation step, a frame can run none or several
+    PERF_SERIES_STEPS_PER_FRAME,  // Steps the accumulator ran in a frame
+    PERF_SERIES_RENDER_CPU,       // CPU time from the start of renderScene to the end of the UI draw
+    PERF_SERIES_GPU,              // GPU time over the same span, from timestamp queries
+
+    PERF_SERIES_COUNT,
+};
+
+// Ring of the most recent samples of one series
+struct PerfHistory
+{
+    f32 values[PERF_HISTORY_LENGTH];
+    u32 head;   // Next slot to write, also the oldest sample once the ring is full
+    u32 count;  // Valid samples, saturates at PERF_HISTORY_LENGTH
+
+    // Recomputed once per frame when the overlay is drawn
+    f32 p50;
+    f32 p99;
+    f32 max;
+    u32 spikeCount;
+
+    void push(f32 value);
+    void computeStatistics();
+};
+
+struct PerfOverlay
+{
+    void initialize();
+    void beginFrame(f64 time);
+    void recordSimStep(f64 seconds);
+    void endUpdate(u32 stepCount);
+    void beginRender(f64 time);
+    void endRender(f64 time);
+    void draw();
+
+private:
+    PerfHistory history[PERF_SERIES_COUNT];
+
+    f64 frameStartTime;
+    f64 renderStartTime;
+
+    // Begin and end timestamps for each frame in flight
+    GLuint gpuQueries[PERF_GPU_QUERY_LATENCY][2];
+    u32 gpuFrameIndex;
+    u32 gpuSamplesDropped;
+
+    void readGPUTime(u32 slot);
+    void drawSeries(PerfSeries series, const char *label, const char *unit, f32 budget);
+};
@@ -0,0 +1,218 @@
+// Sort key layout, most significant bits first:
+//   [63..60] layer  [59..52] program  [51..44] texture  [43..36] mesh  [31..0] submission order
+// Keeping the submission order in the low bits makes the sort stable, so commands that share all of their state are
+// still drawn in the order they were recorded.
+static u64 makeSortKey(RenderLayer layer, OpenGLProgramID programId, TextureID textureId, MeshID meshId, u32 sequence)
+{
+    u64 key = 0;
+    key |= ((u64)layer & 0xF) << 60;
+    key |= ((u64)programId & 0xFF) << 52;
+    key |= ((u64)textureId & 0xFF) << 44;
+    key |= ((u64)meshId & 0xFF) << 36;
+    key |= (u64)sequence;
+    return key;
+}
+
+static bool sortEntryLess(const RenderSortEntry &a, const RenderSortEntry &b)
+{
+    return a.key < b.key;
+}
+
+void RenderQueue::beginFrame()
+{
+    lastFrameStats = frameStats;
+    bzero(&frameStats, sizeof(RenderStats));
+
+    layer = RENDER_LAYER_SCENE;
+}
+
+RenderCommand *RenderQueue::push(OpenGLProgramID programId, MeshID meshId, TextureID textureId)
+{
+    if (commandCount >= MAX_RENDER_COMMANDS)
+    {
+        spdlog::warn("Render queue full, dropping draw command");
+        return NULL;
+    }
+
+    u32 commandIndex = (u32)commandCount++;
+
+    RenderCommand *command = &commands[commandIndex];
+    command->programId = programId;
+    command->meshId = meshId;
+    command->textureId = textureId;
+    command->layer = layer;
+
+    RenderSortEntry *entry = &sortEntries[commandIndex];
+    entry->key = makeSortKey(layer, programId, textureId, meshId, commandIndex);
+    entry->commandIndex = commandIndex;
+
+    return command;
+}
+
+void RenderQueue::invalidateState()
+{
+    // Use values that can never match a real request so that the first bind of each kind always goes through
+    state.program = (GLuint)-1;
+    state.vertexArray = (GLuint)-1;
+    state.texture = (GLuint)-1;
+    state.polygonMode = GL_NONE;
+    state.depthTest = !glIsEnabled(GL_DEPTH_TEST);
+
+    for (u32 programIndex = 0; programIndex < OPENGL_PROGRAM_COUNT; programIndex++)
+    {
+        state.uniformsValid[programIndex] = false;
+    }
+}
+
+void RenderQueue::setDepthTest(bool enabled)
+{
+    if (state.depthTest == enabled)
+    {
+        return;
+    }
+
+    if (enabled)
+    {
+        glEnable(GL_DEPTH_TEST);
+    }
+    else
+    {
+        glDisable(GL_DEPTH_TEST);
+    }
+
+    state.depthTest = enabled;
+    frameStats.rasterStateChanges++;
+    frameStats.stateChanges++;
+}
+
+void RenderQueue::setPolygonMode(GLenum polygonMode)
+{
+    if (state.polygonMode == polygonMode)
+    {
+        return;
+    }
+
+    glPolygonMode(GL_FRONT_AND_BACK, polygonMode);
+
+    state.polygonMode = polygonMode;
+    frameStats.rasterStateChanges++;
+    frameStats.stateChanges++;
+}
+
+void RenderQueue::useProgram(GLuint program)
+{
+    if (state.program == program)
+    {
+        return;
+    }
+
+    glUseProgram(program);
+
+    state.program = program;
+    frameStats.programChanges++;
+    frameStats.stateChanges++;
+}
+
+void RenderQueue::bindVertexArray(GLuint vertexArray)
+{
+    if (state.vertexArray == vertexArray)
+    {
+        return;
+    }
+
+    glBindVertexArray(vertexArray);
+
+    state.vertexArray = vertexArray;
+    frameStats.vertexArrayChanges++;
+    frameStats.stateChanges++;
+}
+
+void RenderQueue::bindTexture(GLuint texture)
+{
+    if (state.texture == texture)
+    {
+        return;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    state.texture = texture;
+    frameStats.textureChanges++;
+    frameStats.stateChanges++;
+}
+
+void RenderQueue::flush(OpenGLRenderer *renderer)
+{
+    ZoneScoped;
+
+    if (commandCount == 0)
+    {
+        return;
+    }
+
+    std::sort(sortEntries, sortEntries + commandCount, sortEntryLess);
+
+    invalidateState();
+    glActiveTexture(GL_TEXTURE0);
+
+    for (size_t entryIndex = 0; entryIndex < commandCount; entryIndex++)
+    {
+        RenderCommand *command = &commands[sortEntries[entryIndex].commandIndex];
+        OpenGLProgram *program = &renderer->programs[command->programId];
+
+        setDepthTest(command->layer != RENDER_LAYER_OVERLAY);
+        setPolygonMode(command->wireframe ? GL_LINE : GL_FILL);
+        useProgram(program->id);
+        bindVertexArray(renderer->vertexArrays[command->meshId]);
+
+        glUniformMatrix4fv((GLint)program->modelViewProjectionUniform, 1, GL_FALSE,
+                           glm::value_ptr(command->modelViewProjection));
+        frameStats.uniformUploads++;
+
+        f32 *cachedColor = state.color[command->programId];
+        bool uniformsValid = state.uniformsValid[command->programId];
+
+        switch (command->programId)
+        {
+            case OPENGL_PROGRAM_TEXTURED_VERTICES:
+            {
+                bindTexture(renderer->textures[command->textureId]);
+
+                if (!uniformsValid || state.uvScale[command->programId] != command->uvScale)
+                {
+                    glUniform1f((GLint)program->uvScaleUniform, command->uvScale);
+                    state.uvScale[command->programId] = command->uvScale;
+                    frameStats.uniformUploads++;
+                }
+                break;
+            }
+            case OPENGL_PROGRAM_COLORED_VERTICES:
+            {
+                if (!uniformsValid || memcmp(cachedColor, command->color, sizeof(command->color)) != 0)
+                {
+                    glUniform4fv((GLint)program->colorUniform, 1, command->color);
+                    memcpy(cachedColor, command->color, sizeof(command->color));
+                    frameStats.uniformUploads++;
+                }
+                break;
+            }
+            default:
+            {
+                invalidDefaultCase;
+            }
+        }
+        state.uniformsValid[command->programId] = true;
+
+        glDrawElements(command->mode, (GLsizei)renderer->vertexCounts[command->meshId],
+                       renderer->indexTypes[command->meshId], 0);
+        frameStats.drawCalls++;
+    }
+
+    frameStats.commands += (u32)commandCount;
+    commandCount = 0;
+
+    // Leave the context the way the rest of the frame expects to find it
+    glBindVertexArray(0);
+    glUseProgram(0);
+    glEnable(GL_DEPTH_TEST);
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#define MAX_RENDER_COMMANDS 131072
+
+// Draw commands are grouped by layer first, so everything in a layer is submitted before the next one starts.
+enum RenderLayer
+{
+    RENDER_LAYER_SCENE,
+    RENDER_LAYER_OVERLAY,  // Drawn on top of the scene with depth testing disabled
+    RENDER_LAYER_UI,
+
+    RENDER_LAYER_COUNT,
+};
+
+struct RenderCommand
+{
+    glm::mat4 modelViewProjection;
+    f32 color[4];
+    f32 uvScale;
+
+    GLenum mode;
+    OpenGLProgramID programId;
+    MeshID meshId;
+    TextureID textureId;
+    RenderLayer layer;
+    bool wireframe;
+};
+
+struct RenderSortEntry
+{
+    u64 key;
+    u32 commandIndex;
+};
+
+struct RenderStats
+{
+    u32 commands;
+    u32 drawCalls;
+    u32 stateChanges;
+
+    u32 programChanges;
+    u32 vertexArrayChanges;
+    u32 textureChanges;
+    u32 rasterStateChanges;
+    u32 uniformUploads;
+};
+
+// Mirrors the GL state last set by the queue so redundant binds can be skipped. It is invalidated at the start of every
+// flush because ImGui and the rest of the frame change state behind its back.
+struct OpenGLStateCache
+{
+    GLuint program;
+    GLuint vertexArray;
+    GLuint texture;
+    GLenum polygonMode;
+    bool depthTest;
+
+    f32 color[OPENGL_PROGRAM_COUNT][4];
+    f32 uvScale[OPENGL_PROGRAM_COUNT];
+    bool uniformsValid[OPENGL_PROGRAM_COUNT];
+};
+
+struct RenderQueue
+{
+    RenderLayer layer;
+
+    RenderStats frameStats;
+    RenderStats lastFrameStats;
+
+    void beginFrame();
+    RenderCommand *push(OpenGLProgramID programId, MeshID meshId, TextureID textureId);
+    void flush(OpenGLRenderer *renderer);
+
+private:
+    RenderCommand commands[MAX_RENDER_COMMANDS];
+    RenderSortEntry sortEntries[MAX_RENDER_COMMANDS];
+    size_t commandCount;
+
+    OpenGLStateCache state;
+
+    void invalidateState();
+    void setDepthTest(bool enabled);
+    void setPolygonMode(GLenum polygonMode);
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vertexArray);
+    void bindTexture(GLuint texture);
+};
\ No newline at end of file
@@ -0,0 +1,673 @@
+static ShotIngestConfig shotIngestConfig = {NULL, INGEST_DEFAULT_SHOTS_PER_STEP};
+
+static const char *launchFieldNames[LAUNCH_FIELD_COUNT] = {
+    "speed", "speedMph", "launchAngle", "heading", "spinRate", "spinAngle", "bay",
+};
+
+// Columns of a CSV without a header line
+static const u8 defaultCsvFields[] = {
+    LAUNCH_FIELD_SPEED,     LAUNCH_FIELD_LAUNCH_ANGLE, LAUNCH_FIELD_HEADING,
+    LAUNCH_FIELD_SPIN_RATE, LAUNCH_FIELD_SPIN_ANGLE,   LAUNCH_FIELD_BAY,
+};
+
+ShotIngestConfig *getShotIngestConfig()
+{
+    return &shotIngestConfig;
+}
+
+bool LaunchQueue::push(const LaunchRecord *record)
+{
+    u32 write = writeIndex.load(std::memory_order_relaxed);
+    if (write - cachedReadIndex == INGEST_QUEUE_SIZE)
+    {
+        cachedReadIndex = readIndex.load(std::memory_order_acquire);
+        if (write - cachedReadIndex == INGEST_QUEUE_SIZE)
+        {
+            return false;
+        }
+    }
+
+    records[write & (INGEST_QUEUE_SIZE - 1)] = *record;
+    writeIndex.store(write + 1, std::memory_order_release);
+    return true;
+}
+
+bool LaunchQueue::pop(LaunchRecord *outRecord)
+{
+    u32 read = readIndex.load(std::memory_order_relaxed);
+    if (read == cachedWriteIndex)
+    {
+        cachedWriteIndex = writeIndex.load(std::memory_order_acquire);
+        if (read == cachedWriteIndex)
+        {
+            return false;
+        }
+    }
+
+    *outRecord = records[read & (INGEST_QUEUE_SIZE - 1)];
+    readIndex.store(read + 1, std::memory_order_release);
+    return true;
+}
+
+#ifdef _WIN32
+
+static bool openIngestSource(const char *path, IngestSource *source)
+{
+    source->isStdin = strcmp(path, "-") == 0;
+    source->handle = source->isStdin ? GetStdHandle(STD_INPUT_HANDLE)
+                                     : CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                                                   OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (source->handle == INVALID_HANDLE_VALUE || source->handle == NULL)
+    {
+        return false;
+    }
+
+    source->isFile = GetFileType(source->handle) == FILE_TYPE_DISK;
+    return true;
+}
+
+static void closeIngestSource(IngestSource *source)
+{
+    if (!source->isStdin)
+    {
+        CloseHandle(source->handle);
+    }
+}
+
+// Bytes read, 0 when nothing came in within the wait, -1 once the source has ended
+static s32 readIngestSource(IngestSource *source, u8 *buffer, u32 size, u32 waitMs)
+{
+    DWORD available = size;
+    if (!source->isFile)
+    {
+        // Pipes are only read once they have something, so the reader never blocks past the wait
+        if (GetFileType(source->handle) == FILE_TYPE_PIPE)
+        {
+            if (!PeekNamedPipe(source->handle, NULL, 0, NULL, &available, NULL))
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            available = WaitForSingleObject(source->handle, waitMs) == WAIT_OBJECT_0 ? size : 0;
+        }
+
+        if (available == 0)
+        {
+            Sleep(waitMs);
+            return 0;
+        }
+    }
+
+    DWORD bytesRead = 0;
+    if (!ReadFile(source->handle, buffer, std::min(available, (DWORD)size), &bytesRead, NULL))
+    {
+        return -1;
+    }
+
+    if (bytesRead == 0)
+    {
+        if (!source->isFile)
+        {
+            return -1;
+        }
+        Sleep(waitMs);
+    }
+
+    return (s32)bytesRead;
+}
+
+#else
+
+static bool openIngestSource(const char *path, IngestSource *source)
+{
+    source->isStdin = strcmp(path, "-") == 0;
+    source->fd = source->isStdin ? STDIN_FILENO : ::open(path, O_RDONLY);
+    if (source->fd < 0)
+    {
+        return false;
+    }
+
+    struct stat status;
+    source->isFile = fstat(source->fd, &status) == 0 && S_ISREG(status.st_mode);
+    return true;
+}
+
+static void closeIngestSource(IngestSource *source)
+{
+    if (!source->isStdin)
+    {
+        ::close(source->fd);
+    }
+}
+
+// Bytes read, 0 when nothing came in within the wait, -1 once the source has ended
+static s32 readIngestSource(IngestSource *source, u8 *buffer, u32 size, u32 waitMs)
+{
+    // Regular files are always readable, even at their end, so only pipes and terminals are polled
+    if (!source->isFile)
+    {
+        struct pollfd pollFd = {source->fd, POLLIN, 0};
+        s32 ready = poll(&pollFd, 1, (s32)waitMs);
+        if (ready == 0 || (ready < 0 && errno == EINTR))
+        {
+            return 0;
+        }
+    }
+
+    ssize_t bytesRead = ::read(source->fd, buffer, size);
+    if (bytesRead < 0)
+    {
+        return errno == EINTR || errno == EAGAIN ? 0 : -1;
+    }
+
+    if (bytesRead == 0)
+    {
+        if (!source->isFile)
+        {
+            return -1;
+        }
+
+        // At the end of a file that may still be written to, like tail -f
+        std::this_thread::sleep_for(std::chrono::milliseconds(waitMs));
+    }
+
+    return (s32)bytesRead;
+}
+
+#endif
+
+static const char *skipSpaces(const char *cursor)
+{
+    while (*cursor == ' ' || *cursor == '\t')
+    {
+        cursor++;
+    }
+    return cursor;
+}
+
+static u32 findLaunchField(const char *name, size_t nameLength)
+{
+    for (u32 field = 0; field < LAUNCH_FIELD_COUNT; field++)
+    {
+        if (strlen(launchFieldNames[field]) == nameLength && memcmp(launchFieldNames[field], name, nameLength) == 0)
+        {
+            return field;
+        }
+    }
+    return LAUNCH_FIELD_IGNORED;
+}
+
+// Turns the fields a record had into launch conditions, angles come in degrees
+static bool finishRecord(const f64 *values, u32 fieldsSet, LaunchRecord *outRecord)
+{
+    bool hasSpeed = (fieldsSet & ((1U << LAUNCH_FIELD_SPEED) | (1U << LAUNCH_FIELD_SPEED_MPH))) != 0;
+    if (!hasSpeed || (fieldsSet & (1U << LAUNCH_FIELD_LAUNCH_ANGLE)) == 0)
+    {
+        return false;
+    }
+
+    f64 speed = (fieldsSet & (1U << LAUNCH_FIELD_SPEED)) ? values[LAUNCH_FIELD_SPEED]
+                                                         : values[LAUNCH_FIELD_SPEED_MPH] * 0.44704;
+    f64 bay = (fieldsSet & (1U << LAUNCH_FIELD_BAY)) ? values[LAUNCH_FIELD_BAY] : 1.0;
+
+    // Written so NaNs fail too
+    if (!(speed > 0.0 && speed < 1000.0) || !(fabs(values[LAUNCH_FIELD_LAUNCH_ANGLE]) <= 90.0) ||
+        !(fabs(values[LAUNCH_FIELD_HEADING]) <= 360.0) || !(fabs(values[LAUNCH_FIELD_SPIN_RATE]) <= 100000.0) ||
+        !(fabs(values[LAUNCH_FIELD_SPIN_ANGLE]) <= 90.0) || !(bay >= 1.0 && bay <= MAX_BAYS))
+    {
+        return false;
+    }
+
+    LaunchRequest *launch = &outRecord->launch;
+    launch->speed = (f32)speed;
+    launch->angle = glm::radians((f32)values[LAUNCH_FIELD_LAUNCH_ANGLE]);
+    launch->heading = glm::radians((f32)values[LAUNCH_FIELD_HEADING]);
+    launch->spinRate = (f32)values[LAUNCH_FIELD_SPIN_RATE];
+    launch->spinAngle = glm::radians((f32)values[LAUNCH_FIELD_SPIN_ANGLE]);
+    outRecord->bay = (u32)bay - 1;
+
+    return true;
+}
+
+void setDefaultCsvColumns(CsvColumns *columns)
+{
+    memcpy(columns->fields, defaultCsvFields, sizeof(defaultCsvFields));
+    columns->count = arrayCount(defaultCsvFields);
+}
+
+bool parseCsvHeader(const char *text, CsvColumns *outColumns)
+{
+    CsvColumns columns;
+    columns.count = 0;
+    u32 fieldsSet = 0;
+
+    const char *cursor = text;
+    for (;;)
+    {
+        cursor = skipSpaces(cursor);
+        const char *end = cursor;
+        while (*end != '\0' && *end != ',')
+        {
+            end++;
+        }
+
+        // Names may be quoted and padded
+        const char *nameEnd = end;
+        while (nameEnd > cursor && (nameEnd[-1] == ' ' || nameEnd[-1] == '\t'))
+        {
+            nameEnd--;
+        }
+        if (nameEnd - cursor >= 2 && *cursor == '"' && nameEnd[-1] == '"')
+        {
+            cursor++;
+            nameEnd--;
+        }
+
+        if (columns.count == INGEST_MAX_CSV_COLUMNS)
+        {
+            return false;
+        }
+
+        u32 field = findLaunchField(cursor, (size_t)(nameEnd - cursor));
+        columns.fields[columns.count++] = (u8)field;
+        fieldsSet |= field != LAUNCH_FIELD_IGNORED ? 1U << field : 0;
+
+        if (*end == '\0')
+        {
+            break;
+        }
+        cursor = end + 1;
+    }
+
+    bool hasSpeed = (fieldsSet & ((1U << LAUNCH_FIELD_SPEED) | (1U << LAUNCH_FIELD_SPEED_MPH))) != 0;
+    if (!hasSpeed || (fieldsSet & (1U << LAUNCH_FIELD_LAUNCH_ANGLE)) == 0)
+    {
+        return false;
+    }
+
+    *outColumns = columns;
+    return true;
+}
+
+bool parseCsvRecord(const char *text, const CsvColumns *columns, LaunchRecord *outRecord)
+{
+    f64 values[LAUNCH_FIELD_COUNT] = {};
+    u32 fieldsSet = 0;
+
+    const char *cursor = text;
+    for (u32 column = 0;; column++)
+    {
+        cursor = skipSpaces(cursor);
+        const char *end = cursor;
+        while (*end != '\0' && *end != ',')
+        {
+            end++;
+        }
+
+        // Empty fields keep their default
+        u32 field = column < columns->count ? columns->fields[column] : (u32)LAUNCH_FIELD_IGNORED;
+        if (field != LAUNCH_FIELD_IGNORED && cursor != end)
+        {
+            char *numberEnd;
+            values[field] = strtod(cursor, &numberEnd);
+            if (numberEnd == cursor || skipSpaces(numberEnd) != end)
+            {
+                return false;
+            }
+            fieldsSet |= 1U << field;
+        }
+
+        if (*end == '\0')
+        {
+            break;
+        }
+        cursor = end + 1;
+    }
+
+    return finishRecord(values, fieldsSet, outRecord);
+}
+
+// Past the closing quote, NULL when the string doesn't end
+static const char *skipJsonString(const char *cursor)
+{
+    for (cursor++; *cursor != '"'; cursor++)
+    {
+        if (*cursor == '\0' || (*cursor == '\\' && *++cursor == '\0'))
+        {
+            return NULL;
+        }
+    }
+    return cursor + 1;
+}
+
+// Past a value of a field that isn't read, nested objects and arrays included
+static const char *skipJsonValue(const char *cursor)
+{
+    u32 depth = 0;
+    for (;;)
+    {
+        char c = *cursor;
+        if (c == '"')
+        {
+            cursor = skipJsonString(cursor);
+            if (cursor == NULL || depth == 0)
+            {
+                return cursor;
+            }
+            continue;
+        }
+
+        if (c == '\0')
+        {
+            return depth == 0 ? cursor : NULL;
+        }
+        else if (c == '{' || c == '[')
+        {
+            depth++;
+        }
+        else if (c == '}' || c == ']')
+        {
+            if (depth == 0)
+            {
+                return cursor;
+            }
+            if (--depth == 0)
+            {
+                return cursor + 1;
+            }
+        }
+        else if (depth == 0 && (c == ',' || c == ' ' || c == '\t'))
+        {
+            return cursor;
+        }
+
+        cursor++;
+    }
+}
+
+// One flat object per line. Fields that aren't launch conditions, or aren't numbers, are skipped.
+bool parseJsonRecord(const char *text, LaunchRecord *outRecord)
+{
+    f64 values[LAUNCH_FIELD_COUNT] = {};
+    u32 fieldsSet = 0;
+
+    const char *cursor = skipSpaces(text);
+    if (*cursor++ != '{')
+    {
+        return false;
+    }
+
+    for (;;)
+    {
+        cursor = skipSpaces(cursor);
+        if (*cursor == '}')
+        {
+            break;
+        }
+
+        if (*cursor != '"')
+        {
+            return false;
+        }
+        const char *name = cursor + 1;
+        cursor = skipJsonString(cursor);
+        if (cursor == NULL)
+        {
+            return false;
+        }
+        u32 field = findLaunchField(name, (size_t)(cursor - 1 - name));
+
+        cursor = skipSpaces(cursor);
+        if (*cursor++ != ':')
+        {
+            return false;
+        }
+        cursor = skipSpaces(cursor);
+
+        if (field != LAUNCH_FIELD_IGNORED && (*cursor == '-' || (*cursor >= '0' && *cursor <= '9')))
+        {
+            char *numberEnd;
+            values[field] = strtod(cursor, &numberEnd);
+            fieldsSet |= 1U << field;
+            cursor = numberEnd;
+        }
+        else
+        {
+            cursor = skipJsonValue(cursor);
+            if (cursor == NULL)
+            {
+                return false;
+            }
+        }
+
+        cursor = skipSpaces(cursor);
+        if (*cursor == ',')
+        {
+            cursor++;
+        }
+        else if (*cursor != '}')
+        {
+            return false;
+        }
+    }
+
+    return finishRecord(values, fieldsSet, outRecord);
+}
+
+bool ShotIngest::open(const ShotIngestConfig *ingestConfig)
+{
+    config = *ingestConfig;
+    config.shotsPerStep = std::max(config.shotsPerStep, 1U);
+
+    if (!openIngestSource(config.path, &source))
+    {
+        spdlog::error("Could not open \"{}\" to read shots from", config.path);
+        return false;
+    }
+
+    spdlog::info("Ingest: Reading shots from {}, up to {} spawned per step",
+                 source.isStdin ? "stdin" : config.path, config.shotsPerStep);
+
+    setDefaultCsvColumns(&columns);
+    reader = std::thread(&ShotIngest::read, this);
+    return true;
+}
+
+void ShotIngest::close()
+{
+    quitting = true;
+    if (reader.joinable())
+    {
+        reader.join();
+    }
+    closeIngestSource(&source);
+}
+
+bool ShotIngest::isFinished() const
+{
+    return finished.load(std::memory_order_relaxed);
+}
+
+void ShotIngest::report(const char *problem)
+{
+    u64 errorCount = ++stats.parseErrors;
+    if (errorCount <= INGEST_MAX_REPORTED_ERRORS)
+    {
+        spdlog::warn("Ingest: Line {}: {}{}", stats.lines.load(), problem,
+                     errorCount == INGEST_MAX_REPORTED_ERRORS ? ", further errors are only counted" : "");
+    }
+}
+
+void ShotIngest::parseLine()
+{
+    stats.lines++;
+
+    if (lineTooLong)
+    {
+        report("Longer than a launch record can be");
+        lineTooLong = false;
+        lineLength = 0;
+        return;
+    }
+
+    // Windows line endings and trailing padding
+    while (lineLength > 0 && (line[lineLength - 1] == '\r' || line[lineLength - 1] == ' ' ||
+                              line[lineLength - 1] == '\t'))
+    {
+        lineLength--;
+    }
+    line[lineLength] = '\0';
+    lineLength = 0;
+
+    const char *text = skipSpaces(line);
+    if (*text == '\0' || *text == '#')
+    {
+        return;
+    }
+
+    // CSV logs may start with a header naming their columns, any other order has to match the default
+    bool isFirstLine = !sawFirstLine;
+    sawFirstLine = true;
+    if (isFirstLine && (isalpha((u8)*text) || *text == '"'))
+    {
+        if (!parseCsvHeader(text, &columns))
+        {
+            report("Header has no speed or launchAngle column");
+        }
+        return;
+    }
+
+    LaunchRecord record;
+    bool parsed = *text == '{' ? parseJsonRecord(text, &record) : parseCsvRecord(text, &columns, &record);
+    if (!parsed)
+    {
+        report("Not a launch record, or its launch conditions are out of range");
+        return;
+    }
+
+    // The sim spawns a step's worth of shots at a time, so a full queue is given a moment rather than spun on
+    while (!queue.push(&record))
+    {
+        stats.queueFullWaits++;
+        if (quitting.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    stats.shotsQueued++;
+}
+
+void ShotIngest::read()
+{
+    while (!quitting.load(std::memory_order_relaxed))
+    {
+        s32 size = readIngestSource(&source, readBuffer, sizeof(readBuffer), INGEST_WAIT_MS);
+        if (size < 0)
+        {
+            break;
+        }
+
+        const u8 *cursor = readBuffer;
+        const u8 *end = readBuffer + size;
+        while (cursor < end)
+        {
+            const u8 *newline = (const u8 *)memchr(cursor, '\n', (size_t)(end - cursor));
+            const u8 *chunkEnd = newline != NULL ? newline : end;
+            size_t chunkSize = (size_t)(chunkEnd - cursor);
+
+            // One byte is kept for the terminator
+            if (lineLength + chunkSize < INGEST_MAX_LINE_LENGTH)
+            {
+                memcpy(line + lineLength, cursor, chunkSize);
+                lineLength += (u32)chunkSize;
+            }
+            else
+            {
+                lineTooLong = true;
+            }
+
+            if (newline == NULL)
+            {
+                break;
+            }
+
+            parseLine();
+            cursor = newline + 1;
+        }
+    }
+
+    if (quitting.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    // A pipe's last line doesn't need a newline
+    if (lineLength > 0 || lineTooLong)
+    {
+        parseLine();
+    }
+
+    spdlog::info("Ingest: Input ended after {} lines, {} shots queued", stats.lines.load(),
+                 stats.shotsQueued.load());
+    finished = true;
+}
+
+bool ShotIngest::spawnQueued(BallManager *ballManager, DrivingRange *range)
+{
+    ZoneScoped;
+
+    bool triedRecycling = false;
+    bool recycled = false;
+
+    for (u32 shotIndex = 0; shotIndex < config.shotsPerStep; shotIndex++)
+    {
+        // Balls that came to rest make room for the rest of the log, once a step at most since it moves every ball
+        if (ballManager->activeBalls >= MAX_BALLS)
+        {
+            if (triedRecycling)
+            {
+                break;
+            }
+            triedRecycling = true;
+
+            recycledBallCount = (u32)ballManager->activeBalls;
+            u32 cleared = ballManager->clearRestingBalls(recycledIndices);
+            stats.ballsRecycled += cleared;
+            recycled = cleared > 0;
+            if (ballManager->activeBalls >= MAX_BALLS)
+            {
+                break;
+            }
+        }
+
+        LaunchRecord record;
+        if (!queue.pop(&record))
+        {
+            break;
+        }
+
+        // Shots from bays the range doesn't have are hit from its last one
+        u32 bayIndex = std::min(record.bay, range->bayCount - 1);
+        const LaunchRequest *launch = &record.launch;
+        ballManager->spawnBall(launch->speed, launch->angle, launch->heading, launch->spinRate, launch->spinAngle,
+                               bayIndex, &range->bays[bayIndex].tee);
+        stats.shotsSpawned++;
+    }
+
+    return recycled;
+}
+
+void ShotIngest::logReport() const
+{
+    spdlog::info("Ingest: {} lines, {} shots queued, {} spawned, {} balls at rest cleared to make room",
+                 stats.lines.load(), stats.shotsQueued.load(), stats.shotsSpawned, stats.ballsRecycled);
+
+    u64 parseErrors = stats.parseErrors.load();
+    if (parseErrors > 0)
+    {
+        spdlog::warn("Ingest: {} lines were not launch records", parseErrors);
+    }
+}
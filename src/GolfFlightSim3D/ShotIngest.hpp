@@ -0,0 +1,144 @@
+#define INGEST_QUEUE_SIZE 4096  // Power of two
+#define INGEST_READ_BUFFER_SIZE 65536
+#define INGEST_MAX_LINE_LENGTH 1024
+#define INGEST_CACHE_LINE_SIZE 64
+
+// How long the reader waits for more input before checking whether it should stop
+#define INGEST_WAIT_MS 50
+
+// 60 steps a second spawn up to 15360 shots a second
+#define INGEST_DEFAULT_SHOTS_PER_STEP 256
+
+// Parse errors reported one by one before they are only counted
+#define INGEST_MAX_REPORTED_ERRORS 8
+
+enum LaunchField
+{
+    LAUNCH_FIELD_SPEED,      // m/s
+    LAUNCH_FIELD_SPEED_MPH,  // mph, in place of speed
+    LAUNCH_FIELD_LAUNCH_ANGLE,
+    LAUNCH_FIELD_HEADING,
+    LAUNCH_FIELD_SPIN_RATE,  // rpm
+    LAUNCH_FIELD_SPIN_ANGLE,
+    LAUNCH_FIELD_BAY,  // Counted from 1 like in the UI
+
+    LAUNCH_FIELD_COUNT,
+    LAUNCH_FIELD_IGNORED = LAUNCH_FIELD_COUNT,
+};
+
+#define INGEST_MAX_CSV_COLUMNS 32
+
+// Which field each CSV column holds, from the header line or the default order
+struct CsvColumns
+{
+    u8 fields[INGEST_MAX_CSV_COLUMNS];
+    u32 count;
+};
+
+struct LaunchRecord
+{
+    LaunchRequest launch;
+    u32 bay;
+};
+
+// Bounded queue between one producer and one consumer thread. Each side only writes its own index, so neither ever
+// waits on a lock, and keeps a copy of the other side's index that is only reloaded when the queue looks full or empty.
+// The two sides are kept on separate cache lines so they don't steal them from each other on every record.
+struct LaunchQueue
+{
+    bool push(const LaunchRecord *record);
+    bool pop(LaunchRecord *outRecord);
+
+private:
+    // Reader thread
+    std::atomic<u32> writeIndex;
+    u32 cachedReadIndex;
+    u8 writerPadding[INGEST_CACHE_LINE_SIZE - 2 * sizeof(u32)];
+
+    // Sim thread
+    std::atomic<u32> readIndex;
+    u32 cachedWriteIndex;
+    u8 readerPadding[INGEST_CACHE_LINE_SIZE - 2 * sizeof(u32)];
+
+    LaunchRecord records[INGEST_QUEUE_SIZE];
+};
+
+// A file or pipe the shots are read from
+struct IngestSource
+{
+#ifdef _WIN32
+    HANDLE handle;
+#else
+    s32 fd;
+#endif
+    bool isFile;  // Regular files are followed as they grow, pipes end when their writer closes them
+    bool isStdin;
+};
+
+struct ShotIngestConfig
+{
+    const char *path;  // NULL when no shots are ingested, "-" for stdin
+    u32 shotsPerStep;  // Most shots spawned in one step
+};
+
+struct ShotIngestStats
+{
+    // Reader thread
+    std::atomic<u64> lines;
+    std::atomic<u64> shotsQueued;
+    std::atomic<u64> parseErrors;
+    std::atomic<u64> queueFullWaits;  // Times the reader had to wait for the sim to make room
+
+    // Sim thread
+    u64 shotsSpawned;
+    u64 ballsRecycled;
+};
+
+// Replays launch records from a CSV or NDJSON file or pipe. A background thread reads and parses them into a bounded
+// queue, the sim thread spawns them at the start of its steps. When the queue fills up the reader waits, so no shot is
+// dropped and a log is replayed as fast as the sim takes it.
+struct ShotIngest
+{
+    ShotIngestStats stats;
+
+    // Where each ball moved to in the last recycle, BALL_CLEARED for the ones cleared, over the balls active before it
+    u32 recycledIndices[MAX_BALLS];
+    u32 recycledBallCount;
+
+    bool open(const ShotIngestConfig *ingestConfig);
+    void close();
+
+    // Returns true when resting balls were cleared to make room, which moves the remaining balls to the indices in
+    // recycledIndices
+    bool spawnQueued(BallManager *ballManager, DrivingRange *range);
+
+    bool isFinished() const;
+    void logReport() const;
+
+private:
+    ShotIngestConfig config;
+    IngestSource source;
+    LaunchQueue queue;
+
+    std::thread reader;
+    std::atomic<bool> quitting;
+    std::atomic<bool> finished;
+
+    u8 readBuffer[INGEST_READ_BUFFER_SIZE];
+    char line[INGEST_MAX_LINE_LENGTH];
+    u32 lineLength;
+    bool lineTooLong;
+    bool sawFirstLine;
+    CsvColumns columns;
+
+    void read();
+    void parseLine();
+    void report(const char *problem);
+};
+
+void setDefaultCsvColumns(CsvColumns *columns);
+bool parseCsvHeader(const char *text, CsvColumns *outColumns);
+bool parseCsvRecord(const char *text, const CsvColumns *columns, LaunchRecord *outRecord);
+bool parseJsonRecord(const char *text, LaunchRecord *outRecord);
+
+ShotIngestConfig *getShotIngestConfig();
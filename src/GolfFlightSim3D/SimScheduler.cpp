@@ -0,0 +1,160 @@
+static const char *simOverloadPolicyNames[SIM_OVERLOAD_POLICY_COUNT] = {
+    "dilate",
+    "catch-up",
+};
+
+// Half a 60 Hz frame for simulation leaves the other half for rendering
+static SimSchedulerConfig simSchedulerConfig = {0.008F, 6, 0.25F, SIM_OVERLOAD_DILATE};
+
+SimSchedulerConfig *getSimSchedulerConfig()
+{
+    return &simSchedulerConfig;
+}
+
+const char *getSimOverloadPolicyName(SimOverloadPolicy policy)
+{
+    return simOverloadPolicyNames[policy];
+}
+
+bool parseSimOverloadPolicy(const char *policy)
+{
+    for (u32 policyIndex = 0; policyIndex < SIM_OVERLOAD_POLICY_COUNT; policyIndex++)
+    {
+        if (strcmp(policy, simOverloadPolicyNames[policyIndex]) == 0)
+        {
+            simSchedulerConfig.policy = (SimOverloadPolicy)policyIndex;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void SimScheduler::initialize(const SimSchedulerConfig *schedulerConfig, f32 dt)
+{
+    bzero(this, sizeof(SimScheduler));
+
+    config = *schedulerConfig;
+    stepTime = dt;
+    dilation = 1.0F;
+    windowStartTime = -1.0;
+
+    spdlog::info("Simulation: {:.1f} ms budget, {} max steps per frame, {} on overload", config.frameBudget * 1000.0F,
+                 config.maxStepsPerFrame, getSimOverloadPolicyName(config.policy));
+}
+
+void SimScheduler::beginFrame(f32 frameTime, f64 time)
+{
+    accumulator += frameTime;
+
+    frameStartTime = time;
+    frameSteps = 0;
+    frameOverloaded = false;
+
+    if (windowStartTime < 0.0)
+    {
+        windowStartTime = time;
+    }
+
+    total.realTime += frameTime;
+    window.realTime += frameTime;
+}
+
+bool SimScheduler::nextStep(f64 time)
+{
+    if (accumulator < stepTime)
+    {
+        return false;
+    }
+
+    if (config.maxStepsPerFrame > 0 && frameSteps >= config.maxStepsPerFrame)
+    {
+        frameOverloaded = true;
+        total.stepCapHits++;
+        window.stepCapHits++;
+        return false;
+    }
+
+    // At least one step always runs, otherwise a step that is slower than the whole budget would stop the simulation
+    if (config.frameBudget > 0.0F && frameSteps > 0 && time - frameStartTime >= config.frameBudget)
+    {
+        frameOverloaded = true;
+        total.budgetHits++;
+        window.budgetHits++;
+        return false;
+    }
+
+    accumulator -= stepTime;
+    frameSteps++;
+
+    return true;
+}
+
+f32 SimScheduler::getFrameLookahead() const
+{
+    f32 lookahead = accumulator;
+    if (config.maxStepsPerFrame > 0)
+    {
+        lookahead = std::min(lookahead, (f32)(config.maxStepsPerFrame - frameSteps) * stepTime);
+    }
+    return lookahead;
+}
+
+void SimScheduler::endFrame(f64 time)
+{
+    f32 dropped = 0.0F;
+    if (frameOverloaded)
+    {
+        total.overloadedFrames++;
+        window.overloadedFrames++;
+
+        // Dilating keeps the fraction of a step that is left, so interpolation between steps stays smooth
+        f32 keep = config.policy == SIM_OVERLOAD_CATCH_UP ? std::min(accumulator, config.maxBacklog)
+                                                          : fmodf(accumulator, stepTime);
+        dropped = accumulator - keep;
+        accumulator = keep;
+    }
+
+    f64 simulated = (f64)frameSteps * stepTime;
+    total.steps += frameSteps;
+    total.simTime += simulated;
+    total.droppedTime += dropped;
+    window.steps += frameSteps;
+    window.simTime += simulated;
+    window.droppedTime += dropped;
+
+    TracyPlot("Sim Dropped ms", (f64)dropped * 1000.0);
+
+    if (time - windowStartTime < SIM_REPORT_INTERVAL)
+    {
+        return;
+    }
+
+    dilation = window.realTime > 0.0 ? (f32)(window.simTime / window.realTime) : 1.0F;
+
+    if (window.droppedTime > 0.0)
+    {
+        spdlog::warn(
+            "Simulation: Overloaded, ran at {:.0f}% of real time and dropped {:.0f} ms over the last {:.0f} s "
+            "({} frames over budget, {} at the step cap)",
+            dilation * 100.0F, window.droppedTime * 1000.0, time - windowStartTime, window.budgetHits,
+            window.stepCapHits);
+    }
+
+    bzero(&window, sizeof(SimSchedulerStats));
+    windowStartTime = time;
+}
+
+void SimScheduler::logReport() const
+{
+    f64 speed = total.realTime > 0.0 ? total.simTime / total.realTime : 1.0;
+
+    spdlog::info("Simulation: {} steps, {:.1f} s simulated in {:.1f} s ({:.1f}% of real time)", total.steps,
+                 total.simTime, total.realTime, speed * 100.0);
+
+    if (total.overloadedFrames > 0)
+    {
+        spdlog::warn("Simulation: {} overloaded frames dropped {:.2f} s ({} over budget, {} at the step cap)",
+                     total.overloadedFrames, total.droppedTime, total.budgetHits, total.stepCapHits);
+    }
+}
@@ -0,0 +1,61 @@
+// How often a summary is logged while the simulation can't keep up
+#define SIM_REPORT_INTERVAL 5.0
+
+enum SimOverloadPolicy
+{
+    SIM_OVERLOAD_DILATE,    // Drop the steps that didn't fit, the simulation runs slower than real time
+    SIM_OVERLOAD_CATCH_UP,  // Keep them as a backlog for later frames, up to maxBacklog
+
+    SIM_OVERLOAD_POLICY_COUNT,
+};
+
+struct SimSchedulerConfig
+{
+    f32 frameBudget;      // CPU seconds the fixed steps may take per frame, 0 is unlimited
+    u32 maxStepsPerFrame;  // 0 is unlimited
+    f32 maxBacklog;       // Seconds of simulation the catch-up policy may owe
+    SimOverloadPolicy policy;
+};
+
+struct SimSchedulerStats
+{
+    f64 realTime;     // Frame time handed to the scheduler
+    f64 simTime;      // Time actually simulated
+    f64 droppedTime;  // Time thrown away to stay within budget
+    u64 steps;
+    u32 overloadedFrames;
+    u32 budgetHits;
+    u32 stepCapHits;
+};
+
+// Decides how many fixed steps run each frame. When steps get expensive an unbounded catch-up loop makes every frame
+// slower than the last, so the scheduler stops at the budget and lets simulated time fall behind instead.
+struct SimScheduler
+{
+    SimSchedulerConfig config;
+    f32 stepTime;
+    f32 accumulator;
+
+    SimSchedulerStats total;
+    f32 dilation;  // Simulated time over real time in the last report interval
+
+    void initialize(const SimSchedulerConfig *schedulerConfig, f32 dt);
+    void beginFrame(f32 frameTime, f64 time);
+    bool nextStep(f64 time);
+    // The most simulated time the steps left in this frame can cover, with the step cap and any backlog
+    f32 getFrameLookahead() const;
+    void endFrame(f64 time);
+    void logReport() const;
+
+private:
+    f64 frameStartTime;
+    u32 frameSteps;
+    bool frameOverloaded;
+
+    SimSchedulerStats window;
+    f64 windowStartTime;
+};
+
+SimSchedulerConfig *getSimSchedulerConfig();
+const char *getSimOverloadPolicyName(SimOverloadPolicy policy);
+bool parseSimOverloadPolicy(const char *policy);
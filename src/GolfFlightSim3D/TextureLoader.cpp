@@ -0,0 +1,192 @@
+#define PREFAULT_STRIDE 4096
+
+static bool validateCookedTexture(const MappedFile *file)
+{
+    const CookedTextureHeader *header = (const CookedTextureHeader *)file->data;
+
+    if (file->size < sizeof(CookedTextureHeader) || header->magic != COOKED_TEXTURE_MAGIC ||
+        header->version != COOKED_TEXTURE_VERSION || header->format != COOKED_TEXTURE_FORMAT_RGBA8 ||
+        header->mipCount == 0 || header->mipCount > COOKED_TEXTURE_MAX_MIPS)
+    {
+        return false;
+    }
+
+    for (u32 level = 0; level < header->mipCount; level++)
+    {
+        const CookedTextureMip *mip = &header->mips[level];
+        if (mip->size != (u64)mip->width * mip->height * 4 || mip->offset + mip->size > file->size)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Fault the whole mapping in from the worker, so a cold file cache costs the worker the disk read instead of the GL
+// thread during upload
+static void prefault(const MappedFile *file)
+{
+    volatile u8 sink = 0;
+    for (size_t offset = 0; offset < file->size; offset += PREFAULT_STRIDE)
+    {
+        sink ^= file->data[offset];
+    }
+    (void)sink;
+}
+
+static void decodeTexture(TextureLoadJob *job)
+{
+    ZoneScoped;
+    ZoneText(job->request.filepath, strlen(job->request.filepath));
+
+    char cookedFilepath[512];
+    if (cookedAssetPath(cookedFilepath, sizeof(cookedFilepath), job->request.filepath, COOKED_TEXTURE_EXTENSION) &&
+        job->cookedFile.open(cookedFilepath))
+    {
+        if (validateCookedTexture(&job->cookedFile))
+        {
+            prefault(&job->cookedFile);
+            job->cooked = (const CookedTextureHeader *)job->cookedFile.data;
+            job->succeeded = true;
+            return;
+        }
+
+        spdlog::warn("Ignoring stale or corrupt cooked texture \"{}\"", cookedFilepath);
+        job->cookedFile.close();
+    }
+
+    s32 comp;
+    job->pixels = stbi_load(job->request.filepath, &job->width, &job->height, &comp, STBI_rgb_alpha);
+    job->succeeded = job->pixels != NULL;
+}
+
+void TextureLoader::work()
+{
+    for (;;)
+    {
+        size_t jobIndex = nextJob.fetch_add(1);
+        if (jobIndex >= jobCount)
+        {
+            return;
+        }
+
+        TextureLoadJob *job = &jobs[jobIndex];
+        decodeTexture(job);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job->finished = true;
+        }
+        jobFinished.notify_one();
+    }
+}
+
+void TextureLoader::upload(TextureLoadJob *job, GLuint *texture)
+{
+    ZoneScoped;
+
+    glGenTextures(1, texture);
+    glBindTexture(GL_TEXTURE_2D, *texture);
+
+    if (job->cooked != NULL)
+    {
+        const CookedTextureHeader *header = job->cooked;
+        for (u32 level = 0; level < header->mipCount; level++)
+        {
+            const CookedTextureMip *mip = &header->mips[level];
+            glTexImage2D(GL_TEXTURE_2D, (GLint)level, GL_RGBA8, (GLsizei)mip->width, (GLsizei)mip->height, 0, GL_RGBA,
+                         GL_UNSIGNED_BYTE, (const GLvoid *)(job->cookedFile.data + mip->offset));
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)header->mipCount - 1);
+
+        job->cookedFile.close();
+        cookedCount++;
+    }
+    else
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, job->width, job->height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                     (const GLvoid *)job->pixels);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        stbi_image_free((void *)job->pixels);
+        decodedCount++;
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, job->request.wrapS);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, job->request.wrapT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+bool TextureLoader::load(const TextureLoadRequest *requests, size_t requestCount, GLuint *textures)
+{
+    ZoneScoped;
+
+    assert(requestCount <= arrayCount(jobs));
+
+    jobCount = requestCount;
+    nextJob = 0;
+    cookedCount = 0;
+    decodedCount = 0;
+
+    for (size_t jobIndex = 0; jobIndex < jobCount; jobIndex++)
+    {
+        TextureLoadJob *job = &jobs[jobIndex];
+        bzero(job, sizeof(TextureLoadJob));
+        job->request = requests[jobIndex];
+    }
+
+    size_t workerCount = glm::clamp((size_t)std::thread::hardware_concurrency(), (size_t)1, jobCount);
+    std::thread workers[TEXTURE_COUNT];
+    for (size_t workerIndex = 0; workerIndex < workerCount; workerIndex++)
+    {
+        workers[workerIndex] = std::thread(&TextureLoader::work, this);
+    }
+
+    bool success = true;
+
+    for (size_t uploadedCount = 0; uploadedCount < jobCount; uploadedCount++)
+    {
+        TextureLoadJob *job = NULL;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            for (;;)
+            {
+                for (size_t jobIndex = 0; jobIndex < jobCount && job == NULL; jobIndex++)
+                {
+                    if (jobs[jobIndex].finished && !jobs[jobIndex].uploaded)
+                    {
+                        job = &jobs[jobIndex];
+                    }
+                }
+
+                if (job != NULL)
+                {
+                    break;
+                }
+
+                jobFinished.wait(lock);
+            }
+
+            job->uploaded = true;
+        }
+
+        if (!job->succeeded)
+        {
+            spdlog::error("Failed to load \"{}\"", job->request.filepath);
+            success = false;
+            continue;
+        }
+
+        upload(job, &textures[job->request.textureId]);
+    }
+
+    for (size_t workerIndex = 0; workerIndex < workerCount; workerIndex++)
+    {
+        workers[workerIndex].join();
+    }
+
+    return success;
+}
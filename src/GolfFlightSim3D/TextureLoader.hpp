@@ -0,0 +1,47 @@
+struct TextureLoadRequest
+{
+    TextureID textureId;
+    const char *filepath;
+    GLint wrapS;
+    GLint wrapT;
+};
+
+// Produced by a worker thread, uploaded and released by the GL thread
+struct TextureLoadJob
+{
+    TextureLoadRequest request;
+
+    // A cooked texture carries its whole mip chain...
+    MappedFile cookedFile;
+    const CookedTextureHeader *cooked;
+
+    // ...otherwise the source image is decoded and GL generates the mips
+    u8 *pixels;
+    s32 width;
+    s32 height;
+
+    bool succeeded;
+    bool finished;
+    bool uploaded;
+};
+
+// Reading and decoding happen on worker threads while the GL thread uploads whichever texture finished first, so the
+// only work left on the GL thread is the copy into the driver
+struct TextureLoader
+{
+    u32 cookedCount;
+    u32 decodedCount;
+
+    bool load(const TextureLoadRequest *requests, size_t requestCount, GLuint *textures);
+
+private:
+    TextureLoadJob jobs[TEXTURE_COUNT];
+    size_t jobCount;
+
+    std::atomic<size_t> nextJob;
+    std::mutex mutex;
+    std::condition_variable jobFinished;
+
+    void work();
+    void upload(TextureLoadJob *job, GLuint *texture);
+};
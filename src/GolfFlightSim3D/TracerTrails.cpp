@@ -0,0 +1,187 @@
+#define TRAIL_SLOTS_PER_BALL (MAX_TRAIL_POINTS + 1)
+
+void TracerTrails::initialize(OpenGLProgram *program)
+{
+    glGenVertexArrays(1, &vertexArray);
+    glBindVertexArray(vertexArray);
+
+    // Every ball owns a fixed region of this buffer, so its size never depends on how many balls have been launched
+    glGenBuffers(1, &vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(MAX_BALLS * TRAIL_SLOTS_PER_BALL * sizeof(glm::vec3)), NULL,
+                 GL_DYNAMIC_DRAW);
+
+    glEnableVertexAttribArray(program->positionAttribute);
+    glVertexAttribPointer(program->positionAttribute, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (const GLvoid *)0);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    reset();
+}
+
+void TracerTrails::reset()
+{
+    for (size_t trailIndex = 0; trailIndex < MAX_BALLS; trailIndex++)
+    {
+        TracerTrail *trail = &trails[trailIndex];
+        trail->head = 0;
+        trail->count = 0;
+        trail->recorded = 0;
+        trail->uploaded = 0;
+    }
+}
+
+void TracerTrails::push(TracerTrail *trail, const glm::vec3 &point)
+{
+    trail->points[trail->head] = point;
+    trail->head = (trail->head + 1) % MAX_TRAIL_POINTS;
+
+    if (trail->count < MAX_TRAIL_POINTS)
+    {
+        trail->count++;
+    }
+    trail->recorded++;
+}
+
+void TracerTrails::record(BallManager *ballManager)
+{
+    const f32 minSegmentLengthSq = TRAIL_MIN_SEGMENT_LENGTH * TRAIL_MIN_SEGMENT_LENGTH;
+
+    for (size_t ballIndex = 0; ballIndex < ballManager->activeBalls; ballIndex++)
+    {
+        Ball *ball = ballManager->getBall(ballIndex);
+        TracerTrail *trail = &trails[ballIndex];
+
+        if (!ball->alive)
+        {
+            continue;
+        }
+
+        if (trail->recorded == 0)
+        {
+            push(trail, ball->startPosition);
+        }
+
+        u32 lastSlot = (trail->head + MAX_TRAIL_POINTS - 1) % MAX_TRAIL_POINTS;
+        if (glm::length2(ball->position - trail->points[lastSlot]) >= minSegmentLengthSq)
+        {
+            push(trail, ball->position);
+        }
+    }
+}
+
+void TracerTrails::uploadRange(size_t trailIndex, u32 firstSlot, u32 slotCount, const glm::vec3 *points)
+{
+    GLintptr offset = (GLintptr)((trailIndex * TRAIL_SLOTS_PER_BALL + firstSlot) * sizeof(glm::vec3));
+    glBufferSubData(GL_ARRAY_BUFFER, offset, (GLsizeiptr)(slotCount * sizeof(glm::vec3)), (const GLvoid *)points);
+
+    pointsUploaded += slotCount;
+}
+
+void TracerTrails::upload(size_t trailCount)
+{
+    pointsUploaded = 0;
+
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+
+    for (size_t trailIndex = 0; trailIndex < trailCount; trailIndex++)
+    {
+        TracerTrail *trail = &trails[trailIndex];
+
+        u32 pending = trail->recorded - trail->uploaded;
+        if (pending == 0)
+        {
+            continue;
+        }
+
+        // Anything older than the ring has already been overwritten and never needs to reach the GPU
+        if (pending > trail->count)
+        {
+            pending = trail->count;
+        }
+
+        u32 firstSlot = (trail->head + MAX_TRAIL_POINTS - pending) % MAX_TRAIL_POINTS;
+        u32 firstRun = pending < MAX_TRAIL_POINTS - firstSlot ? pending : MAX_TRAIL_POINTS - firstSlot;
+
+        uploadRange(trailIndex, firstSlot, firstRun, &trail->points[firstSlot]);
+
+        bool wroteSlotZero = firstSlot == 0;
+        if (pending > firstRun)
+        {
+            uploadRange(trailIndex, 0, pending - firstRun, &trail->points[0]);
+            wroteSlotZero = true;
+        }
+
+        if (wroteSlotZero)
+        {
+            uploadRange(trailIndex, MAX_TRAIL_POINTS, 1, &trail->points[0]);
+        }
+
+        trail->uploaded = trail->recorded;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void TracerTrails::draw(OpenGLProgram *program,
+                        const glm::mat4 &viewProjection,
+                        const u32 *trailIndices,
+                        size_t trailCount,
+                        ColorRGBA color)
+{
+    GLsizei stripCount = 0;
+
+    for (size_t listIndex = 0; listIndex < trailCount; listIndex++)
+    {
+        size_t trailIndex = trailIndices != NULL ? trailIndices[listIndex] : listIndex;
+        TracerTrail *trail = &trails[trailIndex];
+
+        if (trail->count < 2)
+        {
+            continue;
+        }
+
+        GLint base = (GLint)(trailIndex * TRAIL_SLOTS_PER_BALL);
+
+        if (trail->count < MAX_TRAIL_POINTS || trail->head == 0)
+        {
+            stripFirsts[stripCount] = base;
+            stripCounts[stripCount] = (GLsizei)trail->count;
+            stripCount++;
+        }
+        else
+        {
+            // Oldest points run from the head to the end of the ring, including the mirrored copy of slot 0, and the
+            // newest points continue from slot 0
+            stripFirsts[stripCount] = base + (GLint)trail->head;
+            stripCounts[stripCount] = (GLsizei)(TRAIL_SLOTS_PER_BALL - trail->head);
+            stripCount++;
+
+            stripFirsts[stripCount] = base;
+            stripCounts[stripCount] = (GLsizei)trail->head;
+            stripCount++;
+        }
+    }
+
+    stripsDrawn = (u32)stripCount;
+
+    if (stripCount == 0)
+    {
+        return;
+    }
+
+    glUseProgram(program->id);
+    glBindVertexArray(vertexArray);
+
+    glUniformMatrix4fv((GLint)program->modelViewProjectionUniform, 1, GL_FALSE, glm::value_ptr(viewProjection));
+    glUniform4f((GLint)program->colorUniform, color.r, color.g, color.b, color.a);
+
+    // The trail buffer only carries positions, so feed the color attribute a constant instead
+    glVertexAttrib4f(program->colorAttribute, 1.0F, 1.0F, 1.0F, 1.0F);
+
+    glMultiDrawArrays(GL_LINE_STRIP, stripFirsts, stripCounts, stripCount);
+
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#define MAX_TRAIL_POINTS 256
+#define TRAIL_MIN_SEGMENT_LENGTH 0.5F
+
+// Ring of recorded positions for a single ball. The GPU copy of each ring has one extra slot mirroring slot 0, so a
+// ring that has wrapped around can still be drawn as two line strips without a gap at the seam.
+struct TracerTrail
+{
+    glm::vec3 points[MAX_TRAIL_POINTS];
+
+    u32 head;      // Next slot to write
+    u32 count;     // Valid points in the ring, saturates at MAX_TRAIL_POINTS
+    u32 recorded;  // Points ever recorded
+    u32 uploaded;  // Value of recorded at the time of the last upload
+};
+
+struct TracerTrails
+{
+    GLuint vertexArray;
+    GLuint vertexBuffer;
+
+    u32 pointsUploaded;
+    u32 stripsDrawn;
+
+    void initialize(OpenGLProgram *program);
+    void reset();
+    void record(BallManager *ballManager);
+    void upload(size_t trailCount);
+    // Draws the trails of the listed balls, or of the first trailCount balls when there is no list
+    void draw(OpenGLProgram *program,
+              const glm::mat4 &viewProjection,
+              const u32 *trailIndices,
+              size_t trailCount,
+              ColorRGBA color);
+
+private:
+    TracerTrail trails[MAX_BALLS];
+
+    GLint stripFirsts[MAX_BALLS * 2];
+    GLsizei stripCounts[MAX_BALLS * 2];
+
+    void push(TracerTrail *trail, const glm::vec3 &point);
+    void uploadRange(size_t trailIndex, u32 firstSlot, u32 slotCount, const glm::vec3 *points);
+};
\ No newline at end of file
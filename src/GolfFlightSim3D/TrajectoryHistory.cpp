@@ -0,0 +1,664 @@
+static TrajectoryHistoryConfig trajectoryHistoryConfig = {0};
+
+TrajectoryHistoryConfig *getTrajectoryHistoryConfig()
+{
+    return &trajectoryHistoryConfig;
+}
+
+static const char *trajectoryDecoderNames[TRAJECTORY_DECODER_COUNT] = {"scalar", "sse2"};
+
+#define TRAJECTORY_HEADER_UNITS (sizeof(TrajectoryBlock) / sizeof(TrajectoryUnit))
+
+static f64 getHistoryTime()
+{
+    return std::chrono::duration<f64>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Small values of either sign to small unsigned ones: 0, -1, 1, -2, ... to 0, 1, 2, 3, ...
+static u32 zigzagEncode(u32 value)
+{
+    return (value << 1) ^ (0U - (value >> 31));
+}
+
+static u32 zigzagDecode(u32 value)
+{
+    return (value >> 1) ^ (0U - (value & 1));
+}
+
+// Every value of a block is measured when it's encoded, a loop over the bits mispredicts too often for that
+static u32 getBitWidth(u32 value)
+{
+#if defined(_MSC_VER)
+    unsigned long highestBit;
+    return _BitScanReverse(&highestBit, value) ? (u32)highestBit + 1 : 0;
+#else
+    return value != 0 ? 32 - (u32)__builtin_clz(value) : 0;
+#endif
+}
+
+static const TrajectoryException *getTrajectoryExceptions(const TrajectoryBlock *block)
+{
+    const TrajectoryUnit *data = (const TrajectoryUnit *)(block + 1);
+    return (const TrajectoryException *)(data + block->widths[0] + block->widths[1] + block->widths[2]);
+}
+
+static void patchTrajectoryExceptions(const TrajectoryBlock *block, u32 *values)
+{
+    const TrajectoryException *exceptions = getTrajectoryExceptions(block);
+    for (u32 exceptionIndex = 0; exceptionIndex < block->exceptionCount; exceptionIndex++)
+    {
+        values[exceptions[exceptionIndex].slot] = exceptions[exceptionIndex].value;
+    }
+}
+
+// Sums and differences are taken on u32s, so positions far enough apart to overflow an s32 still wrap back exactly
+static void decodeTrajectoryBlockScalar(const TrajectoryBlock *block, f32 *outPositions)
+{
+    u32 values[3 * TRAJECTORY_BLOCK_SAMPLES];
+
+    const TrajectoryUnit *data = (const TrajectoryUnit *)(block + 1);
+    for (u32 axis = 0; axis < 3; axis++)
+    {
+        u32 width = block->widths[axis];
+        u32 mask = width == 32 ? 0xFFFFFFFFU : (1U << width) - 1;
+        for (u32 sampleIndex = 0; sampleIndex < TRAJECTORY_BLOCK_SAMPLES; sampleIndex++)
+        {
+            u32 value = 0;
+            if (width != 0)
+            {
+                u32 lane = sampleIndex & 3;
+                u32 bit = (sampleIndex >> 2) * width;
+                u32 shift = bit & 31;
+                value = data[bit >> 5].lanes[lane] >> shift;
+                if (shift + width > 32)
+                {
+                    value |= data[(bit >> 5) + 1].lanes[lane] << (32 - shift);
+                }
+                value &= mask;
+            }
+            values[axis * TRAJECTORY_BLOCK_SAMPLES + sampleIndex] = value;
+        }
+        data += width;
+    }
+
+    patchTrajectoryExceptions(block, values);
+
+    for (u32 axis = 0; axis < 3; axis++)
+    {
+        u32 step = (u32)block->entryStep[axis];
+        u32 position = (u32)block->first[axis] - step;
+        for (u32 sampleIndex = 0; sampleIndex < TRAJECTORY_BLOCK_SAMPLES; sampleIndex++)
+        {
+            step += zigzagDecode(values[axis * TRAJECTORY_BLOCK_SAMPLES + sampleIndex]);
+            position += step;
+            outPositions[sampleIndex * 3 + axis] = (f32)(s32)position * TRAJECTORY_QUANTUM;
+        }
+    }
+}
+
+#if defined(COLLISION_KERNELS_X86)
+// Four values per axis at a time. They are unpacked with one shift for all lanes and patched, then both running sums
+// are taken across the lanes with two shifted adds each. The three axes go in step so they can be interleaved into
+// glm::vec3s in registers.
+COLLISION_TARGET_SSE2
+static void decodeTrajectoryBlockSSE2(const TrajectoryBlock *block, f32 *outPositions)
+{
+    u32 values[3 * TRAJECTORY_BLOCK_SAMPLES];
+    const __m128i zero = _mm_setzero_si128();
+
+    const TrajectoryUnit *data = (const TrajectoryUnit *)(block + 1);
+    for (u32 axis = 0; axis < 3; axis++)
+    {
+        u32 width = block->widths[axis];
+        __m128i *out = (__m128i *)&values[axis * TRAJECTORY_BLOCK_SAMPLES];
+        if (width == 0)
+        {
+            for (u32 row = 0; row < TRAJECTORY_BLOCK_SAMPLES / 4; row++)
+            {
+                _mm_storeu_si128(&out[row], zero);
+            }
+            continue;
+        }
+
+        __m128i mask = _mm_set1_epi32((s32)(width == 32 ? 0xFFFFFFFFU : (1U << width) - 1));
+        for (u32 row = 0; row < TRAJECTORY_BLOCK_SAMPLES / 4; row++)
+        {
+            u32 bit = row * width;
+            u32 shift = bit & 31;
+            __m128i low = _mm_load_si128((const __m128i *)&data[bit >> 5]);
+            __m128i value = _mm_srl_epi32(low, _mm_cvtsi32_si128((s32)shift));
+            if (shift + width > 32)
+            {
+                __m128i high = _mm_load_si128((const __m128i *)&data[(bit >> 5) + 1]);
+                value = _mm_or_si128(value, _mm_sll_epi32(high, _mm_cvtsi32_si128((s32)(32 - shift))));
+            }
+            _mm_storeu_si128(&out[row], _mm_and_si128(value, mask));
+        }
+        data += width;
+    }
+
+    patchTrajectoryExceptions(block, values);
+
+    __m128i steps[3];
+    __m128i positions[3];
+    for (u32 axis = 0; axis < 3; axis++)
+    {
+        steps[axis] = _mm_set1_epi32(block->entryStep[axis]);
+        positions[axis] = _mm_set1_epi32((s32)((u32)block->first[axis] - (u32)block->entryStep[axis]));
+    }
+
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128 quantum = _mm_set1_ps(TRAJECTORY_QUANTUM);
+
+    for (u32 row = 0; row < TRAJECTORY_BLOCK_SAMPLES / 4; row++)
+    {
+        __m128 scaled[3];
+        for (u32 axis = 0; axis < 3; axis++)
+        {
+            __m128i value = _mm_loadu_si128((const __m128i *)&values[axis * TRAJECTORY_BLOCK_SAMPLES + row * 4]);
+            __m128i change = _mm_xor_si128(_mm_srli_epi32(value, 1), _mm_sub_epi32(zero, _mm_and_si128(value, one)));
+            change = _mm_add_epi32(change, _mm_slli_si128(change, 4));
+            change = _mm_add_epi32(change, _mm_slli_si128(change, 8));
+            __m128i step = _mm_add_epi32(change, steps[axis]);
+            steps[axis] = _mm_shuffle_epi32(step, _MM_SHUFFLE(3, 3, 3, 3));
+
+            step = _mm_add_epi32(step, _mm_slli_si128(step, 4));
+            step = _mm_add_epi32(step, _mm_slli_si128(step, 8));
+            __m128i position = _mm_add_epi32(step, positions[axis]);
+            positions[axis] = _mm_shuffle_epi32(position, _MM_SHUFFLE(3, 3, 3, 3));
+
+            scaled[axis] = _mm_mul_ps(_mm_cvtepi32_ps(position), quantum);
+        }
+
+        // x0 x1 x2 x3, y0 y1 y2 y3, z0 z1 z2 z3 to x0 y0 z0 x1, y1 z1 x2 y2, z2 x3 y3 z3
+        __m128 xyLow = _mm_unpacklo_ps(scaled[0], scaled[1]);
+        __m128 xyHigh = _mm_unpackhi_ps(scaled[0], scaled[1]);
+        __m128 zx = _mm_shuffle_ps(scaled[2], xyLow, _MM_SHUFFLE(2, 2, 0, 0));
+        __m128 yz = _mm_shuffle_ps(xyLow, scaled[2], _MM_SHUFFLE(1, 1, 3, 3));
+        __m128 zxy = _mm_shuffle_ps(scaled[2], xyHigh, _MM_SHUFFLE(3, 2, 3, 2));
+
+        f32 *out = &outPositions[row * 12];
+        _mm_storeu_ps(out, _mm_shuffle_ps(xyLow, zx, _MM_SHUFFLE(2, 0, 1, 0)));
+        _mm_storeu_ps(out + 4, _mm_shuffle_ps(yz, xyHigh, _MM_SHUFFLE(1, 0, 2, 0)));
+        _mm_storeu_ps(out + 8, _mm_shuffle_ps(zxy, zxy, _MM_SHUFFLE(1, 3, 2, 0)));
+    }
+}
+#endif
+
+typedef void TrajectoryDecoder(const TrajectoryBlock *block, f32 *outPositions);
+
+static TrajectoryDecoder *const trajectoryDecoders[TRAJECTORY_DECODER_COUNT] = {
+    decodeTrajectoryBlockScalar,
+#if defined(COLLISION_KERNELS_X86)
+    decodeTrajectoryBlockSSE2,
+#else
+    NULL,
+#endif
+};
+
+const char *getTrajectoryDecoderName(TrajectoryDecoderType type)
+{
+    return trajectoryDecoderNames[type];
+}
+
+bool isTrajectoryDecoderSupported(TrajectoryDecoderType type)
+{
+    if (trajectoryDecoders[type] == NULL)
+    {
+        return false;
+    }
+    return type == TRAJECTORY_DECODER_SCALAR || isCollisionKernelSupported(COLLISION_KERNEL_SSE2);
+}
+
+static TrajectoryDecoder *trajectoryDecoder = isTrajectoryDecoderSupported(TRAJECTORY_DECODER_SSE2)
+                                                  ? trajectoryDecoders[TRAJECTORY_DECODER_SSE2]
+                                                  : trajectoryDecoders[TRAJECTORY_DECODER_SCALAR];
+
+bool setTrajectoryDecoder(TrajectoryDecoderType type)
+{
+    if (!isTrajectoryDecoderSupported(type))
+    {
+        return false;
+    }
+
+    trajectoryDecoder = trajectoryDecoders[type];
+    return true;
+}
+
+void decodeTrajectoryBlock(const TrajectoryBlock *block, glm::vec3 *outPositions, u32 count)
+{
+    if (count == TRAJECTORY_BLOCK_SAMPLES)
+    {
+        trajectoryDecoder(block, &outPositions[0].x);
+        return;
+    }
+
+    glm::vec3 positions[TRAJECTORY_BLOCK_SAMPLES];
+    trajectoryDecoder(block, &positions[0].x);
+    memcpy(outPositions, positions, count * sizeof(glm::vec3));
+}
+
+bool TrajectoryHistory::initialize(const TrajectoryHistoryConfig *historyConfig)
+{
+    config = *historyConfig;
+    bzero(&stats, sizeof(stats));
+    steps = 0;
+    stepTime = 0.0F;
+    trackCount = 0;
+    usedUnits = 1;  // Offset 0 stands for no block
+
+    unitCount = (u32)std::min(config.budget / sizeof(TrajectoryUnit), (size_t)0xFFFFFFFFU);
+    units = (TrajectoryUnit *)malloc(unitCount * sizeof(TrajectoryUnit));
+    if (units == NULL)
+    {
+        spdlog::error("Failed to allocate {:.1f} MiB for the trajectory history", bytesToMiB(config.budget));
+        return false;
+    }
+    trackAllocation(MEMORY_TAG_WORLD, units, unitCount * sizeof(TrajectoryUnit));
+
+    for (u32 ballIndex = 0; ballIndex < MAX_BALLS; ballIndex++)
+    {
+        pending[ballIndex].count = 0;
+        pending[ballIndex].track = TRAJECTORY_NO_TRACK;
+        pending[ballIndex].finished = false;
+    }
+
+    spdlog::info("Trajectory history: Keeping every ball's positions in {:.1f} MiB", bytesToMiB(config.budget));
+    return true;
+}
+
+void TrajectoryHistory::shutdown()
+{
+    if (units != NULL)
+    {
+        trackFree(MEMORY_TAG_WORLD, units, unitCount * sizeof(TrajectoryUnit));
+        free(units);
+        units = NULL;
+    }
+}
+
+// Encodes a full block, or the part filled block of a track being closed. Values after the positions it holds
+// keep their step, so they are zero and don't widen the block.
+bool TrajectoryHistory::encode(PendingBlock *block)
+{
+    TrajectoryTrack *track = &tracks[block->track];
+
+    u32 values[3 * TRAJECTORY_BLOCK_SAMPLES];
+    u32 widths[3];
+    u32 exceptionCount = 0;
+    s32 exitStep[3];
+    for (u32 axis = 0; axis < 3; axis++)
+    {
+        // A track's first block starts at the speed it leaves its first position with, not from standing
+        if (track->firstBlock == 0)
+        {
+            block->entryStep[axis] =
+                block->count > 1 ? (s32)((u32)block->positions[1][axis] - (u32)block->positions[0][axis]) : 0;
+        }
+
+        u32 *axisValues = &values[axis * TRAJECTORY_BLOCK_SAMPLES];
+        u32 widthCounts[33] = {0};
+        u32 step = (u32)block->entryStep[axis];
+        u32 previous = (u32)block->positions[0][axis] - step;
+        for (u32 sampleIndex = 0; sampleIndex < TRAJECTORY_BLOCK_SAMPLES; sampleIndex++)
+        {
+            u32 position = sampleIndex < block->count ? (u32)block->positions[sampleIndex][axis] : previous + step;
+            u32 nextStep = position - previous;
+            axisValues[sampleIndex] = zigzagEncode(nextStep - step);
+            widthCounts[getBitWidth(axisValues[sampleIndex])]++;
+
+            step = nextStep;
+            previous = position;
+        }
+        exitStep[axis] = (s32)step;
+
+        // Every value packed costs the width, every one too wide for it costs an exception. A bounce is one or two
+        // large values in an otherwise narrow block.
+        u32 wider = 0;
+        u32 exceptions = 0;
+        u64 bestCost = ~0ULL;
+        for (s32 width = 32; width >= 0; width--)
+        {
+            u64 cost = (u64)width * TRAJECTORY_BLOCK_SAMPLES + (u64)wider * sizeof(TrajectoryException) * 8;
+            if (cost <= bestCost)
+            {
+                bestCost = cost;
+                widths[axis] = (u32)width;
+                exceptions = wider;
+            }
+            wider += widthCounts[width];
+        }
+        exceptionCount += exceptions;
+    }
+
+    u32 dataUnits = widths[0] + widths[1] + widths[2];
+    u32 blockUnits = (u32)TRAJECTORY_HEADER_UNITS + dataUnits + (exceptionCount + 1) / 2;
+    if (unitCount - usedUnits < blockUnits)
+    {
+        return false;
+    }
+
+    u32 blockOffset = usedUnits;
+    usedUnits += blockUnits;
+
+    TrajectoryBlock *header = (TrajectoryBlock *)&units[blockOffset];
+    TrajectoryUnit *data = (TrajectoryUnit *)(header + 1);
+    TrajectoryException *exceptions = (TrajectoryException *)(data + dataUnits);
+    bzero(data, (blockUnits - TRAJECTORY_HEADER_UNITS) * sizeof(TrajectoryUnit));
+
+    header->exceptionCount = 0;
+    for (u32 axis = 0; axis < 3; axis++)
+    {
+        header->first[axis] = block->positions[0][axis];
+        header->entryStep[axis] = block->entryStep[axis];
+        header->widths[axis] = (u8)widths[axis];
+
+        u32 width = widths[axis];
+        u32 mask = width == 32 ? 0xFFFFFFFFU : (1U << width) - 1;
+        for (u32 sampleIndex = 0; sampleIndex < TRAJECTORY_BLOCK_SAMPLES; sampleIndex++)
+        {
+            u32 slot = axis * TRAJECTORY_BLOCK_SAMPLES + sampleIndex;
+            u32 value = values[slot];
+            if (value > mask)
+            {
+                exceptions[header->exceptionCount].slot = slot;
+                exceptions[header->exceptionCount].value = value;
+                header->exceptionCount++;
+                continue;
+            }
+            if (width == 0)
+            {
+                continue;
+            }
+
+            u32 lane = sampleIndex & 3;
+            u32 bit = (sampleIndex >> 2) * width;
+            u32 shift = bit & 31;
+            data[bit >> 5].lanes[lane] |= value << shift;
+            if (shift + width > 32)
+            {
+                data[(bit >> 5) + 1].lanes[lane] |= value >> (32 - shift);
+            }
+        }
+        data += width;
+
+        block->entryStep[axis] = exitStep[axis];
+    }
+    header->next = 0;
+
+    if (track->firstBlock == 0)
+    {
+        track->firstBlock = blockOffset;
+    }
+    else
+    {
+        ((TrajectoryBlock *)&units[track->lastBlock])->next = blockOffset;
+    }
+    track->lastBlock = blockOffset;
+
+    stats.encodedSamples += block->count;
+    stats.encodedBytes += blockUnits * sizeof(TrajectoryUnit);
+    block->count = 0;
+    return true;
+}
+
+void TrajectoryHistory::closeTrack(PendingBlock *block)
+{
+    TrajectoryTrack *track = &tracks[block->track];
+    if (block->count > 0 && !encode(block))
+    {
+        track->sampleCount -= block->count;
+        stats.droppedSamples += block->count;
+        block->count = 0;
+    }
+    track->open = false;
+}
+
+void TrajectoryHistory::record(BallManager *ballManager, f32 dt)
+{
+    ZoneScoped;
+
+    steps++;
+    stepTime = dt;
+
+    for (size_t ballIndex = 0; ballIndex < ballManager->activeBalls; ballIndex++)
+    {
+        const Ball *ball = ballManager->getBall(ballIndex);
+        PendingBlock *block = &pending[ballIndex];
+        if (!ball->alive || block->finished)
+        {
+            continue;
+        }
+
+        if (block->track == TRAJECTORY_NO_TRACK)
+        {
+            if (trackCount == TRAJECTORY_MAX_TRACKS)
+            {
+                stats.droppedSamples++;
+                continue;
+            }
+
+            block->track = trackCount++;
+            block->count = 0;
+            TrajectoryTrack *track = &tracks[block->track];
+            track->firstStep = steps;
+            track->sampleCount = 0;
+            track->firstBlock = 0;
+            track->lastBlock = 0;
+            track->ball = (u32)ballIndex;
+            track->bay = ball->bay;
+            track->open = true;
+        }
+
+        TrajectoryTrack *track = &tracks[block->track];
+        for (u32 axis = 0; axis < 3; axis++)
+        {
+            block->positions[block->count][axis] = (s32)floorf(ball->position[axis] / TRAJECTORY_QUANTUM + 0.5F);
+        }
+        block->count++;
+        track->sampleCount++;
+        stats.samples++;
+
+        bool resting = ball->state == BALL_STATE_IDLE;
+        if (block->count == TRAJECTORY_BLOCK_SAMPLES && !encode(block))
+        {
+            // Out of budget, the track keeps what it has
+            track->sampleCount -= block->count;
+            stats.droppedSamples += block->count;
+            block->count = 0;
+            resting = true;
+        }
+
+        if (resting)
+        {
+            closeTrack(block);
+            block->finished = true;
+        }
+    }
+}
+
+void TrajectoryHistory::closeTracks()
+{
+    for (u32 ballIndex = 0; ballIndex < MAX_BALLS; ballIndex++)
+    {
+        PendingBlock *block = &pending[ballIndex];
+        if (block->track != TRAJECTORY_NO_TRACK && tracks[block->track].open)
+        {
+            closeTrack(block);
+        }
+        block->track = TRAJECTORY_NO_TRACK;
+        block->count = 0;
+        block->finished = false;
+    }
+}
+
+void TrajectoryHistory::moveBalls(const u32 *newIndices, u32 ballCount)
+{
+    // Balls only ever move down, so every entry is moved before another one is moved onto it
+    u32 keptCount = 0;
+    for (u32 ballIndex = 0; ballIndex < ballCount; ballIndex++)
+    {
+        PendingBlock *block = &pending[ballIndex];
+        u32 newIndex = newIndices[ballIndex];
+        if (newIndex == BALL_CLEARED)
+        {
+            if (block->track != TRAJECTORY_NO_TRACK && tracks[block->track].open)
+            {
+                closeTrack(block);
+            }
+            continue;
+        }
+
+        if (newIndex != ballIndex)
+        {
+            pending[newIndex] = *block;
+        }
+        if (block->track != TRAJECTORY_NO_TRACK)
+        {
+            tracks[block->track].ball = newIndex;
+        }
+        keptCount = newIndex + 1;
+    }
+
+    for (u32 ballIndex = keptCount; ballIndex < ballCount; ballIndex++)
+    {
+        pending[ballIndex].track = TRAJECTORY_NO_TRACK;
+        pending[ballIndex].count = 0;
+        pending[ballIndex].finished = false;
+    }
+}
+
+const TrajectoryTrack *TrajectoryHistory::getTrack(u32 trackIndex) const
+{
+    return &tracks[trackIndex];
+}
+
+u32 TrajectoryHistory::getBallTrack(size_t ballIndex) const
+{
+    return pending[ballIndex].track;
+}
+
+const TrajectoryBlock *TrajectoryHistory::findBlock(const TrajectoryTrack *track, u32 blockIndex) const
+{
+    u32 offset = track->firstBlock;
+    for (u32 hop = 0; hop < blockIndex; hop++)
+    {
+        offset = ((const TrajectoryBlock *)&units[offset])->next;
+    }
+    return (const TrajectoryBlock *)&units[offset];
+}
+
+void TrajectoryHistory::decodeSample(u32 trackIndex, u32 sampleIndex, glm::vec3 *outPosition) const
+{
+    const TrajectoryTrack *track = &tracks[trackIndex];
+
+    // The newest positions of an open track are still waiting for their block to fill
+    if (track->open)
+    {
+        const PendingBlock *block = &pending[track->ball];
+        u32 firstPending = track->sampleCount - block->count;
+        if (sampleIndex >= firstPending)
+        {
+            const s32 *position = block->positions[sampleIndex - firstPending];
+            *outPosition = glm::vec3((f32)position[0] * TRAJECTORY_QUANTUM, (f32)position[1] * TRAJECTORY_QUANTUM,
+                                     (f32)position[2] * TRAJECTORY_QUANTUM);
+            return;
+        }
+    }
+
+    glm::vec3 positions[TRAJECTORY_BLOCK_SAMPLES];
+    decodeTrajectoryBlock(findBlock(track, sampleIndex / TRAJECTORY_BLOCK_SAMPLES), positions,
+                          TRAJECTORY_BLOCK_SAMPLES);
+    *outPosition = positions[sampleIndex % TRAJECTORY_BLOCK_SAMPLES];
+}
+
+glm::vec3 TrajectoryHistory::samplePosition(u32 trackIndex, f64 time) const
+{
+    const TrajectoryTrack *track = &tracks[trackIndex];
+    if (track->sampleCount == 0 || stepTime == 0.0F)
+    {
+        return glm::vec3(0.0F);
+    }
+
+    f64 sample = time / stepTime - track->firstStep;
+    sample = glm::clamp(sample, 0.0, (f64)(track->sampleCount - 1));
+    u32 sampleIndex = (u32)sample;
+    f32 fraction = (f32)(sample - sampleIndex);
+
+    // Both neighbours come out of one decode, unless the next one starts another block or is still pending
+    u32 encodedSamples = track->open ? track->sampleCount - pending[track->ball].count : track->sampleCount;
+    u32 blockSample = sampleIndex % TRAJECTORY_BLOCK_SAMPLES;
+    if (fraction != 0.0F && blockSample + 1 < TRAJECTORY_BLOCK_SAMPLES && sampleIndex + 1 < encodedSamples)
+    {
+        glm::vec3 positions[TRAJECTORY_BLOCK_SAMPLES];
+        decodeTrajectoryBlock(findBlock(track, sampleIndex / TRAJECTORY_BLOCK_SAMPLES), positions,
+                              TRAJECTORY_BLOCK_SAMPLES);
+        return glm::mix(positions[blockSample], positions[blockSample + 1], fraction);
+    }
+
+    glm::vec3 position;
+    decodeSample(trackIndex, sampleIndex, &position);
+    if (fraction == 0.0F)
+    {
+        return position;
+    }
+
+    glm::vec3 nextPosition;
+    decodeSample(trackIndex, sampleIndex + 1, &nextPosition);
+    return glm::mix(position, nextPosition, fraction);
+}
+
+void TrajectoryHistory::decodeTrack(u32 trackIndex, glm::vec3 *outPositions) const
+{
+    const TrajectoryTrack *track = &tracks[trackIndex];
+
+    u32 sampleIndex = 0;
+    for (u32 offset = track->firstBlock; offset != 0 && sampleIndex < track->sampleCount;)
+    {
+        const TrajectoryBlock *block = (const TrajectoryBlock *)&units[offset];
+        u32 count = std::min(track->sampleCount - sampleIndex, (u32)TRAJECTORY_BLOCK_SAMPLES);
+        decodeTrajectoryBlock(block, &outPositions[sampleIndex], count);
+        sampleIndex += count;
+        offset = block->next;
+    }
+
+    for (; sampleIndex < track->sampleCount; sampleIndex++)
+    {
+        decodeSample(trackIndex, sampleIndex, &outPositions[sampleIndex]);
+    }
+}
+
+void TrajectoryHistory::logReport() const
+{
+    f64 rawBytes = (f64)stats.encodedSamples * sizeof(glm::vec3);
+    spdlog::info("Trajectory history: {} tracks, {} positions, {:.2f} MiB encoded for {:.2f} MiB of glm::vec3s "
+                 "({:.1f}x, {:.2f} bytes a position), {} dropped",
+                 trackCount, stats.samples, bytesToMiB(stats.encodedBytes), bytesToMiB(rawBytes),
+                 stats.encodedBytes > 0 ? rawBytes / (f64)stats.encodedBytes : 0.0,
+                 stats.encodedSamples > 0 ? (f64)stats.encodedBytes / (f64)stats.encodedSamples : 0.0,
+                 stats.droppedSamples);
+
+    u32 maxSamples = 0;
+    for (u32 trackIndex = 0; trackIndex < trackCount; trackIndex++)
+    {
+        maxSamples = std::max(maxSamples, tracks[trackIndex].sampleCount);
+    }
+    if (maxSamples == 0)
+    {
+        return;
+    }
+
+    glm::vec3 *positions = (glm::vec3 *)malloc(maxSamples * sizeof(glm::vec3));
+    u64 decodedSamples = 0;
+    f64 startTime = getHistoryTime();
+    for (u32 trackIndex = 0; trackIndex < trackCount; trackIndex++)
+    {
+        decodeTrack(trackIndex, positions);
+        decodedSamples += tracks[trackIndex].sampleCount;
+    }
+    f64 decodeTime = getHistoryTime() - startTime;
+    free(positions);
+
+    spdlog::info("Trajectory history: Decoded every track in {:.2f} ms, {:.1f} million positions a second",
+                 decodeTime * 1000.0, decodeTime > 0.0 ? (f64)decodedSamples / decodeTime * 1e-6 : 0.0);
+}
@@ -0,0 +1,137 @@
+#define TRAJECTORY_BLOCK_SAMPLES 128
+#define TRAJECTORY_QUANTUM 0.001F  // Metres, decoded positions are within about half of it of the recorded ones
+#define TRAJECTORY_MAX_TRACKS 65536
+#define TRAJECTORY_DEFAULT_BUDGET (64ULL * 1024ULL * 1024ULL)
+
+#define TRAJECTORY_NO_TRACK 0xFFFFFFFFU
+
+enum TrajectoryDecoderType
+{
+    TRAJECTORY_DECODER_SCALAR,
+    TRAJECTORY_DECODER_SSE2,
+
+    TRAJECTORY_DECODER_COUNT,
+};
+
+struct TrajectoryHistoryConfig
+{
+    size_t budget;  // Bytes of encoded blocks, 0 when no history is kept
+};
+
+struct TrajectoryHistoryStats
+{
+    u64 samples;         // Positions recorded
+    u64 encodedSamples;  // Of those, the ones in blocks rather than still waiting for their block to fill
+    u64 encodedBytes;    // Block headers and packed data
+    u64 droppedSamples;  // Not recorded since the budget or the track table ran out
+};
+
+// 16 bytes, one bit row of four packed values. Value i of a block's axis is in lane i % 4.
+struct TrajectoryUnit
+{
+    u32 lanes[4];
+};
+
+// 128 positions of one ball, stored as the changes in their steps quantized to TRAJECTORY_QUANTUM. Those change with
+// the forces on the ball rather than its speed, so a few bits hold them. Each axis is packed at the width that holds
+// most of its values, right after the header, and the few that don't fit, like a bounce, follow as exceptions.
+struct TrajectoryBlock
+{
+    s32 first[3];       // First position
+    s32 entryStep[3];   // The step into the first position
+    u8 widths[3];       // Bits per value of each axis, one unit per bit
+    u8 exceptionCount;  // Two to a unit, after the packed values
+    u32 next;           // Unit offset of the track's next block, 0 for its last
+};
+
+// A value wider than its axis is packed at, which takes the place of the 0 packed for it
+struct TrajectoryException
+{
+    u32 slot;  // Axis * TRAJECTORY_BLOCK_SAMPLES + sample
+    u32 value;
+};
+
+// The positions of one ball from when it was first seen to when it came to rest
+struct TrajectoryTrack
+{
+    u32 firstStep;  // History step its first position was recorded after
+    u32 sampleCount;
+    u32 firstBlock;  // Unit offsets of its blocks, 0 until one is encoded
+    u32 lastBlock;
+    u32 ball;  // Index of the ball it was recorded from
+    u32 bay;
+    bool open;  // Still being recorded
+};
+
+// Keeps the trajectory of every ball of a session, for trails, replays and analytics, at around a byte per position
+// instead of the twelve of a glm::vec3. Each ball's positions are gathered until they fill a block, which is then
+// encoded into a fixed budget. Any position of any track can be decoded on its own, and whole tracks decode a block
+// at a time with SSE2.
+struct TrajectoryHistory
+{
+    TrajectoryHistoryStats stats;
+    u32 steps;
+    f32 stepTime;  // Seconds between positions, the sim's fixed step
+    u32 trackCount;
+
+    bool initialize(const TrajectoryHistoryConfig *historyConfig);
+    void shutdown();
+
+    // Adds every ball's position after a step. Balls that came to rest have their track closed.
+    void record(BallManager *ballManager, f32 dt);
+
+    // Closes every open track, for when the balls are replaced or move to indices that aren't known
+    void closeTracks();
+
+    // Follows the balls to the indices clearing resting ones moved them to, see BallManager::clearRestingBalls. The
+    // tracks of the balls still moving carry on.
+    void moveBalls(const u32 *newIndices, u32 ballCount);
+
+    const TrajectoryTrack *getTrack(u32 trackIndex) const;
+
+    // The track a ball is being recorded into or came to rest in, TRAJECTORY_NO_TRACK when there is none
+    u32 getBallTrack(size_t ballIndex) const;
+
+    // Where a track's ball was a time after the history started, interpolated between the positions around it and
+    // clamped to the first and last
+    glm::vec3 samplePosition(u32 trackIndex, f64 time) const;
+
+    // Writes all of a track's positions, outPositions has to hold its sampleCount
+    void decodeTrack(u32 trackIndex, glm::vec3 *outPositions) const;
+
+    // Decodes every track once and logs how well they compress and how fast they decode
+    void logReport() const;
+
+private:
+    // Positions waiting for their block to fill, per ball index
+    struct PendingBlock
+    {
+        s32 positions[TRAJECTORY_BLOCK_SAMPLES][3];
+        s32 entryStep[3];
+        u32 count;
+        u32 track;
+        bool finished;  // Came to rest, nothing more is recorded for this index until the tracks are closed
+    };
+
+    TrajectoryHistoryConfig config;
+    TrajectoryUnit *units;
+    u32 unitCount;
+    u32 usedUnits;
+
+    TrajectoryTrack tracks[TRAJECTORY_MAX_TRACKS];
+    PendingBlock pending[MAX_BALLS];
+
+    bool encode(PendingBlock *block);
+    void closeTrack(PendingBlock *block);
+    void decodeSample(u32 trackIndex, u32 sampleIndex, glm::vec3 *outPosition) const;
+    const TrajectoryBlock *findBlock(const TrajectoryTrack *track, u32 blockIndex) const;
+};
+
+const char *getTrajectoryDecoderName(TrajectoryDecoderType type);
+bool isTrajectoryDecoderSupported(TrajectoryDecoderType type);
+bool setTrajectoryDecoder(TrajectoryDecoderType type);
+
+// Decodes one block's positions, the first count of them when it's a track's last and only partly filled
+void decodeTrajectoryBlock(const TrajectoryBlock *block, glm::vec3 *outPositions, u32 count);
+
+TrajectoryHistoryConfig *getTrajectoryHistoryConfig();
@@ -0,0 +1,360 @@
+static WorldShareConfig worldShareConfig = {WORLD_SHARE_OFF, "/golfsim_world"};
+
+WorldShareConfig *getWorldShareConfig()
+{
+    return &worldShareConfig;
+}
+
+static u64 getSharedTime()
+{
+    return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Slots start on their own cache line so the sim writing one doesn't touch the line a viewer is reading
+static size_t getSharedSlotSize()
+{
+    return (sizeof(SharedWorldSlot) + 63) & ~(size_t)63;
+}
+
+static size_t getSharedHeaderSize()
+{
+    return (sizeof(SharedWorldHeader) + 63) & ~(size_t)63;
+}
+
+#ifdef _WIN32
+
+bool WorldShare::open(const WorldShareConfig *shareConfig)
+{
+    config = *shareConfig;
+    spdlog::error("World sharing needs POSIX shared memory, which this platform doesn't have");
+    return false;
+}
+
+void WorldShare::close()
+{
+}
+
+static bool isProcessAlive(u32 processId)
+{
+    (void)processId;
+    return true;
+}
+
+#else
+
+bool WorldShare::open(const WorldShareConfig *shareConfig)
+{
+    config = *shareConfig;
+    header = NULL;
+    reader = NULL;
+    snapshot = NULL;
+    mappingSize = getSharedHeaderSize() + SHARED_WORLD_SLOTS * getSharedSlotSize();
+
+    bool publishing = config.mode == WORLD_SHARE_PUBLISH;
+    s32 fd = shm_open(config.name, publishing ? O_CREAT | O_RDWR : O_RDWR, 0644);
+    if (fd < 0)
+    {
+        spdlog::error(publishing ? "Could not create shared memory \"{}\": {}"
+                                 : "Nothing is published to \"{}\", start the simulator with --publish: {}",
+                      config.name, strerror(errno));
+        return false;
+    }
+
+    struct stat status;
+    bool sized = publishing ? ftruncate(fd, (off_t)mappingSize) == 0
+                            : fstat(fd, &status) == 0 && (size_t)status.st_size >= mappingSize;
+    void *mapping = sized ? mmap(NULL, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        spdlog::error("Could not map shared memory \"{}\"", config.name);
+        if (publishing)
+        {
+            shm_unlink(config.name);
+        }
+        return false;
+    }
+
+    header = (SharedWorldHeader *)mapping;
+    slots = (u8 *)mapping + getSharedHeaderSize();
+
+    if (publishing)
+    {
+        // Left over by a sim that didn't shut down cleanly, or new and zeroed
+        header->magic.store(0, std::memory_order_relaxed);
+        bzero(slots, SHARED_WORLD_SLOTS * getSharedSlotSize());
+        for (u32 readerIndex = 0; readerIndex < SHARED_WORLD_MAX_READERS; readerIndex++)
+        {
+            header->readers[readerIndex].processId.store(0, std::memory_order_relaxed);
+        }
+
+        header->version = SHARED_WORLD_VERSION;
+        header->slotCount = SHARED_WORLD_SLOTS;
+        header->maxBalls = MAX_BALLS;
+        header->slotSize = getSharedSlotSize();
+        header->publishedSteps.store(0, std::memory_order_relaxed);
+        header->magic.store(SHARED_WORLD_MAGIC, std::memory_order_release);
+
+        spdlog::info("World share: Publishing every step to \"{}\" ({:.1f} MiB)", config.name,
+                     (f64)mappingSize / (1024.0 * 1024.0));
+        return true;
+    }
+
+    if (header->magic.load(std::memory_order_acquire) != SHARED_WORLD_MAGIC ||
+        header->version != SHARED_WORLD_VERSION || header->slotCount != SHARED_WORLD_SLOTS ||
+        header->maxBalls != MAX_BALLS || header->slotSize != getSharedSlotSize())
+    {
+        spdlog::error("\"{}\" was published by an incompatible simulator", config.name);
+        close();
+        return false;
+    }
+
+    snapshot = (SharedWorldSnapshot *)malloc(sizeof(SharedWorldSnapshot));
+    if (snapshot == NULL)
+    {
+        spdlog::error("Failed to allocate {:.1f} MiB for a copy of the shared world",
+                      bytesToMiB(sizeof(SharedWorldSnapshot)));
+        close();
+        return false;
+    }
+    trackAllocation(MEMORY_TAG_WORLD, snapshot, sizeof(SharedWorldSnapshot));
+
+    u32 processId = (u32)getpid();
+    for (u32 readerIndex = 0; readerIndex < SHARED_WORLD_MAX_READERS && reader == NULL; readerIndex++)
+    {
+        u32 expected = 0;
+        if (header->readers[readerIndex].processId.compare_exchange_strong(expected, processId))
+        {
+            reader = &header->readers[readerIndex];
+            reader->step.store(header->publishedSteps.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+    if (reader == NULL)
+    {
+        spdlog::warn("World share: {} viewers are attached already, this one's lag won't be tracked",
+                     SHARED_WORLD_MAX_READERS);
+    }
+
+    spdlog::info("World share: Viewing \"{}\"", config.name);
+    return true;
+}
+
+void WorldShare::close()
+{
+    if (header == NULL)
+    {
+        return;
+    }
+
+    if (reader != NULL)
+    {
+        reader->processId.store(0, std::memory_order_release);
+        reader = NULL;
+    }
+
+    if (snapshot != NULL)
+    {
+        trackFree(MEMORY_TAG_WORLD, snapshot, sizeof(SharedWorldSnapshot));
+        free(snapshot);
+        snapshot = NULL;
+    }
+
+    munmap(header, mappingSize);
+    header = NULL;
+
+    // Viewers still attached keep their mapping, the name is just gone for new ones
+    if (config.mode == WORLD_SHARE_PUBLISH)
+    {
+        shm_unlink(config.name);
+    }
+}
+
+static bool isProcessAlive(u32 processId)
+{
+    return kill((pid_t)processId, 0) == 0 || errno == EPERM;
+}
+
+#endif
+
+SharedWorldSlot *WorldShare::getSlot(u64 step) const
+{
+    return (SharedWorldSlot *)(slots + ((step - 1) % SHARED_WORLD_SLOTS) * getSharedSlotSize());
+}
+
+void WorldShare::publish(World *world, u32 epoch)
+{
+    ZoneScoped;
+
+    u64 step = header->publishedSteps.load(std::memory_order_relaxed) + 1;
+    SharedWorldSlot *slot = getSlot(step);
+
+    // The fence keeps the writes below from being seen before the odd sequence that marks the slot as changing
+    u32 sequence = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->epoch = epoch;
+    slot->step = step;
+    slot->publishTime = getSharedTime();
+    slot->windSpeed = world->wind.speed;
+    slot->windDirection = world->wind.direction;
+
+    slot->bayCount = world->range->bayCount;
+    for (u32 bayIndex = 0; bayIndex < slot->bayCount; bayIndex++)
+    {
+        slot->tees[bayIndex] = world->range->bays[bayIndex].tee;
+    }
+
+    slot->ballCount = (u32)world->ballManager.activeBalls;
+    for (u32 ballIndex = 0; ballIndex < slot->ballCount; ballIndex++)
+    {
+        const Ball *ball = world->ballManager.getBall(ballIndex);
+        SharedBall *sharedBall = &slot->balls[ballIndex];
+        sharedBall->position = ball->position;
+        sharedBall->velocity = ball->velocity;
+        sharedBall->spinRate = ball->spinRate;
+        sharedBall->state = (u16)ball->state;
+        sharedBall->bay = (u16)ball->bay;
+    }
+
+    slot->sequence.store(sequence + 2, std::memory_order_release);
+    header->publishedSteps.store(step, std::memory_order_release);
+}
+
+// Once a frame, the viewers' lag is worked out and the entries of viewers that exited without saying so are freed
+void WorldShare::updateReaders()
+{
+    u64 publishedSteps = header->publishedSteps.load(std::memory_order_relaxed);
+
+    stats.readerCount = 0;
+    stats.maxReaderLag = 0;
+    for (u32 readerIndex = 0; readerIndex < SHARED_WORLD_MAX_READERS; readerIndex++)
+    {
+        SharedWorldReader *entry = &header->readers[readerIndex];
+        u32 processId = entry->processId.load(std::memory_order_acquire);
+        if (processId == 0)
+        {
+            continue;
+        }
+
+        if (!isProcessAlive(processId))
+        {
+            entry->processId.compare_exchange_strong(processId, 0);
+            continue;
+        }
+
+        u64 readerStep = std::min(entry->step.load(std::memory_order_relaxed), publishedSteps);
+        stats.readerCount++;
+        stats.maxReaderLag = std::max(stats.maxReaderLag, publishedSteps - readerStep);
+    }
+}
+
+bool WorldShare::view(World *world, bool *outBallsMoved)
+{
+    ZoneScoped;
+
+    *outBallsMoved = false;
+
+    u64 publishedSteps = header->publishedSteps.load(std::memory_order_acquire);
+    stats.stepLag = publishedSteps - std::min(stats.step, publishedSteps);
+    if (stats.step != 0)
+    {
+        stats.timeLag = (f64)(getSharedTime() - drawnPublishTime) * 1e-9;
+    }
+
+    if (publishedSteps == 0 || publishedSteps == stats.step)
+    {
+        return false;
+    }
+
+    // A sim that restarted counts from 0 again
+    if (publishedSteps < stats.step)
+    {
+        stats.step = 0;
+    }
+
+    BallManager *ballManager = &world->ballManager;
+    for (u32 attempt = 0; attempt < SHARED_WORLD_MAX_READ_ATTEMPTS; attempt++)
+    {
+        u64 step = header->publishedSteps.load(std::memory_order_acquire);
+        const SharedWorldSlot *slot = getSlot(step);
+
+        u32 sequence = slot->sequence.load(std::memory_order_acquire);
+        if ((sequence & 1) != 0)
+        {
+            stats.tornReads++;
+            continue;
+        }
+
+        // Copied out first, so a torn read never reaches the world and a viewer that runs out of attempts keeps
+        // drawing the last good step. Counts are clamped since they can be torn too.
+        snapshot->epoch = slot->epoch;
+        snapshot->windSpeed = slot->windSpeed;
+        snapshot->windDirection = slot->windDirection;
+        snapshot->bayCount = glm::clamp(slot->bayCount, 1U, (u32)MAX_BAYS);
+        snapshot->ballCount = std::min(slot->ballCount, (u32)MAX_BALLS);
+        memcpy(snapshot->tees, slot->tees, snapshot->bayCount * sizeof(BayTee));
+        memcpy(snapshot->balls, slot->balls, snapshot->ballCount * sizeof(SharedBall));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->sequence.load(std::memory_order_relaxed) != sequence)
+        {
+            stats.tornReads++;
+            continue;
+        }
+
+        u32 ballCount = snapshot->ballCount;
+        u32 epoch = snapshot->epoch;
+        world->wind.speed = snapshot->windSpeed;
+        world->wind.direction = snapshot->windDirection;
+        world->range->bayCount = snapshot->bayCount;
+        for (u32 bayIndex = 0; bayIndex < snapshot->bayCount; bayIndex++)
+        {
+            world->range->bays[bayIndex].tee = snapshot->tees[bayIndex];
+        }
+
+        bool ballsMoved = epoch != lastEpoch || ballCount < ballManager->activeBalls;
+        if (ballCount < ballManager->activeBalls)
+        {
+            bzero(ballManager->getBall(ballCount), (ballManager->activeBalls - ballCount) * sizeof(Ball));
+        }
+        ballManager->activeBalls = ballCount;
+
+        for (u32 ballIndex = 0; ballIndex < ballCount; ballIndex++)
+        {
+            const SharedBall *sharedBall = &snapshot->balls[ballIndex];
+            Ball *ball = ballManager->getBall(ballIndex);
+            ball->position = sharedBall->position;
+            ball->velocity = sharedBall->velocity;
+            ball->spinRate = sharedBall->spinRate;
+            ball->state = (BallState)std::min((u32)sharedBall->state, (u32)BALL_STATE_COUNT - 1);
+            ball->bay = sharedBall->bay;
+            ball->alive = true;
+        }
+
+        if (stats.step != 0 && step > stats.step + 1)
+        {
+            stats.skippedSteps += step - stats.step - 1;
+        }
+
+        *outBallsMoved = ballsMoved;
+        lastEpoch = epoch;
+        stats.step = step;
+        stats.stepLag = header->publishedSteps.load(std::memory_order_relaxed) - step;
+        drawnPublishTime = slot->publishTime;
+        stats.timeLag = (f64)(getSharedTime() - drawnPublishTime) * 1e-9;
+
+        if (reader != NULL)
+        {
+            reader->step.store(step, std::memory_order_relaxed);
+        }
+
+        // Bay filters draw from the groups the range builds as it steps, which a viewer never does
+        world->range->partition(ballManager);
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,128 @@
+#define SHARED_WORLD_MAGIC 0x57534647  // "GFSW"
+#define SHARED_WORLD_VERSION 1
+
+// Steps kept in the ring. A reader only has to retry when the sim laps it, writing every slot while it reads one.
+#define SHARED_WORLD_SLOTS 4
+#define SHARED_WORLD_MAX_READERS 16
+
+// Times a viewer retries a snapshot torn by the sim writing it before waiting for the next frame
+#define SHARED_WORLD_MAX_READ_ATTEMPTS 8
+
+// What a viewer draws of a ball
+struct SharedBall
+{
+    glm::vec3 position;
+    glm::vec3 velocity;
+    f32 spinRate;
+    u16 state;
+    u16 bay;
+};
+
+// One published step. The sequence is odd while the sim is writing the slot, and goes up by two with every write, so
+// a reader that sees the same even sequence before and after reading knows nothing changed under it.
+struct SharedWorldSlot
+{
+    std::atomic<u32> sequence;
+    u32 epoch;  // Changes whenever balls move to new indices, so viewers know their trails no longer match
+    u64 step;
+    u64 publishTime;  // Steady clock nanoseconds, shared by every process on the machine
+
+    f32 windSpeed;
+    f32 windDirection;
+    u32 bayCount;
+    u32 ballCount;
+    BayTee tees[MAX_BAYS];
+    SharedBall balls[MAX_BALLS];
+};
+
+// A viewer's copy of a slot, only applied to its world once the slot's sequence shows the copy wasn't torn
+struct SharedWorldSnapshot
+{
+    u32 epoch;
+    f32 windSpeed;
+    f32 windDirection;
+    u32 bayCount;
+    u32 ballCount;
+    BayTee tees[MAX_BAYS];
+    SharedBall balls[MAX_BALLS];
+};
+
+// Each viewer takes an entry, so the sim can tell how far behind its viewers are
+struct SharedWorldReader
+{
+    std::atomic<u32> processId;  // 0 for a free entry
+    u32 padding;
+    std::atomic<u64> step;  // Last step the viewer drew
+};
+
+struct SharedWorldHeader
+{
+    std::atomic<u32> magic;  // Written last by the sim, so viewers never map a half set up ring
+    u32 version;
+    u32 slotCount;
+    u32 maxBalls;
+    u64 slotSize;
+
+    std::atomic<u64> publishedSteps;  // Step n is in slot (n - 1) % slotCount
+    SharedWorldReader readers[SHARED_WORLD_MAX_READERS];
+};
+
+enum WorldShareMode
+{
+    WORLD_SHARE_OFF,
+    WORLD_SHARE_PUBLISH,  // Simulates and publishes every step
+    WORLD_SHARE_VIEW,     // Draws what another process publishes instead of simulating
+};
+
+struct WorldShareConfig
+{
+    WorldShareMode mode;
+    const char *name;  // Shared memory object, "/golfsim_world" by default
+};
+
+struct WorldShareStats
+{
+    // Publisher
+    u32 readerCount;
+    u64 maxReaderLag;  // Steps the furthest behind viewer is from the latest step
+
+    // Viewer
+    u64 step;
+    u64 stepLag;  // Steps published since the one being drawn
+    f64 timeLag;  // Seconds since the step being drawn was published
+    u64 tornReads;
+    u64 skippedSteps;  // Published steps never drawn because the viewer was slower than the sim
+};
+
+// Shares the balls between processes through a ring of snapshots in shared memory. The sim writes each step into
+// the next slot under a seqlock, and viewers copy the latest one out, checking its sequence afterwards instead
+// of taking a lock. Neither side ever waits for the other.
+struct WorldShare
+{
+    WorldShareStats stats;
+
+    bool open(const WorldShareConfig *shareConfig);
+    void close();
+
+    void publish(World *world, u32 epoch);
+    void updateReaders();
+
+    // Applies the latest step to the world's balls, false when there is no new one. outBallsMoved is set when the
+    // balls were cleared or moved to new indices since the last step applied.
+    bool view(World *world, bool *outBallsMoved);
+
+private:
+    WorldShareConfig config;
+    SharedWorldHeader *header;
+    u8 *slots;
+    size_t mappingSize;
+
+    SharedWorldReader *reader;  // This viewer's entry
+    SharedWorldSnapshot *snapshot;
+    u32 lastEpoch;
+    u64 drawnPublishTime;
+
+    SharedWorldSlot *getSlot(u64 step) const;
+};
+
+WorldShareConfig *getWorldShareConfig();
@@ -0,0 +1,339 @@
+// Drives a running golfsim_service from several connections at once and reports how long shots took to come back.
+// Every client keeps a fixed number of requests in flight, sending a new one as each result arrives, so the service
+// sees a steady concurrent load and gets to batch it.
+//
+// Usage: golfsim_loadgen [--socket <path>] [--clients <count>] [--requests <per client>] [--in-flight <count>]
+//                        [--path <samples>]
+
+// clang-format off
+#include <Framework/Application.hpp>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "ServiceProtocol.hpp"
+// clang-format on
+
+#define LOADGEN_MAX_CLIENTS 64
+#define LOADGEN_MAX_IN_FLIGHT 256
+
+struct LoadClient
+{
+    u32 index;
+    const char *socketPath;
+    u32 requestCount;
+    u32 inFlight;
+    u16 pathSamples;
+
+    // Filled in by the client's thread
+    f64 *latencies;  // Seconds from sending to the result arriving, one per request
+    u32 completed;
+    u32 invalid;
+    u32 timedOut;
+    u32 errors;
+    f32 totalDistance;
+};
+
+static f64 getTime()
+{
+    return std::chrono::duration<f64>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static u32 nextRandom(u32 *state)
+{
+    // xorshift32, plenty to vary the shots
+    u32 x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static f32 randomRange(u32 *state, f32 low, f32 high)
+{
+    return low + (high - low) * (f32)(nextRandom(state) >> 8) / (f32)(1 << 24);
+}
+
+static bool sendAll(s32 socket, const void *data, size_t size)
+{
+    const u8 *bytes = (const u8 *)data;
+    while (size > 0)
+    {
+        ssize_t sent = send(socket, bytes, size, 0);
+        if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (sent <= 0)
+        {
+            return false;
+        }
+        bytes += sent;
+        size -= (size_t)sent;
+    }
+    return true;
+}
+
+static bool receiveAll(s32 socket, void *data, size_t size)
+{
+    u8 *bytes = (u8 *)data;
+    while (size > 0)
+    {
+        ssize_t received = recv(socket, bytes, size, 0);
+        if (received < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (received <= 0)
+        {
+            return false;
+        }
+        bytes += received;
+        size -= (size_t)received;
+    }
+    return true;
+}
+
+static bool sendShot(s32 socket, u32 id, u16 pathSamples, u32 *randomState)
+{
+    u8 message[sizeof(ServiceMessageHeader) + sizeof(ServiceShotRequest)];
+
+    ServiceMessageHeader header = {SERVICE_MAGIC, SERVICE_PROTOCOL_VERSION, SERVICE_MESSAGE_SHOT_REQUEST,
+                                   sizeof(ServiceShotRequest)};
+
+    // Anything from a wedge to a driver, with some shape and wind
+    ServiceShotRequest request;
+    request.id = id;
+    request.speed = randomRange(randomState, 40.0F, 80.0F);
+    request.launchAngle = glm::radians(randomRange(randomState, 8.0F, 28.0F));
+    request.heading = glm::radians(randomRange(randomState, -4.0F, 4.0F));
+    request.spinRate = randomRange(randomState, 2000.0F, 10000.0F);
+    request.spinAngle = glm::radians(randomRange(randomState, -20.0F, 20.0F));
+    request.windSpeed = randomRange(randomState, 0.0F, 8.0F);
+    request.windDirection = randomRange(randomState, 0.0F, glm::two_pi<f32>());
+    request.logWind = 1;
+    request.pathSamples = pathSamples;
+
+    memcpy(message, &header, sizeof(header));
+    memcpy(message + sizeof(header), &request, sizeof(request));
+    return sendAll(socket, message, sizeof(message));
+}
+
+static void runClient(LoadClient *client)
+{
+    s32 clientSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    struct sockaddr_un address;
+    bzero(&address, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, client->socketPath, sizeof(address.sun_path) - 1);
+
+    if (clientSocket < 0 || connect(clientSocket, (struct sockaddr *)&address, sizeof(address)) != 0)
+    {
+        spdlog::error("Client {}: Could not connect to \"{}\": {}", client->index, client->socketPath,
+                      strerror(errno));
+        client->errors = client->requestCount;
+        if (clientSocket >= 0)
+        {
+            close(clientSocket);
+        }
+        return;
+    }
+
+    // Request ids are indices into the send times
+    f64 *sendTimes = (f64 *)malloc(client->requestCount * sizeof(f64));
+    ServicePathSample *path = (ServicePathSample *)malloc(SERVICE_MAX_PATH_SAMPLES * sizeof(ServicePathSample));
+    u32 randomState = 0x9E3779B9U ^ (client->index * 0x85EBCA6BU + 1);
+    u32 sent = 0;
+
+    while (client->completed + client->errors < client->requestCount)
+    {
+        while (sent < client->requestCount && sent - client->completed < client->inFlight)
+        {
+            sendTimes[sent] = getTime();
+            if (!sendShot(clientSocket, sent, client->pathSamples, &randomState))
+            {
+                break;
+            }
+            sent++;
+        }
+
+        ServiceMessageHeader header;
+        ServiceShotResult result;
+        if (!receiveAll(clientSocket, &header, sizeof(header)) || header.magic != SERVICE_MAGIC ||
+            header.type != SERVICE_MESSAGE_SHOT_RESULT || header.size < sizeof(result) ||
+            !receiveAll(clientSocket, &result, sizeof(result)) || result.id >= sent ||
+            result.pathSampleCount > SERVICE_MAX_PATH_SAMPLES ||
+            !receiveAll(clientSocket, path, result.pathSampleCount * sizeof(ServicePathSample)))
+        {
+            spdlog::error("Client {}: Lost the connection with {} results outstanding", client->index,
+                          client->requestCount - client->completed);
+            client->errors = client->requestCount - client->completed;
+            break;
+        }
+
+        client->latencies[client->completed++] = getTime() - sendTimes[result.id];
+        client->invalid += result.status == SERVICE_SHOT_INVALID ? 1 : 0;
+        client->timedOut += result.status == SERVICE_SHOT_TIMED_OUT ? 1 : 0;
+        client->totalDistance += result.total;
+    }
+
+    free(path);
+    free(sendTimes);
+    close(clientSocket);
+}
+
+static f64 getPercentile(const f64 *sortedValues, u32 count, f64 percentile)
+{
+    u32 index = (u32)ceil(percentile / 100.0 * (f64)count);
+    return sortedValues[std::min(std::max(index, 1U), count) - 1];
+}
+
+static void printUsage()
+{
+    fprintf(stderr, "Usage: golfsim_loadgen [--socket <path>] [--clients <count>] [--requests <per client>]\n");
+    fprintf(stderr, "                       [--in-flight <count>] [--path <samples>]\n");
+}
+
+int main(int argc, char *argv[])
+{
+    const char *socketPath = SERVICE_DEFAULT_SOCKET_PATH;
+    u32 clientCount = 8;
+    u32 requestCount = 2000;
+    u32 inFlight = 8;
+    u32 pathSamples = 0;
+
+    for (s32 argIndex = 1; argIndex < argc; argIndex++)
+    {
+        const char *arg = argv[argIndex];
+        const char *value = argIndex + 1 < argc ? argv[argIndex + 1] : NULL;
+        u32 number = value != NULL ? (u32)strtoul(value, NULL, 10) : 0;
+
+        if (strcmp(arg, "--socket") == 0 && value != NULL)
+        {
+            socketPath = value;
+        }
+        else if (strcmp(arg, "--clients") == 0 && number > 0 && number <= LOADGEN_MAX_CLIENTS)
+        {
+            clientCount = number;
+        }
+        else if (strcmp(arg, "--requests") == 0 && number > 0)
+        {
+            requestCount = number;
+        }
+        else if (strcmp(arg, "--in-flight") == 0 && number > 0 && number <= LOADGEN_MAX_IN_FLIGHT)
+        {
+            inFlight = number;
+        }
+        else if (strcmp(arg, "--path") == 0 && value != NULL && number <= SERVICE_MAX_PATH_SAMPLES)
+        {
+            pathSamples = number;
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+        argIndex++;
+    }
+
+    spdlog::set_default_logger(spdlog::stdout_color_mt("loadgen"));
+
+    LoadClient clients[LOADGEN_MAX_CLIENTS];
+    f64 *latencies = (f64 *)malloc((size_t)clientCount * requestCount * sizeof(f64));
+    if (latencies == NULL)
+    {
+        spdlog::error("Failed to allocate room for {} latencies", (size_t)clientCount * requestCount);
+        return 1;
+    }
+
+    spdlog::info("{} clients sending {} shots each, {} in flight per client, {} path samples", clientCount,
+                 requestCount, inFlight, pathSamples);
+
+    std::thread threads[LOADGEN_MAX_CLIENTS];
+    f64 startTime = getTime();
+
+    for (u32 clientIndex = 0; clientIndex < clientCount; clientIndex++)
+    {
+        LoadClient *client = &clients[clientIndex];
+        bzero(client, sizeof(LoadClient));
+        client->index = clientIndex;
+        client->socketPath = socketPath;
+        client->requestCount = requestCount;
+        client->inFlight = inFlight;
+        client->pathSamples = (u16)pathSamples;
+        client->latencies = latencies + (size_t)clientIndex * requestCount;
+
+        threads[clientIndex] = std::thread(runClient, client);
+    }
+
+    for (u32 clientIndex = 0; clientIndex < clientCount; clientIndex++)
+    {
+        threads[clientIndex].join();
+    }
+
+    f64 elapsed = getTime() - startTime;
+
+    // Gathered into one run so the percentiles cover every client
+    u32 completed = 0;
+    u32 invalid = 0;
+    u32 timedOut = 0;
+    u32 errors = 0;
+    f64 totalDistance = 0.0;
+    for (u32 clientIndex = 0; clientIndex < clientCount; clientIndex++)
+    {
+        const LoadClient *client = &clients[clientIndex];
+        memmove(latencies + completed, client->latencies, client->completed * sizeof(f64));
+        completed += client->completed;
+        invalid += client->invalid;
+        timedOut += client->timedOut;
+        errors += client->errors;
+        totalDistance += client->totalDistance;
+    }
+
+    if (completed == 0)
+    {
+        spdlog::error("No shots came back");
+        free(latencies);
+        return 1;
+    }
+
+    std::sort(latencies, latencies + completed);
+
+    f64 totalLatency = 0.0;
+    for (u32 latencyIndex = 0; latencyIndex < completed; latencyIndex++)
+    {
+        totalLatency += latencies[latencyIndex];
+    }
+
+    spdlog::info("{} shots in {:.2f} s, {:.0f} shots/s, {:.1f} m average total distance", completed, elapsed,
+                 (f64)completed / elapsed, totalDistance / (f64)completed);
+    spdlog::info("Latency ms: mean {:.2f}, p50 {:.2f}, p90 {:.2f}, p99 {:.2f}, p99.9 {:.2f}, max {:.2f}",
+                 totalLatency * 1000.0 / (f64)completed, getPercentile(latencies, completed, 50.0) * 1000.0,
+                 getPercentile(latencies, completed, 90.0) * 1000.0, getPercentile(latencies, completed, 99.0) * 1000.0,
+                 getPercentile(latencies, completed, 99.9) * 1000.0, latencies[completed - 1] * 1000.0);
+
+    if (invalid > 0 || timedOut > 0 || errors > 0)
+    {
+        spdlog::warn("{} invalid, {} timed out, {} never answered", invalid, timedOut, errors);
+    }
+
+    free(latencies);
+    return errors > 0 ? 1 : 0;
+}
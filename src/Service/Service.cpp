@@ -0,0 +1,859 @@
+// Answers shot requests from other processes, like launch monitors, over a Unix domain socket. Requests that arrive
+// while a batch is being simulated all go into the next batch, so a burst of requests costs one pass over the balls
+// instead of one pass each.
+//
+// Usage: golfsim_service [--socket <path>] [--threads <count>] [--max-batch <count>]
+//                        [--collision-kernel <scalar|sse2|avx2>]
+
+// clang-format off
+#include <Framework/Application.hpp>
+
+#define GLM_ENABLE_EXPERIMENTAL
+
+#include <tracy/Tracy.hpp>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtx/norm.hpp>
+#include <glm/gtx/rotate_vector.hpp>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+#include "GolfFlightSim3D.hpp"
+#include "CollisionKernels.hpp"
+#include "Determinism.hpp"
+#include "DrivingRange.hpp"
+#include "FlightPlanner.hpp"
+#include "ServiceProtocol.hpp"
+#include "Scenarios.hpp"
+
+#include "GolfFlightSim3D.cpp"
+#include "CollisionKernels.cpp"
+#include "Determinism.cpp"
+#include "DrivingRange.cpp"
+#include "FlightPlanner.cpp"
+// clang-format on
+
+#define SERVICE_MAX_CLIENTS 64
+#define SERVICE_DEFAULT_MAX_BATCH 1024
+#define SERVICE_INPUT_BUFFER_SIZE 4096
+#define SERVICE_MAX_WORKERS 32
+
+// Shots one worker steps together, enough to keep the collision blocks in cache across shots
+#define SERVICE_JOB_SIZE 16
+
+#define SERVICE_GROUND_SIZE 2000.0F
+#define MAX_SHOT_SECONDS 120.0F
+
+static const f32 deltaTime = 1.0F / 60.0F;
+
+static volatile sig_atomic_t quitRequested;
+
+struct ServiceClient
+{
+    s32 socket;  // -1 for a free slot
+
+    u8 input[SERVICE_INPUT_BUFFER_SIZE];
+    u32 inputSize;
+
+    // Results not yet taken by the socket, sent as it drains
+    u8 *output;
+    size_t outputSize;
+    size_t outputSent;
+    size_t outputCapacity;
+};
+
+// One request of the batch being simulated, its ball is the one with the same index in the batch's BallManager
+struct ServiceShot
+{
+    ServiceShotRequest request;
+    u32 client;
+
+    Wind wind;
+    ServiceShotResult result;
+    bool landed;
+    bool finished;
+
+    ServicePathSample path[SERVICE_MAX_PATH_SAMPLES];
+    u32 pathStride;  // Steps between samples, doubled whenever the path fills up
+};
+
+struct ServiceStats
+{
+    u64 shots;
+    u64 invalidShots;
+    u64 batches;
+    u32 largestBatch;
+    f64 simulationTime;
+    u32 protocolErrors;
+};
+
+struct ShotService
+{
+    ServiceStats stats;
+
+    bool open(const char *path, u32 threads, u32 batchLimit);
+    void run();
+    void close();
+
+private:
+    const char *socketPath;
+    s32 listenSocket;
+    ServiceClient clients[SERVICE_MAX_CLIENTS];
+
+    CollisionGeometry *geometry;
+    BallManager *ballManager;
+    ServiceShot *shots;
+    u32 shotCount;
+    u32 maxBatch;
+
+    // Started by open and woken for each batch, the calling thread takes jobs too
+    u32 workerCount;
+    std::thread workers[SERVICE_MAX_WORKERS];
+    std::mutex mutex;
+    std::condition_variable batchStarted;
+    std::condition_variable batchFinished;
+    u64 batchIndex;
+    u32 workersRunning;
+    bool quitting;
+    std::atomic<u32> nextJob;
+
+    void acceptClients();
+    void dropClient(ServiceClient *client);
+    bool receive(ServiceClient *client);
+    bool takeRequests(u32 clientIndex);
+    bool flush(ServiceClient *client);
+
+    void simulateBatch();
+    void simulateJob(u32 firstShot, u32 count);
+    void simulateJobs();
+    void work();
+    void sendResult(const ServiceShot *shot);
+};
+
+static void onQuitSignal(int signalNumber)
+{
+    (void)signalNumber;
+    quitRequested = 1;
+}
+
+static bool setNonBlocking(s32 socket)
+{
+    s32 flags = fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static bool isValidShot(const ServiceShotRequest *request)
+{
+    const f32 halfPi = glm::half_pi<f32>();
+
+    // Written so NaNs fail every comparison
+    return request->speed > 0.0F && request->speed <= 150.0F && request->launchAngle >= -halfPi &&
+           request->launchAngle <= halfPi && fabsf(request->heading) <= glm::pi<f32>() && request->spinRate >= 0.0F &&
+           request->spinRate <= 20000.0F && fabsf(request->spinAngle) <= halfPi && request->windSpeed >= 0.0F &&
+           request->windSpeed <= 50.0F && fabsf(request->windDirection) <= glm::two_pi<f32>() &&
+           request->pathSamples <= SERVICE_MAX_PATH_SAMPLES;
+}
+
+bool ShotService::open(const char *path, u32 threads, u32 batchLimit)
+{
+    socketPath = path;
+    listenSocket = -1;
+    maxBatch = glm::clamp(batchLimit, 1U, (u32)MAX_BALLS);
+    workerCount = glm::clamp(threads != 0 ? threads : std::thread::hardware_concurrency(), 1U,
+                             (u32)SERVICE_MAX_WORKERS);
+
+    for (u32 clientIndex = 0; clientIndex < SERVICE_MAX_CLIENTS; clientIndex++)
+    {
+        clients[clientIndex].socket = -1;
+    }
+
+    // Only the pages the ground touches are ever committed
+    geometry = (CollisionGeometry *)calloc(1, sizeof(CollisionGeometry));
+    ballManager = (BallManager *)calloc(1, sizeof(BallManager));
+    shots = (ServiceShot *)calloc(maxBatch, sizeof(ServiceShot));
+    if (geometry == NULL || ballManager == NULL || shots == NULL)
+    {
+        spdlog::error("Failed to allocate the service's simulation state");
+        return false;
+    }
+
+    // Shots only ever land on flat ground as large as the range
+    buildTerrain(geometry, 1, SERVICE_GROUND_SIZE);
+
+    struct sockaddr_un address;
+    bzero(&address, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        spdlog::error("Socket path \"{}\" is too long", path);
+        return false;
+    }
+    strcpy(address.sun_path, path);
+
+    // A socket file left behind by a service that didn't shut down cleanly would make bind fail
+    unlink(path);
+
+    listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenSocket < 0 || bind(listenSocket, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(listenSocket, SERVICE_MAX_CLIENTS) != 0 || !setNonBlocking(listenSocket))
+    {
+        spdlog::error("Could not listen on \"{}\": {}", path, strerror(errno));
+        return false;
+    }
+
+    for (u32 workerIndex = 1; workerIndex < workerCount; workerIndex++)
+    {
+        workers[workerIndex] = std::thread(&ShotService::work, this);
+    }
+
+    spdlog::info("Service: Listening on \"{}\", batches of up to {} shots on {} threads, {} collision kernel", path,
+                 maxBatch, workerCount, getCollisionKernelName(getCollisionKernelType()));
+    return true;
+}
+
+void ShotService::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quitting = true;
+    }
+    batchStarted.notify_all();
+
+    // Only started once open got everything else going
+    for (u32 workerIndex = 1; workerIndex < workerCount; workerIndex++)
+    {
+        if (workers[workerIndex].joinable())
+        {
+            workers[workerIndex].join();
+        }
+    }
+
+    for (u32 clientIndex = 0; clientIndex < SERVICE_MAX_CLIENTS; clientIndex++)
+    {
+        if (clients[clientIndex].socket >= 0)
+        {
+            dropClient(&clients[clientIndex]);
+        }
+    }
+
+    if (listenSocket >= 0)
+    {
+        ::close(listenSocket);
+        unlink(socketPath);
+    }
+
+    if (geometry != NULL)
+    {
+        free(geometry->blocks);
+    }
+    free(geometry);
+    free(ballManager);
+    free(shots);
+}
+
+void ShotService::acceptClients()
+{
+    for (;;)
+    {
+        s32 clientSocket = accept(listenSocket, NULL, NULL);
+        if (clientSocket < 0)
+        {
+            return;
+        }
+
+        ServiceClient *client = NULL;
+        for (u32 clientIndex = 0; clientIndex < SERVICE_MAX_CLIENTS && client == NULL; clientIndex++)
+        {
+            if (clients[clientIndex].socket < 0)
+            {
+                client = &clients[clientIndex];
+            }
+        }
+
+        if (client == NULL || !setNonBlocking(clientSocket))
+        {
+            spdlog::warn("Service: Turning a client away, {} are connected already", SERVICE_MAX_CLIENTS);
+            ::close(clientSocket);
+            continue;
+        }
+
+        client->socket = clientSocket;
+        client->inputSize = 0;
+        client->outputSize = 0;
+        client->outputSent = 0;
+    }
+}
+
+void ShotService::dropClient(ServiceClient *client)
+{
+    ::close(client->socket);
+    free(client->output);
+    bzero(client, sizeof(ServiceClient));
+    client->socket = -1;
+}
+
+// Whether the first message in a client's input has arrived in full, header and body
+static bool hasCompleteMessage(const ServiceClient *client)
+{
+    if (client->inputSize < sizeof(ServiceMessageHeader))
+    {
+        return false;
+    }
+
+    ServiceMessageHeader header;
+    memcpy(&header, client->input, sizeof(header));
+    return client->inputSize - sizeof(header) >= header.size;
+}
+
+// False when the client hung up or broke
+bool ShotService::receive(ServiceClient *client)
+{
+    while (client->inputSize < SERVICE_INPUT_BUFFER_SIZE)
+    {
+        ssize_t received =
+            recv(client->socket, client->input + client->inputSize, SERVICE_INPUT_BUFFER_SIZE - client->inputSize, 0);
+        if (received > 0)
+        {
+            client->inputSize += (u32)received;
+            continue;
+        }
+
+        return received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+    }
+
+    return true;
+}
+
+// Moves the client's complete requests into the batch while it has room. False on a malformed message.
+bool ShotService::takeRequests(u32 clientIndex)
+{
+    ServiceClient *client = &clients[clientIndex];
+    u32 consumed = 0;
+
+    while (shotCount < maxBatch && client->inputSize - consumed >= sizeof(ServiceMessageHeader))
+    {
+        ServiceMessageHeader header;
+        memcpy(&header, client->input + consumed, sizeof(header));
+        if (header.magic != SERVICE_MAGIC || header.version != SERVICE_PROTOCOL_VERSION ||
+            header.type != SERVICE_MESSAGE_SHOT_REQUEST || header.size != sizeof(ServiceShotRequest))
+        {
+            stats.protocolErrors++;
+            return false;
+        }
+
+        if (client->inputSize - consumed < sizeof(header) + header.size)
+        {
+            break;
+        }
+
+        ServiceShot *shot = &shots[shotCount++];
+        memcpy(&shot->request, client->input + consumed + sizeof(header), sizeof(ServiceShotRequest));
+        shot->client = clientIndex;
+        consumed += sizeof(header) + header.size;
+    }
+
+    memmove(client->input, client->input + consumed, client->inputSize - consumed);
+    client->inputSize -= consumed;
+    return true;
+}
+
+// False when the client can't take any more output and has to be dropped
+bool ShotService::flush(ServiceClient *client)
+{
+    while (client->outputSent < client->outputSize)
+    {
+        ssize_t sent = send(client->socket, client->output + client->outputSent,
+                            client->outputSize - client->outputSent, 0);
+        if (sent < 0)
+        {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        client->outputSent += (size_t)sent;
+    }
+
+    client->outputSize = 0;
+    client->outputSent = 0;
+    return true;
+}
+
+void ShotService::sendResult(const ServiceShot *shot)
+{
+    ServiceClient *client = &clients[shot->client];
+    if (client->socket < 0)
+    {
+        return;
+    }
+
+    size_t pathSize = shot->result.pathSampleCount * sizeof(ServicePathSample);
+    ServiceMessageHeader header = {SERVICE_MAGIC, SERVICE_PROTOCOL_VERSION, SERVICE_MESSAGE_SHOT_RESULT,
+                                   (u32)(sizeof(ServiceShotResult) + pathSize)};
+    size_t messageSize = sizeof(header) + header.size;
+
+    if (client->outputSize + messageSize > client->outputCapacity)
+    {
+        size_t capacity = std::max(client->outputCapacity * 2, client->outputSize + messageSize);
+        u8 *output = (u8 *)realloc(client->output, capacity);
+        if (output == NULL)
+        {
+            spdlog::error("Service: Failed to grow a client's output to {} bytes, dropping it", capacity);
+            dropClient(client);
+            return;
+        }
+        client->output = output;
+        client->outputCapacity = capacity;
+    }
+
+    u8 *message = client->output + client->outputSize;
+    memcpy(message, &header, sizeof(header));
+    memcpy(message + sizeof(header), &shot->result, sizeof(ServiceShotResult));
+    memcpy(message + sizeof(header) + sizeof(ServiceShotResult), shot->path, pathSize);
+    client->outputSize += messageSize;
+}
+
+// Called on the steps that are a multiple of the shot's stride
+static void addPathSample(ServiceShot *shot, const glm::vec3 &offset, u32 step)
+{
+    ServiceShotResult *result = &shot->result;
+    if (result->pathSampleCount == shot->request.pathSamples)
+    {
+        // Full, so every other sample is dropped and from now on they are twice as far apart. This step still gets
+        // its sample when it falls on the new stride, or the path would have a gap.
+        for (u32 sampleIndex = 0; 2 * sampleIndex < result->pathSampleCount; sampleIndex++)
+        {
+            shot->path[sampleIndex] = shot->path[2 * sampleIndex];
+        }
+        result->pathSampleCount = (u16)((result->pathSampleCount + 1) / 2);
+        shot->pathStride *= 2;
+        if (step % shot->pathStride != 0 || result->pathSampleCount == shot->request.pathSamples)
+        {
+            return;
+        }
+    }
+
+    ServicePathSample *sample = &shot->path[result->pathSampleCount++];
+    sample->x = offset.x;
+    sample->y = offset.y;
+    sample->z = offset.z;
+}
+
+static void finishShot(ServiceShot *shot, Ball *ball, u32 steps)
+{
+    glm::vec3 offset = ball->position - ball->startPosition;
+    ServiceShotResult *result = &shot->result;
+
+    result->lateral = offset.x;
+    result->total = sqrtf(offset.x * offset.x + offset.z * offset.z);
+    result->restTime = (f32)steps * deltaTime;
+    if (!shot->landed)
+    {
+        result->carry = result->total;
+        result->flightTime = result->restTime;
+    }
+
+    // The rest position always ends the path, in place of the last sample when there is no room for it
+    if (shot->request.pathSamples > 0)
+    {
+        if (result->pathSampleCount == shot->request.pathSamples)
+        {
+            result->pathSampleCount--;
+        }
+        ServicePathSample *sample = &shot->path[result->pathSampleCount++];
+        sample->x = offset.x;
+        sample->y = offset.y;
+        sample->z = offset.z;
+    }
+
+    shot->finished = true;
+}
+
+// The shots of a job are stepped together until every one of them is at rest
+void ShotService::simulateJob(u32 firstShot, u32 count)
+{
+    ZoneScoped;
+
+    const u32 maxSteps = (u32)(MAX_SHOT_SECONDS / deltaTime);
+
+    u32 moving = 0;
+    for (u32 shotIndex = firstShot; shotIndex < firstShot + count; shotIndex++)
+    {
+        ServiceShot *shot = &shots[shotIndex];
+        if (!shot->finished && shot->request.pathSamples > 0)
+        {
+            addPathSample(shot, glm::vec3(0.0F), 0);
+        }
+        moving += shot->finished ? 0 : 1;
+    }
+
+    for (u32 step = 1; step <= maxSteps && moving > 0; step++)
+    {
+        for (u32 shotIndex = firstShot; shotIndex < firstShot + count; shotIndex++)
+        {
+            ServiceShot *shot = &shots[shotIndex];
+            if (shot->finished)
+            {
+                continue;
+            }
+
+            Ball *ball = ballManager->getBall(shotIndex);
+            bool wasFlying = ball->state == BALL_STATE_FLYING;
+            ball->simulate(&shot->wind, geometry, deltaTime);
+
+            glm::vec3 offset = ball->position - ball->startPosition;
+            ServiceShotResult *result = &shot->result;
+            result->apex = std::max(result->apex, offset.y);
+
+            bool bounced = wasFlying && ball->currFlightTime == 0.0F;
+            if (!shot->landed && (ball->state != BALL_STATE_FLYING || bounced))
+            {
+                result->carry = sqrtf(offset.x * offset.x + offset.z * offset.z);
+                result->flightTime = (f32)step * deltaTime;
+                shot->landed = true;
+            }
+
+            if (ball->state == BALL_STATE_IDLE)
+            {
+                finishShot(shot, ball, step);
+                moving--;
+                continue;
+            }
+
+            if (shot->request.pathSamples > 0 && step % shot->pathStride == 0)
+            {
+                addPathSample(shot, offset, step);
+            }
+        }
+    }
+
+    for (u32 shotIndex = firstShot; shotIndex < firstShot + count; shotIndex++)
+    {
+        ServiceShot *shot = &shots[shotIndex];
+        if (!shot->finished)
+        {
+            shot->result.status = SERVICE_SHOT_TIMED_OUT;
+            finishShot(shot, ballManager->getBall(shotIndex), maxSteps);
+        }
+    }
+}
+
+void ShotService::simulateJobs()
+{
+    u32 jobCount = (shotCount + SERVICE_JOB_SIZE - 1) / SERVICE_JOB_SIZE;
+    for (;;)
+    {
+        u32 jobIndex = nextJob.fetch_add(1, std::memory_order_relaxed);
+        if (jobIndex >= jobCount)
+        {
+            return;
+        }
+
+        u32 firstShot = jobIndex * SERVICE_JOB_SIZE;
+        simulateJob(firstShot, std::min(shotCount - firstShot, (u32)SERVICE_JOB_SIZE));
+    }
+}
+
+void ShotService::work()
+{
+    u64 lastBatch = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            batchStarted.wait(lock, [this, lastBatch] { return quitting || batchIndex != lastBatch; });
+            if (quitting)
+            {
+                return;
+            }
+            lastBatch = batchIndex;
+        }
+
+        simulateJobs();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            workersRunning--;
+            if (workersRunning == 0)
+            {
+                batchFinished.notify_one();
+            }
+        }
+    }
+}
+
+void ShotService::simulateBatch()
+{
+    ZoneScoped;
+
+    f64 startTime = std::chrono::duration<f64>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    // Balls are zeroed before spawning because pushBall only sets the launch state
+    bzero(ballManager->getBall(0), shotCount * sizeof(Ball));
+    ballManager->activeBalls = 0;
+
+    for (u32 shotIndex = 0; shotIndex < shotCount; shotIndex++)
+    {
+        ServiceShot *shot = &shots[shotIndex];
+        const ServiceShotRequest *request = &shot->request;
+
+        bzero(&shot->result, sizeof(ServiceShotResult));
+        shot->result.id = request->id;
+        shot->landed = false;
+        shot->finished = false;
+        shot->pathStride = 1;
+
+        // Invalid shots still take their ball slot so shot and ball indices stay the same
+        ballManager->pushBall(request->speed, request->launchAngle, request->heading, request->spinRate,
+                              request->spinAngle);
+        if (!isValidShot(request))
+        {
+            shot->result.status = SERVICE_SHOT_INVALID;
+            shot->finished = true;
+            ballManager->getBall(shotIndex)->alive = false;
+            stats.invalidShots++;
+            continue;
+        }
+
+        shot->wind.speed = request->windSpeed;
+        shot->wind.direction = request->windDirection;
+        shot->wind.logWind = request->logWind != 0;
+    }
+
+    // A single job is simulated on the calling thread, waking the workers would only add to its latency
+    u32 jobCount = (shotCount + SERVICE_JOB_SIZE - 1) / SERVICE_JOB_SIZE;
+    nextJob = 0;
+    if (workerCount > 1 && jobCount > 1)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            batchIndex++;
+            workersRunning = workerCount - 1;
+        }
+        batchStarted.notify_all();
+
+        simulateJobs();
+
+        // Every worker has to check in before the results are sent and the shots reused for the next batch
+        std::unique_lock<std::mutex> lock(mutex);
+        batchFinished.wait(lock, [this] { return workersRunning == 0; });
+    }
+    else
+    {
+        simulateJobs();
+    }
+
+    for (u32 shotIndex = 0; shotIndex < shotCount; shotIndex++)
+    {
+        sendResult(&shots[shotIndex]);
+    }
+
+    f64 endTime = std::chrono::duration<f64>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    stats.simulationTime += endTime - startTime;
+    stats.shots += shotCount;
+    stats.batches++;
+    stats.largestBatch = std::max(stats.largestBatch, shotCount);
+
+    spdlog::debug("Service: Batch of {} shots in {:.2f} ms", shotCount, (endTime - startTime) * 1000.0);
+
+    shotCount = 0;
+}
+
+void ShotService::run()
+{
+    struct pollfd pollFds[SERVICE_MAX_CLIENTS + 1];
+    u32 pollClients[SERVICE_MAX_CLIENTS + 1];
+
+    while (!quitRequested)
+    {
+        // Wait for something to happen only when no request is left over from a full batch
+        bool requestsWaiting = false;
+        for (u32 clientIndex = 0; clientIndex < SERVICE_MAX_CLIENTS; clientIndex++)
+        {
+            if (clients[clientIndex].socket >= 0 && hasCompleteMessage(&clients[clientIndex]))
+            {
+                requestsWaiting = true;
+            }
+        }
+
+        nfds_t pollCount = 0;
+        pollFds[pollCount].fd = listenSocket;
+        pollFds[pollCount].events = POLLIN;
+        pollCount++;
+
+        for (u32 clientIndex = 0; clientIndex < SERVICE_MAX_CLIENTS; clientIndex++)
+        {
+            ServiceClient *client = &clients[clientIndex];
+            if (client->socket < 0)
+            {
+                continue;
+            }
+
+            pollFds[pollCount].fd = client->socket;
+            pollFds[pollCount].events = (short)((client->inputSize < SERVICE_INPUT_BUFFER_SIZE ? POLLIN : 0) |
+                                                (client->outputSize > client->outputSent ? POLLOUT : 0));
+            pollClients[pollCount] = clientIndex;
+            pollCount++;
+        }
+
+        if (poll(pollFds, pollCount, requestsWaiting ? 0 : -1) < 0)
+        {
+            if (errno != EINTR)
+            {
+                spdlog::error("Service: poll failed: {}", strerror(errno));
+                return;
+            }
+            continue;
+        }
+
+        if (pollFds[0].revents & POLLIN)
+        {
+            acceptClients();
+        }
+
+        for (nfds_t pollIndex = 1; pollIndex < pollCount; pollIndex++)
+        {
+            ServiceClient *client = &clients[pollClients[pollIndex]];
+            short events = pollFds[pollIndex].revents;
+
+            bool alive = true;
+            if (events & (POLLIN | POLLHUP | POLLERR))
+            {
+                alive = receive(client);
+            }
+            if (alive && (events & POLLOUT))
+            {
+                alive = flush(client);
+            }
+
+            // What a client sent before hanging up is still answered if it can be, a partial message never will be
+            if (!alive && !hasCompleteMessage(client))
+            {
+                dropClient(client);
+            }
+        }
+
+        for (u32 clientIndex = 0; clientIndex < SERVICE_MAX_CLIENTS; clientIndex++)
+        {
+            if (clients[clientIndex].socket >= 0 && !takeRequests(clientIndex))
+            {
+                spdlog::warn("Service: Dropping a client that sent a malformed message");
+                dropClient(&clients[clientIndex]);
+            }
+        }
+
+        if (shotCount > 0)
+        {
+            simulateBatch();
+
+            for (u32 clientIndex = 0; clientIndex < SERVICE_MAX_CLIENTS; clientIndex++)
+            {
+                if (clients[clientIndex].socket >= 0 && !flush(&clients[clientIndex]))
+                {
+                    dropClient(&clients[clientIndex]);
+                }
+            }
+        }
+    }
+}
+
+static void printUsage()
+{
+    fprintf(stderr, "Usage: golfsim_service [--socket <path>] [--threads <count>] [--max-batch <count>]\n");
+    fprintf(stderr, "                       [--collision-kernel <scalar|sse2|avx2>]\n");
+}
+
+int main(int argc, char *argv[])
+{
+    const char *socketPath = SERVICE_DEFAULT_SOCKET_PATH;
+    u32 threads = 0;
+    u32 maxBatch = SERVICE_DEFAULT_MAX_BATCH;
+
+    for (s32 argIndex = 1; argIndex < argc; argIndex++)
+    {
+        const char *arg = argv[argIndex];
+        const char *value = argIndex + 1 < argc ? argv[argIndex + 1] : NULL;
+
+        if (strcmp(arg, "--socket") == 0 && value != NULL)
+        {
+            socketPath = value;
+            argIndex++;
+        }
+        else if (strcmp(arg, "--threads") == 0 && value != NULL)
+        {
+            threads = (u32)strtoul(value, NULL, 10);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--max-batch") == 0 && value != NULL && strtoul(value, NULL, 10) > 0)
+        {
+            maxBatch = (u32)strtoul(value, NULL, 10);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--collision-kernel") == 0 && value != NULL && parseCollisionKernel(value))
+        {
+            argIndex++;
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    spdlog::set_default_logger(spdlog::stdout_color_mt("service"));
+
+    signal(SIGINT, onQuitSignal);
+    signal(SIGTERM, onQuitSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    ShotService *service = new (std::nothrow) ShotService();
+    if (service == NULL)
+    {
+        spdlog::error("Failed to allocate the service");
+        return 1;
+    }
+
+    if (!service->open(socketPath, threads, maxBatch))
+    {
+        service->close();
+        delete service;
+        return 1;
+    }
+
+    service->run();
+    service->close();
+
+    const ServiceStats *stats = &service->stats;
+    spdlog::info("Service: {} shots ({} invalid) in {} batches, {:.1f} shots per batch, {} at most", stats->shots,
+                 stats->invalidShots, stats->batches,
+                 stats->batches > 0 ? (f64)stats->shots / (f64)stats->batches : 0.0, stats->largestBatch);
+    spdlog::info("Service: {:.2f} ms simulating per batch, {} protocol errors",
+                 stats->batches > 0 ? stats->simulationTime * 1000.0 / (f64)stats->batches : 0.0,
+                 stats->protocolErrors);
+
+    delete service;
+    return 0;
+}
@@ -0,0 +1,72 @@
+// Messages exchanged over the service's Unix domain socket. Both ends run on the same machine, so every field is in
+// host byte order. Each message is a header followed by size bytes of body, and a connection carries any number of
+// them back to back.
+
+#define SERVICE_MAGIC 0x4753  // "SG"
+#define SERVICE_PROTOCOL_VERSION 1
+#define SERVICE_DEFAULT_SOCKET_PATH "/tmp/golfsim.sock"
+
+#define SERVICE_MAX_PATH_SAMPLES 256
+
+enum ServiceMessageType
+{
+    SERVICE_MESSAGE_SHOT_REQUEST = 1,  // ServiceShotRequest
+    SERVICE_MESSAGE_SHOT_RESULT = 2,   // ServiceShotResult, then pathSampleCount ServicePathSample
+};
+
+struct ServiceMessageHeader
+{
+    u16 magic;
+    u8 version;
+    u8 type;
+    u32 size;
+};
+
+// Launch conditions in the same units spawnBall takes: m/s, radians and rpm
+struct ServiceShotRequest
+{
+    u32 id;  // Echoed in the result, so a client can have several requests in flight
+    f32 speed;
+    f32 launchAngle;
+    f32 heading;
+    f32 spinRate;
+    f32 spinAngle;
+
+    f32 windSpeed;  // m/s
+    f32 windDirection;
+    u16 logWind;  // Nonzero for the logarithmic wind profile
+
+    u16 pathSamples;  // Most points of the path wanted back, 0 for none, at most SERVICE_MAX_PATH_SAMPLES
+};
+
+enum ServiceShotStatus
+{
+    SERVICE_SHOT_OK,
+    SERVICE_SHOT_INVALID,    // Launch conditions out of range, nothing was simulated
+    SERVICE_SHOT_TIMED_OUT,  // Still moving after the longest simulated shot, the results are where it got to
+};
+
+// Distances in meters from where the ball was teed up, lateral is along x and the target line runs down z
+struct ServiceShotResult
+{
+    u32 id;
+    u16 status;
+    u16 pathSampleCount;
+
+    f32 carry;  // Horizontal distance to the first landing
+    f32 apex;   // Highest point above the tee
+    f32 lateral;
+    f32 total;  // Horizontal distance at rest
+    f32 flightTime;
+    f32 restTime;
+};
+
+// Positions relative to where the ball was teed up, evenly spaced in time from launch, the last one where it stopped
+struct ServicePathSample
+{
+    f32 x, y, z;
+};
+
+static_assert(sizeof(ServiceMessageHeader) == 8, "Service header must stay packed");
+static_assert(sizeof(ServiceShotRequest) == 36, "Service request must stay packed");
+static_assert(sizeof(ServiceShotResult) == 32, "Service result must stay packed");